@@ -0,0 +1,230 @@
+/**
+ * @file ldpc_batch.h
+ * @brief Inter-frame SIMD batch LDPC decoder (many codewords, one H).
+ *
+ * This header declares a decoder that runs LDPC_BATCH_LANES independent
+ * frames in lockstep on the same Tanner graph. All per-edge and
+ * per-variable quantities are stored frame-interleaved:
+ *
+ *      LLR[j * LDPC_BATCH_LANES + w]   (variable j, frame/lane w)
+ *
+ * so every Tanner-graph edge operation is one contiguous vector operation
+ * across the lanes; the edge index is shared by all frames and no gather
+ * is needed.
+ *
+ * Messages are single-precision floats only, so the lane count is fixed:
+ * 16 lanes fill one AVX-512 register, two AVX2 registers or four NEON
+ * registers. The vector target is chosen at runtime (or forced). On
+ * AArch64, NEON (ASIMD) is the baseline ISA and LDPC_SIMD_NEON runs the
+ * generic instantiation, which the compiler vectorizes for it.
+ *
+ * Only the min-sum family (LDPC_CN_MINSUM / NMS / OMS) is supported in
+ * batch mode; it consists of exact IEEE operations (add, compare, abs,
+ * one multiply) that give identical results in every SIMD width. The
+ * operations and their order per lane are those of the scalar decoder
+ * at LDPC_PREC_F32, so:
+ *
+ *   - every target is bit-identical to the generic build, and
+ *   - every lane is bit-identical (decisions and iteration count) to
+ *     ldpc_decoder_decode_f32() of that frame with the same kernel,
+ *     parameter and schedule. The scalar path can therefore validate
+ *     every vector path. Double-precision scalar decoding
+ *     (ldpc_decoder_decode()) rounds differently and is not identical.
+ */
+
+#ifndef LDPC_BATCH_H
+#define LDPC_BATCH_H
+
+#include <stdint.h>
+
+#include "ldpc_decoder.h"
+#include "ldpc_matrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of frames decoded in lockstep (one SIMD lane per frame). */
+#define LDPC_BATCH_LANES 16
+
+/* ============================================================================
+ *  SIMD targets
+ * ============================================================================
+ *
+ *  LDPC_SIMD_AUTO    : best target supported by the running CPU
+ *  LDPC_SIMD_GENERIC : portable C, baseline ISA of the build
+ *  LDPC_SIMD_AVX2    : x86-64 AVX2
+ *  LDPC_SIMD_AVX512  : x86-64 AVX-512 (F + BW)
+ *  LDPC_SIMD_NEON    : ARM NEON / AArch64 ASIMD
+ */
+typedef enum {
+  LDPC_SIMD_AUTO = 0,
+  LDPC_SIMD_GENERIC,
+  LDPC_SIMD_AVX2,
+  LDPC_SIMD_AVX512,
+  LDPC_SIMD_NEON
+} ldpc_simd_target;
+
+/** Short lowercase name of a target ("generic", "avx2", ...). */
+const char *ldpc_simd_target_name(ldpc_simd_target target);
+
+/** Return 1 if the target can run on this CPU (AUTO always can). */
+int ldpc_simd_target_supported(ldpc_simd_target target);
+
+/* ============================================================================
+ *  Batch decoder context
+ * ============================================================================
+ */
+typedef struct ldpc_batch_decoder ldpc_batch_decoder_t;
+
+/**
+ *  Create a batch decoder on top of an existing Tanner graph.
+ *
+ *  Parameters:
+ *      g       : Tanner graph (borrowed; must outlive the decoder)
+ *      K       : Information length (systematic tail)
+ *      target  : SIMD target; LDPC_SIMD_AUTO picks the best supported
+ *
+ *  Returns NULL if the requested target is not supported by this CPU.
+ *  Defaults: normalized min-sum (α = LDPC_NMS_ALPHA_DEFAULT), layered.
+ */
+ldpc_batch_decoder_t *ldpc_batch_create(const ldpc_graph_t *g, int K,
+                                        ldpc_simd_target target);
+
+/** Release a batch decoder (NULL is allowed). */
+void ldpc_batch_free(ldpc_batch_decoder_t *bd);
+
+/** Target actually used by a batch decoder (never LDPC_SIMD_AUTO). */
+ldpc_simd_target ldpc_batch_target(const ldpc_batch_decoder_t *bd);
+
+/**
+ *  Select the check-node kernel.
+ *
+ *  Returns 0 on success, -1 for LDPC_CN_SPA (not available in batch mode).
+ */
+int ldpc_batch_set_kernel(ldpc_batch_decoder_t *bd, ldpc_cn_kernel kernel,
+                          double param);
+
+/** Select flooding or layered schedule (default: layered). */
+void ldpc_batch_set_schedule(ldpc_batch_decoder_t *bd, ldpc_schedule schedule);
+
+/**
+ *  Decode up to LDPC_BATCH_LANES frames in lockstep.
+ *
+ *  Parameters:
+ *      bd        : Batch decoder
+ *      LLR       : Interleaved channel LLRs, [N * LDPC_BATCH_LANES]
+ *      ecc       : Interleaved decoded bits (0/1), [N * LDPC_BATCH_LANES]
+ *      n_frames  : Number of valid lanes (1 .. LDPC_BATCH_LANES);
+ *                  lanes >= n_frames are decoded but ignored
+ *      max_iter  : Maximum number of iterations
+ *      iters     : Optional [LDPC_BATCH_LANES] iterations used per lane
+ *                  (lanes that never converge report max_iter)
+ *
+ *  Each lane stops (its decisions are latched) as soon as its own
+ *  syndrome is zero, so every lane gives the same result as decoding that
+ *  frame alone. The call returns when all valid lanes have converged or
+ *  max_iter is reached, and returns the number of iterations executed.
+ *  No memory is allocated.
+ */
+int ldpc_batch_decode(ldpc_batch_decoder_t *bd, const float *LLR,
+                      uint8_t *ecc, int n_frames, int max_iter, int *iters);
+
+/* ============================================================================
+ *  Stream mode (per-lane refill)
+ * ============================================================================
+ *
+ *  Instead of decoding a fixed group of frames to the end, every lane holds
+ *  its own frame and iteration count:
+ *
+ *      ldpc_batch_stream_load(bd, lane, LLR)   put a frame into a free lane
+ *      fin = ldpc_batch_stream_step(bd, it)    one iteration of all lanes
+ *      for each bit w of fin:                  frames that finished
+ *          ldpc_batch_stream_result(bd, w, inf, &iters, &conv)
+ *          ... load the next frame into lane w
+ *
+ *  A frame finishes when its syndrome is zero or after max_iter iterations
+ *  of its own, so no lane waits for the slowest frame of a group. Each
+ *  frame gives the same result as ldpc_batch_decode() of that frame alone.
+ *  Stream mode shares the message storage with ldpc_batch_decode(): call
+ *  ldpc_batch_stream_reset() after a batch decode before streaming again.
+ */
+
+/** Free all lanes (drops the frames being decoded). */
+void ldpc_batch_stream_reset(ldpc_batch_decoder_t *bd);
+
+/**
+ *  Load frame LLR[N] into a free lane (converted to float).
+ *  Returns 0, or -1 if the lane is out of range or busy.
+ */
+int ldpc_batch_stream_load(ldpc_batch_decoder_t *bd, int lane,
+                           const double *LLR);
+
+/**
+ *  Same for frames stored as float or int8 LLRs (e.g. straight from an I/O
+ *  buffer); every value is multiplied by scale (the LSB weight of a fixed-
+ *  point stream, negative for the opposite sign convention).
+ */
+int ldpc_batch_stream_load_f32(ldpc_batch_decoder_t *bd, int lane,
+                               const float *LLR, float scale);
+int ldpc_batch_stream_load_s8(ldpc_batch_decoder_t *bd, int lane,
+                              const int8_t *LLR, float scale);
+
+/** Bit mask of the lanes that hold a frame. */
+uint32_t ldpc_batch_stream_busy(const ldpc_batch_decoder_t *bd);
+
+/**
+ *  Run one iteration on all lanes. Returns the bit mask of the lanes whose
+ *  frame finished in this iteration; these lanes are free again. No memory
+ *  is allocated.
+ */
+uint32_t ldpc_batch_stream_step(ldpc_batch_decoder_t *bd, int max_iter);
+
+/**
+ *  Result of the frame that last finished in `lane`: information bits
+ *  inf[K], iterations used and whether the syndrome vanished (iters and
+ *  converged may be NULL). Valid until the lane finishes its next frame.
+ */
+void ldpc_batch_stream_result(const ldpc_batch_decoder_t *bd, int lane,
+                              int *inf, int *iters, int *converged);
+
+/* ============================================================================
+ *  Layout helpers
+ * ============================================================================
+ */
+
+/** Store one frame of N double LLRs into lane `lane` of an interleaved
+ *  buffer. */
+void ldpc_batch_put_llr(float *LLR_batch, const double *LLR, int N, int lane);
+
+/** Extract the information bits (ecc[N-K .. N-1]) of lane `lane`. */
+void ldpc_batch_get_inf(const uint8_t *ecc_batch, int *inf, int N, int K,
+                        int lane);
+
+/**
+ *  Map LDPC_BATCH_LANES frames of a bit-sliced codeword (see
+ *  ldpc_encoder_encode_sliced()) to interleaved BPSK symbols:
+ *
+ *      x_batch[i * LDPC_BATCH_LANES + w] = bit ? +1 : −1,
+ *      bit = code[i] >> (first + w) & 1
+ *
+ *  first + LDPC_BATCH_LANES must not exceed LDPC_SLICE_FRAMES (64), so one
+ *  sliced block feeds four batch decodes (first = 0, 16, 32, 48).
+ */
+void ldpc_batch_put_sliced(float *x_batch, const uint64_t *code, int N,
+                           int first);
+
+/**
+ *  Store the decoded bits of lanes 0 .. n_frames-1 into bit positions
+ *  first .. first+n_frames-1 of a bit-sliced vector (other bits are kept).
+ *  XOR with the transmitted sliced codeword and popcount per word to count
+ *  bit errors of up to 64 frames at once.
+ */
+void ldpc_batch_get_sliced(uint64_t *code, const uint8_t *ecc_batch, int N,
+                           int first, int n_frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDPC_BATCH_H */
@@ -0,0 +1,112 @@
+/**
+ * @file ldpc_bitflip.h
+ * @brief Hard-decision bit-flipping decoders on bit-packed words.
+ *
+ * The decoders keep the hard decisions of the N code bits and the M-bit
+ * syndrome packed in 64-bit words. A frame whose hard decisions already
+ * satisfy H costs one pass over the LLRs and one over the edges; every
+ * flip then updates the syndrome of the flipped bit's checks and the
+ * flip metrics of their bits in place (O(w_c · w_r)), plus one scan of
+ * the N metrics per iteration.
+ *
+ * Channel values are normalized per frame, y_j = LLR_j / mean|LLR|, so
+ * the parameters do not depend on the noise variance. With the library
+ * convention (positive LLR = bit 1) the bipolar value of bit b is
+ * x = 2b − 1, and the hard decision agrees with the channel when
+ * x_j · y_j > 0.
+ *
+ * Modes (s_i = syndrome bit of check i, M(j) = checks of bit j,
+ * N(i) = bits of check i):
+ *
+ *   LDPC_BF_WBF  : modified weighted bit flipping,
+ *                    w_i = min_{k ∈ N(i)} |y_k|
+ *                    E_j = Σ_{i ∈ M(j)} (2 s_i − 1) w_i − α |y_j|
+ *                  one flip per iteration, the bit of largest E_j
+ *   LDPC_BF_GDBF : gradient-descent bit flipping,
+ *                    Δ_j = x_j y_j + Σ_{i ∈ M(j)} (1 − 2 s_i)
+ *                  every bit with Δ_j < θ is flipped while that lowers
+ *                  the syndrome weight, then one flip per iteration of
+ *                  the bit of smallest Δ_j
+ *
+ * Used on its own, or in front of the soft decoder through
+ * ldpc_decoder_set_hybrid() (ldpc_decoder.h).
+ *
+ * WBF is not a useful fast path for the (N, 3, 6) codes of matrices/. In
+ * front of NMS layered at N = 1024 it needs about 20 single flips per
+ * frame even at 6 dB: with a budget of 20 about 73 % of the frames fall
+ * back to the soft decoder (α from 0 to 4 does no better than the default
+ * 0.3); a budget of 60 brings that to 5 %, but the O(N) scan per flip then
+ * costs more than the soft decoder it avoids. GDBF settles about 99 % of
+ * the frames at 6 dB in under 4 iterations and is the hybrid default.
+ */
+
+#ifndef LDPC_BITFLIP_H
+#define LDPC_BITFLIP_H
+
+#include "ldpc_matrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { LDPC_BF_WBF = 0, LDPC_BF_GDBF } ldpc_bf_mode;
+
+#define LDPC_WBF_ALPHA_DEFAULT 0.3   /* channel weight of the WBF metric */
+#define LDPC_GDBF_THETA_DEFAULT -0.6 /* multi-flip threshold of GDBF     */
+#define LDPC_BF_ITER_DEFAULT 20      /* hybrid bit-flipping budget       */
+#define LDPC_BF_GATE_DEFAULT 4       /* attempt up to M / gate unsat. checks */
+
+/** Short lowercase name of a mode ("wbf", "gdbf"). */
+const char *ldpc_bf_mode_name(ldpc_bf_mode mode);
+
+/** Parse a mode name. Returns 0 on success, -1 if unknown. */
+int ldpc_bf_mode_parse(const char *name, ldpc_bf_mode *mode);
+
+/** Default parameter of a mode (α for WBF, θ for GDBF). */
+double ldpc_bf_param_default(ldpc_bf_mode mode);
+
+typedef struct ldpc_bf_decoder ldpc_bf_decoder_t;
+
+/**
+ *  Create a bit-flipping decoder on an existing Tanner graph (borrowed,
+ *  must outlive the decoder). Mode: GDBF with its default θ.
+ */
+ldpc_bf_decoder_t *ldpc_bf_create(const ldpc_graph_t *g, int K);
+
+/** Release a decoder (NULL is allowed). */
+void ldpc_bf_free(ldpc_bf_decoder_t *bf);
+
+/** Select the mode and its parameter (α for WBF, θ for GDBF). */
+void ldpc_bf_set_mode(ldpc_bf_decoder_t *bf, ldpc_bf_mode mode, double param);
+
+/**
+ *  Syndrome-weight gate: frames with more than M / gate unsatisfied checks
+ *  are not attempted (default LDPC_BF_GATE_DEFAULT; gate <= 0 attempts
+ *  every frame).
+ */
+void ldpc_bf_set_gate(ldpc_bf_decoder_t *bf, int gate);
+
+/**
+ *  Decode one frame: start from the hard decisions of LLR[N] and flip for
+ *  at most max_iter iterations. ecc[N] and inf[K] receive the final hard
+ *  decisions. No memory allocation.
+ *
+ *  A frame with more than M / gate unsatisfied checks at the start (see
+ *  ldpc_bf_set_gate()) is left as is: at that noise level bit flipping
+ *  rarely recovers it within a small budget.
+ *
+ *  Returns the number of iterations used (0 if the hard decisions already
+ *  were a codeword or the frame was not attempted); ldpc_bf_unsat() tells
+ *  whether the syndrome vanished.
+ */
+int ldpc_bf_decode(ldpc_bf_decoder_t *bf, const double *LLR, int *ecc,
+                   int *inf, int max_iter);
+
+/** Unsatisfied checks after the last ldpc_bf_decode() (0: codeword). */
+int ldpc_bf_unsat(const ldpc_bf_decoder_t *bf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDPC_BITFLIP_H */
@@ -6,6 +6,8 @@
  * @brief LDPC Sum-Product (SPA) decoder and bit-wise LLR utilities.
  *
  * This header declares:
+ *   - A reusable decoder context (ldpc_decoder_t) that holds the Tanner
+ *     graph and edge-indexed message storage, built once from H
  *   - A standard LDPC decoder based on the Sum-Product Algorithm (SPA)
  *     in the log-likelihood ratio (LLR) domain
  *   - A helper function to convert symbol-wise likelihoods into
@@ -21,10 +23,310 @@
  *        LLR = log( P(y|x=+1) / P(y|x=-1) )
  */
 
+#include <stdint.h>
+
+#include "ldpc_bitflip.h"
+#include "ldpc_matrix.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* ============================================================================
+ *  Decoder context
+ * ============================================================================
+ *
+ *  Holds everything that depends only on H:
+ *      - CSR/CSC edge lists of the Tanner graph (ldpc_graph_t)
+ *      - V→C and C→V message arrays, one entry per edge
+ *
+ *  Create it once per parity-check matrix and reuse it for every frame;
+ *  ldpc_decoder_decode() performs no memory allocation.
+ *
+ *  A context is not thread-safe: use one context per thread. Several
+ *  contexts may share one graph via ldpc_decoder_create_from_graph().
+ */
+typedef struct ldpc_decoder ldpc_decoder_t;
+
+/**
+ *  Build a decoder context from a dense parity-check matrix.
+ *
+ *  Parameters:
+ *      H[M][N]   : Parity-check matrix (entries are 0/1)
+ *      M         : Number of parity-check equations
+ *      N         : Codeword length
+ *      K         : Information word length (systematic tail)
+ *
+ *  Returns a new context; release with ldpc_decoder_free().
+ */
+ldpc_decoder_t *ldpc_decoder_create(int **H, int M, int N, int K);
+
+/**
+ *  Build a decoder context on top of an existing Tanner graph.
+ *
+ *  The graph is borrowed, not copied: it must outlive the context and is
+ *  not released by ldpc_decoder_free().
+ */
+ldpc_decoder_t *ldpc_decoder_create_from_graph(const ldpc_graph_t *g, int K);
+
+/** Release a decoder context (NULL is allowed). */
+void ldpc_decoder_free(ldpc_decoder_t *dec);
+
+/** Tanner graph used by a decoder context. */
+const ldpc_graph_t *ldpc_decoder_graph(const ldpc_decoder_t *dec);
+
+/* ============================================================================
+ *  Check-node kernels
+ * ============================================================================
+ *
+ *  LDPC_CN_SPA    : exact Sum-Product, v = sign · φ( Σ φ(|x|) )
+ *  LDPC_CN_MINSUM : min-sum,           v = sign · min|x|
+ *  LDPC_CN_NMS    : normalized MS,     v = sign · α · min|x|
+ *  LDPC_CN_OMS    : offset MS,         v = sign · max(min|x| − β, 0)
+ *
+ *  The min-sum family evaluates each check row in a single pass
+ *  (min1 / min2 / sign product), i.e. O(w_r) per check instead of
+ *  O(w_r²) with two exp() and one log() per term for SPA.
+ */
+typedef enum {
+  LDPC_CN_SPA = 0,
+  LDPC_CN_MINSUM,
+  LDPC_CN_NMS,
+  LDPC_CN_OMS
+} ldpc_cn_kernel;
+
+#define LDPC_NMS_ALPHA_DEFAULT 0.75 /* typical normalization for (3,6) codes */
+#define LDPC_OMS_BETA_DEFAULT 0.5   /* offset in LLR units                   */
+
+/* Magnitude the min-sum family takes for the (empty) minimum of the other
+ * edges of a degree-1 check, before α / β: what SPA sends there, spf() at
+ * its 1e-7 input clip. Keeps such rows finite in every schedule. */
+#define LDPC_CN_DEG1_MAG 16.811242832084588
+
+/**
+ *  Select the check-node kernel of a decoder context (default: SPA).
+ *
+ *  Parameters:
+ *      kernel : one of ldpc_cn_kernel
+ *      param  : α for LDPC_CN_NMS, β for LDPC_CN_OMS, ignored otherwise
+ */
+void ldpc_decoder_set_kernel(ldpc_decoder_t *dec, ldpc_cn_kernel kernel,
+                             double param);
+
+/* ============================================================================
+ *  Message-passing schedules
+ * ============================================================================
+ *
+ *  LDPC_SCHED_FLOODING : all check updates, then all variable updates
+ *  LDPC_SCHED_LAYERED  : layered / TDMP; the layers of ldpc_graph_t
+ *                        (Gallager row blocks) are updated one after the
+ *                        other on a running posterior LLR. Converges in
+ *                        about half the iterations and stores only the
+ *                        C→V messages.
+ */
+typedef enum { LDPC_SCHED_FLOODING = 0, LDPC_SCHED_LAYERED } ldpc_schedule;
+
+/** Select the schedule of a decoder context (default: flooding). */
+void ldpc_decoder_set_schedule(ldpc_decoder_t *dec, ldpc_schedule schedule);
+
+/* ============================================================================
+ *  SPA nonlinearity φ(x) = log((e^x + 1)/(e^x − 1))
+ * ============================================================================
+ *
+ *  LDPC_PHI_EXACT : libm exp()/log(), d² evaluations per check row
+ *                   (reference; identical to ldpc_decode_spa())
+ *  LDPC_PHI_LUT   : lookup table with linear interpolation
+ *  LDPC_PHI_PWL   : 16-segment piecewise-linear approximation
+ *
+ *  LUT and PWL use the "total minus self" row update, i.e. 2·d φ
+ *  evaluations per row of degree d. Only affects LDPC_CN_SPA.
+ */
+typedef enum { LDPC_PHI_EXACT = 0, LDPC_PHI_LUT, LDPC_PHI_PWL } ldpc_phi_mode;
+
+/** Select the φ implementation of a decoder context (default: exact). */
+void ldpc_decoder_set_phi(ldpc_decoder_t *dec, ldpc_phi_mode mode);
+
+/* ============================================================================
+ *  Degree-specialized schedules
+ * ============================================================================
+ *
+ *  If the most frequent column degree wc and row degree wr of H form one
+ *  of the built-in profiles (3,6), (4,8), (5,10), (3,12), the min-sum
+ *  family is decoded with schedules specialized at compile time for that
+ *  profile: rows of degree wr and columns of degree wc run fully unrolled
+ *  loops with their messages in registers and a branchless min1 / min2;
+ *  rows and columns of other degrees (e.g. the few empty rows and
+ *  degree-2 columns of a Gallager H) take the generic loops. The results
+ *  are identical to the generic path, which remains in use for other
+ *  profiles and SPA.
+ */
+
+/**
+ *  Degree profile of the code of a context: *wc, *wr receive the most
+ *  frequent column and row degree (either may be NULL).
+ *
+ *  Returns 1 if a specialized schedule exists for the profile.
+ */
+int ldpc_decoder_regular(const ldpc_decoder_t *dec, int *wc, int *wr);
+
+/** Use the specialized schedules when available (default 1; 0 forces the
+ *  generic loops, e.g. for comparisons). */
+void ldpc_decoder_set_specialized(ldpc_decoder_t *dec, int enable);
+
+/* ============================================================================
+ *  Message precision
+ * ============================================================================
+ *
+ *  LDPC_PREC_F64 : double LLRs and messages (reference)
+ *  LDPC_PREC_F32 : float LLRs and messages; half the message memory and
+ *                  twice the elements per vector register. With the
+ *                  min-sum family the BER is indistinguishable from double;
+ *                  SPA keeps evaluating φ in double
+ *
+ *  Both are built from the same kernel and schedule code. The input type
+ *  of ldpc_decoder_decode() (double) and ldpc_decoder_decode_f32() (float)
+ *  is independent of the precision: LLRs of the other type are converted
+ *  once per frame into a buffer of the context.
+ */
+typedef enum { LDPC_PREC_F64 = 0, LDPC_PREC_F32 } ldpc_precision;
+
+/** Select the message precision of a decoder context (default: f64). */
+void ldpc_decoder_set_precision(ldpc_decoder_t *dec, ldpc_precision prec);
+
+/** Message precision of a decoder context. */
+ldpc_precision ldpc_decoder_precision(const ldpc_decoder_t *dec);
+
+/** Short lowercase name of a precision ("f64", "f32"). */
+const char *ldpc_precision_name(ldpc_precision prec);
+
+/** Parse a precision name. Returns 0 on success, -1 if unknown. */
+int ldpc_precision_parse(const char *name, ldpc_precision *prec);
+
+/* ============================================================================
+ *  Hybrid bit-flipping front end
+ * ============================================================================
+ *
+ *  With a nonzero budget, every frame is first decoded by a hard-decision
+ *  bit-flipping decoder (ldpc_bitflip.h) for at most bf_iter iterations.
+ *  Only if its syndrome is still nonzero does the soft decoder run, from
+ *  the original channel LLRs. At high Eb/N0 most frames end in the
+ *  bit-flipping stage, which costs one pass over the edges for the
+ *  syndrome plus O(N) per flip iteration; at low Eb/N0 most frames fail
+ *  the syndrome-weight gate of ldpc_bf_decode() and go to the soft
+ *  decoder after that pass.
+ *
+ *  The soft iteration count returned by the decode functions is 0 for a
+ *  frame settled by bit flipping; ldpc_decoder_stats_t reports the
+ *  bit-flipping iterations and whether the frame fell back.
+ */
+
+/**
+ *  Enable (bf_iter > 0) or disable (bf_iter = 0) the bit-flipping front
+ *  end of a context (default: disabled).
+ *
+ *  Parameters:
+ *      bf_iter : bit-flipping budget, e.g. LDPC_BF_ITER_DEFAULT
+ *      mode    : LDPC_BF_GDBF or LDPC_BF_WBF
+ *      param   : θ (GDBF) or α (WBF), see ldpc_bf_param_default()
+ *      gate    : skip bit flipping above M / gate unsatisfied checks,
+ *                e.g. LDPC_BF_GATE_DEFAULT (<= 0: never skip)
+ */
+void ldpc_decoder_set_hybrid(ldpc_decoder_t *dec, int bf_iter,
+                             ldpc_bf_mode mode, double param, int gate);
+
+/** Short lowercase name of a φ mode ("exact", "lut", "pwl"). */
+const char *ldpc_phi_mode_name(ldpc_phi_mode mode);
+
+/** Parse a φ mode name. Returns 0 on success, -1 if unknown. */
+int ldpc_phi_mode_parse(const char *name, ldpc_phi_mode *mode);
+
+/** Short lowercase name of a kernel ("spa", "minsum", "nms", "oms"). */
+const char *ldpc_cn_kernel_name(ldpc_cn_kernel kernel);
+
+/**
+ *  Parse a kernel name as returned by ldpc_cn_kernel_name().
+ *
+ *  Returns 0 on success, -1 if the name is unknown.
+ */
+int ldpc_cn_kernel_parse(const char *name, ldpc_cn_kernel *kernel);
+
+/**
+ *  Decode one frame with a prebuilt context.
+ *
+ *  Parameters:
+ *      dec       : Decoder context
+ *      LLR[N]    : Input channel LLRs for each code bit
+ *      ecc[N]    : Output decoded codeword bits (0/1)
+ *      inf[K]    : Output decoded information bits (0/1)
+ *      max_iter  : Maximum number of iterations
+ *
+ *  Notes:
+ *      - Uses the kernel and schedule chosen with ldpc_decoder_set_kernel()
+ *        and ldpc_decoder_set_schedule(); with the defaults (SPA,
+ *        flooding) results are identical to ldpc_decode_spa().
+ *      - No memory allocation.
+ *
+ *  Returns the number of iterations used; a frame whose syndrome never
+ *  vanished reports max_iter.
+ */
+int ldpc_decoder_decode(ldpc_decoder_t *dec, const double *LLR, int *ecc,
+                        int *inf, int max_iter);
+
+/* ============================================================================
+ *  Per-frame decoder statistics
+ * ============================================================================
+ *
+ *  Filled by ldpc_decoder_decode_stats(). Phase times are wall-clock
+ *  nanoseconds summed over the iterations of the frame:
+ *
+ *      flooding : cn_ns = check-node update, vn_ns = variable-node update
+ *                 and tentative decision, syn_ns = parity check
+ *      layered  : cn_ns = fused row updates (check + posterior),
+ *                 vn_ns = tentative decision, syn_ns = parity check
+ *
+ *  unsat is optional: if non-NULL (caller-owned, at least max_iter
+ *  entries), unsat[t] receives the number of unsatisfied checks after
+ *  iteration t + 1 for t < iterations. The parity check then counts all
+ *  rows instead of stopping at the first unsatisfied one.
+ *
+ *  With the hybrid front end, iterations and the phase times refer to the
+ *  soft decoder (all 0 for a frame settled by bit flipping); without it,
+ *  fallback is 1 and the bit-flipping fields are 0.
+ *
+ *  ldpc_decoder_decode() is a separate instantiation of the same loops
+ *  without any of this bookkeeping, so it pays nothing for it.
+ */
+typedef struct {
+  int iterations;    /**< iterations used                              */
+  int converged;     /**< 1 if the syndrome vanished, 0 at max_iter    */
+  int *unsat;        /**< optional [max_iter] unsatisfied-check trace  */
+  uint64_t cn_ns;    /**< check-node phase time                        */
+  uint64_t vn_ns;    /**< variable-node phase time                     */
+  uint64_t syn_ns;   /**< syndrome phase time                          */
+  int bf_iterations; /**< hybrid: bit-flipping iterations (0: off)     */
+  int fallback;      /**< hybrid: 1 if the soft decoder had to run     */
+  uint64_t bf_ns;    /**< hybrid: bit-flipping stage time              */
+} ldpc_decoder_stats_t;
+
+/**
+ *  ldpc_decoder_decode() that also fills *stats (unsat is read, the other
+ *  fields are overwritten). Returns the number of iterations used.
+ */
+int ldpc_decoder_decode_stats(ldpc_decoder_t *dec, const double *LLR,
+                              int *ecc, int *inf, int max_iter,
+                              ldpc_decoder_stats_t *stats);
+
+/**
+ *  ldpc_decoder_decode() / ldpc_decoder_decode_stats() with float channel
+ *  LLRs (e.g. straight from a float demapper or stream), decoded in the
+ *  precision of the context.
+ */
+int ldpc_decoder_decode_f32(ldpc_decoder_t *dec, const float *LLR, int *ecc,
+                            int *inf, int max_iter);
+int ldpc_decoder_decode_f32_stats(ldpc_decoder_t *dec, const float *LLR,
+                                  int *ecc, int *inf, int max_iter,
+                                  ldpc_decoder_stats_t *stats);
+
 /* ============================================================================
  *  LDPC Decoder: Sum-Product Algorithm (SPA)
  * ============================================================================
@@ -46,10 +348,19 @@ extern "C" {
  *      - Early termination if all parity checks are satisfied.
  *      - Assumes systematic code: info bits are extracted from
  *            ecc[N-K ... N-1]
+ *      - Convenience wrapper: builds a temporary ldpc_decoder_t on each
+ *        call. Use ldpc_decoder_create()/ldpc_decoder_decode() when
+ *        decoding many frames with the same H.
  */
 void ldpc_decode_spa(double *LLR, int *ecc, int *inf, int **H, int M, int N,
                      int K, int max_iter);
 
+/** ldpc_decode_spa() with per-frame statistics (stats may be NULL);
+ *  returns the number of iterations used. */
+int ldpc_decode_spa_stats(double *LLR, int *ecc, int *inf, int **H, int M,
+                          int N, int K, int max_iter,
+                          ldpc_decoder_stats_t *stats);
+
 /* ============================================================================
  *  Compute bit-wise LLR from symbol-wise likelihoods
  * ============================================================================
@@ -69,6 +380,8 @@ void ldpc_decode_spa(double *LLR, int *ecc, int *inf, int **H, int M, int N,
  *  Notes:
  *      - Supports any M-ary modulation (BPSK, QPSK, 8PSK, 16QAM, ...)
  *      - Symbol bit-labels are derived from binary representation of k
+ *      - For AWGN samples, ldpc_demap() (ldpc_demap.h) computes the same
+ *        LLRs directly from y without the E x N likelihood table
  */
 void compute_llr_from_pyx(double **pyx, int E, int N, double *LLR);
 
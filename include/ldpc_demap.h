@@ -0,0 +1,124 @@
+/**
+ * @file ldpc_demap.h
+ * @brief Soft demappers: complex samples → bit LLRs for Gray QAM, PSK and
+ *        custom constellations.
+ *
+ * Channel model (complex AWGN, N0 = noise variance per complex sample,
+ * i.e. N0 / 2 per dimension):
+ *
+ *      y = x + n,   p(y | x) ∝ exp( −|y − x|² / N0 )
+ *
+ * and, with the convention of the rest of the library (positive = 1):
+ *
+ *      exact   : LLR_b = ln Σ_{x : b=1} e^{−|y−x|²/N0}
+ *                      − ln Σ_{x : b=0} e^{−|y−x|²/N0}
+ *      max-log : LLR_b = ( min_{x : b=0} |y−x|² − min_{x : b=1} |y−x|² ) / N0
+ *
+ * Labels: point k carries label k, bit b of a symbol is (label >> b) & 1
+ * and goes to LLR[i·m + b] (m = log2(order) bits per symbol), the layout
+ * of compute_llr_from_pyx().
+ *
+ * Built-in constellations (unit average energy):
+ *   - QAM (order 4^j): product of two Gray √order-PAMs, label bits
+ *     0 .. m/2−1 on I, m/2 .. m−1 on Q. Since the metric separates, both
+ *     modes are computed per dimension over √order levels instead of over
+ *     all points, which is exact for this labeling (16 + 16 metrics per
+ *     256-QAM symbol instead of 256).
+ *   - PSK (order 2^j): Gray-labeled points at angles 2πp/order + φ0,
+ *     φ0 = π for BPSK (bit 1 ↦ +1, matching ldpc_bpsk_awgn_llr()) and
+ *     π/order otherwise.
+ *
+ * Symbols are processed in fixed blocks of LDPC_DEMAP_BLOCK, point by
+ * point, so the inner loops run over contiguous symbol lanes and
+ * vectorize. The exact mode needs one exp() per point and symbol; the
+ * max-log mode none. Nothing is allocated per call: every output variant
+ * writes straight into the caller's decoder buffer.
+ */
+
+#ifndef LDPC_DEMAP_H
+#define LDPC_DEMAP_H
+
+#include <stdint.h>
+
+#include "ldpc_batch.h"
+#include "ldpc_fixed.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LDPC_DEMAP_BLOCK 16       /* symbols per inner block            */
+#define LDPC_DEMAP_MAX_POINTS 256 /* PSK / custom constellations        */
+#define LDPC_DEMAP_MAX_LEVELS 64  /* per dimension, i.e. QAM up to 4096 */
+
+typedef enum { LDPC_MOD_PSK = 0, LDPC_MOD_QAM } ldpc_mod_kind;
+
+typedef enum { LDPC_DEMAP_EXACT = 0, LDPC_DEMAP_MAXLOG } ldpc_demap_mode;
+
+typedef struct ldpc_demapper ldpc_demapper_t;
+
+/**
+ *  Built-in constellation: PSK of order 2 .. LDPC_DEMAP_MAX_POINTS, or
+ *  square QAM of order 4 .. LDPC_DEMAP_MAX_LEVELS² (order a power of 4).
+ *
+ *  Returns NULL for an unsupported order.
+ */
+ldpc_demapper_t *ldpc_demapper_create(ldpc_mod_kind kind, int order);
+
+/**
+ *  Custom constellation: iq[2k], iq[2k+1] is the point with label k,
+ *  order a power of two up to LDPC_DEMAP_MAX_POINTS (copied).
+ *
+ *  Returns NULL for an unsupported order.
+ */
+ldpc_demapper_t *ldpc_demapper_create_points(const double *iq, int order);
+
+/**
+ *  Parse "bpsk", "qpsk", "8psk", "16psk", ..., "16qam", "64qam", ... into a
+ *  built-in constellation. Returns NULL if unknown.
+ */
+ldpc_demapper_t *ldpc_demapper_parse(const char *name);
+
+/** Release a demapper (NULL is allowed). */
+void ldpc_demapper_free(ldpc_demapper_t *dm);
+
+/** Bits per symbol. */
+int ldpc_demapper_bits(const ldpc_demapper_t *dm);
+
+/** Number of points. */
+int ldpc_demapper_order(const ldpc_demapper_t *dm);
+
+/**
+ *  Map bits[n_sym · m] (bit b of symbol i at bits[i·m + b]) to the
+ *  interleaved I/Q samples iq[2 · n_sym].
+ */
+void ldpc_modulate(const ldpc_demapper_t *dm, const int *bits, int n_sym,
+                   double *iq);
+
+/**
+ *  Demap n_sym interleaved I/Q samples y[2 · n_sym] into n_sym · m LLRs.
+ *
+ *      ldpc_demap()       : double LLRs (ldpc_decoder_t, QC decoder)
+ *      ldpc_demap_lane()  : float LLRs into lane `lane` of an interleaved
+ *                           batch buffer, LLR_batch[j · LDPC_BATCH_LANES +
+ *                           lane] for bit j
+ *      ldpc_demap_q8/q16(): quantized LLRs in format fmt (the same rounding
+ *                           and saturation as ldpc_quantize_llr_q8/q16())
+ */
+void ldpc_demap(const ldpc_demapper_t *dm, ldpc_demap_mode mode,
+                const double *y, int n_sym, double N0, double *LLR);
+void ldpc_demap_lane(const ldpc_demapper_t *dm, ldpc_demap_mode mode,
+                     const double *y, int n_sym, double N0, float *LLR_batch,
+                     int lane);
+void ldpc_demap_q8(const ldpc_demapper_t *dm, ldpc_demap_mode mode,
+                   const double *y, int n_sym, double N0, int8_t *q,
+                   const ldpc_qformat_t *fmt);
+void ldpc_demap_q16(const ldpc_demapper_t *dm, ldpc_demap_mode mode,
+                    const double *y, int n_sym, double N0, int16_t *q,
+                    const ldpc_qformat_t *fmt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDPC_DEMAP_H */
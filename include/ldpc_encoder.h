@@ -19,6 +19,10 @@
 #ifndef LDPC_ENCODER_H
 #define LDPC_ENCODER_H
 
+#include <stdint.h>
+
+#include "ldpc_matrix.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -45,6 +49,167 @@ extern "C" {
  */
 void ldpc_encode(int *ecc, const int *inf, int **G, int N, int K);
 
+/* ============================================================================
+ *  Packed bit vectors
+ * ============================================================================
+ *
+ *  Bit i of a packed vector is bit (i % 64) of word i / 64 (LSB first).
+ *  Unused high bits of the last word are zero on output and ignored on
+ *  input.
+ */
+
+/** Number of uint64_t words needed for n bits. */
+#define LDPC_BITS_WORDS(n) (((n) + 63) / 64)
+
+/** Pack n 0/1 ints into LDPC_BITS_WORDS(n) words. */
+void ldpc_pack_bits(uint64_t *dst, const int *src, int n);
+
+/** Unpack n bits into 0/1 ints. */
+void ldpc_unpack_bits(int *dst, const uint64_t *src, int n);
+
+/* ============================================================================
+ *  Packed systematic encoder
+ * ============================================================================
+ *
+ *  For a systematic G = [P | I_K] (parity bits first, information bits in
+ *  the tail, as produced by generate_Gmatrix()) only P is needed:
+ *
+ *      ecc[0 .. M-1]  = XOR of the P rows j with inf[j] = 1
+ *      ecc[M .. N-1]  = inf
+ *
+ *  P is stored bit-packed, K rows × LDPC_BITS_WORDS(M) words (32 KB for
+ *  N = 1024 instead of 2 MB for the int G). Encoding allocates nothing and
+ *  the context is read-only, so one encoder may be shared by threads.
+ */
+typedef struct ldpc_encoder ldpc_encoder_t;
+
+/**
+ *  Build a packed encoder from a K×N generator matrix.
+ *
+ *  Returns NULL if G is not of the form [P | I_K]; use ldpc_encode() for
+ *  such matrices.
+ */
+ldpc_encoder_t *ldpc_encoder_create(int **G, int N, int K);
+
+/**
+ *  Build an encoder on an already packed P (K rows × LDPC_BITS_WORDS(N-K)
+ *  words, e.g. the P block of a binary matrix file). P is borrowed and
+ *  must outlive the encoder.
+ */
+ldpc_encoder_t *ldpc_encoder_create_packed(const uint64_t *P, int N, int K);
+
+/** Release an encoder (NULL is allowed). */
+void ldpc_encoder_free(ldpc_encoder_t *enc);
+
+/** Packed P of an encoder (K rows × LDPC_BITS_WORDS(N-K) words). */
+const uint64_t *ldpc_encoder_parity(const ldpc_encoder_t *enc);
+
+/** Encode int bits: inf[K] → ecc[N] (same result as ldpc_encode()). */
+void ldpc_encoder_encode(const ldpc_encoder_t *enc, int *ecc, const int *inf);
+
+/** Encode packed bits: inf[LDPC_BITS_WORDS(K)] → ecc[LDPC_BITS_WORDS(N)]. */
+void ldpc_encoder_encode_packed(const ldpc_encoder_t *enc, uint64_t *ecc,
+                                const uint64_t *inf);
+
+/* ============================================================================
+ *  Bit-sliced 64-frame encoder
+ * ============================================================================
+ *
+ *  Bit-sliced layout: word i holds bit i of LDPC_SLICE_FRAMES independent
+ *  frames, frame f in bit position f:
+ *
+ *      inf[j] >> f & 1  = information bit j of frame f   (K words)
+ *      ecc[i] >> f & 1  = codeword bit i of frame f      (N words)
+ *
+ *  Encoding is then a pure word-wide XOR network driven by the ones of P
+ *  (parity i = XOR of inf[j] over P[j][i] = 1), i.e. 64 frames cost the
+ *  same as one. ldpc_batch_put_sliced() maps such codewords straight into
+ *  the lanes of the batch SIMD decoder.
+ */
+
+/** Number of frames in one bit-sliced word. */
+#define LDPC_SLICE_FRAMES 64
+
+/** Encode 64 frames at once: inf[K] → ecc[N] (bit-sliced words). */
+void ldpc_encoder_encode_sliced(const ldpc_encoder_t *enc, uint64_t *ecc,
+                                const uint64_t *inf);
+
+/** Store n 0/1 ints as frame `frame` (bit position) of a sliced vector. */
+void ldpc_slice_put(uint64_t *sliced, const int *bits, int n, int frame);
+
+/** Extract frame `frame` of a sliced vector as n 0/1 ints. */
+void ldpc_slice_get(int *bits, const uint64_t *sliced, int n, int frame);
+
+/* ============================================================================
+ *  Encoder from the sparse parity-check matrix (no G)
+ * ============================================================================
+ *
+ *  Codeword layout as for G: ecc = [p | s], parity p in columns 0..M-1,
+ *  information s in columns M..N-1. Preprocessing (Richardson–Urbanke
+ *  style, restricted to the parity columns so the layout is kept):
+ *
+ *      Rows / parity columns of H are permuted greedily into
+ *
+ *            [ T  B | A ]      T : (M-g)×(M-g) lower triangular, unit diag.
+ *            [ E  D | C ]      B, D : the g "gap" columns
+ *
+ *      and the dense g×g matrix φ = E·T⁻¹·B + D is reduced once.
+ *
+ *  Encoding is two sparse forward substitutions through T plus one dense
+ *  g×g solve, i.e. O(n_edges + g²) instead of O(N·K) for a dense G.
+ *  Redundant rows of H (rank < M) are handled: the corresponding gap bits
+ *  are set to zero, which still yields a valid codeword.
+ */
+typedef struct ldpc_hencoder ldpc_hencoder_t;
+
+/**
+ *  Preprocess a Tanner graph for encoding.
+ *
+ *  g is borrowed and must outlive the encoder. Returns NULL if the parity
+ *  columns 0..M-1 cannot produce a codeword for every information word,
+ *  i.e. rank(H[:, 0..M-1]) < rank(H). The H written next to a G by
+ *  generate_Gmatrix() (columns already swapped) always works; for other
+ *  matrices see ldpc_hencoder_parity_perm().
+ */
+ldpc_hencoder_t *ldpc_hencoder_create(const ldpc_graph_t *g);
+
+/**
+ *  Find a column permutation that makes columns 0..M-1 a valid parity set
+ *  (the sparse counterpart of the H column swaps in generate_Gmatrix()).
+ *
+ *  perm[N] receives the permutation in ldpc_graph_permute_cols() order;
+ *  only information / parity column pairs are swapped. Returns the number
+ *  of swapped pairs (0: H is usable as is), or -1 if none was found.
+ */
+int ldpc_hencoder_parity_perm(const ldpc_graph_t *g, int *perm);
+
+/**
+ *  Save / load the preprocessing (binary, native byte order).
+ *
+ *  ldpc_hencoder_load() returns NULL if the file is missing or was made
+ *  for a different graph.
+ *  ldpc_hencoder_save() returns 0 on success, -1 on I/O failure.
+ */
+int ldpc_hencoder_save(const ldpc_hencoder_t *enc, const char *path);
+ldpc_hencoder_t *ldpc_hencoder_load(const ldpc_graph_t *g, const char *path);
+
+/** Independent copy of an H encoder on the same graph (one per thread). */
+ldpc_hencoder_t *ldpc_hencoder_dup(const ldpc_hencoder_t *enc);
+
+/** Release an H encoder (NULL is allowed). */
+void ldpc_hencoder_free(ldpc_hencoder_t *enc);
+
+/** Gap g (size of the dense part) of an H encoder. */
+int ldpc_hencoder_gap(const ldpc_hencoder_t *enc);
+
+/**
+ *  Encode inf[K] → ecc[N] with K = N - M.
+ *
+ *  No memory is allocated; the encoder holds a small scratch buffer, so
+ *  use one encoder per thread.
+ */
+void ldpc_hencoder_encode(ldpc_hencoder_t *enc, int *ecc, const int *inf);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,121 @@
+/**
+ * @file ldpc_fixed.h
+ * @brief Fixed-point (int8 / int16) LDPC min-sum decoder and LLR quantizer.
+ *
+ * This header declares a quantized counterpart of ldpc_decoder_t:
+ *
+ *   - Channel LLRs, V→C and C→V messages are saturating integers
+ *   - Storage is int8_t for formats up to 8 bits and int16_t otherwise,
+ *     i.e. 8× / 4× smaller message arrays than the double decoder
+ *   - The running posterior keeps 2 extra bits of headroom
+ *   - Min-sum family kernels (MS / NMS / OMS), flooding or layered
+ *
+ * Quantization format (ldpc_qformat_t):
+ *
+ *      q = sat( round( clip(LLR) · 2^frac_bits ) ),   |q| ≤ 2^(bits−1) − 1
+ *
+ * The symmetric range keeps sign/magnitude operations exact (no −2^(b−1)).
+ */
+
+#ifndef LDPC_FIXED_H
+#define LDPC_FIXED_H
+
+#include <stdint.h>
+
+#include "ldpc_decoder.h"
+#include "ldpc_matrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ *  Quantization format
+ * ============================================================================
+ */
+typedef struct {
+  int bits;      /**< total width including sign, 2 .. 16            */
+  int frac_bits; /**< fractional bits (LSB = 2^-frac_bits)           */
+  double clip;   /**< |LLR| clip before scaling (<= 0: none)         */
+} ldpc_qformat_t;
+
+/** Largest representable message magnitude, 2^(bits−1) − 1. */
+int ldpc_qformat_max(const ldpc_qformat_t *fmt);
+
+/**
+ *  Parse "B.F" or "B.F:clip" (e.g. "6.2", "8.3:12"); the whole string
+ *  has to be the format.
+ *
+ *  Returns 0 on success, -1 on a malformed or out-of-range format
+ *  (including trailing characters).
+ */
+int ldpc_qformat_parse(const char *str, ldpc_qformat_t *fmt);
+
+/**
+ *  Quantize n LLRs (e.g. LLR = 2·y/σ²) into int8 or int16.
+ *
+ *  ldpc_quantize_llr_q8() requires fmt->bits <= 8.
+ */
+void ldpc_quantize_llr_q8(const double *LLR, int8_t *q, int n,
+                          const ldpc_qformat_t *fmt);
+void ldpc_quantize_llr_q16(const double *LLR, int16_t *q, int n,
+                           const ldpc_qformat_t *fmt);
+
+/* ============================================================================
+ *  Fixed-point decoder context
+ * ============================================================================
+ */
+typedef struct ldpc_qdecoder ldpc_qdecoder_t;
+
+/**
+ *  Create a fixed-point decoder on top of an existing Tanner graph.
+ *
+ *  Parameters:
+ *      g    : Tanner graph (borrowed; must outlive the decoder)
+ *      K    : Information length (systematic tail)
+ *      fmt  : Message format (copied)
+ *
+ *  Defaults: offset min-sum with β = LDPC_OMS_BETA_DEFAULT, layered.
+ *  Returns NULL if the format is invalid.
+ */
+ldpc_qdecoder_t *ldpc_qdecoder_create(const ldpc_graph_t *g, int K,
+                                      const ldpc_qformat_t *fmt);
+
+/** Release a fixed-point decoder (NULL is allowed). */
+void ldpc_qdecoder_free(ldpc_qdecoder_t *qd);
+
+/** Message format of a fixed-point decoder. */
+const ldpc_qformat_t *ldpc_qdecoder_format(const ldpc_qdecoder_t *qd);
+
+/**
+ *  Select the check-node kernel.
+ *
+ *  param is given in LLR units like for ldpc_decoder_set_kernel():
+ *  α is rounded to 1/16 steps, β to the format's LSB.
+ *
+ *  Returns 0 on success, -1 for LDPC_CN_SPA (not available in fixed point).
+ */
+int ldpc_qdecoder_set_kernel(ldpc_qdecoder_t *qd, ldpc_cn_kernel kernel,
+                             double param);
+
+/** Select flooding or layered schedule (default: layered). */
+void ldpc_qdecoder_set_schedule(ldpc_qdecoder_t *qd, ldpc_schedule schedule);
+
+/**
+ *  Decode one frame of quantized LLRs.
+ *
+ *  Use the _q8 variant for formats up to 8 bits and _q16 otherwise.
+ *
+ *  Returns the number of iterations used, or -1 if the LLR width does not
+ *  match the decoder format. No memory is allocated.
+ */
+int ldpc_qdecoder_decode_q8(ldpc_qdecoder_t *qd, const int8_t *LLR, int *ecc,
+                            int *inf, int max_iter);
+int ldpc_qdecoder_decode_q16(ldpc_qdecoder_t *qd, const int16_t *LLR,
+                             int *ecc, int *inf, int max_iter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDPC_FIXED_H */
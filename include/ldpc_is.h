@@ -0,0 +1,160 @@
+/**
+ * @file ldpc_is.h
+ * @brief Importance sampling of the BPSK/AWGN channel for low error rates.
+ *
+ * Plain Monte Carlo needs about 100 / FER frames per Eb/N0 point, which
+ * rules out error rates much below 1e-7. Importance sampling draws the
+ * noise from a biased density q that makes decoder failures common and
+ * weights every frame by
+ *
+ *      w = p(n) / q(n)        (p: the true N(0, σ²) noise density)
+ *
+ * With e_f the error indicator (or bit error count) of frame f,
+ * (1/n) Σ w_f e_f is an unbiased estimate of FER (BER·K) for any q that
+ * is positive wherever p is, and its sample variance gives the
+ * confidence interval (ldpc_is_estimate()).
+ *
+ * The biased density is a defensive mixture of mean-shifted Gaussians,
+ *
+ *      q(n) = p0 · p(n) + (1 − p0) / S · Σ_k p(n − μ_k),
+ *
+ * where μ_k moves the bits of set k by `shift` (in units of the BPSK
+ * amplitude, 1 = onto the decision boundary) towards the wrong sign. The
+ * unshifted component bounds every weight by 1 / p0, so no frame can
+ * blow up the variance; the estimate stays unbiased whichever sets are
+ * chosen, the sets only decide how fast it converges.
+ *
+ * Modes:
+ *   LDPC_IS_SHIFT : one set, all N bits (mean translation; the shifted
+ *                   component is the channel at a lower Eb/N0). The log
+ *                   weight of a frame has a variance of about N s² / σ²,
+ *                   so the shift has to shrink like σ / √N: at N ≈ 1000
+ *                   a fixed s = 0.2 gives N s² / σ² ≈ 70 at 2.5 dB and
+ *                   the estimate rests on one or two frames.
+ *                   ldpc_is_shift_auto() keeps that variance at
+ *                   LDPC_IS_SHIFT_KAPPA², which at N = 1024 moves the
+ *                   channel by well under 1 dB: a check of plain Monte
+ *                   Carlo for long codes rather than a way to reach the
+ *                   error floor (short codes gain more).
+ *   LDPC_IS_TS    : trapping-set targeted: one set per variable node, the
+ *                   variables of a shortest cycle through it (a 4-cycle if
+ *                   H has one, else a girth cycle, as found by
+ *                   ldpc_graph_girth()), up to length LDPC_IS_MAX_CYCLE.
+ *                   For a w_c = 3 code of girth 6 a 6-cycle is a (3, 3)
+ *                   trapping set, the kind of small structure error
+ *                   floors come from. ldpc_is_calibrate() then keeps
+ *                   the sets the decoder actually fails on and gives
+ *                   each its own shift.
+ *
+ * A density only reads the graph while it is built and is afterwards
+ * read-only, so one density can serve every simulation thread.
+ */
+
+#ifndef LDPC_IS_H
+#define LDPC_IS_H
+
+#include "ldpc_decoder.h"
+#include "ldpc_matrix.h"
+#include "ldpc_noise.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum { LDPC_IS_SHIFT = 0, LDPC_IS_TS } ldpc_is_mode;
+
+#define LDPC_IS_SHIFT_DEFAULT 0.2    /* mean shift of LDPC_IS_SHIFT      */
+#define LDPC_IS_TS_SHIFT_DEFAULT 1.0 /* mean shift of LDPC_IS_TS         */
+#define LDPC_IS_P0_DEFAULT 0.1       /* weight of the unbiased component */
+#ifndef LDPC_IS_MAX_CYCLE
+#define LDPC_IS_MAX_CYCLE 12 /* longest cycle used as an LDPC_IS_TS set */
+#endif
+#define LDPC_IS_IMPULSE_MAX 8.0 /* largest shift tried by calibration */
+#define LDPC_IS_SHIFT_KAPPA 2.0 /* ldpc_is_shift_auto(): s = κ σ / √N  */
+/* Fewer effective error frames, (Σw·e)² / Σ(w·e)², and the sample
+ * variance says little about the error of the estimate: no CI. */
+#define LDPC_IS_MIN_EFF_FRAMES 20
+
+/** Short lowercase name of a mode ("shift", "ts"). */
+const char *ldpc_is_mode_name(ldpc_is_mode mode);
+
+/** Parse a mode name. Returns 0 on success, -1 if unknown. */
+int ldpc_is_mode_parse(const char *name, ldpc_is_mode *mode);
+
+/** Default shift of a mode. */
+double ldpc_is_shift_default(ldpc_is_mode mode);
+
+typedef struct ldpc_is ldpc_is_t;
+
+/**
+ *  Build the biased density of a mode for the code of graph g, with the
+ *  given mean shift and unbiased mixture weight p0 (0 < p0 < 1).
+ *
+ *  Returns NULL if p0 is out of range or LDPC_IS_TS finds no cycle of at
+ *  most LDPC_IS_MAX_CYCLE edges.
+ */
+ldpc_is_t *ldpc_is_create(const ldpc_graph_t *g, ldpc_is_mode mode,
+                          double shift, double p0);
+
+/** Release a density (NULL is allowed). */
+void ldpc_is_free(ldpc_is_t *is);
+
+/**
+ *  Shift of LDPC_IS_SHIFT for an Eb/N0 point: LDPC_IS_SHIFT_KAPPA · σ / √n
+ *  for a translation of n bits, so that the log weights keep a variance
+ *  of about κ² whatever N and σ.
+ */
+double ldpc_is_shift_auto(int n, double sigma2);
+
+/**
+ *  Give every set the same shift and use all of them again (undoes
+ *  ldpc_is_calibrate()); e.g. ldpc_is_shift_auto() per point. Must not
+ *  run while the density is used for sampling.
+ */
+void ldpc_is_set_shift(ldpc_is_t *is, double shift);
+
+/**
+ *  Error-impulse calibration of the set shifts for a decoder: for every
+ *  set, the smallest shift s ≤ LDPC_IS_IMPULSE_MAX for which the
+ *  noise-free all-zero frame with the set's bits moved by s is decoded
+ *  wrongly (bisection, 17 decodes), which puts the biased mean on the
+ *  decoder's error boundary. Sets the decoder corrects at every shift are
+ *  left out of the mixture; if it corrects all of them, nothing changes.
+ *  Every call starts again from all cycle sets, so a density can be
+ *  calibrated again for another sigma2.
+ *
+ *  dec must be configured like the decoder under test (kernel, schedule,
+ *  precision); sigma2 only matters for SPA, whose LLRs are not scale
+ *  invariant. N, K: code dimensions. Must not run while the density is
+ *  used for sampling. Returns the number of sets kept.
+ */
+int ldpc_is_calibrate(ldpc_is_t *is, ldpc_decoder_t *dec, int N, int K,
+                      int max_iter, double sigma2);
+
+/** Number of mixture components besides the unbiased one. */
+int ldpc_is_n_sets(const ldpc_is_t *is);
+
+/** Mean number of bits per set. */
+double ldpc_is_mean_set_size(const ldpc_is_t *is);
+
+/**
+ *  Biased counterpart of ldpc_bpsk_awgn_llr(): BPSK of code[n] plus noise
+ *  drawn from q, straight to LLR = 2y/σ². Returns the weight
+ *  p(n) / q(n) of the frame (in (0, 1/p0]). No memory allocation.
+ */
+double ldpc_is_awgn_llr(const ldpc_is_t *is, ldpc_rng_t *rng,
+                        const int *code, double *LLR, int n, double sigma2);
+
+/**
+ *  Estimate and 95 % confidence half-width from the sums of n per-frame
+ *  samples x_f = w_f · e_f: sum = Σ x_f, sum2 = Σ x_f². The half-width
+ *  uses the normal approximation, 1.96 · sqrt(Var(x) / n).
+ */
+void ldpc_is_estimate(double sum, double sum2, long long n, double *mean,
+                      double *ci95);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDPC_IS_H */
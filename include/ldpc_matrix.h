@@ -8,6 +8,9 @@
  *   1) Regular Gallager-type LDPC parity-check matrix generation (H)
  *   2) Systematic generator matrix construction (G) from H via Gaussian
  * elimination 3) 4-cycle counting for structural evaluation of LDPC codes
+ *   4) Sparse Tanner-graph (CSR/CSC edge list) representation of H
+ *   5) alist and memory-mappable binary files for the sparse H
+ *   6) Girth and 4- / 6-cycle counts on the Tanner graph
  *
  * All matrix operations are performed over GF(2), i.e., addition is XOR.
  */
@@ -15,6 +18,11 @@
 #ifndef LDPC_MATRIX_H
 #define LDPC_MATRIX_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ldpc_noise.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -86,6 +94,20 @@ void generate_Hmatrix(int **H, int N, int wc, int wr);
  */
 void generate_Gmatrix(int **H, int **G, int N, int wc, int wr);
 
+/** Default Four-Russians block size used by generate_Gmatrix(). */
+#define LDPC_M4RI_K_DEFAULT 6
+
+/**
+ * @brief generate_Gmatrix() with an explicit elimination block size.
+ *
+ * The elimination runs on bit-packed rows. m4ri_k > 0 enables the Method
+ * of Four Russians with blocks of m4ri_k columns (at most 16; a table of
+ * 2^m4ri_k rows is used), m4ri_k = 0 eliminates column by column. G and
+ * the column swaps applied to H are identical for every m4ri_k.
+ */
+void generate_Gmatrix_m4ri(int **H, int **G, int N, int wc, int wr,
+                           int m4ri_k);
+
 /* ========================================================================== */
 /* 3. Structural Analysis: 4-Cycle Counting                                   */
 /* ========================================================================== */
@@ -100,7 +122,11 @@ void generate_Gmatrix(int **H, int **G, int N, int wc, int wr);
  *   - For each column, record the indices of the rows where H(row, col) = 1
  *   - For every unordered pair of columns, count how many rows they share
  *   - If two columns share `shared >= 2` check nodes, they contribute
- *     nC2 = shared! / (2!(shared − 2)!) distinct 4-cycles
+ *     nC2 = shared·(shared − 1)/2 distinct 4-cycles
+ *
+ * Only pairs that meet in some check are visited (through the rows of each
+ * column), i.e. O(M·wr²) work after one scan of H; see
+ * ldpc_graph_count_4cycles().
  *
  * This function is intended for structural analysis only; it does not
  * modify H.
@@ -114,6 +140,230 @@ void generate_Gmatrix(int **H, int **G, int N, int wc, int wr);
  */
 int count_floop(int **H, int N, int wc, int wr);
 
+/* ========================================================================== */
+/* 4. Sparse Tanner-Graph Representation                                      */
+/* ========================================================================== */
+/**
+ * @brief Edge-list view of a parity-check matrix H (M×N).
+ *
+ * Every '1' of H is one Tanner-graph edge. Edges are numbered in
+ * check-major order (row by row, columns ascending), which is the
+ * layout used by edge-indexed message arrays in the decoder:
+ *
+ *   CSR (check side):
+ *     edges of check i      : e = row_ptr[i] .. row_ptr[i+1]-1
+ *     variable of edge e    : col_idx[e]
+ *
+ *   CSC (variable side):
+ *     slots of variable j   : s = col_ptr[j] .. col_ptr[j+1]-1
+ *     edge of slot s        : col_edge[s]   (check-major edge index)
+ *     check of slot s       : row_idx[s]
+ *
+ * Within each check the variables are in ascending order, and within each
+ * variable the checks are in ascending order.
+ *
+ *   Layers (for layered decoding):
+ *     rows of layer l       : i = layer_ptr[l] .. layer_ptr[l+1]-1
+ *
+ * A layer is a run of consecutive rows that share no column, so all of its
+ * checks can be updated independently. For Gallager matrices from
+ * generate_Hmatrix() the layers are exactly the w_c row blocks of M/w_c
+ * rows, each touching every column once.
+ */
+typedef struct {
+  int M;       /**< number of checks (rows of H)           */
+  int N;       /**< number of variables (columns of H)     */
+  int n_edges; /**< number of ones in H                    */
+
+  int *row_ptr;  /**< [M+1] CSR row offsets                  */
+  int *col_idx;  /**< [n_edges] variable index per edge      */
+  int *col_ptr;  /**< [N+1] CSC column offsets               */
+  int *col_edge; /**< [n_edges] edge index per column slot   */
+  int *row_idx;  /**< [n_edges] check index per column slot  */
+
+  int max_row_deg; /**< largest check degree                 */
+  int max_col_deg; /**< largest variable degree              */
+
+  int n_layers;   /**< number of row layers                  */
+  int *layer_ptr; /**< [n_layers+1] first row of each layer  */
+
+  void *map;       /**< file image the arrays point into, or NULL */
+  size_t map_size; /**< size of map in bytes                      */
+} ldpc_graph_t;
+
+/**
+ * @brief Build the sparse Tanner graph of a dense parity-check matrix.
+ *
+ * This is a one-time O(M·N) scan of H; all later graph walks are
+ * O(n_edges).
+ *
+ * @param H  Parity-check matrix (M × N), entries in {0,1}
+ * @param M  Number of rows
+ * @param N  Number of columns
+ *
+ * @return   Newly allocated graph (release with ldpc_graph_free()).
+ */
+ldpc_graph_t *ldpc_graph_create(int **H, int M, int N);
+
+/**
+ * @brief Build a Tanner graph from CSR edge lists.
+ *
+ * @param M        Number of rows
+ * @param N        Number of columns
+ * @param row_ptr  [M+1] first edge of each row
+ * @param col_idx  [row_ptr[M]] column of each edge (check-major)
+ *
+ * The arrays are copied. O(n_edges + M + N).
+ */
+ldpc_graph_t *ldpc_graph_create_csr(int M, int N, const int *row_ptr,
+                                    const int *col_idx);
+
+/**
+ * @brief Gallager construction straight into a Tanner graph.
+ *
+ * Builds the same kind of H as generate_Hmatrix() (deterministic block 0,
+ * blocks 1 .. wc-1 shuffled column permutations of it), but:
+ *   - draws from the caller's stream instead of rand(), so threads can
+ *     generate candidates concurrently and reproducibly
+ *   - never forms the dense M×N matrix: O(N·wc) work per candidate
+ *
+ * @param rng  Random stream (advanced by (wc−1)·N draws)
+ */
+ldpc_graph_t *ldpc_graph_gallager(int N, int wc, int wr, ldpc_rng_t *rng);
+
+/**
+ * @brief Progressive Edge Growth (Hu, Eleftheriou, Arnold) construction.
+ *
+ * Builds an M×N H (M = N·wc/wr) with column weight wc, one edge at a
+ * time. Variable j receives its k-th edge to the check that is farthest
+ * from j in the graph built so far (unreachable checks count as
+ * infinitely far), so every new edge closes the longest possible cycle;
+ * ties go to the check of lowest degree, then at random. Check degrees are
+ * capped at ⌈N·wc/M⌉, which gives exactly wr when wr divides N·wc.
+ *
+ * Each edge costs one breadth-first search of the current graph:
+ * O(N·wc · n_edges) in total, seconds for N in the thousands.
+ *
+ * @param rng  Random stream for tie-breaking
+ */
+ldpc_graph_t *ldpc_graph_peg(int N, int wc, int wr, ldpc_rng_t *rng);
+
+/**
+ * @brief Copy of a graph with permuted columns.
+ *
+ * Column j of the result is column perm[j] of g (the same convention as
+ * a dense  H'[i][j] = H[i][perm[j]]). Rows and edge order are kept.
+ */
+ldpc_graph_t *ldpc_graph_permute_cols(const ldpc_graph_t *g,
+                                      const int *perm);
+
+/**
+ * @brief Release a graph created by ldpc_graph_create(),
+ *        ldpc_graph_read_alist() or ldpc_graph_load_bin(). NULL is allowed.
+ */
+void ldpc_graph_free(ldpc_graph_t *g);
+
+/* ========================================================================== */
+/* 5. Sparse Matrix Files                                                     */
+/* ========================================================================== */
+/**
+ * @brief Write H in MacKay's alist format.
+ *
+ *   N M
+ *   max_col_deg max_row_deg
+ *   N column degrees
+ *   M row degrees
+ *   N lines: 1-based rows of each column, 0-padded to max_col_deg
+ *   M lines: 1-based columns of each row, 0-padded to max_row_deg
+ *
+ * @return 0 on success, -1 on an I/O error.
+ */
+int ldpc_graph_write_alist(const ldpc_graph_t *g, const char *path);
+
+/**
+ * @brief Read an alist file (zero padding is optional).
+ *
+ * The column lists define H; the row degrees are checked against them.
+ *
+ * @return Newly allocated graph, or NULL if the file is missing or
+ *         malformed.
+ */
+ldpc_graph_t *ldpc_graph_read_alist(const char *path);
+
+/** Version of the binary matrix format written by ldpc_graph_save_bin(). */
+#define LDPC_HBIN_VERSION 1
+
+/**
+ * @brief Write the graph (and optionally the P block of G) as a binary
+ *        image that ldpc_graph_load_bin() maps without parsing.
+ *
+ * Layout (native byte order, every section 8-byte aligned):
+ *
+ *   header : magic "LDPCHB01", version, byte-order mark 0x01020304,
+ *            M, N, n_edges, n_layers, max_row_deg, max_col_deg, K, pw,
+ *            file offsets of the sections below (0 = absent), file size
+ *   int32  : row_ptr[M+1], col_idx[n_edges], col_ptr[N+1],
+ *            col_edge[n_edges], row_idx[n_edges], layer_ptr[n_layers+1]
+ *   uint64 : P[K][pw], pw = (M+63)/64, row j = bits 0..M-1 of G row j
+ *            packed LSB-first (the layout of ldpc_encoder_create_packed())
+ *
+ * @param P  Packed parity part of G = [P | I_K], or NULL to omit it
+ * @param K  Number of P rows (ignored if P is NULL)
+ *
+ * @return 0 on success, -1 on an I/O error.
+ */
+int ldpc_graph_save_bin(const ldpc_graph_t *g, const uint64_t *P, int K,
+                        const char *path);
+
+/**
+ * @brief Map a binary matrix file written by ldpc_graph_save_bin().
+ *
+ * The graph arrays point directly into a read-only mmap() of the file, so
+ * loading costs one validation pass over the edges and no copies; pages
+ * are shared by all processes that map the same file. On Windows the file
+ * is read into one buffer instead.
+ *
+ * @param P  If not NULL, receives the packed P block (inside the mapping,
+ *           valid until ldpc_graph_free()) or NULL if the file has none
+ * @param K  If not NULL, receives the number of P rows (0 without P)
+ *
+ * @return Graph (release with ldpc_graph_free()), or NULL if the file is
+ *         missing, of another version or byte order, or inconsistent.
+ */
+ldpc_graph_t *ldpc_graph_load_bin(const char *path, const uint64_t **P,
+                                  int *K);
+
+/* ========================================================================== */
+/* 6. Girth and Short-Cycle Analysis                                          */
+/* ========================================================================== */
+/**
+ * @brief Number of 4-cycles of the Tanner graph.
+ *
+ * Σ over column pairs of C(shared, 2), found by walking each column's
+ * checks: O(n_edges · max_row_deg) time, O(N) memory.
+ */
+long long ldpc_graph_count_4cycles(const ldpc_graph_t *g);
+
+/**
+ * @brief Number of 6-cycles of the Tanner graph (exact, with or without
+ *        4-cycles present).
+ *
+ * Every triple of pairwise check-sharing columns contributes the number of
+ * ways to pick three distinct checks joining its pairs. Roughly
+ * O(N · (wc·(wr−1))² · wc) for a (wc, wr)-regular code.
+ */
+long long ldpc_graph_count_6cycles(const ldpc_graph_t *g);
+
+/**
+ * @brief Girth (length of the shortest cycle) of the Tanner graph.
+ *
+ * Exact, via breadth-first searches from every variable node that stop at
+ * half the shortest cycle found so far (and stop altogether at 4).
+ *
+ * @return Even length ≥ 4, or 0 if the graph has no cycle.
+ */
+int ldpc_graph_girth(const ldpc_graph_t *g);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,133 @@
+/**
+ * @file ldpc_qc.h
+ * @brief Quasi-cyclic (QC) LDPC codes: circulant base matrices, expansion
+ *        and a block-row decoder.
+ *
+ * A QC-LDPC parity-check matrix is an mb × nb array of Z × Z blocks. Each
+ * block is either zero or a cyclically shifted identity P^s, stored in the
+ * base matrix as its shift s (0 .. Z−1, −1 for a zero block):
+ *
+ *      row r·Z + i of block (r, c) has its one in column c·Z + (i + s) % Z
+ *
+ * so M = mb·Z, N = nb·Z and the whole code is mb·nb small integers.
+ *
+ * Base matrix file (text, '#' starts a comment up to the end of the line):
+ *
+ *      mb nb Z
+ *      s(0,0)    s(0,1)    ...  s(0,nb-1)
+ *      ...
+ *      s(mb-1,0) ...            s(mb-1,nb-1)
+ *
+ * The codeword layout is the one of the rest of the library:
+ * [parity (M bits) | info (K bits)], i.e. the info bits are the last K
+ * columns.
+ *
+ * The decoder processes one block row (Z checks that share no variable)
+ * at a time; every block edge is a run of Z contiguous messages, and the
+ * variables it touches are two contiguous runs of L[] (rotated indexing),
+ * so the inner loops are over Z independent lanes without any gather.
+ */
+
+#ifndef LDPC_QC_H
+#define LDPC_QC_H
+
+#include "ldpc_decoder.h"
+#include "ldpc_matrix.h"
+#include "ldpc_noise.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ *  Base matrix
+ * ============================================================================
+ */
+typedef struct {
+  int mb;     /**< block rows                                      */
+  int nb;     /**< block columns                                   */
+  int Z;      /**< circulant size (lifting factor)                 */
+  int *shift; /**< [mb·nb] row-major shifts, −1 = zero block       */
+} ldpc_qc_t;
+
+/** Allocate an mb × nb base matrix of zero blocks (shift −1). */
+ldpc_qc_t *ldpc_qc_create(int mb, int nb, int Z);
+
+/** Release a base matrix (NULL is allowed). */
+void ldpc_qc_free(ldpc_qc_t *qc);
+
+/**
+ *  Read / write a base matrix file (format above).
+ *
+ *  ldpc_qc_read() returns NULL if the file is missing or malformed
+ *  (a shift outside −1 .. Z−1, missing entries).
+ *  ldpc_qc_write() returns 0 on success, -1 on I/O failure.
+ */
+ldpc_qc_t *ldpc_qc_read(const char *path);
+int ldpc_qc_write(const ldpc_qc_t *qc, const char *path);
+
+/**
+ *  Expand to the Tanner graph of the full M × N matrix (release with
+ *  ldpc_graph_free()). Rows are ordered by block row, so the graph layers
+ *  are the block rows; within a row the columns are ascending.
+ */
+ldpc_graph_t *ldpc_qc_expand(const ldpc_qc_t *qc);
+
+/**
+ *  Fully populated mb × nb base matrix with random shifts.
+ *
+ *  Row 0 and column 0 have shift 0 (this does not change the cycle
+ *  structure); every other shift is drawn until it closes no 4-cycle with
+ *  the shifts placed so far, i.e. until
+ *
+ *      s(r,c) − s(r',c) + s(r',c') − s(r,c') ≢ 0  (mod Z)
+ *
+ *  for all r' < r, c' < c. If no such shift is found after a few hundred
+ *  draws (Z too small), the last draw is kept.
+ */
+ldpc_qc_t *ldpc_qc_random(int mb, int nb, int Z, ldpc_rng_t *rng);
+
+/* ============================================================================
+ *  Block-row layered decoder
+ * ============================================================================
+ */
+typedef struct ldpc_qc_decoder ldpc_qc_decoder_t;
+
+/**
+ *  Create a layered min-sum decoder for a QC code.
+ *
+ *  qc is borrowed and must outlive the decoder. Defaults: normalized
+ *  min-sum with α = LDPC_NMS_ALPHA_DEFAULT.
+ *
+ *  The arithmetic per check, the order of the edges within a check and
+ *  the order of the layers are those of ldpc_decoder_t with the layered
+ *  schedule on ldpc_qc_expand(qc), so both decoders return identical
+ *  results.
+ */
+ldpc_qc_decoder_t *ldpc_qc_decoder_create(const ldpc_qc_t *qc, int K);
+
+/** Release a QC decoder (NULL is allowed). */
+void ldpc_qc_decoder_free(ldpc_qc_decoder_t *dec);
+
+/**
+ *  Select the check-node kernel (param: α for NMS, β for OMS).
+ *
+ *  Returns 0 on success, -1 for LDPC_CN_SPA (min-sum family only).
+ */
+int ldpc_qc_decoder_set_kernel(ldpc_qc_decoder_t *dec, ldpc_cn_kernel kernel,
+                               double param);
+
+/**
+ *  Decode one frame; same interface as ldpc_decoder_decode().
+ *
+ *  Returns the number of iterations used (max_iter if the syndrome never
+ *  vanished). No memory is allocated.
+ */
+int ldpc_qc_decoder_decode(ldpc_qc_decoder_t *dec, const double *LLR,
+                           int *ecc, int *inf, int max_iter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDPC_QC_H */
@@ -0,0 +1,159 @@
+/**
+ * @file ldpc_registry.h
+ * @brief Registry of preloaded LDPC codes for switching codes per frame.
+ *
+ * A registry loads a set of code folders once (every N* folder of a
+ * directory such as matrices/, a list in a config file, or single
+ * folders) and keeps, per code, everything that depends only on H and G:
+ * the Tanner graph, the QC base matrix, the packed and dense G encoders
+ * and the sparse-H encoder. Codes are numbered 0, 1, ... in load order;
+ * ldpc_registry_code() is an array lookup.
+ *
+ * After loading, the registry is read-only and may be shared by any
+ * number of threads. The objects that keep per-frame state (decoder
+ * contexts, H encoders) are not thread-safe; one ldpc_registry_ctx_t per
+ * thread holds a ready-made copy of them for every code, so switching
+ * codes in the data path is a pointer lookup with no parsing, graph build
+ * or allocation.
+ *
+ * Folder contents (read this way by ldpc_ber, ldpc_stream and ldpc_bench,
+ * which all load through the registry): H from H.qc, H.bin, H.alist or
+ * H.csv (the first found; H.csv needs an N{N}_wc{wc}_wr{wr} folder name
+ * for its dimensions), G from the packed P block of H.bin or from G.csv,
+ * the H encoder from H_enc.bin or built from H.
+ *
+ * Config file: one code folder per line, optionally followed by a name
+ * under which ldpc_registry_find() knows it (default: the folder's base
+ * name). Empty lines and lines starting with '#' are skipped:
+ *
+ *      # link adaptation set
+ *      matrices/N1024_wc3_wr6   short
+ *      matrices/N2048_wc3_wr6   long
+ */
+
+#ifndef LDPC_REGISTRY_H
+#define LDPC_REGISTRY_H
+
+#include "ldpc_decoder.h"
+#include "ldpc_encoder.h"
+#include "ldpc_matrix.h"
+#include "ldpc_qc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** One code of a registry (owned by the registry, read-only). */
+typedef struct {
+  int id;             /**< index in the registry                          */
+  const char *name;   /**< lookup name (folder base name or config alias) */
+  const char *path;   /**< folder the code was loaded from                */
+  const char *h_file; /**< file H was read from (H.qc, ..., H.csv)        */
+  int N, K;           /**< code length and information length             */
+  int wc, wr;         /**< largest column / row degree of H               */
+
+  const ldpc_graph_t *graph; /**< Tanner graph                          */
+  const ldpc_qc_t *qc;       /**< QC base matrix (H.qc), or NULL        */
+  const ldpc_encoder_t *enc; /**< packed G encoder, or NULL             */
+  int **G;                   /**< dense G (from G.csv), or NULL         */
+  /** Sparse-H encoder template (copy it per thread, see
+   *  ldpc_registry_ctx_hencoder()), or NULL. If H had to be column
+   *  permuted for it, its codewords are in the column order of
+   *  henc_graph; otherwise henc_graph == graph. */
+  const ldpc_hencoder_t *henc;
+  const ldpc_graph_t *henc_graph;
+} ldpc_code_t;
+
+typedef struct ldpc_registry ldpc_registry_t;
+
+/** Create an empty registry. */
+ldpc_registry_t *ldpc_registry_create(void);
+
+/**
+ *  Add the codes of path to a registry:
+ *      - a config file            : ldpc_registry_load_config()
+ *      - a folder with an H file  : that single code
+ *      - any other folder         : ldpc_registry_scan()
+ *
+ *  Returns the number of codes added, or -1 if path does not exist or
+ *  the function it dispatches to fails.
+ */
+int ldpc_registry_load(ldpc_registry_t *reg, const char *path);
+
+/** ldpc_registry_create() + ldpc_registry_load(); NULL if no code was
+ *  loaded. */
+ldpc_registry_t *ldpc_registry_open(const char *path);
+
+/** Release a registry and all its codes (NULL is allowed). Contexts
+ *  created from it must be released first. */
+void ldpc_registry_free(ldpc_registry_t *reg);
+
+/**
+ *  Load one code folder under the given name (NULL: the folder's base
+ *  name). Returns the new code id, or -1 if no H could be loaded.
+ */
+int ldpc_registry_add(ldpc_registry_t *reg, const char *folder,
+                      const char *name);
+
+/**
+ *  Load every subfolder of dir whose name starts with 'N', in name order;
+ *  folders without a readable H are skipped. Returns the number of codes
+ *  added, or -1 if dir cannot be read.
+ */
+int ldpc_registry_scan(ldpc_registry_t *reg, const char *dir);
+
+/**
+ *  Load the folders listed in a config file (see above). Returns the
+ *  number of codes added, or -1 if the file cannot be read or a listed
+ *  folder has no readable H.
+ */
+int ldpc_registry_load_config(ldpc_registry_t *reg, const char *path);
+
+/** Number of codes. */
+int ldpc_registry_count(const ldpc_registry_t *reg);
+
+/** Code of an id (NULL if out of range). */
+const ldpc_code_t *ldpc_registry_code(const ldpc_registry_t *reg, int id);
+
+/** Id of the code with this name or folder path, or -1. */
+int ldpc_registry_find(const ldpc_registry_t *reg, const char *name);
+
+/** Id of the first code with these parameters, or -1. */
+int ldpc_registry_find_params(const ldpc_registry_t *reg, int N, int wc,
+                              int wr);
+
+/* ============================================================================
+ *  Per-thread contexts
+ * ============================================================================
+ *
+ *  A context holds one decoder context (on the shared graph) and one copy
+ *  of the H encoder for every code of the registry, all built by
+ *  ldpc_registry_ctx_create(). Codes added to the registry later are not
+ *  covered.
+ */
+typedef struct ldpc_registry_ctx ldpc_registry_ctx_t;
+
+/** Build the per-thread objects of every code of reg. */
+ldpc_registry_ctx_t *ldpc_registry_ctx_create(const ldpc_registry_t *reg);
+
+/** Release a context (NULL is allowed). */
+void ldpc_registry_ctx_free(ldpc_registry_ctx_t *ctx);
+
+/** Apply ldpc_decoder_set_kernel() / _set_schedule() to every decoder. */
+void ldpc_registry_ctx_set_kernel(ldpc_registry_ctx_t *ctx,
+                                  ldpc_cn_kernel kernel, double param);
+void ldpc_registry_ctx_set_schedule(ldpc_registry_ctx_t *ctx,
+                                    ldpc_schedule schedule);
+
+/** Decoder context of code id (NULL if out of range). */
+ldpc_decoder_t *ldpc_registry_ctx_decoder(ldpc_registry_ctx_t *ctx, int id);
+
+/** H encoder of code id (NULL if the code has none). */
+ldpc_hencoder_t *ldpc_registry_ctx_hencoder(ldpc_registry_ctx_t *ctx,
+                                            int id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDPC_REGISTRY_H */
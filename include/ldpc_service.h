@@ -0,0 +1,124 @@
+/**
+ * @file ldpc_service.h
+ * @brief Asynchronous multi-threaded decode service (work stealing, lane
+ *        refill).
+ *
+ * Frames are submitted one at a time from any thread and decoded by a pool
+ * of workers; results come back through a callback or a completion queue.
+ *
+ * Scheduling:
+ *   - Every worker owns a deque of queued frames. Submissions are dealt
+ *     round-robin onto the deques; a worker takes the oldest frame of its
+ *     own deque and, when that is empty, steals the newer half of another
+ *     worker's deque, so no core idles while frames are queued anywhere.
+ *   - With a min-sum kernel every worker runs a batch decoder in stream
+ *     mode (ldpc_batch_stream_step()): LDPC_BATCH_LANES frames iterate in
+ *     lockstep and a lane whose frame has converged (or reached max_iter)
+ *     is refilled with the next frame before the following iteration, so
+ *     lanes do not wait for the slowest frame of a group.
+ *   - With SPA every worker decodes one frame at a time (ldpc_decoder_t).
+ *
+ * Each frame gives the same decisions and iteration count as decoding it
+ * alone with the corresponding decoder, whichever worker or lane it lands
+ * on. Results are delivered in completion order, not submission order.
+ */
+
+#ifndef LDPC_SERVICE_H
+#define LDPC_SERVICE_H
+
+#include <stdint.h>
+
+#include "ldpc_batch.h"
+#include "ldpc_decoder.h"
+#include "ldpc_matrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** One decoded frame. */
+typedef struct {
+  uint64_t id;    /**< value returned by ldpc_service_submit()       */
+  void *user;     /**< user pointer passed to ldpc_service_submit()  */
+  const int *inf; /**< [K] information bits (see the delivery notes) */
+  int iterations; /**< iterations used                               */
+  int converged;  /**< 1 if the syndrome vanished                    */
+  int worker;     /**< worker that decoded the frame                 */
+} ldpc_service_result_t;
+
+/**
+ *  Completion callback, called on the worker thread that decoded the
+ *  frame; res->inf is only valid during the call. Callbacks of different
+ *  workers may run concurrently.
+ */
+typedef void (*ldpc_service_callback)(const ldpc_service_result_t *res,
+                                      void *arg);
+
+typedef struct {
+  const ldpc_graph_t *graph; /**< Tanner graph (borrowed)                 */
+  int K;                     /**< information length                      */
+  ldpc_cn_kernel kernel;
+  double cn_param; /**< α for NMS, β for OMS                           */
+  ldpc_schedule schedule;
+  int max_iter;
+  int n_threads;          /**< workers (>= 1)                           */
+  ldpc_simd_target target; /**< batch target (min-sum family only)      */
+  /** Frames submitted but not yet delivered (returned from the callback
+   *  or taken from the completion queue); ldpc_service_submit() blocks
+   *  beyond this (0: 4 · n_threads · LDPC_BATCH_LANES). */
+  int max_pending;
+  /** NULL: results go to the completion queue (ldpc_service_wait()). */
+  ldpc_service_callback callback;
+  void *callback_arg;
+} ldpc_service_config_t;
+
+typedef struct ldpc_service ldpc_service_t;
+
+/**
+ *  Create the service and start its workers (config is copied).
+ *
+ *  Returns NULL if n_threads < 1, max_iter < 1 or the batch target is not
+ *  supported by this CPU.
+ */
+ldpc_service_t *ldpc_service_create(const ldpc_service_config_t *cfg);
+
+/**
+ *  Wait until every submitted frame has been delivered, stop the workers
+ *  and release the service (NULL is allowed). Results still in the
+ *  completion queue are dropped.
+ */
+void ldpc_service_free(ldpc_service_t *svc);
+
+/**
+ *  Queue one frame of N channel LLRs (copied) and return its id (1, 2,
+ *  ...). Thread-safe; blocks while max_pending frames are outstanding.
+ */
+uint64_t ldpc_service_submit(ldpc_service_t *svc, const double *LLR,
+                             void *user);
+
+/**
+ *  Completion queue (no callback configured): take the oldest delivered
+ *  result and copy its information bits to inf[K].
+ *
+ *  ldpc_service_wait() blocks until a result is available and returns 0,
+ *  or -1 if nothing is outstanding (or a callback is configured).
+ *  ldpc_service_poll() does not block: 1 with a result, 0 without.
+ *  res->inf points to the caller's inf.
+ */
+int ldpc_service_wait(ldpc_service_t *svc, ldpc_service_result_t *res,
+                      int *inf);
+int ldpc_service_poll(ldpc_service_t *svc, ldpc_service_result_t *res,
+                      int *inf);
+
+/** Block until every submitted frame has been decoded and delivered
+ *  (with a completion queue: until the queue holds all of them). */
+void ldpc_service_drain(ldpc_service_t *svc);
+
+/** Number of frames moved between workers by stealing so far. */
+long long ldpc_service_steals(const ldpc_service_t *svc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDPC_SERVICE_H */
@@ -0,0 +1,183 @@
+/**
+ * @file ldpc_sim.h
+ * @brief Multi-threaded Monte Carlo BER engine (BPSK over AWGN).
+ *
+ * The frames of one Eb/N0 point are split across worker threads. Every
+ * worker owns its decoder contexts, buffers and random stream; the graph
+ * and the (const) encoders are shared. Worker t of point p in shard s
+ * draws from
+ *
+ *      ldpc_rng_stream(seed, s · LDPC_SIM_MAX_POINTS + p, t)
+ *
+ * and handles a fixed slice of the frames, so the error counts depend only
+ * on (seed, shard, n_threads) and not on scheduling. The worker threads
+ * are started once by ldpc_sim_create() and wait between calls, so many
+ * short ldpc_sim_run() calls cost no thread creation. Counts are summed in
+ * worker order when all workers of a call have finished. Shards of one
+ * seed never share a stream, so processes running different shards of
+ * the same points produce independent frames whose counts can be added.
+ *
+ * Per frame: random info bits → encode → BPSK (0 → −1, 1 → +1) + AWGN →
+ * LLR = 2y/σ² → decode with the configured decoder (the QC decoder for a
+ * QC code with a layered min-sum configuration), plus optionally the
+ * exact-phi reference decoder and the fixed-point decoders on the same
+ * LLRs.
+ *
+ * With an importance-sampling density (config.is, ldpc_is.h) the noise is
+ * drawn from that density and every frame also adds its weighted error
+ * counts, whose means are unbiased FER / BER estimates of the channel.
+ *
+ * In all-zero mode every frame is the all-zero codeword and no encoder is
+ * used. For a linear code on the output-symmetric BPSK/AWGN channel with a
+ * symmetric decoder (all kernels here, including the fixed-point
+ * quantizer), error statistics do not depend on the transmitted codeword,
+ * so the result is statistically identical to random data.
+ */
+
+#ifndef LDPC_SIM_H
+#define LDPC_SIM_H
+
+#include <stdint.h>
+
+#include "ldpc_decoder.h"
+#include "ldpc_encoder.h"
+#include "ldpc_fixed.h"
+#include "ldpc_is.h"
+#include "ldpc_matrix.h"
+#include "ldpc_noise.h"
+#include "ldpc_qc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of fixed-point formats decoded alongside. */
+#define LDPC_SIM_MAX_QUANT 8
+
+/** Largest max_iter accepted together with statistics (config.stats). */
+#define LDPC_SIM_MAX_ITER 256
+
+/** Stream blocks per shard: points 0 .. LDPC_SIM_MAX_POINTS − 1. */
+#define LDPC_SIM_MAX_POINTS 256
+
+typedef struct {
+  const ldpc_graph_t *graph; /**< Tanner graph (borrowed)                 */
+  int K;                     /**< information length                      */
+  /** QC base matrix that graph was expanded from, or NULL. With a min-sum
+   *  kernel and the layered schedule the main decoder is then the
+   *  block-row QC decoder (identical results, faster). */
+  const ldpc_qc_t *qc;
+
+  /* encoder: the first non-NULL of henc, enc, G is used (none if all_zero) */
+  const ldpc_hencoder_t *henc; /**< H encoder (copied for every worker)   */
+  const ldpc_encoder_t *enc;   /**< packed G encoder (shared)             */
+  int **G;                     /**< dense G for ldpc_encode() (shared)    */
+
+  ldpc_cn_kernel kernel;
+  double cn_param; /**< α for NMS, β for OMS                  */
+  ldpc_schedule schedule;
+  ldpc_phi_mode phi;
+  /** Message precision of the generic decoders (main and libm reference).
+   *  The QC decoder is double only and is not used with LDPC_PREC_F32. */
+  ldpc_precision precision;
+  /** Hybrid bit-flipping front end of the main decoder (bf_iter > 0,
+   *  see ldpc_decoder_set_hybrid()); the QC decoder is not used then. */
+  int bf_iter;
+  ldpc_bf_mode bf_mode;
+  double bf_param; /**< θ (GDBF) or α (WBF)                   */
+  int bf_gate;     /**< syndrome-weight gate, M / bf_gate      */
+  int check_libm; /**< also decode with the exact (libm) phi  */
+  int n_quant;    /**< fixed-point formats decoded alongside  */
+  ldpc_qformat_t quant[LDPC_SIM_MAX_QUANT];
+  int max_iter;
+  int all_zero; /**< transmit the all-zero codeword          */
+  /** Draw the noise from this importance-sampling density (shared,
+   *  read-only) instead of the channel, and sum the weighted error counts
+   *  into counts.is_*; NULL: plain Monte Carlo. The unweighted counts then
+   *  describe the biased channel. */
+  const ldpc_is_t *is;
+  /** Collect decoder statistics of the main decoder into counts.stats
+   *  (ldpc_decoder_decode_stats(); the QC decoder is not used then). */
+  int stats;
+
+  int n_threads; /**< worker threads (>= 1)                  */
+  uint64_t seed; /**< master seed of all random streams      */
+  int shard;     /**< stream shard (>= 0, 0: the default)    */
+} ldpc_sim_config_t;
+
+/** Decoder statistics, summed over frames (config.stats only). */
+typedef struct {
+  /** converged[i]: frames whose syndrome vanished after i iterations
+   *  (i = 0: settled by the bit-flipping front end) */
+  long long converged[LDPC_SIM_MAX_ITER + 1];
+  long long failed; /**< frames that used max_iter without converging */
+  /** unsat_sum[t] / unsat_frames[t]: mean number of unsatisfied checks
+   *  after iteration t + 1 over the frames that ran it */
+  long long unsat_sum[LDPC_SIM_MAX_ITER];
+  long long unsat_frames[LDPC_SIM_MAX_ITER];
+  long long cn_ns, vn_ns, syn_ns; /**< phase times (see ldpc_decoder.h) */
+  long long fallback;      /**< hybrid: frames that ran the soft decoder */
+  long long bf_iterations; /**< hybrid: bit-flipping iterations          */
+  long long bf_ns;         /**< hybrid: bit-flipping stage time          */
+} ldpc_sim_stats_t;
+
+/** Error counts; ldpc_sim_run() adds to them. */
+typedef struct {
+  long long frames;        /**< frames simulated                        */
+  long long err_info;      /**< info bit errors of the main decoder      */
+  long long err_frames;    /**< frames with an info bit error (main)     */
+  long long iterations;    /**< iterations used by the main decoder      */
+  long long err_libm;      /**< info bit errors of the libm reference    */
+  long long frames_differ; /**< frames where main and reference differ   */
+  long long err_q[LDPC_SIM_MAX_QUANT]; /**< per fixed-point format       */
+  ldpc_sim_stats_t stats;              /**< with config.stats only       */
+  /** config.is only: sums of w and of w·e, (w·e)² with e the frame error
+   *  indicator (fe) or the info bit error count (be) of the main decoder;
+   *  see ldpc_is_estimate() */
+  double is_w;
+  double is_fe, is_fe2;
+  double is_be, is_be2;
+} ldpc_sim_counts_t;
+
+typedef struct ldpc_sim ldpc_sim_t;
+
+/**
+ *  Create the engine and all worker contexts (config is copied).
+ *
+ *  Returns NULL if n_threads < 1, shard < 0, no encoder is given outside
+ *  all-zero mode, or stats is set with max_iter > LDPC_SIM_MAX_ITER.
+ */
+ldpc_sim_t *ldpc_sim_create(const ldpc_sim_config_t *cfg);
+
+/** Release the engine (NULL is allowed). */
+void ldpc_sim_free(ldpc_sim_t *sim);
+
+/**
+ *  Start Eb/N0 point `point` (0 .. LDPC_SIM_MAX_POINTS − 1) with noise
+ *  variance sigma2: every worker is reset to its stream
+ *  (seed, shard · LDPC_SIM_MAX_POINTS + point, worker).
+ */
+void ldpc_sim_set_point(ldpc_sim_t *sim, int point, double sigma2);
+
+/**
+ *  Copy the random stream states of the n_threads workers out of / into
+ *  rng[n_threads]. Saved after an ldpc_sim_run() call and restored after
+ *  ldpc_sim_set_point() of the same point, they let a simulation that
+ *  was stopped continue with exactly the frames it would have drawn.
+ */
+void ldpc_sim_get_rng(const ldpc_sim_t *sim, ldpc_rng_t *rng);
+void ldpc_sim_set_rng(ldpc_sim_t *sim, const ldpc_rng_t *rng);
+
+/**
+ *  Simulate n_frames frames of the current point on all workers and add
+ *  the results to *counts. Worker t takes frames
+ *  [n·t/T, n·(t+1)/T). Streams continue across calls within a point.
+ */
+void ldpc_sim_run(ldpc_sim_t *sim, long long n_frames,
+                  ldpc_sim_counts_t *counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDPC_SIM_H */
@@ -0,0 +1,131 @@
+/**
+ * @file ldpc_stream.h
+ * @brief Streaming encode / decode pipelines over files and pipes.
+ *
+ * Both pipelines move a byte stream through a ring of buffers with three
+ * overlapping stages:
+ *
+ *      reader thread ──▶ n_threads workers ──▶ writer (calling thread)
+ *
+ * Each buffer holds frames_per_buf frames of input and the matching output
+ * area. The reader fread()s straight into a free buffer, the workers
+ * encode / decode the frames of the filled buffers in place (input read
+ * from the buffer, results written into its output area) and the writer
+ * fwrite()s the output areas in stream order, so reading, coding and
+ * writing of different buffers run concurrently and the data is never
+ * copied between stages.
+ *
+ * Stream formats (bit streams are MSB first: bit b is bit 7 − b % 8 of
+ * byte b / 8, frames are back to back without padding):
+ *
+ *      information   K bits per frame; the last frame is padded with 0
+ *      bits          codeword as a bit stream, N bits per frame
+ *      f32           one float per code bit, native byte order
+ *      s8            one int8 per code bit
+ *
+ * Soft formats use the library convention: a positive value (symbol or
+ * LLR) means bit 1 (see ldpc_bpsk_awgn_llr()). The encoder writes BPSK
+ * symbols ±1.0 (f32) or ±127 (s8); the decoder reads LLRs scaled by
+ * llr_scale (e.g. −1 for the "positive means 0" convention). A trailing
+ * partial codeword on the decoder input is ignored.
+ *
+ * The decoder refills the batch decoder lanes of every worker as soon as
+ * a frame converges (ldpc_batch_stream_step()), across buffer boundaries;
+ * with SPA every worker decodes one frame at a time. The output is always
+ * in input order and identical to decoding every frame alone.
+ */
+
+#ifndef LDPC_STREAM_H
+#define LDPC_STREAM_H
+
+#include <stdio.h>
+
+#include "ldpc_batch.h"
+#include "ldpc_decoder.h"
+#include "ldpc_encoder.h"
+#include "ldpc_matrix.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Codeword stream format. */
+typedef enum {
+  LDPC_STREAM_BITS = 0,
+  LDPC_STREAM_F32,
+  LDPC_STREAM_S8
+} ldpc_stream_format;
+
+/** Short lowercase name of a format ("bits", "f32", "s8"). */
+const char *ldpc_stream_format_name(ldpc_stream_format fmt);
+
+/** Parse a format name. Returns 0 on success, -1 if unknown. */
+int ldpc_stream_format_parse(const char *name, ldpc_stream_format *fmt);
+
+/** Ring geometry and worker count shared by both pipelines. */
+typedef struct {
+  int n_threads;      /**< coding workers (0: 1)                   */
+  int n_bufs;         /**< ring buffers (0: 2 · n_threads + 2)     */
+  int frames_per_buf; /**< frames per buffer, rounded up to a
+                           multiple of 8 (0: 16 · LDPC_BATCH_LANES) */
+} ldpc_stream_ring_t;
+
+typedef struct {
+  int N, K;
+  /** Encoder: the packed G encoder if not NULL (shared by all workers),
+   *  otherwise the sparse-H encoder (duplicated per worker). */
+  const ldpc_encoder_t *enc;
+  const ldpc_hencoder_t *henc;
+  ldpc_stream_format format; /**< codeword output format */
+  ldpc_stream_ring_t ring;
+} ldpc_stream_enc_config_t;
+
+typedef struct {
+  const ldpc_graph_t *graph;
+  int K;
+  ldpc_cn_kernel kernel;
+  double cn_param; /**< α for NMS, β for OMS */
+  ldpc_schedule schedule;
+  int max_iter;
+  ldpc_simd_target target; /**< batch target (min-sum family only) */
+  ldpc_stream_format format; /**< LLR input format (f32 or s8)     */
+  double llr_scale;          /**< LLR = value · llr_scale          */
+  ldpc_stream_ring_t ring;
+} ldpc_stream_dec_config_t;
+
+/** Totals of one pipeline run. */
+typedef struct {
+  long long frames;
+  long long bytes_in;
+  long long bytes_out;
+  long long iterations;    /**< decoder: summed over all frames */
+  long long not_converged; /**< decoder: frames at max_iter     */
+} ldpc_stream_counts_t;
+
+/**
+ *  Encode the information stream `in` into codewords on `out` until end
+ *  of input. counts may be NULL.
+ *
+ *  Returns 0 on success, -1 on a read / write error, a thread that cannot
+ *  be started or an invalid configuration (no encoder, unsupported
+ *  format).
+ */
+int ldpc_stream_encode(const ldpc_stream_enc_config_t *cfg, FILE *in,
+                       FILE *out, ldpc_stream_counts_t *counts);
+
+/**
+ *  Decode the LLR stream `in` (cfg->format: f32 or s8) and write the
+ *  information bits to `out` until end of input. counts may be NULL.
+ *
+ *  Returns 0 on success, -1 on a read / write error, a thread that cannot
+ *  be started or an invalid configuration (format bits, unsupported batch
+ *  target).
+ */
+int ldpc_stream_decode(const ldpc_stream_dec_config_t *cfg, FILE *in,
+                       FILE *out, ldpc_stream_counts_t *counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDPC_STREAM_H */
@@ -3,23 +3,51 @@
  * @brief LDPC H/G matrix generator (Gallager construction + G from H).
  *
  * This tool:
- *   1. Generates an LDPC parity-check matrix H via Gallager's regular
- * construction
- *   2. Constructs a systematic generator matrix G from H (GF(2) Gaussian
- * elimination)
- *   3. Counts 4-cycles in H (short cycles in the Tanner graph)
- *   4. Searches for the H/G pair with the smallest number of 4-cycles
- *   5. Periodically saves the best matrices and statistics into files
+ *   1. Generates LDPC parity-check matrices H via Gallager's regular
+ *      construction (sparse, ldpc_graph_gallager())
+ *   2. Counts 4-cycles in each H (short cycles in the Tanner graph)
+ *   3. Searches for the H with the smallest number of 4-cycles
+ *   4. Constructs a systematic generator matrix G from the best H (GF(2)
+ *      Gaussian elimination) and reports its girth and 6-cycle count
+ *   5. Periodically saves the best matrices and statistics into files,
+ *      together with the sparse H (H.alist, H.bin with the packed P of G)
+ *      and the preprocessing of the sparse H encoder (H_enc.bin)
+ *
+ * Usage:
+ *   gene_hg [-t threads] [-n loops] [--seed S] [--peg | --qc]
+ *
+ *   N, wc and wr are read from standard input.
+ *
+ *   --peg replaces the search by a single Progressive Edge Growth
+ *   construction (ldpc_graph_peg()): no 4-cycles in practice and girth 6
+ *   or more, in a fraction of a second for N in the low thousands.
+ *
+ *   --qc builds a quasi-cyclic code instead (ldpc_qc_random()): a fully
+ *   populated wc × wr base matrix of Z × Z circulants, Z = N / wr. Only
+ *   the base matrix (H.qc), H.alist, H_enc.bin and info.txt are written,
+ *   into matrices/N{N}_wc{wc}_wr{wr}_qc; ldpc_ber encodes from H and
+ *   decodes with the QC decoder.
+ *
+ * Search structure:
+ *   - T worker threads draw candidates from their own xoshiro stream
+ *     (stream t of the master seed) and compute only the 4-cycle count;
+ *     a better candidate replaces the shared best graph under a mutex
+ *   - A checkpoint thread wakes every second and, only if the best has
+ *     changed, derives G and rewrites the files while the workers go on
  *
  * Notes:
  *   - The search is performed by repeated random Gallager constructions.
- *   - For large N, the exhaustive search with a huge loop_count_max is
- *     computationally very expensive. Adjust loop_count_max as needed
- *     for practical use.
+ *   - With one thread the result is reproducible from the seed; with more
+ *     threads the best H depends on how the candidates interleave.
+ *   - For large N, the exhaustive search with a huge loop count is
+ *     computationally very expensive. Adjust -n as needed for practical
+ *     use.
  */
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h> /* mkdir() for POSIX */
 #include <sys/types.h>
 #include <time.h>
@@ -28,7 +56,9 @@
 #include <direct.h> /* _mkdir() on Windows */
 #endif
 
+#include "ldpc_encoder.h"
 #include "ldpc_matrix.h"
+#include "ldpc_qc.h"
 
 /* ------------------------------------------------------------------------- */
 /* Portable mkdir wrapper                                                    */
@@ -43,11 +73,317 @@ static void make_dir(const char *d) {
 #endif
 }
 
+/* ========================================================================== */
+/* Shared search state                                                        */
+/* ========================================================================== */
+typedef struct {
+  /* code parameters and output files (read-only during the search) */
+  int N, wc, wr, M, K;
+  double R;
+  const char *method; /* construction, for info.txt */
+  char path_H[256], path_G[256], path_info[256], path_enc[256];
+  char path_alist[256], path_bin[256];
+  long long loop_max;
+  unsigned long long seed;
+  double interval_sec; /* checkpoint interval */
+
+  pthread_mutex_t lock;
+  pthread_cond_t wake; /* checkpoint thread: first best or stop */
+  long long issued;    /* candidates handed out                  */
+  long long done;      /* candidates evaluated                   */
+  long long floop_sum; /* average tracking                       */
+  long long best_floop; /* best (minimum) number of 4-cycles, -1 */
+  ldpc_graph_t *best;   /* best H so far (owned)                 */
+  long long best_version; /* number of improvements              */
+  int stop;
+} search_t;
+
+typedef struct {
+  search_t *s;
+  int index;
+} search_worker_t;
+
+/* ========================================================================== */
+/* Search worker: generate, count 4-cycles, keep the best                     */
+/* ========================================================================== */
+/*
+ * One lock per candidate: publish the previous result, claim the next.
+ * The losing graph (the candidate or the replaced best) is freed outside
+ * the lock.
+ */
+static void *search_worker_main(void *arg) {
+  search_worker_t *w = (search_worker_t *)arg;
+  search_t *s = w->s;
+
+  ldpc_rng_t rng;
+  ldpc_rng_stream(&rng, s->seed, 0, w->index);
+
+  ldpc_graph_t *g = NULL;
+  long long floop = 0;
+
+  for (;;) {
+    pthread_mutex_lock(&s->lock);
+    if (g) {
+      s->done++;
+      s->floop_sum += floop;
+      if (s->best_floop < 0 || floop < s->best_floop) {
+        ldpc_graph_t *old = s->best;
+        s->best = g;
+        s->best_floop = floop;
+        if (s->best_version++ == 0)
+          pthread_cond_signal(&s->wake);
+        g = old;
+      }
+    }
+    int go = !s->stop && s->issued < s->loop_max;
+    if (go)
+      s->issued++;
+    pthread_mutex_unlock(&s->lock);
+
+    ldpc_graph_free(g);
+    g = NULL;
+    if (!go)
+      break;
+
+    g = ldpc_graph_gallager(s->N, s->wc, s->wr, &rng);
+    floop = ldpc_graph_count_4cycles(g);
+  }
+
+  return NULL;
+}
+
+/* ========================================================================== */
+/* Checkpoints                                                                */
+/* ========================================================================== */
+typedef struct {
+  int *row_ptr; /* [M+1] snapshot of the best H (CSR) */
+  int *col_idx; /* [n_edges]                         */
+  int n_edges;
+  int **H, **G; /* dense work matrices                */
+  int girth;
+  long long n6;
+} checkpoint_t;
+
+static int **alloc_dense(int rows, int cols) {
+  int **A = (int **)malloc((rows > 0 ? rows : 1) * sizeof(int *));
+  if (!A) {
+    fprintf(stderr, "malloc failed in gene_hg\n");
+    exit(1);
+  }
+  for (int i = 0; i < rows; i++) {
+    A[i] = (int *)malloc((cols > 0 ? cols : 1) * sizeof(int));
+    if (!A[i]) {
+      fprintf(stderr, "malloc failed in gene_hg\n");
+      exit(1);
+    }
+  }
+  return A;
+}
+
+static void free_dense(int **A, int rows) {
+  for (int i = 0; i < rows; i++)
+    free(A[i]);
+  free(A);
+}
+
+/* Save a 0/1 matrix as CSV (no separators) */
+static void write_dense(const char *path, int **A, int rows, int cols) {
+  FILE *fp = fopen(path, "w");
+  if (!fp)
+    return;
+  for (int i = 0; i < rows; i++) {
+    for (int j = 0; j < cols; j++)
+      fputc(A[i][j] ? '1' : '0', fp);
+    fputc('\n', fp);
+  }
+  fclose(fp);
+}
+
+/* Derive G from the snapshot and rewrite all matrix files */
+static void write_best(const search_t *s, checkpoint_t *c) {
+  int M = s->M, N = s->N, K = s->K;
+
+  for (int i = 0; i < M; i++) {
+    memset(c->H[i], 0, N * sizeof(int));
+    for (int e = c->row_ptr[i]; e < c->row_ptr[i + 1]; e++)
+      c->H[i][c->col_idx[e]] = 1;
+  }
+
+  /* G from H; the column swaps of the elimination are applied to H */
+  generate_Gmatrix(c->H, c->G, N, s->wc, s->wr);
+
+  write_dense(s->path_H, c->H, M, N);
+  write_dense(s->path_G, c->G, K, N);
+
+  /* Save sparse H: alist, and the binary image with packed P of G */
+  ldpc_graph_t *graph = ldpc_graph_create(c->H, M, N);
+  ldpc_graph_write_alist(graph, s->path_alist);
+  ldpc_encoder_t *enc = ldpc_encoder_create(c->G, N, K);
+  ldpc_graph_save_bin(graph, enc ? ldpc_encoder_parity(enc) : NULL, K,
+                      s->path_bin);
+  ldpc_encoder_free(enc);
+
+  /* Save the sparse H encoder preprocessing (ldpc_ber -e h) */
+  ldpc_hencoder_t *henc = ldpc_hencoder_create(graph);
+  if (henc)
+    ldpc_hencoder_save(henc, s->path_enc);
+  ldpc_hencoder_free(henc);
+
+  /* Girth and 6-cycles of the best H */
+  c->girth = ldpc_graph_girth(graph);
+  c->n6 = ldpc_graph_count_6cycles(graph);
+  ldpc_graph_free(graph);
+}
+
+static void write_info(const search_t *s, const checkpoint_t *c,
+                       long long loop, long long best_floop,
+                       long long floop_sum) {
+  FILE *fp = fopen(s->path_info, "w");
+  if (fp) {
+    fprintf(fp, "LDPC Matrix Generation Status\n");
+    fprintf(fp, "Code rate R = %.5f\n", s->R);
+    fprintf(fp, "N = %d\n", s->N);
+    fprintf(fp, "wc = %d\n", s->wc);
+    fprintf(fp, "wr = %d\n", s->wr);
+    fprintf(fp, "Construction = %s\n", s->method);
+    fprintf(fp, "Loop count = %lld\n", loop);
+    fprintf(fp, "Best 4-cycles = %lld\n", best_floop);
+    fprintf(fp, "Average 4-cycles = %.3f\n", (double)floop_sum / loop);
+    fprintf(fp, "Girth = %d\n", c->girth);
+    fprintf(fp, "6-cycles = %lld\n", c->n6);
+    fclose(fp);
+  }
+
+  printf("[Loop %lld] Best 4-cycles = %lld, Avg = %.3f, girth = %d, "
+         "6-cycles = %lld\n",
+         loop, best_floop, (double)floop_sum / loop, c->girth, c->n6);
+  fflush(stdout);
+}
+
+/*
+ * Checkpoint thread: waits for the first best, then wakes every
+ * interval_sec (and once more on stop). The best graph is copied under
+ * the lock; G, the files and the cycle statistics are produced outside it,
+ * and only when the best has changed since the last checkpoint.
+ */
+static void *checkpoint_main(void *arg) {
+  search_t *s = (search_t *)arg;
+
+  checkpoint_t c;
+  c.row_ptr = (int *)malloc((s->M + 1) * sizeof(int));
+  c.col_idx = (int *)malloc(((size_t)s->N * s->wc + 1) * sizeof(int));
+  if (!c.row_ptr || !c.col_idx) {
+    fprintf(stderr, "malloc failed in gene_hg\n");
+    exit(1);
+  }
+  c.H = alloc_dense(s->M, s->N);
+  c.G = alloc_dense(s->K, s->N);
+  c.girth = 0;
+  c.n6 = 0;
+
+  long long written = 0; /* best_version on disk */
+
+  pthread_mutex_lock(&s->lock);
+  for (;;) {
+    if (!s->stop) {
+      if (s->best_version == 0) {
+        pthread_cond_wait(&s->wake, &s->lock);
+      } else {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        long long ns = ts.tv_nsec + (long long)(s->interval_sec * 1e9);
+        ts.tv_sec += ns / 1000000000;
+        ts.tv_nsec = ns % 1000000000;
+        pthread_cond_timedwait(&s->wake, &s->lock, &ts);
+      }
+    }
+
+    int last = s->stop;
+    long long loop = s->done;
+    long long floop_sum = s->floop_sum;
+    long long best_floop = s->best_floop;
+    long long version = s->best_version;
+    if (version != written && s->best) {
+      c.n_edges = s->best->n_edges;
+      memcpy(c.row_ptr, s->best->row_ptr, (s->M + 1) * sizeof(int));
+      memcpy(c.col_idx, s->best->col_idx, c.n_edges * sizeof(int));
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    if (version != written) {
+      write_best(s, &c);
+      written = version;
+    }
+    if (loop > 0)
+      write_info(s, &c, loop, best_floop, floop_sum);
+
+    pthread_mutex_lock(&s->lock);
+    if (last)
+      break;
+  }
+  pthread_mutex_unlock(&s->lock);
+
+  free(c.row_ptr);
+  free(c.col_idx);
+  free_dense(c.H, s->M);
+  free_dense(c.G, s->K);
+  return NULL;
+}
+
+/* ========================================================================== */
+/* Command line                                                               */
+/* ========================================================================== */
+static void usage(const char *prog) {
+  printf("Usage: %s [options]\n\n", prog);
+  printf("  -t, --threads T   search threads (default 1)\n");
+  printf("  -n, --loops L     candidates to evaluate (default 10000000)\n");
+  printf("      --seed S      master seed (default: time)\n");
+  printf("      --peg         one PEG construction instead of the search\n");
+  printf("      --qc          random quasi-cyclic code (Z = N / wr)\n");
+  printf("  -h, --help        show this help\n");
+  printf("\nN, wc and wr are read from standard input.\n");
+}
+
 /* ========================================================================== */
 /* MAIN                                                                       */
 /* ========================================================================== */
-int main(void) {
-  srand((unsigned int)time(NULL));
+int main(int argc, char **argv) {
+  int n_threads = 1;
+  long long loop_count_max = 10000000;
+  unsigned long long seed = (unsigned long long)time(NULL);
+  int peg = 0;
+  int qc = 0;
+
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    int has_val = (i + 1 < argc);
+
+    if (!strcmp(a, "-h") || !strcmp(a, "--help")) {
+      usage(argv[0]);
+      return 0;
+    } else if ((!strcmp(a, "-t") || !strcmp(a, "--threads")) && has_val) {
+      n_threads = atoi(argv[++i]);
+      if (n_threads < 1) {
+        fprintf(stderr, "Invalid thread count '%s'\n", argv[i]);
+        return 1;
+      }
+    } else if ((!strcmp(a, "-n") || !strcmp(a, "--loops")) && has_val) {
+      loop_count_max = atoll(argv[++i]);
+      if (loop_count_max < 1) {
+        fprintf(stderr, "Invalid loop count '%s'\n", argv[i]);
+        return 1;
+      }
+    } else if (!strcmp(a, "--seed") && has_val) {
+      seed = strtoull(argv[++i], NULL, 0);
+    } else if (!strcmp(a, "--peg")) {
+      peg = 1;
+    } else if (!strcmp(a, "--qc")) {
+      qc = 1;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
 
   printf("==============================================\n");
   printf("       LDPC Matrix Generator (Gallager)       \n");
@@ -67,163 +403,186 @@ int main(void) {
   printf("Row weight wr (larger than wc): ");
   scanf("%d", &wr);
 
+  if (qc && (wc >= wr || N % wr != 0)) {
+    fprintf(stderr, "--qc needs wc < wr and N a multiple of wr\n");
+    return 1;
+  }
+
   int M = (N * wc) / wr; /* number of parity-check equations */
   int K = N - M;         /* number of information bits       */
   double R = (double)K / N;
 
-  printf("\nRate R = %.5f (K = %d, M = %d)\n\n", R, K, M);
+  printf("\nRate R = %.5f (K = %d, M = %d)\n", R, K, M);
+  printf("Threads: %d, seed: %llu\n\n", n_threads, seed);
 
   /* ------------------------------------------------------------------ */
   /* Prepare output directory                                           */
   /*   matrices/Nxxx_wcX_wrY/                                          */
   /* ------------------------------------------------------------------ */
   char dirpath[128];
-  sprintf(dirpath, "matrices/N%d_wc%d_wr%d", N, wc, wr);
+  sprintf(dirpath, "matrices/N%d_wc%d_wr%d%s", N, wc, wr, qc ? "_qc" : "");
 
   make_dir("matrices");
   make_dir(dirpath);
 
+  search_t s;
+  memset(&s, 0, sizeof(s));
+  s.N = N;
+  s.wc = wc;
+  s.wr = wr;
+  s.M = M;
+  s.K = K;
+  s.R = R;
+  s.method = peg ? "PEG" : qc ? "QC" : "Gallager search";
+  s.loop_max = loop_count_max;
+  s.seed = seed;
+  s.interval_sec = 1.0; /* periodic save interval */
+  s.best_floop = -1;
+
   /* Output file paths */
-  char path_H[256], path_G[256], path_info[256];
-  sprintf(path_H, "%s/H.csv", dirpath);
-  sprintf(path_G, "%s/G.csv", dirpath);
-  sprintf(path_info, "%s/info.txt", dirpath);
+  sprintf(s.path_H, "%s/H.csv", dirpath);
+  sprintf(s.path_G, "%s/G.csv", dirpath);
+  sprintf(s.path_info, "%s/info.txt", dirpath);
+  sprintf(s.path_enc, "%s/H_enc.bin", dirpath);
+  sprintf(s.path_alist, "%s/H.alist", dirpath);
+  sprintf(s.path_bin, "%s/H.bin", dirpath);
+
+  pthread_mutex_init(&s.lock, NULL);
+  pthread_cond_init(&s.wake, NULL);
 
   /* ------------------------------------------------------------------ */
-  /* Allocate matrices H, G and their "best" copies                     */
+  /* QC: random base matrices until the H encoder accepts the expansion */
   /* ------------------------------------------------------------------ */
-  int **H = (int **)malloc(M * sizeof(int *));
-  int **H_best = (int **)malloc(M * sizeof(int *));
-  for (int i = 0; i < M; i++) {
-    H[i] = (int *)malloc(N * sizeof(int));
-    H_best[i] = (int *)malloc(N * sizeof(int));
-  }
+  if (qc) {
+    int Z = N / wr;
+    printf("Quasi-cyclic construction: %d x %d base matrix, Z = %d\n", wc, wr,
+           Z);
+
+    ldpc_rng_t rng;
+    ldpc_rng_stream(&rng, seed, 0, 0);
+    ldpc_qc_t *base = NULL;
+    ldpc_graph_t *graph = NULL;
+    ldpc_hencoder_t *henc = NULL;
+    for (int tries = 1; tries <= 100 && !henc; tries++) {
+      ldpc_qc_free(base);
+      ldpc_graph_free(graph);
+      base = ldpc_qc_random(wc, wr, Z, &rng);
+      graph = ldpc_qc_expand(base);
+      henc = ldpc_hencoder_create(graph);
+      if (henc)
+        printf("Base matrix %d accepted (H encoder gap %d)\n", tries,
+               ldpc_hencoder_gap(henc));
+    }
+    if (!henc) {
+      /* the circulant parity part is singular for every draw */
+      fprintf(stderr, "No encodable base matrix found\n");
+      return 1;
+    }
 
-  int **G = (int **)malloc(K * sizeof(int *));
-  int **G_best = (int **)malloc(K * sizeof(int *));
-  for (int i = 0; i < K; i++) {
-    G[i] = (int *)malloc(N * sizeof(int));
-    G_best[i] = (int *)malloc(N * sizeof(int));
+    char path_qc[256];
+    sprintf(path_qc, "%s/H.qc", dirpath);
+    ldpc_qc_write(base, path_qc);
+    ldpc_graph_write_alist(graph, s.path_alist);
+    ldpc_hencoder_save(henc, s.path_enc);
+
+    checkpoint_t c;
+    memset(&c, 0, sizeof(c));
+    c.girth = ldpc_graph_girth(graph);
+    c.n6 = ldpc_graph_count_6cycles(graph);
+    long long floop = ldpc_graph_count_4cycles(graph);
+    write_info(&s, &c, 1, floop, floop);
+
+    ldpc_hencoder_free(henc);
+    ldpc_graph_free(graph);
+    ldpc_qc_free(base);
+
+    printf("\nGeneration completed.\n");
+    printf("Files saved under directory: %s\n", dirpath);
+    return 0;
   }
 
   /* ------------------------------------------------------------------ */
-  /* Search H/G matrices with minimum number of 4-cycles                */
+  /* PEG: one construction, written by a single (final) checkpoint      */
   /* ------------------------------------------------------------------ */
-  const int loop_count_max = 10000000;
-  const double print_interval_sec = 1.0; /* periodic save interval   */
-
-  int loop;
-  int best_floop = -1;     /* best (minimum) number of 4-cycles */
-  long long floop_sum = 0; /* average tracking */
-
-  clock_t t_start = clock();
-  clock_t t_last_print = clock();
-
-  printf("Searching for best H/G matrices (min 4-cycles)...\n");
-
-  for (loop = 1; loop <= loop_count_max; loop++) {
-
-    /* -------------------------------------------------------------- */
-    /* 1) Generate new H and G                                        */
-    /* -------------------------------------------------------------- */
-    generate_Hmatrix(H, N, wc, wr);
-    generate_Gmatrix(H, G, N, wc, wr);
-
-    /* -------------------------------------------------------------- */
-    /* 2) Count 4-cycles in H                                         */
-    /* -------------------------------------------------------------- */
-    int floop = count_floop(H, N, wc, wr);
-    floop_sum += floop;
-
-    /* -------------------------------------------------------------- */
-    /* 3) Update best H/G if this one has fewer 4-cycles              */
-    /* -------------------------------------------------------------- */
-    if (best_floop == -1 || floop < best_floop) {
-      best_floop = floop;
-
-      /* copy best H */
-      for (int i = 0; i < M; i++)
-        for (int j = 0; j < N; j++)
-          H_best[i][j] = H[i][j];
-
-      /* copy best G */
-      for (int i = 0; i < K; i++)
-        for (int j = 0; j < N; j++)
-          G_best[i][j] = G[i][j];
+  if (peg) {
+    printf("Progressive Edge Growth construction...\n");
+
+    ldpc_rng_t rng;
+    ldpc_rng_stream(&rng, seed, 0, 0);
+    clock_t t0 = clock();
+    s.best = ldpc_graph_peg(N, wc, wr, &rng);
+    if (!s.best) {
+      fprintf(stderr, "PEG needs 1 <= wc <= M\n");
+      return 1;
     }
+    printf("Built in %.3f s\n", (double)(clock() - t0) / CLOCKS_PER_SEC);
+
+    s.best_floop = ldpc_graph_count_4cycles(s.best);
+    s.issued = s.done = 1;
+    s.floop_sum = s.best_floop;
+    s.best_version = 1;
+    s.stop = 1;
+    checkpoint_main(&s);
+
+    ldpc_graph_free(s.best);
+    pthread_mutex_destroy(&s.lock);
+    pthread_cond_destroy(&s.wake);
+
+    printf("\nGeneration completed.\n");
+    printf("Files saved under directory: %s\n", dirpath);
+    return 0;
+  }
 
-    /* -------------------------------------------------------------- */
-    /* 4) Periodically save current best matrices and statistics       */
-    /* -------------------------------------------------------------- */
-    clock_t t_now = clock();
-    double elapsed = (double)(t_now - t_last_print) / CLOCKS_PER_SEC;
-
-    if (loop == 1 || elapsed > print_interval_sec) {
-
-      t_last_print = t_now;
-
-      /* Save best H as CSV (no separators, 0/1 matrix) */
-      FILE *fp = fopen(path_H, "w");
-      if (fp) {
-        for (int i = 0; i < M; i++) {
-          for (int j = 0; j < N; j++)
-            fprintf(fp, "%d", H_best[i][j]);
-          fprintf(fp, "\n");
-        }
-        fclose(fp);
-      }
-
-      /* Save best G as CSV (no separators, 0/1 matrix) */
-      fp = fopen(path_G, "w");
-      if (fp) {
-        for (int i = 0; i < K; i++) {
-          for (int j = 0; j < N; j++)
-            fprintf(fp, "%d", G_best[i][j]);
-          fprintf(fp, "\n");
-        }
-        fclose(fp);
-      }
+  /* ------------------------------------------------------------------ */
+  /* Search H matrices with minimum number of 4-cycles                  */
+  /* ------------------------------------------------------------------ */
+  printf("Searching for best H/G matrices (min 4-cycles)...\n");
 
-      /* Save status information */
-      fp = fopen(path_info, "w");
-      if (fp) {
-        fprintf(fp, "LDPC Matrix Generation Status\n");
-        fprintf(fp, "Code rate R = %.5f\n", R);
-        fprintf(fp, "N = %d\n", N);
-        fprintf(fp, "wc = %d\n", wc);
-        fprintf(fp, "wr = %d\n", wr);
-        fprintf(fp, "Loop count = %d\n", loop);
-        fprintf(fp, "Best 4-cycles = %d\n", best_floop);
-        fprintf(fp, "Average 4-cycles = %.3f\n", (double)floop_sum / loop);
-        fclose(fp);
-      }
+  pthread_t ckpt;
+  if (pthread_create(&ckpt, NULL, checkpoint_main, &s) != 0) {
+    fprintf(stderr, "pthread_create failed in gene_hg\n");
+    exit(1);
+  }
 
-      printf("[Loop %d] Best 4-cycles = %d, Avg = %.3f\n", loop, best_floop,
-             (double)floop_sum / loop);
-    }
+  /* worker 0 runs on the calling thread */
+  pthread_t *tid = (pthread_t *)malloc(n_threads * sizeof(pthread_t));
+  search_worker_t *w =
+      (search_worker_t *)malloc(n_threads * sizeof(search_worker_t));
+  if (!tid || !w) {
+    fprintf(stderr, "malloc failed in gene_hg\n");
+    exit(1);
   }
+  for (int t = 0; t < n_threads; t++) {
+    w[t].s = &s;
+    w[t].index = t;
+  }
+  for (int t = 1; t < n_threads; t++)
+    if (pthread_create(&tid[t], NULL, search_worker_main, &w[t]) != 0) {
+      fprintf(stderr, "pthread_create failed in gene_hg\n");
+      exit(1);
+    }
+  search_worker_main(&w[0]);
+  for (int t = 1; t < n_threads; t++)
+    pthread_join(tid[t], NULL);
+
+  /* final checkpoint */
+  pthread_mutex_lock(&s.lock);
+  s.stop = 1;
+  pthread_cond_signal(&s.wake);
+  pthread_mutex_unlock(&s.lock);
+  pthread_join(ckpt, NULL);
 
   /* ------------------------------------------------------------------ */
   /* Cleanup                                                            */
   /* ------------------------------------------------------------------ */
-  for (int i = 0; i < M; i++) {
-    free(H[i]);
-    free(H_best[i]);
-  }
-  free(H);
-  free(H_best);
-
-  for (int i = 0; i < K; i++) {
-    free(G[i]);
-    free(G_best[i]);
-  }
-  free(G);
-  free(G_best);
+  ldpc_graph_free(s.best);
+  pthread_mutex_destroy(&s.lock);
+  pthread_cond_destroy(&s.wake);
+  free(tid);
+  free(w);
 
   printf("\nGeneration completed.\n");
   printf("Files saved under directory: %s\n", dirpath);
 
-  (void)t_start; /* currently unused; kept for potential profiling */
-
   return 0;
 }
@@ -0,0 +1,915 @@
+/**
+ * @file ldpc_bench.c
+ * @brief Decoder / encoder throughput and latency benchmark.
+ *
+ * This program measures, for every code folder and every decoder variant,
+ * only the decoding call (channel noise, quantization and lane packing are
+ * done outside the timed region):
+ *   - decoded information Mbit/s per core and across all threads
+ *   - per-frame latency percentiles (p50 / p99 / p99.9)
+ *   - average iterations and FER at each Eb/N0 point
+ * and, separately, the throughput of every available encoder.
+ *
+ * Usage:
+ *   ldpc_bench [options] [matrices/N{N}_wc{wc}_wr{wr} ...]
+ *
+ *   -o, --output PATH   CSV output (default results/bench.csv)
+ *   -t, --threads T     also run every decoder point on T threads
+ *                       (default: number of online CPUs)
+ *   -f, --frames F      frames per decoder point (default 1000)
+ *       --max-time S    wall-clock cap per decoder point in seconds
+ *                       (default 2, 0 = none); slow variants then report
+ *                       fewer frames
+ *   -E, --ebn0 LIST     comma separated Eb/N0 points in dB
+ *                       (default 1.0,2.0,3.0)
+ *       --seed S        master seed (default 1)
+ *   -h, --help          show usage
+ *
+ * Without folder arguments every N* folder under matrices/ is measured.
+ * An argument may also be a directory of code folders or a registry
+ * config file (ldpc_registry.h); all codes are loaded once before the
+ * first measurement. H and G are taken from the same files as ldpc_ber
+ * (H.qc, H.bin, H.alist, H.csv; packed P of H.bin or G.csv).
+ *
+ * Decoder variants (max_iter 40, all-zero codeword: for BPSK/AWGN the
+ * iteration and error statistics are the same as with random data):
+ *   spa          : SPA, flooding
+ *   minsum       : min-sum, flooding
+ *   nms_layered  : normalized min-sum, layered
+ *   nms_f32      : nms_layered with float messages (LDPC_PREC_F32)
+ *   hybrid_nms   : GDBF bit flipping first, nms_layered for the frames it
+ *                  leaves unsolved (ldpc_decoder_set_hybrid()); the
+ *                  iteration column counts soft iterations only
+ *   fixed_q6.2   : int8 offset min-sum, layered
+ *   batch_nms    : batch SIMD decoder, LDPC_BATCH_LANES frames per call;
+ *                  the latency of a frame is the latency of its call
+ *   qc_nms       : block-row QC decoder (QC codes only)
+ *   service_nms  : ldpc_service_t with T workers (batch lanes with refill,
+ *                  work stealing); frames are generated and submitted by
+ *                  one producer thread, the latency of a frame runs from
+ *                  submit to its completion callback (queueing included),
+ *                  and mbps_core is mbps_total / T
+ *
+ * Encoder variants (one thread, random information bits):
+ *   g_dense      : ldpc_encode() on the dense G
+ *   g_packed     : packed-P encoder, int bits in and out
+ *   g_sliced     : bit-sliced encoder, LDPC_SLICE_FRAMES frames per call
+ *   h_sparse     : sparse-H encoder (no G)
+ *
+ * Demapper variants (one thread, one codeword of random bits per frame on
+ * ceil(N / m) symbols of 16-QAM and 256-QAM at Es/N0 = 10 dB):
+ *   pyx_<mod>    : Gaussian likelihood table + compute_llr_from_pyx()
+ *   exact_<mod>  : ldpc_demap(), exact
+ *   maxlog_<mod> : ldpc_demap(), max-log
+ *
+ * CSV columns:
+ *   matrix,N,K,kind,variant,ebn0_db,threads,frames,avg_iter,fer,
+ *   mbps_core,mbps_total,lat_p50_us,lat_p99_us,lat_p999_us
+ * kind is "decode", "encode" or "demap"; ebn0_db, avg_iter and fer are
+ * empty for encoder and demapper rows. mbps_core divides the bits by the
+ * summed time spent in the timed calls, mbps_total by the wall time of
+ * the run. Decoder and encoder rows count information bits, demapper
+ * rows the coded bits they produce LLRs for (n_sym · m per frame).
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include "ldpc_batch.h"
+#include "ldpc_decoder.h"
+#include "ldpc_demap.h"
+#include "ldpc_encoder.h"
+#include "ldpc_fixed.h"
+#include "ldpc_noise.h"
+#include "ldpc_qc.h"
+#include "ldpc_registry.h"
+#include "ldpc_service.h"
+
+/* ============================================================
+ * Benchmark parameters
+ * ============================================================ */
+#define BENCH_MAX_POINTS 16
+#define BENCH_MAX_CODES 64
+
+const int max_iter = 40;
+const int enc_frames = 20000; /* frames per encoder variant */
+const int demap_frames = 2000; /* frames per demapper variant */
+
+static double wall_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/* ============================================================
+ * Decoder variants
+ * ============================================================ */
+typedef enum {
+  DEC_FLOAT,
+  DEC_FIXED,
+  DEC_BATCH,
+  DEC_QC,
+  DEC_SERVICE
+} dec_kind;
+
+typedef struct {
+  const char *name;
+  dec_kind kind;
+  ldpc_cn_kernel kernel;
+  double param;
+  ldpc_schedule schedule;
+  ldpc_precision prec; /* DEC_FLOAT only */
+  int bf_iter;         /* DEC_FLOAT: GDBF front end budget, 0: off */
+} variant_t;
+
+static const variant_t variants[] = {
+    {.name = "spa",
+     .kind = DEC_FLOAT,
+     .kernel = LDPC_CN_SPA,
+     .schedule = LDPC_SCHED_FLOODING},
+    {.name = "minsum",
+     .kind = DEC_FLOAT,
+     .kernel = LDPC_CN_MINSUM,
+     .schedule = LDPC_SCHED_FLOODING},
+    {.name = "nms_layered",
+     .kind = DEC_FLOAT,
+     .kernel = LDPC_CN_NMS,
+     .param = LDPC_NMS_ALPHA_DEFAULT,
+     .schedule = LDPC_SCHED_LAYERED},
+    {.name = "nms_f32",
+     .kind = DEC_FLOAT,
+     .kernel = LDPC_CN_NMS,
+     .param = LDPC_NMS_ALPHA_DEFAULT,
+     .schedule = LDPC_SCHED_LAYERED,
+     .prec = LDPC_PREC_F32},
+    {.name = "hybrid_nms",
+     .kind = DEC_FLOAT,
+     .kernel = LDPC_CN_NMS,
+     .param = LDPC_NMS_ALPHA_DEFAULT,
+     .schedule = LDPC_SCHED_LAYERED,
+     .bf_iter = LDPC_BF_ITER_DEFAULT},
+    {.name = "fixed_q6.2",
+     .kind = DEC_FIXED,
+     .kernel = LDPC_CN_OMS,
+     .param = LDPC_OMS_BETA_DEFAULT,
+     .schedule = LDPC_SCHED_LAYERED},
+    {.name = "batch_nms",
+     .kind = DEC_BATCH,
+     .kernel = LDPC_CN_NMS,
+     .param = LDPC_NMS_ALPHA_DEFAULT,
+     .schedule = LDPC_SCHED_LAYERED},
+    {.name = "qc_nms",
+     .kind = DEC_QC,
+     .kernel = LDPC_CN_NMS,
+     .param = LDPC_NMS_ALPHA_DEFAULT,
+     .schedule = LDPC_SCHED_LAYERED},
+    {.name = "service_nms",
+     .kind = DEC_SERVICE,
+     .kernel = LDPC_CN_NMS,
+     .param = LDPC_NMS_ALPHA_DEFAULT,
+     .schedule = LDPC_SCHED_LAYERED},
+};
+#define N_VARIANTS ((int)(sizeof(variants) / sizeof(variants[0])))
+
+static const ldpc_qformat_t bench_qformat = {6, 2, 0.0};
+
+/* ============================================================
+ * Results
+ * ============================================================ */
+typedef struct {
+  long long frames;
+  int frame_bits; /* bits per frame counted in Mb/s (K, demap: n_sym·m) */
+  long long iters;
+  long long frame_errors;
+  double busy;   /* summed time inside the timed calls [s] */
+  double wall;   /* wall time of the whole run [s]         */
+  double lat[3]; /* p50, p99, p99.9 [s]                    */
+} result_t;
+
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/* p50 / p99 / p99.9 of n samples (sorted in place) */
+static void percentiles(double *lat, int n, double out[3]) {
+  static const double p[3] = {0.5, 0.99, 0.999};
+  if (n == 0) {
+    out[0] = out[1] = out[2] = 0.0;
+    return;
+  }
+  qsort(lat, n, sizeof(double), cmp_double);
+  for (int i = 0; i < 3; i++) {
+    int k = (int)(p[i] * n + 0.999999) - 1;
+    out[i] = lat[k < 0 ? 0 : k >= n ? n - 1 : k];
+  }
+}
+
+static void write_row(FILE *fp, const ldpc_code_t *c, const char *kind,
+                      const char *variant, const double *ebn0, int threads,
+                      const result_t *r) {
+  double bits = (double)r->frames * r->frame_bits;
+  fprintf(fp, "%s,%d,%d,%s,%s,", c->name, c->N, c->K, kind, variant);
+  if (ebn0)
+    fprintf(fp, "%.2f", *ebn0);
+  fprintf(fp, ",%d,%lld,", threads, r->frames);
+  if (ebn0)
+    fprintf(fp, "%.4f,%.6e", (double)r->iters / r->frames,
+            (double)r->frame_errors / r->frames);
+  else
+    fprintf(fp, ",");
+  fprintf(fp, ",%.4f,%.4f,%.3f,%.3f,%.3f\n", bits / r->busy * 1e-6,
+          bits / r->wall * 1e-6, r->lat[0] * 1e6, r->lat[1] * 1e6,
+          r->lat[2] * 1e6);
+  fflush(fp);
+}
+
+/* ============================================================
+ * Decoder benchmark worker: one thread, its own decoder and stream
+ * ============================================================ */
+typedef struct {
+  const ldpc_code_t *code;
+  const variant_t *v;
+  double sigma2;
+  long long frames; /* frames of this thread */
+  double max_time;  /* wall-clock cap [s], 0 = none */
+  unsigned long long seed;
+  int point, index;
+
+  double *lat; /* [frames] latency per frame (per call for batch) */
+  int n_lat;
+  result_t r;
+} dec_worker_t;
+
+static void *dec_worker_main(void *arg) {
+  dec_worker_t *w = (dec_worker_t *)arg;
+  const ldpc_code_t *c = w->code;
+  const variant_t *v = w->v;
+  int N = c->N, K = c->K;
+  int lanes = (v->kind == DEC_BATCH) ? LDPC_BATCH_LANES : 1;
+
+  ldpc_decoder_t *dec = NULL;
+  ldpc_qdecoder_t *qdec = NULL;
+  ldpc_batch_decoder_t *bdec = NULL;
+  ldpc_qc_decoder_t *qcdec = NULL;
+  switch (v->kind) {
+  case DEC_FLOAT:
+    dec = ldpc_decoder_create_from_graph(c->graph, K);
+    ldpc_decoder_set_kernel(dec, v->kernel, v->param);
+    ldpc_decoder_set_schedule(dec, v->schedule);
+    ldpc_decoder_set_precision(dec, v->prec);
+    ldpc_decoder_set_hybrid(dec, v->bf_iter, LDPC_BF_GDBF,
+                            LDPC_GDBF_THETA_DEFAULT, LDPC_BF_GATE_DEFAULT);
+    break;
+  case DEC_FIXED:
+    qdec = ldpc_qdecoder_create(c->graph, K, &bench_qformat);
+    ldpc_qdecoder_set_kernel(qdec, v->kernel, v->param);
+    ldpc_qdecoder_set_schedule(qdec, v->schedule);
+    break;
+  case DEC_BATCH:
+    bdec = ldpc_batch_create(c->graph, K, LDPC_SIMD_AUTO);
+    ldpc_batch_set_kernel(bdec, v->kernel, v->param);
+    ldpc_batch_set_schedule(bdec, v->schedule);
+    break;
+  case DEC_QC:
+    qcdec = ldpc_qc_decoder_create(c->qc, K);
+    ldpc_qc_decoder_set_kernel(qcdec, v->kernel, v->param);
+    break;
+  case DEC_SERVICE: /* see bench_service() */
+    break;
+  }
+
+  int *code = (int *)calloc(N, sizeof(int)); /* all-zero codeword */
+  double *LLR = (double *)malloc(N * sizeof(double));
+  int8_t *qLLR = (int8_t *)malloc(N * sizeof(int8_t));
+  int *ecc = (int *)malloc(N * sizeof(int));
+  int *inf = (int *)malloc(K * sizeof(int));
+  float *bLLR = (float *)malloc((size_t)N * LDPC_BATCH_LANES * sizeof(float));
+  uint8_t *becc = (uint8_t *)malloc((size_t)N * LDPC_BATCH_LANES);
+  w->lat = (double *)malloc((w->frames + 1) * sizeof(double));
+  if (!code || !LLR || !qLLR || !ecc || !inf || !bLLR || !becc || !w->lat) {
+    fprintf(stderr, "malloc failed in ldpc_bench\n");
+    exit(1);
+  }
+
+  ldpc_rng_t rng;
+  ldpc_rng_stream(&rng, w->seed, w->point, w->index);
+
+  memset(&w->r, 0, sizeof(w->r));
+  w->n_lat = 0;
+  double t_start = wall_seconds();
+  for (long long f = 0; f < w->frames; f += lanes) {
+    if (w->max_time > 0 && f > 0 && wall_seconds() - t_start > w->max_time)
+      break;
+    int n = (w->frames - f < lanes) ? (int)(w->frames - f) : lanes;
+    int iters[LDPC_BATCH_LANES];
+
+    if (v->kind == DEC_BATCH) {
+      for (int l = 0; l < n; l++) {
+        ldpc_bpsk_awgn_llr(&rng, code, LLR, N, w->sigma2);
+        ldpc_batch_put_llr(bLLR, LLR, N, l);
+      }
+    } else {
+      ldpc_bpsk_awgn_llr(&rng, code, LLR, N, w->sigma2);
+      if (v->kind == DEC_FIXED)
+        ldpc_quantize_llr_q8(LLR, qLLR, N, &bench_qformat);
+    }
+
+    double t0 = wall_seconds();
+    switch (v->kind) {
+    case DEC_FLOAT:
+      iters[0] = ldpc_decoder_decode(dec, LLR, ecc, inf, max_iter);
+      break;
+    case DEC_FIXED:
+      iters[0] = ldpc_qdecoder_decode_q8(qdec, qLLR, ecc, inf, max_iter);
+      break;
+    case DEC_BATCH:
+      ldpc_batch_decode(bdec, bLLR, becc, n, max_iter, iters);
+      break;
+    case DEC_QC:
+      iters[0] = ldpc_qc_decoder_decode(qcdec, LLR, ecc, inf, max_iter);
+      break;
+    case DEC_SERVICE:
+      break;
+    }
+    double dt = wall_seconds() - t0;
+
+    w->r.busy += dt;
+    for (int l = 0; l < n; l++) {
+      int err = 0;
+      if (v->kind == DEC_BATCH) {
+        for (int j = 0; j < N && !err; j++)
+          err = becc[(size_t)j * LDPC_BATCH_LANES + l];
+      } else {
+        for (int j = 0; j < N && !err; j++)
+          err = ecc[j];
+      }
+      w->r.frame_errors += err;
+      w->r.iters += iters[l];
+      w->lat[w->n_lat++] = dt;
+    }
+    w->r.frames += n;
+  }
+
+  free(code);
+  free(LLR);
+  free(qLLR);
+  free(ecc);
+  free(inf);
+  free(bLLR);
+  free(becc);
+  ldpc_decoder_free(dec);
+  ldpc_qdecoder_free(qdec);
+  ldpc_batch_free(bdec);
+  ldpc_qc_decoder_free(qcdec);
+  return NULL;
+}
+
+/* ============================================================
+ * Decode service benchmark: one producer, n_threads service workers
+ * ============================================================ */
+typedef struct {
+  double *t_submit; /* [frames] submit time of each frame     */
+  double *lat;      /* [frames] submit → completion latency   */
+  int *iters;       /* [frames]                               */
+  int *err;         /* [frames] 1 if any information bit is 1 */
+  int K;
+} service_bench_t;
+
+static void service_done(const ldpc_service_result_t *res, void *arg) {
+  service_bench_t *b = (service_bench_t *)arg;
+  long long f = (long long)(intptr_t)res->user;
+  int err = 0;
+  for (int j = 0; j < b->K && !err; j++)
+    err = res->inf[j];
+  b->lat[f] = wall_seconds() - b->t_submit[f];
+  b->iters[f] = res->iterations;
+  b->err[f] = err;
+}
+
+static result_t bench_service(const ldpc_code_t *c, const variant_t *v,
+                              double sigma2, int point, long long frames,
+                              double max_time, int n_threads,
+                              unsigned long long seed) {
+  int N = c->N;
+  service_bench_t b;
+  b.K = c->K;
+  b.t_submit = (double *)malloc((frames + 1) * sizeof(double));
+  b.lat = (double *)malloc((frames + 1) * sizeof(double));
+  b.iters = (int *)malloc((frames + 1) * sizeof(int));
+  b.err = (int *)malloc((frames + 1) * sizeof(int));
+  int *code = (int *)calloc(N, sizeof(int)); /* all-zero codeword */
+  double *LLR = (double *)malloc(N * sizeof(double));
+  if (!b.t_submit || !b.lat || !b.iters || !b.err || !code || !LLR) {
+    fprintf(stderr, "malloc failed in bench_service\n");
+    exit(1);
+  }
+
+  ldpc_service_config_t cfg;
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.graph = c->graph;
+  cfg.K = c->K;
+  cfg.kernel = v->kernel;
+  cfg.cn_param = v->param;
+  cfg.schedule = v->schedule;
+  cfg.max_iter = max_iter;
+  cfg.n_threads = n_threads;
+  cfg.target = LDPC_SIMD_AUTO;
+  cfg.callback = service_done;
+  cfg.callback_arg = &b;
+  ldpc_service_t *svc = ldpc_service_create(&cfg);
+
+  ldpc_rng_t rng;
+  ldpc_rng_stream(&rng, seed, point, 0);
+
+  double t0 = wall_seconds();
+  long long f;
+  for (f = 0; f < frames; f++) {
+    if (max_time > 0 && f > 0 && wall_seconds() - t0 > max_time)
+      break;
+    ldpc_bpsk_awgn_llr(&rng, code, LLR, N, sigma2);
+    b.t_submit[f] = wall_seconds();
+    ldpc_service_submit(svc, LLR, (void *)(intptr_t)f);
+  }
+  ldpc_service_drain(svc);
+
+  result_t r;
+  memset(&r, 0, sizeof(r));
+  r.frame_bits = c->K;
+  r.wall = wall_seconds() - t0;
+  r.busy = r.wall * n_threads;
+  r.frames = f;
+  for (long long i = 0; i < f; i++) {
+    r.iters += b.iters[i];
+    r.frame_errors += b.err[i];
+  }
+  percentiles(b.lat, (int)f, r.lat);
+
+  ldpc_service_free(svc);
+  free(b.t_submit);
+  free(b.lat);
+  free(b.iters);
+  free(b.err);
+  free(code);
+  free(LLR);
+  return r;
+}
+
+/* Decode `frames` frames split across n_threads threads */
+static result_t bench_decode(const ldpc_code_t *c, const variant_t *v,
+                             double ebn0_db, int point, long long frames,
+                             double max_time, int n_threads,
+                             unsigned long long seed) {
+  double R = (double)c->K / c->N;
+  double sigma2 = 1.0 / (2.0 * R * pow(10.0, ebn0_db / 10.0));
+  if (v->kind == DEC_SERVICE)
+    return bench_service(c, v, sigma2, point, frames, max_time, n_threads,
+                         seed);
+
+  dec_worker_t *w = (dec_worker_t *)calloc(n_threads, sizeof(dec_worker_t));
+  pthread_t *tid = (pthread_t *)malloc(n_threads * sizeof(pthread_t));
+  if (!w || !tid) {
+    fprintf(stderr, "malloc failed in bench_decode\n");
+    exit(1);
+  }
+  for (int t = 0; t < n_threads; t++) {
+    w[t].code = c;
+    w[t].v = v;
+    w[t].sigma2 = sigma2;
+    w[t].frames = frames / n_threads + (t < frames % n_threads);
+    w[t].max_time = max_time;
+    w[t].seed = seed;
+    w[t].point = point;
+    w[t].index = t;
+  }
+
+  double t0 = wall_seconds();
+  for (int t = 1; t < n_threads; t++)
+    pthread_create(&tid[t], NULL, dec_worker_main, &w[t]);
+  dec_worker_main(&w[0]);
+  for (int t = 1; t < n_threads; t++)
+    pthread_join(tid[t], NULL);
+
+  result_t r;
+  memset(&r, 0, sizeof(r));
+  r.frame_bits = c->K;
+  r.wall = wall_seconds() - t0;
+
+  /* pool the latencies of all threads */
+  int n_lat = 0;
+  for (int t = 0; t < n_threads; t++)
+    n_lat += w[t].n_lat;
+  double *lat = (double *)malloc((n_lat + 1) * sizeof(double));
+  if (!lat) {
+    fprintf(stderr, "malloc failed in bench_decode\n");
+    exit(1);
+  }
+  n_lat = 0;
+  for (int t = 0; t < n_threads; t++) {
+    r.frames += w[t].r.frames;
+    r.iters += w[t].r.iters;
+    r.frame_errors += w[t].r.frame_errors;
+    r.busy += w[t].r.busy;
+    memcpy(lat + n_lat, w[t].lat, w[t].n_lat * sizeof(double));
+    n_lat += w[t].n_lat;
+    free(w[t].lat);
+  }
+  percentiles(lat, n_lat, r.lat);
+
+  free(lat);
+  free(w);
+  free(tid);
+  return r;
+}
+
+/* ============================================================
+ * Encoder benchmark (one thread)
+ * ============================================================ */
+typedef enum { ENC_G_DENSE, ENC_G_PACKED, ENC_G_SLICED, ENC_H_SPARSE } enc_kind;
+
+static const char *enc_names[] = {"g_dense", "g_packed", "g_sliced",
+                                  "h_sparse"};
+
+static int enc_available(const ldpc_code_t *c, enc_kind kind) {
+  switch (kind) {
+  case ENC_G_DENSE:
+    return c->G != NULL;
+  case ENC_G_PACKED:
+  case ENC_G_SLICED:
+    return c->enc != NULL;
+  case ENC_H_SPARSE:
+    return c->henc != NULL;
+  }
+  return 0;
+}
+
+static result_t bench_encode(const ldpc_code_t *c, enc_kind kind, int frames,
+                             unsigned long long seed) {
+  int N = c->N, K = c->K;
+  int per_call = (kind == ENC_G_SLICED) ? LDPC_SLICE_FRAMES : 1;
+  int calls = (frames + per_call - 1) / per_call;
+
+  int *inf = (int *)malloc(K * sizeof(int));
+  int *ecc = (int *)malloc(N * sizeof(int));
+  uint64_t *sinf = (uint64_t *)malloc(K * sizeof(uint64_t));
+  uint64_t *secc = (uint64_t *)malloc(N * sizeof(uint64_t));
+  double *lat = (double *)malloc(calls * sizeof(double));
+  if (!inf || !ecc || !sinf || !secc || !lat) {
+    fprintf(stderr, "malloc failed in bench_encode\n");
+    exit(1);
+  }
+
+  /* the registry's H encoder is a shared template */
+  ldpc_hencoder_t *henc =
+      (kind == ENC_H_SPARSE) ? ldpc_hencoder_dup(c->henc) : NULL;
+
+  ldpc_rng_t rng;
+  ldpc_rng_stream(&rng, seed, 0, 0);
+
+  result_t r;
+  memset(&r, 0, sizeof(r));
+  r.frame_bits = c->K;
+  double t_start = wall_seconds();
+  for (int i = 0; i < calls; i++) {
+    if (kind == ENC_G_SLICED) {
+      for (int j = 0; j < K; j++)
+        sinf[j] = ldpc_rng_next(&rng);
+    } else {
+      ldpc_rng_bits(&rng, inf, K);
+    }
+
+    double t0 = wall_seconds();
+    switch (kind) {
+    case ENC_G_DENSE:
+      ldpc_encode(ecc, inf, c->G, N, K);
+      break;
+    case ENC_G_PACKED:
+      ldpc_encoder_encode(c->enc, ecc, inf);
+      break;
+    case ENC_G_SLICED:
+      ldpc_encoder_encode_sliced(c->enc, secc, sinf);
+      break;
+    case ENC_H_SPARSE:
+      ldpc_hencoder_encode(henc, ecc, inf);
+      break;
+    }
+    lat[i] = wall_seconds() - t0;
+    r.busy += lat[i];
+    r.frames += per_call;
+  }
+  r.wall = wall_seconds() - t_start;
+  percentiles(lat, calls, r.lat);
+
+  free(inf);
+  free(ecc);
+  free(sinf);
+  free(secc);
+  free(lat);
+  ldpc_hencoder_free(henc);
+  return r;
+}
+
+/* ============================================================
+ * Demapper benchmark (one thread)
+ * ============================================================ */
+typedef enum { DEMAP_PYX, DEMAP_EXACT, DEMAP_MAXLOG } demap_kind;
+
+static const char *demap_names[] = {"pyx", "exact", "maxlog"};
+static const char *demap_mods[] = {"16qam", "256qam"};
+
+static result_t bench_demap(const ldpc_code_t *c, const char *mod,
+                            demap_kind kind, int frames,
+                            unsigned long long seed) {
+  ldpc_demapper_t *dm = ldpc_demapper_parse(mod);
+  int E = ldpc_demapper_order(dm), m = ldpc_demapper_bits(dm);
+  int n_sym = (c->N + m - 1) / m;
+  double N0 = pow(10.0, -1.0); /* Es/N0 = 10 dB */
+
+  int *bits = (int *)malloc((size_t)n_sym * m * sizeof(int));
+  double *y = (double *)malloc(2 * (size_t)n_sym * sizeof(double));
+  double *pts = (double *)malloc(2 * (size_t)E * sizeof(double));
+  double *LLR = (double *)malloc((size_t)n_sym * m * sizeof(double));
+  double **pyx = (double **)malloc(E * sizeof(double *));
+  double *lat = (double *)malloc(frames * sizeof(double));
+  if (!bits || !y || !pts || !LLR || !pyx || !lat) {
+    fprintf(stderr, "malloc failed in bench_demap\n");
+    exit(1);
+  }
+  for (int k = 0; k < E; k++) {
+    pyx[k] = (double *)malloc(n_sym * sizeof(double));
+    if (!pyx[k]) {
+      fprintf(stderr, "malloc failed in bench_demap\n");
+      exit(1);
+    }
+    /* point of label k */
+    for (int b = 0; b < m; b++)
+      bits[b] = (k >> b) & 1;
+    ldpc_modulate(dm, bits, 1, pts + 2 * k);
+  }
+
+  ldpc_rng_t rng;
+  ldpc_rng_stream(&rng, seed, 0, 0);
+
+  result_t r;
+  memset(&r, 0, sizeof(r));
+  r.frame_bits = n_sym * m;
+  double t_start = wall_seconds();
+  for (int i = 0; i < frames; i++) {
+    ldpc_rng_bits(&rng, bits, n_sym * m);
+    ldpc_modulate(dm, bits, n_sym, y);
+    for (int j = 0; j < 2 * n_sym; j++)
+      y[j] += sqrt(N0 / 2.0) * ldpc_rng_gauss(&rng);
+
+    double t0 = wall_seconds();
+    switch (kind) {
+    case DEMAP_PYX:
+      for (int k = 0; k < E; k++)
+        for (int j = 0; j < n_sym; j++) {
+          double dx = y[2 * j] - pts[2 * k], dy = y[2 * j + 1] - pts[2 * k + 1];
+          pyx[k][j] = exp(-(dx * dx + dy * dy) / N0);
+        }
+      compute_llr_from_pyx(pyx, E, n_sym, LLR);
+      break;
+    case DEMAP_EXACT:
+      ldpc_demap(dm, LDPC_DEMAP_EXACT, y, n_sym, N0, LLR);
+      break;
+    case DEMAP_MAXLOG:
+      ldpc_demap(dm, LDPC_DEMAP_MAXLOG, y, n_sym, N0, LLR);
+      break;
+    }
+    lat[i] = wall_seconds() - t0;
+    r.busy += lat[i];
+    r.frames++;
+  }
+  r.wall = wall_seconds() - t_start;
+  percentiles(lat, frames, r.lat);
+
+  for (int k = 0; k < E; k++)
+    free(pyx[k]);
+  free(pyx);
+  free(bits);
+  free(y);
+  free(pts);
+  free(LLR);
+  free(lat);
+  ldpc_demapper_free(dm);
+  return r;
+}
+
+/* ============================================================
+ * Command line
+ * ============================================================ */
+typedef struct {
+  const char *output;
+  int n_threads;
+  long long frames;
+  double max_time;
+  double ebn0[BENCH_MAX_POINTS];
+  int n_ebn0;
+  unsigned long long seed;
+  const char *folders[BENCH_MAX_CODES];
+  int n_folders;
+} bench_options_t;
+
+static void usage(const char *prog) {
+  printf("Usage: %s [options] [matrices/N{N}_wc{wc}_wr{wr} ...]\n\n", prog);
+  printf("  -o, --output PATH   CSV output (default results/bench.csv)\n");
+  printf("  -t, --threads T     threads of the multi-thread runs "
+         "(default: CPUs)\n");
+  printf("  -f, --frames F      frames per decoder point (default 1000)\n");
+  printf("      --max-time S    seconds per decoder point (default 2, 0 = "
+         "none)\n");
+  printf("  -E, --ebn0 LIST     Eb/N0 points in dB (default 1.0,2.0,3.0)\n");
+  printf("      --seed S        master seed (default 1)\n");
+  printf("  -h, --help          show this help\n");
+  printf("\nWithout folders every N* folder under matrices/ is measured.\n");
+  printf("A folder may also be a directory of codes or a registry config "
+         "file.\n");
+}
+
+static int parse_ebn0(const char *list, bench_options_t *opt) {
+  char buf[256];
+  snprintf(buf, sizeof(buf), "%s", list);
+  opt->n_ebn0 = 0;
+  for (char *tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+    if (opt->n_ebn0 == BENCH_MAX_POINTS)
+      return -1;
+    char *end;
+    opt->ebn0[opt->n_ebn0++] = strtod(tok, &end);
+    if (end == tok)
+      return -1;
+  }
+  return opt->n_ebn0 > 0 ? 0 : -1;
+}
+
+static int parse_options(int argc, char **argv, bench_options_t *opt) {
+  memset(opt, 0, sizeof(*opt));
+  opt->output = "results/bench.csv";
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  opt->n_threads = cpus > 0 ? (int)cpus : 1;
+  opt->frames = 1000;
+  opt->max_time = 2.0;
+  opt->seed = 1;
+  parse_ebn0("1.0,2.0,3.0", opt);
+
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    int has_val = (i + 1 < argc);
+
+    if (!strcmp(a, "-h") || !strcmp(a, "--help")) {
+      usage(argv[0]);
+      exit(0);
+    } else if ((!strcmp(a, "-o") || !strcmp(a, "--output")) && has_val) {
+      opt->output = argv[++i];
+    } else if ((!strcmp(a, "-t") || !strcmp(a, "--threads")) && has_val) {
+      opt->n_threads = atoi(argv[++i]);
+      if (opt->n_threads < 1) {
+        fprintf(stderr, "Invalid thread count '%s'\n", argv[i]);
+        return -1;
+      }
+    } else if ((!strcmp(a, "-f") || !strcmp(a, "--frames")) && has_val) {
+      opt->frames = atoll(argv[++i]);
+      if (opt->frames < 1) {
+        fprintf(stderr, "Invalid frame count '%s'\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--max-time") && has_val) {
+      opt->max_time = atof(argv[++i]);
+    } else if ((!strcmp(a, "-E") || !strcmp(a, "--ebn0")) && has_val) {
+      if (parse_ebn0(argv[++i], opt)) {
+        fprintf(stderr, "Invalid Eb/N0 list '%s'\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--seed") && has_val) {
+      opt->seed = strtoull(argv[++i], NULL, 0);
+    } else if (a[0] != '-' && opt->n_folders < BENCH_MAX_CODES) {
+      opt->folders[opt->n_folders++] = a;
+    } else {
+      usage(argv[0]);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/* ============================================================
+ * MAIN
+ * ============================================================ */
+int main(int argc, char **argv) {
+  bench_options_t opt;
+  if (parse_options(argc, argv, &opt))
+    return 1;
+
+  /* every code is loaded once, up front */
+  ldpc_registry_t *reg = ldpc_registry_create();
+  if (opt.n_folders == 0)
+    ldpc_registry_scan(reg, "matrices");
+  for (int f = 0; f < opt.n_folders; f++)
+    if (ldpc_registry_load(reg, opt.folders[f]) <= 0)
+      fprintf(stderr, "Skipping %s: no H found\n", opt.folders[f]);
+  if (ldpc_registry_count(reg) == 0) {
+    fprintf(stderr, opt.n_folders ? "No code to measure\n"
+                                  : "No code folders under matrices/\n");
+    ldpc_registry_free(reg);
+    return 1;
+  }
+
+#ifdef _WIN32
+  _mkdir("results");
+#else
+  mkdir("results", 0777);
+#endif
+  FILE *fp = fopen(opt.output, "w");
+  if (!fp) {
+    fprintf(stderr, "Cannot open %s\n", opt.output);
+    return 1;
+  }
+  fprintf(fp, "matrix,N,K,kind,variant,ebn0_db,threads,frames,avg_iter,fer,"
+              "mbps_core,mbps_total,lat_p50_us,lat_p99_us,lat_p999_us\n");
+
+  printf("LDPC decoder benchmark: %lld frames per point, threads 1",
+         opt.frames);
+  if (opt.n_threads > 1)
+    printf(" and %d", opt.n_threads);
+  printf("\n");
+  printf("Saving results to: %s\n", opt.output);
+
+  for (int id = 0; id < ldpc_registry_count(reg); id++) {
+    const ldpc_code_t *c = ldpc_registry_code(reg, id);
+    ldpc_batch_decoder_t *probe = ldpc_batch_create(c->graph, c->K,
+                                                     LDPC_SIMD_AUTO);
+    printf("\n%s: N = %d, K = %d%s, batch target %s\n", c->name, c->N, c->K,
+           c->qc ? " (QC)" : "",
+           ldpc_simd_target_name(ldpc_batch_target(probe)));
+    ldpc_batch_free(probe);
+    printf("  %-13s %6s %3s %9s %8s %10s %10s %9s %9s %9s\n", "variant",
+           "EbN0", "T", "avg_iter", "FER", "Mb/s core", "Mb/s total",
+           "p50 us", "p99 us", "p99.9 us");
+
+    for (int v = 0; v < N_VARIANTS; v++) {
+      if (variants[v].kind == DEC_QC && !c->qc)
+        continue;
+      for (int p = 0; p < opt.n_ebn0; p++) {
+        for (int pass = 0; pass < 2; pass++) {
+          int T = pass ? opt.n_threads : 1;
+          if (pass && T == 1)
+            break;
+          result_t r = bench_decode(c, &variants[v], opt.ebn0[p], p,
+                                    opt.frames, opt.max_time, T, opt.seed);
+          write_row(fp, c, "decode", variants[v].name, &opt.ebn0[p], T, &r);
+          double bits = (double)r.frames * r.frame_bits;
+          printf("  %-13s %6.2f %3d %9.3f %8.2e %10.2f %10.2f %9.1f %9.1f "
+                 "%9.1f\n",
+                 variants[v].name, opt.ebn0[p], T,
+                 (double)r.iters / r.frames,
+                 (double)r.frame_errors / r.frames, bits / r.busy * 1e-6,
+                 bits / r.wall * 1e-6, r.lat[0] * 1e6, r.lat[1] * 1e6,
+                 r.lat[2] * 1e6);
+        }
+      }
+    }
+
+    for (int e = 0; e <= ENC_H_SPARSE; e++) {
+      if (!enc_available(c, (enc_kind)e))
+        continue;
+      result_t r = bench_encode(c, (enc_kind)e, enc_frames, opt.seed);
+      write_row(fp, c, "encode", enc_names[e], NULL, 1, &r);
+      printf("  %-13s %6s %3d %9s %8s %10.2f %10.2f %9.1f %9.1f %9.1f\n",
+             enc_names[e], "-", 1, "-", "-",
+             (double)r.frames * r.frame_bits / r.busy * 1e-6,
+             (double)r.frames * r.frame_bits / r.wall * 1e-6, r.lat[0] * 1e6,
+             r.lat[1] * 1e6, r.lat[2] * 1e6);
+    }
+
+    for (int md = 0; md < 2; md++) {
+      for (int d = 0; d <= DEMAP_MAXLOG; d++) {
+        char name[32];
+        snprintf(name, sizeof(name), "%s_%s", demap_names[d], demap_mods[md]);
+        result_t r = bench_demap(c, demap_mods[md], (demap_kind)d,
+                                 demap_frames, opt.seed);
+        write_row(fp, c, "demap", name, NULL, 1, &r);
+        printf("  %-13s %6s %3d %9s %8s %10.2f %10.2f %9.1f %9.1f %9.1f\n",
+               name, "-", 1, "-", "-",
+               (double)r.frames * r.frame_bits / r.busy * 1e-6,
+               (double)r.frames * r.frame_bits / r.wall * 1e-6,
+               r.lat[0] * 1e6, r.lat[1] * 1e6, r.lat[2] * 1e6);
+      }
+    }
+  }
+
+  fclose(fp);
+  ldpc_registry_free(reg);
+  return 0;
+}
@@ -4,10 +4,117 @@
  *
  * This program evaluates the information-bit BER performance of a
  * systematic LDPC code under BPSK modulation over AWGN, using the
- * Sum-Product Algorithm (SPA) decoder.
+ * Sum-Product Algorithm (SPA) decoder or one of the min-sum kernels.
+ *
+ * Usage:
+ *   ldpc_ber [options] [matrices/N{N}_wc{wc}_wr{wr}]
+ *
+ *   -k, --kernel NAME   check-node kernel: spa | minsum | nms | oms
+ *       --alpha X       normalization factor for nms (default 0.75)
+ *       --beta X        offset for oms (default 0.5)
+ *   -s, --schedule S    flooding | layered (default flooding)
+ *   -p, --precision P   message precision: f64 | f32 (default f64)
+ *       --bf MODE       hybrid decoding: bit flipping (wbf | gdbf) first,
+ *                       the soft decoder only for frames it leaves with a
+ *                       nonzero syndrome; --stats reports the fallback rate
+ *       --bf-iter N     bit-flipping budget (default 20)
+ *       --bf-param X    θ for gdbf (default -0.6), α for wbf (default 0.3)
+ *       --bf-gate G     skip bit flipping for frames with more than M/G
+ *                       unsatisfied checks (default 4,
+ *                       LDPC_BF_GATE_DEFAULT; 0: never skip)
+ *       --is MODE       importance sampling for very low error rates
+ *                       (ldpc_is.h): shift (mean translation of all bits)
+ *                       | ts (shifts on the short cycles of H, calibrated
+ *                       per set to the decoder's error boundary). BER_info
+ *                       and FER are then the weighted, unbiased estimates;
+ *                       BER_ci95, FER_ci95 (95 % half-widths) and
+ *                       eff_frames (effective number of error frames,
+ *                       (Σw·e)² / Σ(w·e)²) are added; below
+ *                       LDPC_IS_MIN_EFF_FRAMES the CI columns stay empty
+ *                       and the row is flagged as unreliable. avg_iter
+ *                       describes the biased channel. The lowest point
+ *                       of the sweep is also run with plain Monte Carlo
+ *                       (not by a --shard) and the two FER estimates are
+ *                       compared
+ *       --is-shift X    shift mode: fixed mean shift in units of the BPSK
+ *                       amplitude (default: 2 σ / √N per point, see
+ *                       ldpc_is_shift_auto())
+ *       --is-p0 X       share of unbiased frames (default 0.1); all
+ *                       weights are at most 1 / p0
+ *   -e, --encoder E     g | h: dense-G based or sparse-H based encoder
+ *                       (default g, h if the folder has no G); the H
+ *                       encoder preprocessing is read from H_enc.bin if
+ *                       present (gene_hg writes it)
+ *       --phi MODE      SPA nonlinearity: exact | lut | pwl (default exact);
+ *                       lut / pwl also decode every frame with the exact
+ *                       (libm) phi and add a BER_libm column
+ *   -q, --quant LIST    also decode with fixed-point formats, e.g. 5.1,6.2:8
+ *                       (B.F[:clip], needs a min-sum kernel); one extra
+ *                       BER_q{B}.{F} column per format
+ *   -z, --all-zero      transmit the all-zero codeword: no G, no encoding
+ *                       (statistically identical for BPSK/AWGN)
+ *       --check-random  with -z: also run every point with random data
+ *                       (H encoder, independent noise) for the same number
+ *                       of frames; adds BER_random / FER_random columns
+ *       --stats         decoder statistics: per point, print the iteration
+ *                       percentiles, non-converged frames and CN / VN /
+ *                       syndrome time per frame, and write the histogram
+ *                       of iterations and the mean unsatisfied-check trace
+ *                       to ..._iter_hist.csv next to the BER CSV
+ *       --no-qc         QC code: decode with the generic decoder on the
+ *                       expanded graph instead of the block-row QC decoder
+ *   -t, --threads T     worker threads (default 1)
+ *       --seed S        master seed (default: time); results are
+ *                       reproducible for the same seed and thread count
+ *                       (unless a point is cut by --max-time)
+ *
+ *   Stopping rules, checked after every round of frames_per_round frames
+ *   per thread (the last round cut to the frame budget); a point ends when any enabled target is met or the budget
+ *   is used up:
+ *       --target-fe N   frame errors (default 100, 0 = off); with --is
+ *                       effective error frames
+ *       --target-be N   information bit errors (default 0 = off; not
+ *                       used with --is)
+ *       --ci X          relative half-width of the 95 % confidence
+ *                       interval of the FER (e.g. 0.1; default 0 = off)
+ *       --max-frames N  frame budget per point, exact (default 100000)
+ *       --max-time S    wall-clock budget per point in seconds (0 = none)
+ *   The sweep ends after the first point that used its budget without a
+ *   single frame error.
+ *
+ *   Sharded and resumable sweeps (see "Counter files" below):
+ *       --ebn0 LO:HI    only the points of the grid with LO <= Eb/N0 <= HI
+ *                       (their random streams are those of a full sweep)
+ *       --shard I/S     shard I of S (0 <= I < S): independent random
+ *                       streams, and 1/S of the frame budget and of the
+ *                       error targets per point (--ci is widened by
+ *                       sqrt(S)); needs --seed, the same for all
+ *                       shards; writes only the counter file
+ *                       ..._shard{I}of{S}_counts.csv, not the data CSV
+ *       --checkpoint S  save the raw counters every S seconds and after
+ *                       every point (default 60 with --shard, else off)
+ *       --resume        continue from the counter file of the same
+ *                       command line: finished points are not run again,
+ *                       the running one continues with the saved random
+ *                       streams (same result as an uninterrupted run)
+ *   Merge:
+ *       ldpc_ber --merge FILE...   add up the counters of shard files of
+ *                       the same sweep and write the data CSV the sweep
+ *                       would have written (path taken from the files)
+ *
+ *   -h, --help          show usage
+ *
+ * Without a folder argument one of the codes under matrices/ is selected
+ * interactively.
+ *
+ * The folder is loaded by the code registry (ldpc_registry.h): H from the
+ * first file found of H.qc (QC base matrix, see ldpc_qc.h), H.bin (mapped,
+ * may carry the packed P of G), H.alist, H.csv; G from the P block of
+ * H.bin or from G.csv. N, K, wc and wr are taken from H (wc / wr: largest
+ * column / row degree). For H.qc with a min-sum kernel and -s layered the
+ * QC decoder is used.
  */
 
-#include <dirent.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -23,157 +130,1125 @@
 
 #include "ldpc_decoder.h"
 #include "ldpc_encoder.h"
-
-#define PI 3.141592653589793
+#include "ldpc_fixed.h"
+#include "ldpc_is.h"
+#include "ldpc_qc.h"
+#include "ldpc_registry.h"
+#include "ldpc_sim.h"
 
 /* ============================================================
  * Simulation parameters
  * ============================================================ */
-const int N_trials = 10; /* Monte Carlo trials */
+const int frames_per_round = 8; /* per thread, between stop checks */
 const double EbN0_min = -2.0;
 const double EbN0_max = 10.0;
 const double EbN0_step = 0.5;
 const int max_iter_spa = 40; /* SPA maximum iteration */
 
 /* ============================================================
- * Gaussian noise generator
+ * BPSK theoretical BER
  * ============================================================ */
-static double rand_uniform(void) { return (rand() + 1.0) / (RAND_MAX + 2.0); }
-static double randn(void) {
-  double u1 = rand_uniform();
-  double u2 = rand_uniform();
-  return sqrt(-2.0 * log(u1)) * cos(2.0 * PI * u2);
+static double bpsk_ber(double EbN0_linear) {
+  return 0.5 * erfc(sqrt(EbN0_linear));
 }
 
 /* ============================================================
- * BPSK theoretical BER
+ * Wall-clock time in seconds (clock() would sum all threads)
  * ============================================================ */
-static double bpsk_ber(double EbN0_linear) {
-  return 0.5 * erfc(sqrt(EbN0_linear));
+static double wall_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
 }
 
 /* ============================================================
- * Load matrix from CSV
+ * --stats: one point of decoder statistics
+ *   console: iteration percentiles, failures, phase time per frame and,
+ *            with --bf, the fallback rate of the bit-flipping stage
+ *   fp     : histogram rows EbN0_dB,iter,converged,failed,unsat_mean
  * ============================================================ */
-static int load_matrix(int **mat, int rows, int cols, const char *path) {
-  FILE *fp = fopen(path, "r");
-  if (!fp) {
-    fprintf(stderr, "ERROR: cannot open %s\n", path);
+static void report_stats(FILE *fp, double EbN0_dB, const ldpc_sim_stats_t *st,
+                         long long frames, int max_iter, int hybrid) {
+  /* iteration percentiles over all frames (failures count as max_iter) */
+  static const double pct[3] = {0.5, 0.9, 0.99};
+  int it_p[3] = {max_iter, max_iter, max_iter};
+  long long cum = 0;
+  int p = 0;
+  for (int i = 0; i <= max_iter && p < 3; i++) {
+    cum += st->converged[i] + (i == max_iter ? st->failed : 0);
+    while (p < 3 && cum >= pct[p] * frames)
+      it_p[p++] = i;
+  }
+  double us = 1e-3 / frames;
+  printf("    iter p50/p90/p99 = %d/%d/%d, not converged = %lld (%.2f%%), "
+         "CN/VN/syndrome = %.1f/%.1f/%.1f us per frame\n",
+         it_p[0], it_p[1], it_p[2], st->failed, 100.0 * st->failed / frames,
+         st->cn_ns * us, st->vn_ns * us, st->syn_ns * us);
+  if (hybrid)
+    printf("    bit flipping: fallback = %lld (%.2f%%), %.2f BF iterations, "
+           "%.1f us per frame\n",
+           st->fallback, 100.0 * st->fallback / frames,
+           (double)st->bf_iterations / frames, st->bf_ns * us);
+
+  for (int i = 1; i <= max_iter; i++) {
+    long long n = st->unsat_frames[i - 1];
+    fprintf(fp, "%.1f,%d,%lld,%lld,%.4f\n", EbN0_dB, i, st->converged[i],
+            i == max_iter ? st->failed : 0,
+            n ? (double)st->unsat_sum[i - 1] / n : 0.0);
+  }
+  fflush(fp);
+}
+
+/* ============================================================
+ * Pick one of the codes under matrices/
+ * ============================================================ */
+static int select_ldpc_code(ldpc_registry_t *reg) {
+  const char *root = "matrices";
+
+  printf("Searching LDPC matrix folders under '%s'...\n\n", root);
+  int n = ldpc_registry_scan(reg, root);
+  if (n < 0) {
+    fprintf(stderr, "ERROR: '%s' directory not found.\n", root);
+    exit(1);
+  }
+  if (n == 0) {
+    fprintf(stderr, "ERROR: no LDPC code under '%s'.\n", root);
+    exit(1);
+  }
+
+  printf("Available LDPC matrix folders:\n\n");
+  for (int i = 0; i < n; i++)
+    printf(" [%d] %s\n", i, ldpc_registry_code(reg, i)->path);
+
+  printf("\nSelect folder index: ");
+  int idx = -1;
+  if (scanf("%d", &idx) != 1 || idx < 0 || idx >= n) {
+    /* e.g. stdin not a terminal: scripted runs pass the folder */
+    fprintf(stderr, "\nERROR: no valid folder index; pass the folder as "
+                    "an argument (ldpc_ber matrices/N...).\n");
+    exit(1);
+  }
+
+  printf("\nUsing LDPC folder: %s\n\n", ldpc_registry_code(reg, idx)->path);
+  return idx;
+}
+
+/* ============================================================
+ * Command line
+ * ============================================================ */
+#define MAX_QUANT LDPC_SIM_MAX_QUANT
+
+/* encoder selection */
+enum { ENC_AUTO = 0, ENC_G, ENC_H };
+
+typedef struct {
+  const char *folder; /* NULL → interactive selection */
+  ldpc_cn_kernel kernel;
+  double alpha;
+  double beta;
+  ldpc_schedule schedule;
+  ldpc_phi_mode phi;
+  ldpc_precision precision;
+  int bf_iter;  /* hybrid bit flipping, 0: off */
+  ldpc_bf_mode bf_mode;
+  double bf_param;
+  int has_bf_param;
+  int bf_gate;  /* skip bit flipping above M / bf_gate unsatisfied checks */
+  int is; /* importance sampling */
+  ldpc_is_mode is_mode;
+  double is_shift; /* 0: ldpc_is_shift_auto() per point */
+  double is_p0;
+  int encoder; /* ENC_AUTO | ENC_G | ENC_H */
+  int n_quant; /* fixed-point formats decoded alongside */
+  ldpc_qformat_t quant[MAX_QUANT];
+  int all_zero;
+  int check_random;
+  int stats;
+  int no_qc;
+  int n_threads;
+  unsigned long long seed;
+  int has_seed;
+  /* stopping rules per Eb/N0 point */
+  long long target_fe;
+  long long target_be;
+  double ci;
+  long long max_frames;
+  double max_time;
+  /* sharded / resumable sweeps */
+  double ebn0_lo, ebn0_hi;
+  int shard, n_shards;
+  double checkpoint; /* seconds between counter saves, 0: off */
+  int has_checkpoint;
+  int resume;
+  int merge; /* --merge: the positional arguments are counter files */
+  int n_files;
+  char **files;
+} ber_options_t;
+
+static void usage(const char *prog) {
+  printf("Usage: %s [options] [matrices/N{N}_wc{wc}_wr{wr}]\n\n", prog);
+  printf("  -k, --kernel NAME   check-node kernel: spa | minsum | nms | oms\n");
+  printf("      --alpha X       normalization factor for nms (default %.2f)\n",
+         LDPC_NMS_ALPHA_DEFAULT);
+  printf("      --beta X        offset for oms (default %.2f)\n",
+         LDPC_OMS_BETA_DEFAULT);
+  printf("  -s, --schedule S    flooding | layered (default flooding)\n");
+  printf("  -p, --precision P   f64 | f32 (default f64)\n");
+  printf("      --bf MODE       bit flipping first: wbf | gdbf (default "
+         "off)\n");
+  printf("      --bf-iter N     bit-flipping budget (default %d)\n",
+         LDPC_BF_ITER_DEFAULT);
+  printf("      --bf-param X    gdbf theta (default %.2f), wbf alpha "
+         "(default %.2f)\n",
+         LDPC_GDBF_THETA_DEFAULT, LDPC_WBF_ALPHA_DEFAULT);
+  printf("      --bf-gate G     skip bit flipping above M/G unsatisfied "
+         "checks,\n"
+         "                      0: never (default %d)\n",
+         LDPC_BF_GATE_DEFAULT);
+  printf("      --is MODE       importance sampling: shift | ts (default "
+         "off)\n");
+  printf("      --is-shift X    shift mode: fixed mean shift (default "
+         "%g sigma/sqrt(N)\n"
+         "                      per point)\n",
+         LDPC_IS_SHIFT_KAPPA);
+  printf("      --is-p0 X       share of unbiased frames (default %.2f)\n",
+         LDPC_IS_P0_DEFAULT);
+  printf("  -e, --encoder E     g | h (default g; h if there is no G.csv)\n");
+  printf("      --phi MODE      SPA phi: exact | lut | pwl (default exact)\n");
+  printf("  -q, --quant LIST    fixed-point formats B.F[:clip], comma "
+         "separated\n");
+  printf("  -z, --all-zero      all-zero codeword, G is not loaded\n");
+  printf("      --check-random  with -z: compare with random data\n");
+  printf("      --stats         iteration histograms and phase times "
+         "(_iter_hist.csv)\n");
+  printf("      --no-qc         QC code: generic decoder on the expanded "
+         "graph\n");
+  printf("  -t, --threads T     worker threads (default 1)\n");
+  printf("      --seed S        master seed (default: time)\n");
+  printf("      --target-fe N   frame errors per point (default 100)\n");
+  printf("      --target-be N   bit errors per point (default off)\n");
+  printf("      --ci X          relative 95%% CI half-width of FER "
+         "(default off)\n");
+  printf("      --max-frames N  at most N frames per point (default 100000)\n");
+  printf("      --max-time S    seconds per point (default unlimited)\n");
+  printf("      --ebn0 LO:HI    only the grid points from LO to HI dB\n");
+  printf("      --shard I/S     run shard I of S (counter file only)\n");
+  printf("      --checkpoint S  save counters every S seconds (default 60 "
+         "with --shard)\n");
+  printf("      --resume        continue from the saved counters\n");
+  printf("      --merge FILE... merge shard counter files into the data "
+         "CSV\n");
+  printf("  -h, --help          show this help\n");
+}
+
+static int parse_args(int argc, char **argv, ber_options_t *opt) {
+  opt->folder = NULL;
+  opt->kernel = LDPC_CN_SPA;
+  opt->alpha = LDPC_NMS_ALPHA_DEFAULT;
+  opt->beta = LDPC_OMS_BETA_DEFAULT;
+  opt->schedule = LDPC_SCHED_FLOODING;
+  opt->phi = LDPC_PHI_EXACT;
+  opt->precision = LDPC_PREC_F64;
+  opt->bf_iter = 0;
+  opt->bf_mode = LDPC_BF_GDBF;
+  opt->bf_param = 0.0;
+  opt->has_bf_param = 0;
+  opt->bf_gate = LDPC_BF_GATE_DEFAULT;
+  opt->is = 0;
+  opt->is_mode = LDPC_IS_TS;
+  opt->is_shift = 0.0; /* per point */
+  opt->is_p0 = LDPC_IS_P0_DEFAULT;
+  opt->encoder = ENC_AUTO;
+  opt->n_quant = 0;
+  opt->all_zero = 0;
+  opt->check_random = 0;
+  opt->stats = 0;
+  opt->no_qc = 0;
+  opt->n_threads = 1;
+  opt->seed = 0;
+  opt->has_seed = 0;
+  opt->target_fe = 100;
+  opt->target_be = 0;
+  opt->ci = 0.0;
+  opt->max_frames = 100000;
+  opt->max_time = 0.0;
+  opt->ebn0_lo = EbN0_min;
+  opt->ebn0_hi = EbN0_max;
+  opt->shard = 0;
+  opt->n_shards = 1;
+  opt->checkpoint = 0.0;
+  opt->has_checkpoint = 0;
+  opt->resume = 0;
+  opt->merge = 0;
+  opt->n_files = 0;
+  opt->files = argv + 1; /* positional arguments are moved to the front */
+
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    int has_val = (i + 1 < argc);
+
+    if (!strcmp(a, "-h") || !strcmp(a, "--help")) {
+      usage(argv[0]);
+      exit(0);
+    } else if ((!strcmp(a, "-k") || !strcmp(a, "--kernel")) && has_val) {
+      if (ldpc_cn_kernel_parse(argv[++i], &opt->kernel)) {
+        fprintf(stderr, "Unknown kernel '%s'\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--alpha") && has_val) {
+      opt->alpha = atof(argv[++i]);
+    } else if (!strcmp(a, "--beta") && has_val) {
+      opt->beta = atof(argv[++i]);
+    } else if ((!strcmp(a, "-s") || !strcmp(a, "--schedule")) && has_val) {
+      const char *v = argv[++i];
+      if (!strcmp(v, "flooding")) {
+        opt->schedule = LDPC_SCHED_FLOODING;
+      } else if (!strcmp(v, "layered")) {
+        opt->schedule = LDPC_SCHED_LAYERED;
+      } else {
+        fprintf(stderr, "Unknown schedule '%s'\n", v);
+        return -1;
+      }
+    } else if ((!strcmp(a, "-p") || !strcmp(a, "--precision")) && has_val) {
+      if (ldpc_precision_parse(argv[++i], &opt->precision)) {
+        fprintf(stderr, "Unknown precision '%s'\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--bf") && has_val) {
+      if (ldpc_bf_mode_parse(argv[++i], &opt->bf_mode)) {
+        fprintf(stderr, "Unknown bit-flipping mode '%s'\n", argv[i]);
+        return -1;
+      }
+      if (opt->bf_iter == 0)
+        opt->bf_iter = LDPC_BF_ITER_DEFAULT;
+    } else if (!strcmp(a, "--bf-iter") && has_val) {
+      opt->bf_iter = atoi(argv[++i]);
+      if (opt->bf_iter < 1) {
+        fprintf(stderr, "Invalid bit-flipping budget '%s'\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--bf-param") && has_val) {
+      opt->bf_param = atof(argv[++i]);
+      opt->has_bf_param = 1;
+    } else if (!strcmp(a, "--bf-gate") && has_val) {
+      opt->bf_gate = atoi(argv[++i]);
+      if (opt->bf_gate < 0) {
+        fprintf(stderr, "Invalid bit-flipping gate '%s'\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--is") && has_val) {
+      if (ldpc_is_mode_parse(argv[++i], &opt->is_mode)) {
+        fprintf(stderr, "Unknown importance-sampling mode '%s'\n", argv[i]);
+        return -1;
+      }
+      opt->is = 1;
+    } else if (!strcmp(a, "--is-shift") && has_val) {
+      opt->is_shift = atof(argv[++i]);
+      if (!(opt->is_shift > 0.0)) {
+        fprintf(stderr, "Invalid --is-shift '%s' (> 0)\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--is-p0") && has_val) {
+      opt->is_p0 = atof(argv[++i]);
+      if (!(opt->is_p0 > 0.0 && opt->is_p0 < 1.0)) {
+        fprintf(stderr, "Invalid --is-p0 '%s' (0 < p0 < 1)\n", argv[i]);
+        return -1;
+      }
+    } else if ((!strcmp(a, "-e") || !strcmp(a, "--encoder")) && has_val) {
+      const char *v = argv[++i];
+      if (!strcmp(v, "g")) {
+        opt->encoder = ENC_G;
+      } else if (!strcmp(v, "h")) {
+        opt->encoder = ENC_H;
+      } else {
+        fprintf(stderr, "Unknown encoder '%s'\n", v);
+        return -1;
+      }
+    } else if (!strcmp(a, "--phi") && has_val) {
+      if (ldpc_phi_mode_parse(argv[++i], &opt->phi)) {
+        fprintf(stderr, "Unknown phi mode '%s'\n", argv[i]);
+        return -1;
+      }
+    } else if ((!strcmp(a, "-q") || !strcmp(a, "--quant")) && has_val) {
+      char list[256];
+      snprintf(list, sizeof(list), "%s", argv[++i]);
+      for (char *t = strtok(list, ","); t; t = strtok(NULL, ",")) {
+        if (opt->n_quant == MAX_QUANT ||
+            ldpc_qformat_parse(t, &opt->quant[opt->n_quant])) {
+          fprintf(stderr, "Invalid quantization format '%s'\n", t);
+          return -1;
+        }
+        opt->n_quant++;
+      }
+    } else if (!strcmp(a, "-z") || !strcmp(a, "--all-zero")) {
+      opt->all_zero = 1;
+    } else if (!strcmp(a, "--check-random")) {
+      opt->check_random = 1;
+    } else if (!strcmp(a, "--stats")) {
+      opt->stats = 1;
+    } else if (!strcmp(a, "--no-qc")) {
+      opt->no_qc = 1;
+    } else if ((!strcmp(a, "-t") || !strcmp(a, "--threads")) && has_val) {
+      opt->n_threads = atoi(argv[++i]);
+      if (opt->n_threads < 1) {
+        fprintf(stderr, "Invalid thread count '%s'\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--seed") && has_val) {
+      opt->seed = strtoull(argv[++i], NULL, 0);
+      opt->has_seed = 1;
+    } else if (!strcmp(a, "--target-fe") && has_val) {
+      opt->target_fe = atoll(argv[++i]);
+    } else if (!strcmp(a, "--target-be") && has_val) {
+      opt->target_be = atoll(argv[++i]);
+    } else if (!strcmp(a, "--ci") && has_val) {
+      opt->ci = atof(argv[++i]);
+    } else if (!strcmp(a, "--max-frames") && has_val) {
+      opt->max_frames = atoll(argv[++i]);
+      if (opt->max_frames < 1) {
+        fprintf(stderr, "Invalid frame budget '%s'\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--max-time") && has_val) {
+      opt->max_time = atof(argv[++i]);
+    } else if (!strcmp(a, "--ebn0") && has_val) {
+      if (sscanf(argv[++i], "%lf:%lf", &opt->ebn0_lo, &opt->ebn0_hi) != 2 ||
+          opt->ebn0_lo > opt->ebn0_hi) {
+        fprintf(stderr, "Invalid Eb/N0 range '%s' (LO:HI)\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--shard") && has_val) {
+      if (sscanf(argv[++i], "%d/%d", &opt->shard, &opt->n_shards) != 2 ||
+          opt->shard < 0 || opt->shard >= opt->n_shards) {
+        fprintf(stderr, "Invalid shard '%s' (I/S, 0 <= I < S)\n", argv[i]);
+        return -1;
+      }
+    } else if (!strcmp(a, "--checkpoint") && has_val) {
+      opt->checkpoint = atof(argv[++i]);
+      opt->has_checkpoint = 1;
+    } else if (!strcmp(a, "--resume")) {
+      opt->resume = 1;
+    } else if (!strcmp(a, "--merge")) {
+      opt->merge = 1;
+    } else if (a[0] != '-') {
+      opt->files[opt->n_files++] = argv[i];
+    } else {
+      fprintf(stderr, "Invalid argument '%s'\n", a);
+      return -1;
+    }
+  }
+  if (!opt->merge && opt->n_files > 1) {
+    fprintf(stderr, "Invalid argument '%s'\n", opt->files[1]);
+    return -1;
+  }
+  if (!opt->merge && opt->n_files == 1)
+    opt->folder = opt->files[0];
+  if (opt->merge && opt->n_files == 0) {
+    fprintf(stderr, "--merge needs counter files\n");
     return -1;
   }
+  if (opt->n_shards > 1 && !opt->has_seed && !opt->resume) {
+    fprintf(stderr, "--shard needs --seed (the same for all shards)\n");
+    return -1;
+  }
+  if (opt->n_shards > 1 && !opt->has_checkpoint)
+    opt->checkpoint = 60.0;
+  if ((opt->n_shards > 1 || opt->checkpoint > 0.0 || opt->resume) &&
+      (opt->stats || opt->check_random)) {
+    /* histograms and the random-data reference are not saved */
+    fprintf(stderr, "--stats and --check-random do not combine with "
+                    "--shard, --checkpoint or --resume\n");
+    return -1;
+  }
+  if (opt->n_quant > 0 && opt->kernel == LDPC_CN_SPA) {
+    fprintf(stderr, "Fixed-point decoding needs -k minsum | nms | oms\n");
+    return -1;
+  }
+  if (opt->phi != LDPC_PHI_EXACT && opt->kernel != LDPC_CN_SPA) {
+    fprintf(stderr, "--phi only applies to -k spa\n");
+    return -1;
+  }
+  if (!opt->has_bf_param)
+    opt->bf_param = ldpc_bf_param_default(opt->bf_mode);
+  if (opt->is && (opt->n_quant > 0 || opt->phi != LDPC_PHI_EXACT ||
+                  opt->check_random)) {
+    /* their error counts are not weighted */
+    fprintf(stderr, "--is does not combine with -q, --phi or "
+                    "--check-random\n");
+    return -1;
+  }
+  if (opt->check_random && !opt->all_zero) {
+    fprintf(stderr, "--check-random needs -z\n");
+    return -1;
+  }
+  if (opt->all_zero && opt->encoder == ENC_G) {
+    fprintf(stderr, "-z does not use G (--check-random encodes from H)\n");
+    return -1;
+  }
+  return 0;
+}
+
+/* ============================================================
+ * Stopping rules of one Eb/N0 point
+ * ============================================================
+ * Returns 0 to continue, 1 when a target is met, 2 when the frame or
+ * time budget is used up. The confidence interval uses the normal
+ * approximation of the FER estimate, p ± 1.96·sqrt(p(1 − p)/n), and is
+ * only trusted from 10 frame errors on.
+ *
+ * With --is the weighted estimate and its sample variance take their
+ * place (from LDPC_IS_MIN_EFF_FRAMES on), and frame errors are counted
+ * as effective error frames (Σw·e)² / Σ(w·e)², which is the error count
+ * itself for w = 1.
+ */
+static double is_eff_frames(const ldpc_sim_counts_t *c) {
+  return c->is_fe2 > 0.0 ? c->is_fe * c->is_fe / c->is_fe2 : 0.0;
+}
 
-  char line[20000];
-  for (int r = 0; r < rows; r++) {
-    if (!fgets(line, sizeof(line), fp)) {
-      fprintf(stderr, "ERROR: insufficient rows in %s\n", path);
-      fclose(fp);
-      return -2;
+static int point_done(const ber_options_t *opt, const ldpc_sim_counts_t *c,
+                      double elapsed) {
+  if (opt->is) {
+    double eff = is_eff_frames(c), fer, ci95;
+    ldpc_is_estimate(c->is_fe, c->is_fe2, c->frames, &fer, &ci95);
+    if (opt->target_fe > 0 && eff >= opt->target_fe)
+      return 1;
+    if (opt->ci > 0.0 && eff >= LDPC_IS_MIN_EFF_FRAMES &&
+        ci95 <= opt->ci * fer)
+      return 1;
+  } else {
+    if (opt->target_fe > 0 && c->err_frames >= opt->target_fe)
+      return 1;
+    if (opt->target_be > 0 && c->err_info >= opt->target_be)
+      return 1;
+    if (opt->ci > 0.0 && c->err_frames >= 10) {
+      double p = (double)c->err_frames / c->frames;
+      if (1.96 * sqrt((1.0 - p) / (p * c->frames)) <= opt->ci)
+        return 1;
     }
-    for (int c = 0; c < cols; c++)
-      mat[r][c] = (line[c] == '1') ? 1 : 0;
   }
-  fclose(fp);
+  if (c->frames >= opt->max_frames)
+    return 2;
+  if (opt->max_time > 0.0 && elapsed >= opt->max_time)
+    return 2;
   return 0;
 }
 
+/* frames of the next round: frames_per_round per thread, the last round
+ * of a point cut to what is left of --max-frames */
+static long long round_frames(const ber_options_t *opt,
+                              const ldpc_sim_counts_t *c) {
+  long long n = (long long)frames_per_round * opt->n_threads;
+  long long left = opt->max_frames - c->frames;
+  if (left < 0)
+    left = 0;
+  return n < left ? n : left;
+}
+
 /* ============================================================
- * Matrix alloc/free
- * ============================================================ */
-static int **alloc_matrix_int(int rows, int cols) {
-  int **m = (int **)malloc(rows * sizeof(int *));
-  for (int i = 0; i < rows; i++)
-    m[i] = (int *)malloc(cols * sizeof(int));
-  return m;
+ * --is: plain Monte Carlo check at the lowest point of the sweep
+ * ============================================================
+ * Runs the point again without the biased density, under the stopping
+ * rules of a plain run, and compares the two FER estimates by
+ *   z = (FER_is − FER_mc) / sqrt(se_is² + p(1 − p)/n),
+ * se_is = FER_ci95 / 1.96; they agree for |z| < 2. Without a single
+ * Monte Carlo error the IS estimate has to be below 3/n (the 95 % upper
+ * bound). Returns 1 if the estimates agree, 0 if not, and -1 if the IS
+ * estimate has too few effective error frames to be checked.
+ */
+static int is_check_mc(const ber_options_t *opt, ldpc_sim_t *sim, int point,
+                       double sigma2, double EbN0_dB,
+                       const ldpc_sim_counts_t *c_is) {
+  ber_options_t o = *opt;
+  o.is = 0;
+  ldpc_sim_counts_t m;
+  memset(&m, 0, sizeof(m));
+  ldpc_sim_set_point(sim, point, sigma2);
+  double t0 = wall_seconds();
+  do
+    ldpc_sim_run(sim, round_frames(&o, &m), &m);
+  while (!point_done(&o, &m, wall_seconds() - t0));
+
+  double fer_is, ci95;
+  ldpc_is_estimate(c_is->is_fe, c_is->is_fe2, c_is->frames, &fer_is, &ci95);
+  double fer_mc = (double)m.err_frames / m.frames;
+  int agree;
+
+  printf("    plain Monte Carlo at %.1f dB: FER %.3e (%lld errors in %lld "
+         "frames) vs IS %.3e, ",
+         EbN0_dB, fer_mc, m.err_frames, m.frames, fer_is);
+  if (is_eff_frames(c_is) < LDPC_IS_MIN_EFF_FRAMES) {
+    agree = -1;
+    printf("IS not reliable, no check\n");
+  } else if (m.err_frames == 0) {
+    agree = (fer_is < 3.0 / m.frames);
+    printf("IS %s 3/n\n", agree ? "below" : "not below");
+  } else {
+    double se = sqrt(ci95 * ci95 / (1.96 * 1.96) +
+                     fer_mc * (1.0 - fer_mc) / m.frames);
+    double z = se > 0.0 ? (fer_is - fer_mc) / se : 0.0;
+    agree = (fabs(z) < 2.0);
+    printf("z = %+.2f\n", z);
+  }
+  return agree;
 }
 
-static void free_matrix_int(int **m, int rows) {
-  for (int i = 0; i < rows; i++)
-    free(m[i]);
-  free(m);
+/* ============================================================
+ * Result rows
+ * ============================================================
+ * One row per point, on the console and (fp != NULL) in the data CSV;
+ * the columns depend on the run, see out_columns_t. The sweep and
+ * --merge share these so a merged CSV is the one the run would have
+ * written. With --is the CI columns of a row with fewer than
+ * LDPC_IS_MIN_EFF_FRAMES effective error frames are left empty.
+ */
+typedef struct {
+  int K;
+  int check_libm;
+  int n_quant;
+  ldpc_qformat_t quant[MAX_QUANT];
+  int check_random;
+  int is;
+} out_columns_t;
+
+static void write_header(FILE *fp, const out_columns_t *o) {
+  if (fp) {
+    fprintf(fp, "EbN0_dB,BER_info,BER_bpsk,FER,avg_iter,frames");
+    if (o->check_libm)
+      fprintf(fp, ",BER_libm");
+    for (int q = 0; q < o->n_quant; q++)
+      fprintf(fp, ",BER_q%d.%d", o->quant[q].bits, o->quant[q].frac_bits);
+    if (o->check_random)
+      fprintf(fp, ",BER_random,FER_random");
+    if (o->is)
+      fprintf(fp, ",BER_ci95,FER_ci95,eff_frames");
+    fprintf(fp, "\n");
+  }
+
+  printf("EbN0_dB, BER_info, BER_bpsk, FER, avg_iter, frames");
+  if (o->check_libm)
+    printf(", BER_libm, frames_differ");
+  for (int q = 0; q < o->n_quant; q++)
+    printf(", BER_q%d.%d", o->quant[q].bits, o->quant[q].frac_bits);
+  if (o->check_random)
+    printf(", BER_random, FER_random, z");
+  if (o->is)
+    printf(", BER_ci95, FER_ci95, eff_frames");
+  printf("\n");
+}
+
+/* r: counts of the random-data reference (check_random), else NULL.
+ * Returns the two-proportion z-score of FER against r (0 without r). */
+static double write_point(FILE *fp, double EbN0_dB, const ldpc_sim_counts_t *c,
+                          const ldpc_sim_counts_t *r,
+                          const out_columns_t *o) {
+  double EbN0 = pow(10.0, EbN0_dB / 10.0);
+  long long total_info_bits = c->frames * o->K;
+  double FER = (double)c->err_frames / c->frames;
+  double avg_iter = (double)c->iterations / c->frames;
+
+  double BER_info = (double)c->err_info / total_info_bits;
+  double BER_ci95 = 0.0, FER_ci95 = 0.0;
+  if (o->is) {
+    ldpc_is_estimate(c->is_fe, c->is_fe2, c->frames, &FER, &FER_ci95);
+    ldpc_is_estimate(c->is_be, c->is_be2, c->frames, &BER_info, &BER_ci95);
+    BER_info /= o->K;
+    BER_ci95 /= o->K;
+  }
+  double BER_bpsk = bpsk_ber(EbN0);
+  double z = 0.0;
+
+  printf("%.1f, %.10e, %.10e, %.6e, %.2f, %lld", EbN0_dB, BER_info,
+         BER_bpsk, FER, avg_iter, c->frames);
+  if (fp)
+    fprintf(fp, "%.1f,%.10e,%.10e,%.10e,%.4f,%lld", EbN0_dB, BER_info,
+            BER_bpsk, FER, avg_iter, c->frames);
+  if (o->check_libm) {
+    double BER_libm = (double)c->err_libm / total_info_bits;
+    printf(", %.10e, %lld", BER_libm, c->frames_differ);
+    if (fp)
+      fprintf(fp, ",%.10e", BER_libm);
+  }
+  for (int q = 0; q < o->n_quant; q++) {
+    double BER_q = (double)c->err_q[q] / total_info_bits;
+    printf(", %.10e", BER_q);
+    if (fp)
+      fprintf(fp, ",%.10e", BER_q);
+  }
+  if (o->check_random && r) {
+    double BER_rnd = (double)r->err_info / total_info_bits;
+    double FER_rnd = (double)r->err_frames / r->frames;
+    double p = 0.5 * (FER + FER_rnd);
+    z = (p > 0.0 && p < 1.0)
+            ? (FER - FER_rnd) / sqrt(p * (1.0 - p) * 2.0 / c->frames)
+            : 0.0;
+    printf(", %.10e, %.6e, %+.2f", BER_rnd, FER_rnd, z);
+    if (fp)
+      fprintf(fp, ",%.10e,%.10e", BER_rnd, FER_rnd);
+  }
+  /* too few effective error frames: the sample variance of the weights
+   * is no error bar, leave the CI columns empty */
+  double eff = o->is ? is_eff_frames(c) : 0.0;
+  int reliable = (eff >= LDPC_IS_MIN_EFF_FRAMES);
+  if (o->is && reliable) {
+    printf(", %.3e, %.3e, %.1f", BER_ci95, FER_ci95, eff);
+    if (fp)
+      fprintf(fp, ",%.10e,%.10e,%.2f", BER_ci95, FER_ci95, eff);
+  } else if (o->is) {
+    printf(", n/a, n/a, %.1f", eff);
+    if (fp)
+      fprintf(fp, ",,,%.2f", eff);
+  }
+  printf("\n");
+  if (o->is && !reliable)
+    printf("    warning: %.1f effective error frames (< %d); the IS estimate "
+           "is not reliable\n",
+           eff, LDPC_IS_MIN_EFF_FRAMES);
+  if (fp) {
+    fprintf(fp, "\n");
+    fflush(fp);
+  }
+  return z;
 }
 
 /* ============================================================
- * List LDPC folders under matrices/
- * ============================================================ */
-static void select_ldpc_folder(char *selected_path, size_t bufsize) {
-  const char *root = "matrices";
-  DIR *dp = opendir(root);
-  if (!dp) {
-    fprintf(stderr, "ERROR: '%s' directory not found.\n", root);
-    exit(1);
+ * Counter files (sharded / resumable sweeps)
+ * ============================================================
+ * The raw counters of every point run so far, rewritten after every
+ * point and every --checkpoint seconds (into FILE.tmp, then renamed, so
+ * a killed process leaves the previous version):
+ *
+ *   # ldpc_ber counts
+ *   # run shard=0 shards=4 threads=2
+ *   # code N=1024 K=512 seed=7 libm=0 quant=5.1,6.2:8 is=0 data=results/...
+ *   point,EbN0_dB,state,elapsed,frames,...,is_be2,rng
+ *   17,6.5,1,12.5,3648,...
+ *
+ * state: 1 target met, 2 budget used up, 0 still running; for a running
+ * point, rng holds the worker streams to continue from
+ * (ldpc_sim_get_rng()). A resumed run needs the same "code" and "run"
+ * lines; shards merged by --merge need the same "code" line.
+ */
+#define META_LEN 512
+
+typedef struct {
+  int state; /* -1: not run, 0: running, 1 / 2: point_done() */
+  double elapsed;
+  ldpc_sim_counts_t c; /* stats are not saved */
+} saved_point_t;
+
+static void counts_add(ldpc_sim_counts_t *a, const ldpc_sim_counts_t *b,
+                       int n_quant) {
+  a->frames += b->frames;
+  a->err_info += b->err_info;
+  a->err_frames += b->err_frames;
+  a->iterations += b->iterations;
+  a->err_libm += b->err_libm;
+  a->frames_differ += b->frames_differ;
+  for (int q = 0; q < n_quant; q++)
+    a->err_q[q] += b->err_q[q];
+  a->is_w += b->is_w;
+  a->is_fe += b->is_fe;
+  a->is_fe2 += b->is_fe2;
+  a->is_be += b->is_be;
+  a->is_be2 += b->is_be2;
+}
+
+/* "code" line of a run (without the "# code " prefix) */
+static void code_meta(char *buf, size_t size, int N, int K,
+                      unsigned long long seed, const out_columns_t *o,
+                      const char *data_path) {
+  char quant[256] = "none";
+  for (int q = 0; q < o->n_quant; q++) {
+    char f[32];
+    if (o->quant[q].clip > 0.0)
+      snprintf(f, sizeof(f), "%d.%d:%g", o->quant[q].bits,
+               o->quant[q].frac_bits, o->quant[q].clip);
+    else
+      snprintf(f, sizeof(f), "%d.%d", o->quant[q].bits, o->quant[q].frac_bits);
+    if (q == 0)
+      quant[0] = '\0';
+    else
+      strcat(quant, ",");
+    strcat(quant, f);
   }
+  snprintf(buf, size, "N=%d K=%d seed=%llu libm=%d quant=%s is=%d data=%s",
+           N, K, seed, o->check_libm, quant, o->is, data_path);
+}
 
-  char *folder_list[256];
-  int folder_count = 0;
-  struct dirent *entry;
+static int counts_write(const char *path, const char *run, const char *code,
+                        const saved_point_t *sp, int n_points, int n_quant,
+                        const ldpc_rng_t *rng, int n_threads) {
+  char tmp[300];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  FILE *fp = fopen(tmp, "w");
+  if (!fp) {
+    fprintf(stderr, "Cannot write %s\n", tmp);
+    return -1;
+  }
 
-  printf("Searching LDPC matrix folders under '%s'...\n\n", root);
+  fprintf(fp, "# ldpc_ber counts\n# run %s\n# code %s\n", run, code);
+  fprintf(fp, "point,EbN0_dB,state,elapsed,frames,err_info,err_frames,"
+              "iterations,err_libm,frames_differ");
+  for (int q = 0; q < n_quant; q++)
+    fprintf(fp, ",err_q%d", q);
+  fprintf(fp, ",is_w,is_fe,is_fe2,is_be,is_be2,rng\n");
 
-  while ((entry = readdir(dp)) != NULL) {
-    if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+  for (int p = 0; p < n_points; p++) {
+    const ldpc_sim_counts_t *c = &sp[p].c;
+    if (sp[p].state < 0)
       continue;
+    fprintf(fp, "%d,%.1f,%d,%.3f,%lld,%lld,%lld,%lld,%lld,%lld", p,
+            EbN0_min + p * EbN0_step, sp[p].state, sp[p].elapsed, c->frames,
+            c->err_info, c->err_frames, c->iterations, c->err_libm,
+            c->frames_differ);
+    for (int q = 0; q < n_quant; q++)
+      fprintf(fp, ",%lld", c->err_q[q]);
+    fprintf(fp, ",%.17g,%.17g,%.17g,%.17g,%.17g,", c->is_w, c->is_fe,
+            c->is_fe2, c->is_be, c->is_be2);
+    if (sp[p].state == 0) {
+      for (int t = 0; t < n_threads; t++)
+        for (int k = 0; k < 4; k++)
+          fprintf(fp, "%s%016llx", (t | k) ? " " : "",
+                  (unsigned long long)rng[t].s[k]);
+    } else {
+      fprintf(fp, "-");
+    }
+    fprintf(fp, "\n");
+  }
 
-    folder_list[folder_count] = strdup(entry->d_name);
-    folder_count++;
+  if (fclose(fp) != 0 || rename(tmp, path) != 0) {
+    fprintf(stderr, "Cannot write %s\n", path);
+    return -1;
   }
-  closedir(dp);
+  return 0;
+}
 
-  printf("Available LDPC matrix folders:\n\n");
-  for (int i = 0; i < folder_count; i++)
-    printf(" [%d] %s/%s\n", i, root, folder_list[i]);
+/* Read a counter file into sp[n_points] (state -1 for points it does not
+ * hold) and, for a running point, its streams into rng[n_threads]
+ * (n_threads = 0: not read). With n_points = 0 only the meta lines are
+ * read. Returns 0, -1 if the file cannot be opened, -2 if it is
+ * malformed. */
+static int counts_read(const char *path, char *run, char *code,
+                       saved_point_t *sp, int n_points, int n_quant,
+                       ldpc_rng_t *rng, int n_threads) {
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+    return -1;
 
-  printf("\nSelect folder index: ");
-  int idx = 0;
-  scanf("%d", &idx);
+  static char line[8192];
+  int ok = fgets(line, sizeof(line), fp) &&
+           !strncmp(line, "# ldpc_ber counts", 17) &&
+           fgets(line, sizeof(line), fp) && !strncmp(line, "# run ", 6);
+  if (ok) {
+    line[strcspn(line, "\r\n")] = '\0';
+    snprintf(run, META_LEN, "%.*s", META_LEN - 1, line + 6);
+    ok = fgets(line, sizeof(line), fp) && !strncmp(line, "# code ", 7);
+  }
+  if (ok) {
+    line[strcspn(line, "\r\n")] = '\0';
+    snprintf(code, META_LEN, "%.*s", META_LEN - 1, line + 7);
+    ok = fgets(line, sizeof(line), fp) != NULL; /* column names */
+  }
+  if (n_points == 0) {
+    fclose(fp);
+    return ok ? 0 : -2;
+  }
 
-  snprintf(selected_path, bufsize, "%s/%s", root, folder_list[idx]);
+  for (int p = 0; p < n_points; p++) {
+    memset(&sp[p], 0, sizeof(sp[p]));
+    sp[p].state = -1;
+  }
+  while (ok && fgets(line, sizeof(line), fp)) {
+    int p, n;
+    char *s = line;
+    double EbN0_dB;
+    if (sscanf(s, "%d,%lf,%n", &p, &EbN0_dB, &n) != 2 || p < 0 ||
+        p >= n_points) {
+      ok = 0;
+      break;
+    }
+    saved_point_t *d = &sp[p];
+    ldpc_sim_counts_t *c = &d->c;
+    s += n;
+    ok = sscanf(s, "%d,%lf,%lld,%lld,%lld,%lld,%lld,%lld%n", &d->state,
+                &d->elapsed, &c->frames, &c->err_info, &c->err_frames,
+                &c->iterations, &c->err_libm, &c->frames_differ, &n) == 8;
+    s += ok ? n : 0;
+    for (int q = 0; ok && q < n_quant; q++) {
+      ok = sscanf(s, ",%lld%n", &c->err_q[q], &n) == 1;
+      s += ok ? n : 0;
+    }
+    ok = ok && sscanf(s, ",%lg,%lg,%lg,%lg,%lg,%n", &c->is_w, &c->is_fe,
+                      &c->is_fe2, &c->is_be, &c->is_be2, &n) == 5;
+    s += ok ? n : 0;
+    if (ok && d->state == 0) {
+      for (int t = 0; ok && t < n_threads; t++)
+        for (int k = 0; ok && k < 4; k++) {
+          unsigned long long v;
+          ok = sscanf(s, "%llx%n", &v, &n) == 1;
+          rng[t].s[k] = v;
+          s += ok ? n : 0;
+        }
+    }
+  }
 
-  for (int i = 0; i < folder_count; i++)
-    free(folder_list[i]);
+  fclose(fp);
+  return ok ? 0 : -2;
+}
 
-  printf("\nUsing LDPC folder: %s\n\n", selected_path);
+/* Value of key in a meta line ("key=value" words); 0 if found */
+static int meta_get(const char *meta, const char *key, char *val,
+                    size_t size) {
+  size_t len = strlen(key);
+  for (const char *m = meta; (m = strstr(m, key)) != NULL; m += len) {
+    if ((m == meta || m[-1] == ' ') && m[len] == '=') {
+      size_t n = strcspn(m + len + 1, " ");
+      snprintf(val, size, "%.*s", (int)n, m + len + 1);
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/* ============================================================
+ * --merge: add up the counter files of the shards of one sweep
+ * ============================================================ */
+static int merge_counts(const ber_options_t *opt) {
+  int n_points = (int)((EbN0_max - EbN0_min) / EbN0_step + 1.5);
+  saved_point_t *sum = (saved_point_t *)calloc(n_points, sizeof(*sum));
+  saved_point_t *sp = (saved_point_t *)calloc(n_points, sizeof(*sp));
+  int *seen = NULL, *n_in = (int *)calloc(n_points, sizeof(int));
+  if (!sum || !sp || !n_in) {
+    fprintf(stderr, "malloc failed in merge_counts\n");
+    exit(1);
+  }
+  for (int p = 0; p < n_points; p++)
+    sum[p].state = -1;
+
+  char code0[META_LEN] = "", run[META_LEN], code[META_LEN], val[256];
+  out_columns_t o;
+  memset(&o, 0, sizeof(o));
+  int n_shards = 0, status = 1;
+
+  for (int f = 0; f < opt->n_files; f++) {
+    const char *path = opt->files[f];
+
+    /* the number of err_q columns comes from the code line: read it
+     * first with no quantized columns, then again */
+    int r = counts_read(path, run, code, sp, 0, 0, NULL, 0);
+    if (r == 0 && f == 0) {
+      snprintf(code0, sizeof(code0), "%s", code);
+      meta_get(code, "K", val, sizeof(val));
+      o.K = atoi(val);
+      meta_get(code, "libm", val, sizeof(val));
+      o.check_libm = atoi(val);
+      meta_get(code, "is", val, sizeof(val));
+      o.is = atoi(val);
+      meta_get(code, "quant", val, sizeof(val));
+      for (char *t = strtok(val, ","); t && strcmp(t, "none");
+           t = strtok(NULL, ","))
+        if (o.n_quant < MAX_QUANT &&
+            !ldpc_qformat_parse(t, &o.quant[o.n_quant]))
+          o.n_quant++;
+      meta_get(run, "shards", val, sizeof(val));
+      n_shards = atoi(val);
+      seen = (int *)calloc(n_shards > 0 ? n_shards : 1, sizeof(int));
+      if (!seen) {
+        fprintf(stderr, "malloc failed in merge_counts\n");
+        exit(1);
+      }
+    }
+    if (r == 0)
+      r = counts_read(path, run, code, sp, n_points, o.n_quant, NULL, 0);
+    if (r != 0) {
+      fprintf(stderr, "%s: %s\n", path,
+              r == -1 ? "cannot open" : "not an ldpc_ber counter file");
+      goto out;
+    }
+    if (strcmp(code, code0)) {
+      fprintf(stderr, "%s: other code or settings than %s\n", path,
+              opt->files[0]);
+      goto out;
+    }
+    int shard = meta_get(run, "shard", val, sizeof(val)) ? -1 : atoi(val);
+    meta_get(run, "shards", val, sizeof(val));
+    if (atoi(val) != n_shards || shard < 0 || shard >= n_shards ||
+        seen[shard]++) {
+      fprintf(stderr, "%s: shard %d/%s repeated or not of %d shards\n",
+              path, shard, val, n_shards);
+      goto out;
+    }
+
+    for (int p = 0; p < n_points; p++) {
+      if (sp[p].state < 0)
+        continue;
+      if (sp[p].state == 0)
+        printf("Note: %s is still running point %.1f dB (its %lld frames "
+               "are included)\n",
+               path, EbN0_min + p * EbN0_step, sp[p].c.frames);
+      if (sum[p].state < 0)
+        sum[p].state = sp[p].state;
+      n_in[p]++;
+      counts_add(&sum[p].c, &sp[p].c, o.n_quant);
+    }
+  }
+
+  for (int s = 0; s < n_shards; s++)
+    if (!seen[s])
+      printf("Note: shard %d of %d is missing\n", s, n_shards);
+  /* a shard stops its sweep after its first error-free point */
+  for (int p = 0; p < n_points; p++)
+    if (n_in[p] > 0 && n_in[p] < opt->n_files)
+      printf("Note: %.1f dB is in %d of %d files\n", EbN0_min + p * EbN0_step,
+             n_in[p], opt->n_files);
+
+  meta_get(code0, "data", val, sizeof(val));
+  FILE *fp = fopen(val, "w");
+  if (!fp) {
+    fprintf(stderr, "Cannot open %s\n", val);
+    goto out;
+  }
+  printf("Merging %d counter files into %s\n\n", opt->n_files, val);
+  write_header(fp, &o);
+  for (int p = 0; p < n_points; p++)
+    if (sum[p].state >= 0 && sum[p].c.frames > 0)
+      write_point(fp, EbN0_min + p * EbN0_step, &sum[p].c, NULL, &o);
+  fclose(fp);
+  printf("\nResults saved to %s\n", val);
+  status = 0;
+
+out:
+  free(sum);
+  free(sp);
+  free(seen);
+  free(n_in);
+  return status;
 }
 
 /* ============================================================
  * MAIN
  * ============================================================ */
-int main(void) {
+int main(int argc, char **argv) {
+  ber_options_t opt;
+  if (parse_args(argc, argv, &opt)) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (opt.merge)
+    return merge_counts(&opt);
+
   printf("==============================================\n");
   printf("          LDPC BER Simulation (AWGN)          \n");
   printf("==============================================\n\n");
 
-  /* 1. Select folder */
-  char folder[256];
-  select_ldpc_folder(folder, sizeof(folder));
-
-  /* 2. Parse parameters from folder name */
-  int N = 0, wc = 0, wr = 0;
-  if (sscanf(folder, "matrices/N%d_wc%d_wr%d", &N, &wc, &wr) != 3) {
-    fprintf(stderr,
-            "Folder name format error. Expected matrices/N{N}_wc{wc}_wr{wr}\n");
-    return 1;
+  /* 1. Load the code (ldpc_registry.h): the folder argument, or one of
+   *    the codes under matrices/ picked interactively */
+  ldpc_registry_t *reg = ldpc_registry_create();
+  int code_id;
+  if (opt.folder) {
+    char folder[256];
+    snprintf(folder, sizeof(folder), "%s", opt.folder);
+    size_t len = strlen(folder);
+    while (len > 1 && (folder[len - 1] == '/' || folder[len - 1] == '\\'))
+      folder[--len] = '\0';
+    printf("Using LDPC folder: %s\n\n", folder);
+    code_id = ldpc_registry_add(reg, folder, NULL);
+    if (code_id < 0) {
+      fprintf(stderr, "No H in %s (H.qc, H.bin, H.alist, or H.csv in a "
+                      "folder named N{N}_wc{wc}_wr{wr})\n",
+              folder);
+      return 1;
+    }
+  } else {
+    code_id = select_ldpc_code(reg);
   }
+  const ldpc_code_t *code = ldpc_registry_code(reg, code_id);
 
-  int M = (N * wc) / wr;
-  int K = N - M;
+  /* 2. Parameters: wc / wr are the largest column / row degree of H */
+  const ldpc_qc_t *qc = code->qc;
+  const int N = code->N, K = code->K, M = N - K;
+  const int wc = code->wc, wr = code->wr;
 
   printf("LDPC parameters:\n");
   printf("  N  = %d\n", N);
   printf("  K  = %d\n", K);
   printf("  M  = %d\n", M);
-  printf("  wc = %d, wr = %d\n\n", wc, wr);
+  printf("  wc = %d, wr = %d\n", wc, wr);
+  if (qc)
+    printf("  QC base matrix %d x %d, Z = %d\n", qc->mb, qc->nb, qc->Z);
 
-  /* 3. Load H,G matrices */
-  int **H = alloc_matrix_int(M, N);
-  int **G = alloc_matrix_int(K, N);
+  double cn_param = (opt.kernel == LDPC_CN_NMS)   ? opt.alpha
+                    : (opt.kernel == LDPC_CN_OMS) ? opt.beta
+                                                  : 0.0;
+  printf("  kernel = %s", ldpc_cn_kernel_name(opt.kernel));
+  if (opt.kernel == LDPC_CN_NMS || opt.kernel == LDPC_CN_OMS)
+    printf(" (%s = %.3f)", opt.kernel == LDPC_CN_NMS ? "alpha" : "beta",
+           cn_param);
+  printf("\n  schedule = %s\n",
+         opt.schedule == LDPC_SCHED_LAYERED ? "layered" : "flooding");
+  if (opt.kernel == LDPC_CN_SPA)
+    printf("  phi = %s\n", ldpc_phi_mode_name(opt.phi));
+  printf("  precision = %s\n", ldpc_precision_name(opt.precision));
+  if (opt.bf_iter > 0) {
+    printf("  bit flipping = %s (%s = %.3f, %d iterations, ",
+           ldpc_bf_mode_name(opt.bf_mode),
+           opt.bf_mode == LDPC_BF_GDBF ? "theta" : "alpha", opt.bf_param,
+           opt.bf_iter);
+    if (opt.bf_gate > 0)
+      printf("gate M/%d = %d checks", opt.bf_gate, M / opt.bf_gate);
+    else
+      printf("no gate");
+    printf("), then the kernel above\n");
+  }
+  for (int q = 0; q < opt.n_quant; q++)
+    printf("  fixed-point = %d.%d (clip %.2f)\n", opt.quant[q].bits,
+           opt.quant[q].frac_bits, opt.quant[q].clip);
+  printf("\n");
 
-  char path_H[512], path_G[512];
-  snprintf(path_H, sizeof(path_H), "%s/H.csv", folder);
-  snprintf(path_G, sizeof(path_G), "%s/G.csv", folder);
+  /* 3. Encoder: G (packed P of H.bin or G.csv) unless -e h or -z, else
+   *    the sparse H encoder. H may have been column permuted for the H
+   *    encoder; the decoders then run on the permuted graph. */
+  const ldpc_graph_t *graph = code->graph;
+  const ldpc_encoder_t *enc = NULL;
+  const ldpc_hencoder_t *henc = NULL;
+  int **G = NULL;
 
-  if (load_matrix(H, M, N, path_H) || load_matrix(G, K, N, path_G)) {
-    fprintf(stderr, "Matrix load failed.\n");
+  printf("H loaded from %s\n", code->h_file);
+  if (opt.all_zero) {
+    printf("All-zero codeword: G is not used\n");
+  } else if (opt.encoder != ENC_H && code->G) {
+    enc = code->enc;
+    if (!enc) {
+      printf("G is not of the form [P | I]; using dense encoder\n");
+      G = code->G;
+    }
+  } else if (opt.encoder != ENC_H && code->enc) {
+    enc = code->enc;
+    printf("G (packed P) loaded from %s\n", code->h_file);
+  } else if (opt.encoder == ENC_G) {
+    fprintf(stderr, "No G in %s (packed P of H.bin or G.csv)\n", code->path);
     return 1;
+  } else if (opt.encoder != ENC_H) {
+    printf("No G.csv; encoding from H\n");
+  }
+  if (!enc && !G && (!opt.all_zero || opt.check_random)) {
+    henc = code->henc;
+    if (!henc) {
+      fprintf(stderr, "No parity column set found for H\n");
+      return 1;
+    }
+    printf("H encoder: gap %d", ldpc_hencoder_gap(henc));
+    if (code->henc_graph != code->graph) {
+      /* columns 0..M-1 are not a parity set: swapped in memory */
+      graph = code->henc_graph;
+      printf(", on H with swapped columns (%s is unchanged)", code->h_file);
+      if (qc) {
+        /* the permuted graph is no longer the expansion of qc */
+        printf("; QC structure lost");
+        qc = NULL;
+      }
+    }
+    printf("\n");
   }
 
   /* 4. Create results directory */
@@ -184,89 +1259,434 @@ int main(void) {
 #endif
 
   /* =============================================
-   * NEW: include N, wc, wr, max_iter_spa in file name
+   * File name includes N, wc, wr, max_iter_spa and, for
+   * non-default decoder settings, a tag:
+   *   ldpc_ber_N{N}_wc{wc}_wr{wr}_iter{iter}[_{kernel}|_{phi}][_layered]
+   *   [_f32][_{wbf|gdbf}][_is_{shift|ts}]_data.csv
    * ============================================= */
+  char tag[64] = "";
+  if (opt.kernel != LDPC_CN_SPA)
+    snprintf(tag, sizeof(tag), "_%s", ldpc_cn_kernel_name(opt.kernel));
+  else if (opt.phi != LDPC_PHI_EXACT)
+    snprintf(tag, sizeof(tag), "_%s", ldpc_phi_mode_name(opt.phi));
+  if (opt.schedule == LDPC_SCHED_LAYERED)
+    strcat(tag, "_layered");
+  if (qc)
+    strcat(tag, "_qc");
+  if (opt.precision == LDPC_PREC_F32)
+    strcat(tag, "_f32");
+  if (opt.bf_iter > 0) {
+    strcat(tag, "_");
+    strcat(tag, ldpc_bf_mode_name(opt.bf_mode));
+  }
+  if (opt.is) {
+    strcat(tag, "_is_");
+    strcat(tag, ldpc_is_mode_name(opt.is_mode));
+  }
+
   char csv_path[256];
   snprintf(csv_path, sizeof(csv_path),
-           "results/ldpc_ber_N%d_wc%d_wr%d_iter%d_data.csv", N, wc, wr,
-           max_iter_spa);
+           "results/ldpc_ber_N%d_wc%d_wr%d_iter%d%s_data.csv", N, wc, wr,
+           max_iter_spa, tag);
 
-  FILE *fp = fopen(csv_path, "w");
-  if (!fp) {
-    fprintf(stderr, "Cannot open %s\n", csv_path);
-    return 1;
+  int check_libm = (opt.phi != LDPC_PHI_EXACT);
+
+  out_columns_t cols;
+  memset(&cols, 0, sizeof(cols));
+  cols.K = K;
+  cols.check_libm = check_libm;
+  cols.n_quant = opt.n_quant;
+  memcpy(cols.quant, opt.quant, sizeof(cols.quant));
+  cols.check_random = opt.check_random;
+  cols.is = opt.is;
+
+  /* counter file: ..._data.csv -> ..._counts.csv, or
+   * ..._shard{I}of{S}_counts.csv for a shard */
+  char counts_path[256] = "";
+  if (opt.n_shards > 1 || opt.checkpoint > 0.0 || opt.resume) {
+    size_t len = strlen(csv_path) - strlen("_data.csv");
+    if (opt.n_shards > 1)
+      snprintf(counts_path, sizeof(counts_path), "%.*s_shard%dof%d_counts.csv",
+               (int)len, csv_path, opt.shard, opt.n_shards);
+    else
+      snprintf(counts_path, sizeof(counts_path), "%.*s_counts.csv", (int)len,
+               csv_path);
   }
 
-  fprintf(fp, "EbN0_dB,BER_info,BER_bpsk\n");
+  /* a shard only writes its counters; --merge writes the data CSV */
+  FILE *fp = NULL;
+  if (opt.n_shards == 1) {
+    fp = fopen(csv_path, "w");
+    if (!fp) {
+      fprintf(stderr, "Cannot open %s\n", csv_path);
+      return 1;
+    }
+  }
 
-  printf("Saving results to: %s\n\n", csv_path);
+  /* --stats: EbN0_dB,iter,converged,failed,unsat_mean per point and
+   * iteration (failed: frames at max_iter without convergence) */
+  char hist_path[256];
+  FILE *fp_hist = NULL;
+  if (opt.stats) {
+    snprintf(hist_path, sizeof(hist_path),
+             "results/ldpc_ber_N%d_wc%d_wr%d_iter%d%s_iter_hist.csv", N, wc,
+             wr, max_iter_spa, tag);
+    fp_hist = fopen(hist_path, "w");
+    if (!fp_hist) {
+      fprintf(stderr, "Cannot open %s\n", hist_path);
+      return 1;
+    }
+    fprintf(fp_hist, "EbN0_dB,iter,converged,failed,unsat_mean\n");
+  }
 
-  srand((unsigned int)time(NULL));
+  if (fp)
+    printf("Saving results to: %s\n", csv_path);
+  if (counts_path[0])
+    printf("Saving counters to: %s\n", counts_path);
+  printf("\n");
 
-  /* buffers */
-  int *inf = malloc(K * sizeof(int));
-  int *code = malloc(N * sizeof(int));
-  double *tx = malloc(N * sizeof(double));
-  double *rx = malloc(N * sizeof(double));
-  double *LLR = malloc(N * sizeof(double));
-  int *ecc_hat = malloc(N * sizeof(int));
-  int *inf_hat = malloc(K * sizeof(int));
+  /* saved points of --resume; the seed is that of the saved run unless
+   * --seed is given (then it has to match) */
+  int n_points = (int)((EbN0_max - EbN0_min) / EbN0_step + 1.5);
+  saved_point_t *saved = (saved_point_t *)calloc(n_points, sizeof(*saved));
+  ldpc_rng_t *rng_saved =
+      (ldpc_rng_t *)malloc(opt.n_threads * sizeof(ldpc_rng_t));
+  if (!saved || !rng_saved) {
+    fprintf(stderr, "malloc failed in main\n");
+    exit(1);
+  }
+  for (int p = 0; p < n_points; p++)
+    saved[p].state = -1;
 
-  printf("EbN0_dB, BER_info, BER_bpsk\n");
+  char run_meta[META_LEN], code_line[META_LEN];
+  snprintf(run_meta, sizeof(run_meta), "shard=%d shards=%d threads=%d",
+           opt.shard, opt.n_shards, opt.n_threads);
+  unsigned long long seed =
+      opt.has_seed ? opt.seed : (unsigned long long)time(NULL);
+  if (opt.resume) {
+    char run_file[META_LEN], code_file[META_LEN], val[64];
+    int r = counts_read(counts_path, run_file, code_file, saved, n_points,
+                        opt.n_quant, rng_saved, opt.n_threads);
+    if (r == -1) {
+      printf("No counters in %s; starting from the first point\n\n",
+             counts_path);
+    } else {
+      if (r == 0 && !opt.has_seed && !meta_get(code_file, "seed", val,
+                                               sizeof(val)))
+        seed = strtoull(val, NULL, 10);
+      code_meta(code_line, sizeof(code_line), N, K, seed, &cols, csv_path);
+      if (r != 0 || strcmp(run_file, run_meta) ||
+          strcmp(code_file, code_line)) {
+        fprintf(stderr, "%s: %s\n", counts_path,
+                r != 0 ? "not an ldpc_ber counter file"
+                       : "saved by another command line (code, seed, "
+                         "columns, shard or threads differ)");
+        return 1;
+      }
+    }
+  }
+  code_meta(code_line, sizeof(code_line), N, K, seed, &cols, csv_path);
+  printf("Threads: %d, seed: %llu", opt.n_threads, seed);
+  if (opt.n_shards > 1)
+    printf(", shard %d of %d", opt.shard, opt.n_shards);
+  printf("\n\n");
 
-  /* 6. SNR loop */
-  for (double EbN0_dB = EbN0_min; EbN0_dB <= EbN0_max; EbN0_dB += EbN0_step) {
+  /* simulation engine: per-thread decoders on the shared graph */
+  ldpc_sim_config_t cfg;
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.graph = graph;
+  cfg.K = K;
+  cfg.qc = (opt.no_qc || opt.stats || opt.precision != LDPC_PREC_F64 ||
+            opt.bf_iter > 0)
+               ? NULL
+               : qc;
+  if (cfg.qc && opt.schedule == LDPC_SCHED_LAYERED &&
+      opt.kernel != LDPC_CN_SPA)
+    printf("QC decoder: block-row layered, Z = %d\n", qc->Z);
+  else if (qc)
+    printf("QC code decoded on the expanded graph%s\n",
+           opt.no_qc   ? ""
+           : opt.stats ? " (--stats)"
+           : opt.precision != LDPC_PREC_F64
+               ? " (the QC decoder is double only)"
+           : opt.bf_iter > 0 ? " (--bf)"
+               : " (the QC decoder needs a min-sum kernel and -s layered)");
+  cfg.henc = henc;
+  cfg.enc = enc;
+  cfg.G = G;
+  cfg.kernel = opt.kernel;
+  cfg.cn_param = cn_param;
+  cfg.schedule = opt.schedule;
+  cfg.phi = opt.phi;
+  cfg.precision = opt.precision;
+  cfg.bf_iter = opt.bf_iter;
+  cfg.bf_mode = opt.bf_mode;
+  cfg.bf_param = opt.bf_param;
+  cfg.bf_gate = opt.bf_gate;
+  cfg.check_libm = check_libm; /* reference decoder with the libm phi */
+  cfg.n_quant = opt.n_quant;
+  memcpy(cfg.quant, opt.quant, sizeof(cfg.quant));
+  cfg.max_iter = max_iter_spa;
+  cfg.all_zero = opt.all_zero;
+  cfg.stats = opt.stats;
+  cfg.n_threads = opt.n_threads;
+  cfg.seed = seed;
+  cfg.shard = opt.shard;
 
-    double EbN0 = pow(10.0, EbN0_dB / 10.0);
-    double R = (double)K / N;
-    double sigma2 = 1.0 / (2.0 * R * EbN0);
+  /* importance sampling: the density is shared by all workers; ts sets
+   * are calibrated with a decoder configured like the main one */
+  ldpc_is_t *is = NULL;
+  ldpc_decoder_t *is_dec = NULL;
+  if (opt.is) {
+    is = ldpc_is_create(graph, opt.is_mode,
+                        opt.is_mode == LDPC_IS_SHIFT && opt.is_shift > 0.0
+                            ? opt.is_shift
+                            : ldpc_is_shift_default(opt.is_mode),
+                        opt.is_p0);
+    if (!is) {
+      fprintf(stderr, "No cycle of at most %d edges for --is ts\n",
+              LDPC_IS_MAX_CYCLE);
+      return 1;
+    }
+    if (opt.is_mode == LDPC_IS_TS) {
+      is_dec = ldpc_decoder_create_from_graph(graph, K);
+      ldpc_decoder_set_kernel(is_dec, opt.kernel, cn_param);
+      ldpc_decoder_set_schedule(is_dec, opt.schedule);
+      ldpc_decoder_set_precision(is_dec, opt.precision);
+      ldpc_decoder_set_hybrid(is_dec, opt.bf_iter, opt.bf_mode,
+                              opt.bf_param, opt.bf_gate);
+      printf("Importance sampling: %d cycle sets (mean %.2f bits)\n",
+             ldpc_is_n_sets(is), ldpc_is_mean_set_size(is));
+    } else if (opt.is_shift > 0.0) {
+      printf("Importance sampling: mean shift %.3f on all bits\n",
+             opt.is_shift);
+    } else {
+      printf("Importance sampling: mean shift %g sigma/sqrt(N) on all bits, "
+             "per point\n",
+             LDPC_IS_SHIFT_KAPPA);
+    }
+  }
+  cfg.is = is;
+
+  ldpc_sim_t *sim = ldpc_sim_create(&cfg);
+  if (!sim) {
+    fprintf(stderr, "Cannot create the simulation engine\n");
+    return 1;
+  }
+
+  /* random-data reference for -z: main decoder only, independent noise */
+  ldpc_sim_t *sim_rnd = NULL;
+  if (opt.check_random) {
+    ldpc_sim_config_t cfg_rnd = cfg;
+    cfg_rnd.all_zero = 0;
+    cfg_rnd.check_libm = 0;
+    cfg_rnd.n_quant = 0;
+    cfg_rnd.stats = 0;
+    cfg_rnd.seed = seed + 1;
+    sim_rnd = ldpc_sim_create(&cfg_rnd);
+    if (!sim_rnd) {
+      fprintf(stderr, "Cannot create the random-data simulation engine\n");
+      return 1;
+    }
+  }
+
+  /* --is: plain Monte Carlo at the lowest point, independent noise (not
+   * for a shard, whose point is only a share of the sweep) */
+  ldpc_sim_t *sim_mc = NULL;
+  int is_checked = 0, is_agree = 0, is_unreliable = 0;
+  double is_check_dB = 0.0;
+  if (opt.is && opt.n_shards == 1) {
+    ldpc_sim_config_t cfg_mc = cfg;
+    cfg_mc.is = NULL;
+    cfg_mc.check_libm = 0;
+    cfg_mc.n_quant = 0;
+    cfg_mc.stats = 0;
+    cfg_mc.seed = seed + 2;
+    sim_mc = ldpc_sim_create(&cfg_mc);
+    if (!sim_mc) {
+      fprintf(stderr, "Cannot create the Monte Carlo check engine\n");
+      return 1;
+    }
+  }
+
+  /* ts with min-sum / NMS: LLR scaling does not change decoding, one
+   * calibration holds for every point */
+  int is_scale_free =
+      (opt.kernel == LDPC_CN_MINSUM || opt.kernel == LDPC_CN_NMS);
+  if (is_dec && is_scale_free) {
+    int kept = ldpc_is_calibrate(is, is_dec, N, K, max_iter_spa, 1.0);
+    printf("Calibrated: the decoder fails on %d sets (mean %.2f bits)\n",
+           kept, ldpc_is_mean_set_size(is));
+  } else if (is_dec) {
+    printf("Sets are calibrated at every point (%s is not scale "
+           "invariant)\n", ldpc_cn_kernel_name(opt.kernel));
+  }
 
-    long long err_info = 0;
-    long long total_info_bits = (long long)N_trials * K;
+  /* a shard runs its share of every target and budget */
+  if (opt.n_shards > 1) {
+    long long S = opt.n_shards, I = opt.shard;
+    opt.max_frames = opt.max_frames * (I + 1) / S - opt.max_frames * I / S;
+    opt.target_fe = (opt.target_fe + S - 1) / S;
+    opt.target_be = (opt.target_be + S - 1) / S;
+    opt.ci *= sqrt((double)S);
+  }
 
-    for (int f = 0; f < N_trials; f++) {
+  printf("Stop per point: ");
+  if (opt.target_fe > 0)
+    printf("%lld %sframe errors, ", opt.target_fe, opt.is ? "effective " : "");
+  if (opt.target_be > 0 && !opt.is)
+    printf("%lld bit errors, ", opt.target_be);
+  if (opt.ci > 0.0)
+    printf("FER CI +-%.0f%%, ", 100.0 * opt.ci);
+  printf("budget %lld frames", opt.max_frames);
+  if (opt.max_time > 0.0)
+    printf(" / %g s", opt.max_time);
+  printf("\n\n");
 
-      for (int i = 0; i < K; i++)
-        inf[i] = rand() & 1;
+  write_header(fp, &cols);
 
-      ldpc_encode(code, inf, G, N, K);
+  /* deviation of the approximate phi from the libm reference */
+  double max_dev = 0.0;
+  /* largest two-proportion z-score of FER, all-zero vs random data */
+  double max_z = 0.0;
+  long long total_differ = 0, total_frames = 0;
 
-      for (int i = 0; i < N; i++)
-        tx[i] = (code[i] == 1) ? +1.0 : -1.0;
+  /* 6. SNR loop */
+  int point = 0;
+  for (double EbN0_dB = EbN0_min; EbN0_dB <= EbN0_max;
+       EbN0_dB += EbN0_step, point++) {
 
-      for (int i = 0; i < N; i++)
-        rx[i] = tx[i] + sqrt(sigma2) * randn();
+    double EbN0 = pow(10.0, EbN0_dB / 10.0);
+    double R = (double)K / N;
+    double sigma2 = 1.0 / (2.0 * R * EbN0);
 
-      for (int i = 0; i < N; i++)
-        LLR[i] = 2.0 * rx[i] / sigma2;
+    if (EbN0_dB < opt.ebn0_lo - 1e-9 || EbN0_dB > opt.ebn0_hi + 1e-9)
+      continue;
 
-      ldpc_decode_spa(LLR, ecc_hat, inf_hat, H, M, N, K, max_iter_spa);
+    /* rounds of frames_per_round frames per thread until a rule fires;
+     * a point finished by the saved run is taken as it is */
+    saved_point_t *sp = &saved[point];
+    ldpc_sim_counts_t c;
+    memset(&c, 0, sizeof(c));
+    int done = sp->state > 0 ? sp->state : 0;
+    if (done) {
+      c = sp->c;
+    } else {
+      /* ts with SPA / OMS: the decoder is not scale invariant, so the
+       * error impulses depend on the point */
+      if (is_dec && !is_scale_free)
+        ldpc_is_calibrate(is, is_dec, N, K, max_iter_spa, sigma2);
+      /* shift: the translation shrinks like sigma / sqrt(N) */
+      if (is && opt.is_mode == LDPC_IS_SHIFT && opt.is_shift <= 0.0)
+        ldpc_is_set_shift(is, ldpc_is_shift_auto(N, sigma2));
 
-      for (int i = 0; i < K; i++)
-        if (inf[i] != inf_hat[i])
-          err_info++;
+      ldpc_sim_set_point(sim, point, sigma2);
+      double t0 = wall_seconds(), t_save = t0;
+      if (sp->state == 0) {
+        /* continue the interrupted point */
+        c = sp->c;
+        ldpc_sim_set_rng(sim, rng_saved);
+        t0 -= sp->elapsed;
+      }
+      do {
+        ldpc_sim_run(sim, round_frames(&opt, &c), &c);
+        double now = wall_seconds();
+        done = point_done(&opt, &c, now - t0);
+        if (!done && opt.checkpoint > 0.0 && now - t_save >= opt.checkpoint) {
+          sp->state = 0;
+          sp->elapsed = now - t0;
+          sp->c = c;
+          ldpc_sim_get_rng(sim, rng_saved);
+          counts_write(counts_path, run_meta, code_line, saved, n_points,
+                       opt.n_quant, rng_saved, opt.n_threads);
+          t_save = now;
+        }
+      } while (!done);
+      if (counts_path[0]) {
+        sp->state = done;
+        sp->elapsed = wall_seconds() - t0;
+        sp->c = c;
+        counts_write(counts_path, run_meta, code_line, saved, n_points,
+                     opt.n_quant, rng_saved, opt.n_threads);
+      }
     }
 
-    double BER_info = (double)err_info / total_info_bits;
-    double BER_bpsk = bpsk_ber(EbN0);
+    ldpc_sim_counts_t r;
+    if (sim_rnd) {
+      /* same number of frames with random data */
+      memset(&r, 0, sizeof(r));
+      ldpc_sim_set_point(sim_rnd, point, sigma2);
+      ldpc_sim_run(sim_rnd, c.frames, &r);
+    }
+    double z = write_point(fp, EbN0_dB, &c, sim_rnd ? &r : NULL, &cols);
+    if (opt.is && is_eff_frames(&c) < LDPC_IS_MIN_EFF_FRAMES)
+      is_unreliable++;
+    if (sim_mc) {
+      is_agree = is_check_mc(&opt, sim_mc, point, sigma2, EbN0_dB, &c);
+      is_checked = 1;
+      is_check_dB = EbN0_dB;
+      ldpc_sim_free(sim_mc);
+      sim_mc = NULL;
+    }
+    if (fabs(z) > max_z)
+      max_z = fabs(z);
+    if (check_libm) {
+      double dev =
+          fabs((double)(c.err_info - c.err_libm) / ((double)c.frames * K));
+      if (dev > max_dev)
+        max_dev = dev;
+      total_differ += c.frames_differ;
+      total_frames += c.frames;
+    }
+    if (fp_hist)
+      report_stats(fp_hist, EbN0_dB, &c.stats, c.frames, max_iter_spa,
+                   opt.bf_iter > 0);
 
-    printf("%.1f, %.10e, %.10e\n", EbN0_dB, BER_info, BER_bpsk);
-    fprintf(fp, "%.1f,%.10e,%.10e\n", EbN0_dB, BER_info, BER_bpsk);
+    /* error-free after the whole budget: higher Eb/N0 would be too */
+    if (done == 2 && c.err_frames == 0 && !opt.is) {
+      printf("No frame errors in %lld frames; sweep stopped\n", c.frames);
+      break;
+    }
   }
 
-  fclose(fp);
-
-  free(inf);
-  free(code);
-  free(tx);
-  free(rx);
-  free(LLR);
-  free(ecc_hat);
-  free(inf_hat);
+  if (fp)
+    fclose(fp);
+  if (fp_hist)
+    fclose(fp_hist);
+  free(saved);
+  free(rng_saved);
 
-  free_matrix_int(H, M);
-  free_matrix_int(G, K);
+  ldpc_sim_free(sim);
+  ldpc_sim_free(sim_rnd);
+  ldpc_sim_free(sim_mc);
+  ldpc_is_free(is);
+  ldpc_decoder_free(is_dec);
+  ldpc_registry_free(reg);
 
-  printf("\nResults saved to %s\n", csv_path);
+  if (check_libm)
+    printf("\nphi = %s vs libm: max |BER_info - BER_libm| = %.3e, "
+           "%lld / %lld frames decoded differently\n",
+           ldpc_phi_mode_name(opt.phi), max_dev, total_differ, total_frames);
+  if (opt.check_random)
+    printf("\nall-zero vs random data: max |z| of FER = %.2f "
+           "(|z| < 2 expected for most points)\n",
+           max_z);
+  if (is_checked)
+    printf("\nIS vs plain Monte Carlo at %.1f dB: %s\n", is_check_dB,
+           is_agree > 0    ? "agree"
+           : is_agree == 0 ? "DISAGREE, do not trust the IS estimates of "
+                             "this run"
+                           : "not confirmed (too few effective error frames)");
+  if (is_unreliable)
+    printf("%s%d point%s with fewer than %d effective error frames: no CI, "
+           "not reliable\n",
+           is_checked ? "" : "\n", is_unreliable,
+           is_unreliable > 1 ? "s" : "", LDPC_IS_MIN_EFF_FRAMES);
+  if (fp)
+    printf("\nResults saved to %s\n", csv_path);
+  if (counts_path[0])
+    printf("%sCounters saved to %s\n", fp ? "" : "\n", counts_path);
+  if (opt.stats)
+    printf("Iteration histograms saved to %s\n", hist_path);
   return 0;
 }
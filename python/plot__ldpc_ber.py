@@ -4,7 +4,19 @@ plot_ldpc_ber.py
 BER Curves for LDPC (SPA Decoder) over AWGN (BPSK)
 -----------------------------------------------------------
 Automatically loads:
-    results/ldpc_ber_N{N}_wc{wc}_wr{wr}_iter{iter}_data.csv
+    results/ldpc_ber_N{N}_wc{wc}_wr{wr}_iter{iter}[_{tag}]_data.csv
+
+All decoder variants (tag = kernel or SPA phi mode, and/or "layered") of
+the most recently written code/iteration setting are overlaid in one graph.
+Fixed-point columns (BER_q{bits}.{frac}) of the latest file are drawn
+as dotted curves. Files with a FER column (adaptive-stopping runs, which
+also record avg_iter and frames per point) get their FER drawn as thin
+dash-dotted curves in the variant's color. Importance-sampling runs
+(BER_ci95 column) get their 95 % confidence intervals as error bars;
+their rows without a CI (too few effective error frames) are left out.
+Points without errors are left
+out of the log-scale plot, and the lower y-limit follows the smallest
+rate that was measured.
 
 Output:
     images/ldpc_ber_graph.png
@@ -16,6 +28,7 @@ Notes:
     - Auto-displays N, wc, wr, R, iter inside the graph
 """
 
+import math
 import pandas as pd
 import matplotlib.pyplot as plt
 import os
@@ -31,7 +44,9 @@ def find_latest_ldpc_csv():
     if not os.path.exists(results_dir):
         raise FileNotFoundError("results/ directory not found.")
 
-    pattern = re.compile(r"ldpc_ber_N(\d+)_wc(\d+)_wr(\d+)_iter(\d+)_data\.csv")
+    pattern = re.compile(
+        r"ldpc_ber_N(\d+)_wc(\d+)_wr(\d+)_iter(\d+)(?:_([a-z0-9_]+?))?_data\.csv"
+    )
 
     candidates = []
     for f in os.listdir(results_dir):
@@ -47,13 +62,21 @@ def find_latest_ldpc_csv():
     # 最新更新ファイルを選択
     candidates.sort(key=lambda x: os.path.getmtime(os.path.join(results_dir, x[0])))
     filename, match = candidates[-1]
-    return os.path.join(results_dir, filename), match
+
+    # 同じ (N, wc, wr, iter) のカーネル違いを集める
+    variants = [
+        (os.path.join(results_dir, f), m.group(5) or "spa")
+        for f, m in candidates
+        if m.groups()[:4] == match.groups()[:4]
+    ]
+    variants.sort(key=lambda v: (v[1] != "spa", v[1]))
+    return os.path.join(results_dir, filename), match, variants
 
 
 # =====================================================================
 #  Load CSV (auto-detected)
 # =====================================================================
-csv_path, meta = find_latest_ldpc_csv()
+csv_path, meta, variants = find_latest_ldpc_csv()
 N = int(meta.group(1))
 wc = int(meta.group(2))
 wr = int(meta.group(3))
@@ -67,7 +90,6 @@ print(f"N={N}, wc={wc}, wr={wr}, iter={iter_spa}, R={R:.4f}")
 df = pd.read_csv(csv_path)
 
 EbN0 = df["EbN0_dB"]
-ber_info = df["BER_info"]
 ber_bpsk = df["BER_bpsk"]
 
 # =====================================================================
@@ -87,18 +109,75 @@ plt.rcParams["font.size"] = 14
 # =====================================================================
 plt.figure(figsize=(7.5, 6))
 
-# --- LDPC (SPA) BER curve ---
-plt.semilogy(
-    EbN0,
-    ber_info,
-    marker="o",
-    markersize=8,
-    markerfacecolor="none",
-    markeredgewidth=1.8,
-    linewidth=2.5,
-    color="green",
-    label="LDPC SPA BPSK",
-)
+# --- LDPC BER curves (one per check-node kernel) ---
+y_floor = 1e-5
+kernel_style = {
+    "spa": ("green", "o", "SPA"),
+    "minsum": ("blue", "s", "Min-Sum"),
+    "nms": ("purple", "^", "Normalized MS"),
+    "oms": ("orange", "D", "Offset MS"),
+}
+for path, tag in variants:
+    dfk = pd.read_csv(path)
+    parts = tag.split("_")
+    kernel = parts[0] if parts[0] in kernel_style else "spa"
+    color, marker, name = kernel_style[kernel]
+    for phi in ("lut", "pwl"):
+        if phi in parts:
+            name += f" ({phi.upper()} phi)"
+    if "layered" in parts:
+        name += " layered"
+    if "is" in parts:
+        name += " (IS)"
+    dfk = dfk[dfk["BER_info"] > 0]
+    if "BER_ci95" in dfk.columns:
+        dfk = dfk[dfk["BER_ci95"].notna()]
+    plt.semilogy(
+        dfk["EbN0_dB"],
+        dfk["BER_info"],
+        marker=marker,
+        markersize=8,
+        markerfacecolor="none",
+        markeredgewidth=1.8,
+        linewidth=2.5,
+        color=color,
+        linestyle="--" if "layered" in parts else "-",
+        label=f"LDPC {name} BPSK",
+    )
+    if "BER_ci95" in dfk.columns:
+        # lower bar clipped to stay on the log scale
+        lower = dfk["BER_ci95"].clip(upper=0.9 * dfk["BER_info"])
+        plt.errorbar(
+            dfk["EbN0_dB"],
+            dfk["BER_info"],
+            yerr=[lower, dfk["BER_ci95"]],
+            fmt="none",
+            ecolor=color,
+            capsize=3,
+            linewidth=1.0,
+        )
+    if "FER" in dfk.columns:
+        plt.semilogy(
+            dfk["EbN0_dB"],
+            dfk["FER"],
+            linewidth=1.2,
+            color=color,
+            linestyle="-.",
+            label=f"LDPC {name} FER",
+        )
+    y_floor = min([y_floor] + list(dfk["BER_info"]))
+
+# --- Fixed-point formats decoded alongside (BER_q{bits}.{frac} columns) ---
+for col in [c for c in df.columns if c.startswith("BER_q")]:
+    plt.semilogy(
+        EbN0,
+        df[col],
+        marker="x",
+        markersize=7,
+        linewidth=1.6,
+        linestyle=":",
+        label=f"fixed-point {col[5:]}",
+    )
 
 # --- Uncoded BPSK theory ---
 plt.semilogy(
@@ -110,7 +189,7 @@ plt.semilogy(
 )
 
 # Axes
-plt.ylim(1e-5, 1)
+plt.ylim(10 ** math.floor(math.log10(y_floor)), 1)
 plt.xlabel("Eb/N0 [dB]", fontsize=18)
 plt.ylabel("Bit Error Rate (BER)", fontsize=18)
 plt.grid(True, which="both", linestyle="--", linewidth=0.6, alpha=0.6)
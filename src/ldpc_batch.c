@@ -0,0 +1,723 @@
+/**
+ * @file ldpc_batch.c
+ * @brief Inter-frame SIMD batch LDPC decoder (min-sum family).
+ *
+ * This module decodes LDPC_BATCH_LANES frames in lockstep. Every array is
+ * frame-interleaved (index * W + lane), and every inner loop runs over the
+ * W lanes with a compile-time trip count and no data-dependent branches,
+ * so the compiler turns each Tanner-graph edge operation into straight
+ * vector instructions.
+ *
+ * The decoder body is written once (always_inline) and instantiated for
+ * several instruction sets via function target attributes; a dispatch
+ * pointer selected at creation time picks the instantiation. Because the
+ * min-sum arithmetic is exact IEEE single precision (no FMA contraction,
+ * no transcendental functions), every instantiation is bit-identical,
+ * and since every sum is formed in the order of ldpc_decoder_impl.h, so
+ * is each lane to the scalar float decoder.
+ *
+ * Stream mode runs the same iteration body one iteration per call, with a
+ * private iteration count per lane: a lane whose frame converges (or
+ * reaches max_iter) is reported and can be refilled with a new frame while
+ * the other lanes go on.
+ */
+
+#include "ldpc_batch.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define W LDPC_BATCH_LANES
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LDPC_BATCH_X86 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define LDPC_BATCH_NEON 1
+#endif
+
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+
+/* ========================================================================== */
+/* Batch decoder context                                                      */
+/* ========================================================================== */
+typedef int (*batch_fn)(ldpc_batch_decoder_t *bd, const float *LLR,
+                        uint8_t *ecc, int n_frames, int max_iter, int *iters);
+typedef uint32_t (*batch_step_fn)(ldpc_batch_decoder_t *bd, int max_iter);
+
+struct ldpc_batch_decoder {
+  const ldpc_graph_t *g;
+  int K;
+
+  ldpc_simd_target target;
+  batch_fn decode;
+  batch_step_fn step;
+
+  ldpc_cn_kernel kernel;
+  float cn_param;
+  ldpc_schedule schedule;
+
+  /* all arrays are W-interleaved: element index * W + lane */
+  float *u;     /* [n_edges * W] V→C messages (flooding only)    */
+  float *v;     /* [n_edges * W] C→V messages                    */
+  float *L;     /* [N * W] posterior LLR                         */
+  float *x;     /* [max_row_deg * W] check-row scratch           */
+  int32_t *hd;  /* [N * W] hard decisions of the current iterate */
+
+  /* stream mode */
+  float *llr;       /* [N * W] channel LLRs of the loaded frames      */
+  uint8_t *out;     /* [N * W] decisions of the finished frames       */
+  int busy[W];      /* lane holds a frame that is being decoded       */
+  int lane_iter[W]; /* iterations run on the frame of the lane        */
+  int lane_conv[W]; /* the finished frame converged (zero syndrome)   */
+};
+
+/* ========================================================================== */
+/* Lane kernels (instantiated per target)                                     */
+/* ========================================================================== */
+
+/*
+ * Min-sum check row for W lanes:
+ *   x[k*W + w] : input of edge k in lane w
+ *   out        : C→V messages of the row (same layout)
+ *
+ * Branch-free form of the scalar min1/min2 update:
+ *   lt    = a < min1
+ *   min2  = lt ? min1 : (a < min2 ? a : min2)
+ *   min1  = lt ? a : min1
+ */
+ALWAYS_INLINE void lanes_cn_minsum(const float *restrict x,
+                                   float *restrict out, int d,
+                                   ldpc_cn_kernel kernel, float param) {
+  float m1[W], m2[W];
+  int32_t idx[W], sgn[W];
+
+  for (int w = 0; w < W; w++) {
+    m1[w] = FLT_MAX;
+    m2[w] = FLT_MAX;
+    idx[w] = 0;
+    sgn[w] = 0;
+  }
+
+  for (int k = 0; k < d; k++) {
+    const float *xk = x + k * W;
+    for (int w = 0; w < W; w++) {
+      float a = fabsf(xk[w]);
+      int32_t lt = a < m1[w];
+      float m2n = (a < m2[w]) ? a : m2[w];
+      m2[w] = lt ? m1[w] : m2n;
+      m1[w] = lt ? a : m1[w];
+      idx[w] = lt ? k : idx[w];
+      sgn[w] ^= (xk[w] < 0.0f);
+    }
+  }
+  if (d == 1)
+    for (int w = 0; w < W; w++)
+      m2[w] = (float)LDPC_CN_DEG1_MAG;
+
+  /* magnitude correction applied once per row, not per edge */
+  if (kernel == LDPC_CN_NMS) {
+    for (int w = 0; w < W; w++) {
+      m1[w] *= param;
+      m2[w] *= param;
+    }
+  } else if (kernel == LDPC_CN_OMS) {
+    for (int w = 0; w < W; w++) {
+      m1[w] = (m1[w] > param) ? m1[w] - param : 0.0f;
+      m2[w] = (m2[w] > param) ? m2[w] - param : 0.0f;
+    }
+  }
+
+  for (int k = 0; k < d; k++) {
+    const float *xk = x + k * W;
+    float *ok = out + k * W;
+    for (int w = 0; w < W; w++) {
+      float mag = (idx[w] == k) ? m2[w] : m1[w];
+      int32_t neg = sgn[w] ^ (xk[w] < 0.0f);
+      ok[w] = neg ? -mag : mag;
+    }
+  }
+}
+
+/*
+ * Per-lane syndrome test on hd[]. Sets bad[w] = 1 for every lane with at
+ * least one unsatisfied check.
+ */
+ALWAYS_INLINE void lanes_syndrome(const ldpc_graph_t *g,
+                                  const int32_t *restrict hd, int32_t *bad) {
+  for (int w = 0; w < W; w++)
+    bad[w] = 0;
+
+  for (int i = 0; i < g->M; i++) {
+    int32_t par[W];
+    for (int w = 0; w < W; w++)
+      par[w] = 0;
+    for (int e = g->row_ptr[i]; e < g->row_ptr[i + 1]; e++) {
+      const int32_t *h = hd + g->col_idx[e] * W;
+      for (int w = 0; w < W; w++)
+        par[w] ^= h[w];
+    }
+    for (int w = 0; w < W; w++)
+      bad[w] |= par[w];
+  }
+}
+
+/*
+ * Latch the hard decisions of lanes that converged in this iteration and
+ * return 1 when every valid lane is done.
+ */
+ALWAYS_INLINE int lanes_latch(const ldpc_graph_t *g, const int32_t *hd,
+                              const int32_t *bad, int32_t *done, uint8_t *ecc,
+                              int *iters, int iter, int n_frames) {
+  int all_done = 1;
+
+  for (int w = 0; w < W; w++) {
+    if (!done[w] && !bad[w]) {
+      done[w] = 1;
+      if (iters)
+        iters[w] = iter + 1;
+      for (int j = 0; j < g->N; j++)
+        ecc[j * W + w] = (uint8_t)hd[j * W + w];
+    }
+    if (w < n_frames && !done[w])
+      all_done = 0;
+  }
+  return all_done;
+}
+
+/* Common epilogue: lanes that never converged keep their last iterate. */
+ALWAYS_INLINE void lanes_finish(const ldpc_graph_t *g, const int32_t *hd,
+                                const int32_t *done, uint8_t *ecc, int *iters,
+                                int max_iter) {
+  for (int w = 0; w < W; w++) {
+    if (done[w])
+      continue;
+    if (iters)
+      iters[w] = max_iter;
+    for (int j = 0; j < g->N; j++)
+      ecc[j * W + w] = (uint8_t)hd[j * W + w];
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Layered schedule (see decode_layered() in ldpc_decoder.c)                   */
+/* -------------------------------------------------------------------------- */
+/* One iteration on the running posterior L[]; hard decisions into hd[]. */
+ALWAYS_INLINE void batch_layered_iter(ldpc_batch_decoder_t *bd) {
+  const ldpc_graph_t *g = bd->g;
+  const int *restrict row_ptr = g->row_ptr;
+  const int *restrict col_idx = g->col_idx;
+  float *restrict v = bd->v;
+  float *restrict L = bd->L;
+  float *restrict x = bd->x;
+  int32_t *restrict hd = bd->hd;
+  const ldpc_cn_kernel kernel = bd->kernel;
+  const float param = bd->cn_param;
+
+  for (int i = 0; i < g->M; i++) {
+    const int e0 = row_ptr[i];
+    const int d = row_ptr[i + 1] - e0;
+
+    for (int k = 0; k < d; k++) {
+      const float *Lj = L + col_idx[e0 + k] * W;
+      const float *ve = v + (e0 + k) * W;
+      float *xk = x + k * W;
+      for (int w = 0; w < W; w++)
+        xk[w] = Lj[w] - ve[w];
+    }
+
+    lanes_cn_minsum(x, v + e0 * W, d, kernel, param);
+
+    for (int k = 0; k < d; k++) {
+      float *Lj = L + col_idx[e0 + k] * W;
+      const float *ve = v + (e0 + k) * W;
+      const float *xk = x + k * W;
+      for (int w = 0; w < W; w++)
+        Lj[w] = xk[w] + ve[w];
+    }
+  }
+
+  for (int j = 0; j < g->N * W; j++)
+    hd[j] = (L[j] >= 0.0f);
+}
+
+ALWAYS_INLINE int batch_layered_body(ldpc_batch_decoder_t *bd,
+                                     const float *restrict LLR, uint8_t *ecc,
+                                     int n_frames, int max_iter, int *iters) {
+  const ldpc_graph_t *g = bd->g;
+  int32_t done[W], bad[W];
+  int iter;
+
+  for (int w = 0; w < W; w++)
+    done[w] = 0;
+  memset(bd->v, 0, (size_t)g->n_edges * W * sizeof(float));
+  memcpy(bd->L, LLR, (size_t)g->N * W * sizeof(float));
+
+  for (iter = 0; iter < max_iter; iter++) {
+    batch_layered_iter(bd);
+
+    lanes_syndrome(g, bd->hd, bad);
+    if (lanes_latch(g, bd->hd, bad, done, ecc, iters, iter, n_frames)) {
+      iter++;
+      break;
+    }
+  }
+
+  lanes_finish(g, bd->hd, done, ecc, iters, max_iter);
+  return iter;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Flooding schedule (see decode_flooding() in ldpc_decoder.c)                 */
+/* -------------------------------------------------------------------------- */
+/* One iteration from the V→C messages u[]; hard decisions into hd[]. */
+ALWAYS_INLINE void batch_flooding_iter(ldpc_batch_decoder_t *bd,
+                                       const float *restrict LLR) {
+  const ldpc_graph_t *g = bd->g;
+  const int *restrict row_ptr = g->row_ptr;
+  const int *restrict col_idx = g->col_idx;
+  const int *restrict col_ptr = g->col_ptr;
+  const int *restrict col_edge = g->col_edge;
+  float *restrict u = bd->u;
+  float *restrict v = bd->v;
+  float *restrict L = bd->L;
+  float *restrict x = bd->x;
+  int32_t *restrict hd = bd->hd;
+  const ldpc_cn_kernel kernel = bd->kernel;
+  const float param = bd->cn_param;
+
+  /* ------------------------ Check node update ------------------- */
+  for (int i = 0; i < g->M; i++) {
+    const int e0 = row_ptr[i];
+    const int d = row_ptr[i + 1] - e0;
+
+    for (int k = 0; k < d; k++) {
+      const float *lj = LLR + col_idx[e0 + k] * W;
+      const float *ue = u + (e0 + k) * W;
+      float *xk = x + k * W;
+      for (int w = 0; w < W; w++)
+        xk[w] = lj[w] + ue[w];
+    }
+
+    lanes_cn_minsum(x, v + e0 * W, d, kernel, param);
+  }
+
+  /* ------------------------ Variable node update ---------------- */
+  /* the sums of decode_flooding(), in its order (the "total minus own
+   * message" shortcut rounds differently) */
+  for (int j = 0; j < g->N; j++) {
+    const int s0 = col_ptr[j], s1 = col_ptr[j + 1];
+    float *Lj = L + j * W;
+    const float *lj = LLR + j * W;
+
+    for (int s = s0; s < s1; s++) {
+      float *ue = u + col_edge[s] * W;
+      for (int w = 0; w < W; w++)
+        ue[w] = 0.0f;
+      for (int r = s0; r < s1; r++) {
+        if (r == s)
+          continue;
+        const float *ve = v + col_edge[r] * W;
+        for (int w = 0; w < W; w++)
+          ue[w] += ve[w];
+      }
+    }
+    for (int w = 0; w < W; w++)
+      Lj[w] = lj[w];
+    for (int s = s0; s < s1; s++) {
+      const float *ve = v + col_edge[s] * W;
+      for (int w = 0; w < W; w++)
+        Lj[w] += ve[w];
+    }
+    for (int w = 0; w < W; w++)
+      hd[j * W + w] = (Lj[w] >= 0.0f);
+  }
+}
+
+ALWAYS_INLINE int batch_flooding_body(ldpc_batch_decoder_t *bd,
+                                      const float *restrict LLR, uint8_t *ecc,
+                                      int n_frames, int max_iter, int *iters) {
+  const ldpc_graph_t *g = bd->g;
+  int32_t done[W], bad[W];
+  int iter;
+
+  for (int w = 0; w < W; w++)
+    done[w] = 0;
+  memset(bd->u, 0, (size_t)g->n_edges * W * sizeof(float));
+
+  for (iter = 0; iter < max_iter; iter++) {
+    batch_flooding_iter(bd, LLR);
+
+    lanes_syndrome(g, bd->hd, bad);
+    if (lanes_latch(g, bd->hd, bad, done, ecc, iters, iter, n_frames)) {
+      iter++;
+      break;
+    }
+  }
+
+  lanes_finish(g, bd->hd, done, ecc, iters, max_iter);
+  return iter;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Stream mode: one iteration of every lane, finished lanes reported          */
+/* -------------------------------------------------------------------------- */
+/*
+ * Lanes without a frame stay at zero (all messages and LLRs 0 are a fixed
+ * point of the min-sum update), so they cost time but never produce
+ * non-finite values.
+ */
+ALWAYS_INLINE void lane_clear(ldpc_batch_decoder_t *bd, int w) {
+  const ldpc_graph_t *g = bd->g;
+  for (int e = 0; e < g->n_edges; e++) {
+    bd->u[e * W + w] = 0.0f;
+    bd->v[e * W + w] = 0.0f;
+  }
+  for (int j = 0; j < g->N; j++) {
+    bd->L[j * W + w] = 0.0f;
+    bd->llr[j * W + w] = 0.0f;
+  }
+}
+
+ALWAYS_INLINE uint32_t batch_step_body(ldpc_batch_decoder_t *bd,
+                                       int max_iter) {
+  const ldpc_graph_t *g = bd->g;
+  int32_t bad[W];
+  uint32_t finished = 0;
+
+  if (bd->schedule == LDPC_SCHED_LAYERED)
+    batch_layered_iter(bd);
+  else
+    batch_flooding_iter(bd, bd->llr);
+
+  lanes_syndrome(g, bd->hd, bad);
+  for (int w = 0; w < W; w++) {
+    if (!bd->busy[w])
+      continue;
+    bd->lane_iter[w]++;
+    if (bad[w] && bd->lane_iter[w] < max_iter)
+      continue;
+    bd->lane_conv[w] = !bad[w];
+    for (int j = 0; j < g->N; j++)
+      bd->out[j * W + w] = (uint8_t)bd->hd[j * W + w];
+    bd->busy[w] = 0;
+    lane_clear(bd, w);
+    finished |= (uint32_t)1 << w;
+  }
+  return finished;
+}
+
+ALWAYS_INLINE int batch_body(ldpc_batch_decoder_t *bd, const float *LLR,
+                             uint8_t *ecc, int n_frames, int max_iter,
+                             int *iters) {
+  if (bd->schedule == LDPC_SCHED_LAYERED)
+    return batch_layered_body(bd, LLR, ecc, n_frames, max_iter, iters);
+  return batch_flooding_body(bd, LLR, ecc, n_frames, max_iter, iters);
+}
+
+/* ========================================================================== */
+/* Target instantiations                                                      */
+/* ========================================================================== */
+static int batch_decode_generic(ldpc_batch_decoder_t *bd, const float *LLR,
+                                uint8_t *ecc, int n_frames, int max_iter,
+                                int *iters) {
+  return batch_body(bd, LLR, ecc, n_frames, max_iter, iters);
+}
+
+static uint32_t batch_step_generic(ldpc_batch_decoder_t *bd, int max_iter) {
+  return batch_step_body(bd, max_iter);
+}
+
+#ifdef LDPC_BATCH_X86
+__attribute__((target("avx2"))) static int
+batch_decode_avx2(ldpc_batch_decoder_t *bd, const float *LLR, uint8_t *ecc,
+                  int n_frames, int max_iter, int *iters) {
+  return batch_body(bd, LLR, ecc, n_frames, max_iter, iters);
+}
+
+__attribute__((target("avx512f,avx512bw"))) static int
+batch_decode_avx512(ldpc_batch_decoder_t *bd, const float *LLR, uint8_t *ecc,
+                    int n_frames, int max_iter, int *iters) {
+  return batch_body(bd, LLR, ecc, n_frames, max_iter, iters);
+}
+
+__attribute__((target("avx2"))) static uint32_t
+batch_step_avx2(ldpc_batch_decoder_t *bd, int max_iter) {
+  return batch_step_body(bd, max_iter);
+}
+
+__attribute__((target("avx512f,avx512bw"))) static uint32_t
+batch_step_avx512(ldpc_batch_decoder_t *bd, int max_iter) {
+  return batch_step_body(bd, max_iter);
+}
+#endif
+
+/* ========================================================================== */
+/* Target selection                                                           */
+/* ========================================================================== */
+static const char *const simd_target_names[] = {"auto", "generic", "avx2",
+                                                "avx512", "neon"};
+
+const char *ldpc_simd_target_name(ldpc_simd_target target) {
+  if ((int)target < 0 || (int)target > LDPC_SIMD_NEON)
+    return "unknown";
+  return simd_target_names[target];
+}
+
+int ldpc_simd_target_supported(ldpc_simd_target target) {
+  switch (target) {
+  case LDPC_SIMD_AUTO:
+  case LDPC_SIMD_GENERIC:
+    return 1;
+#ifdef LDPC_BATCH_X86
+  case LDPC_SIMD_AVX2:
+    return __builtin_cpu_supports("avx2");
+  case LDPC_SIMD_AVX512:
+    return __builtin_cpu_supports("avx512f") &&
+           __builtin_cpu_supports("avx512bw");
+#endif
+#ifdef LDPC_BATCH_NEON
+  case LDPC_SIMD_NEON:
+    return 1;
+#endif
+  default:
+    return 0;
+  }
+}
+
+static ldpc_simd_target resolve_target(ldpc_simd_target target) {
+  if (target != LDPC_SIMD_AUTO)
+    return target;
+  if (ldpc_simd_target_supported(LDPC_SIMD_AVX512))
+    return LDPC_SIMD_AVX512;
+  if (ldpc_simd_target_supported(LDPC_SIMD_AVX2))
+    return LDPC_SIMD_AVX2;
+  if (ldpc_simd_target_supported(LDPC_SIMD_NEON))
+    return LDPC_SIMD_NEON;
+  return LDPC_SIMD_GENERIC;
+}
+
+static batch_fn target_fn(ldpc_simd_target target) {
+  switch (target) {
+#ifdef LDPC_BATCH_X86
+  case LDPC_SIMD_AVX2:
+    return batch_decode_avx2;
+  case LDPC_SIMD_AVX512:
+    return batch_decode_avx512;
+#endif
+  default:
+    /* NEON is the baseline ISA on AArch64: the generic build uses it */
+    return batch_decode_generic;
+  }
+}
+
+static batch_step_fn target_step_fn(ldpc_simd_target target) {
+  switch (target) {
+#ifdef LDPC_BATCH_X86
+  case LDPC_SIMD_AVX2:
+    return batch_step_avx2;
+  case LDPC_SIMD_AVX512:
+    return batch_step_avx512;
+#endif
+  default:
+    return batch_step_generic;
+  }
+}
+
+/* ========================================================================== */
+/* Public API                                                                 */
+/* ========================================================================== */
+static void *alloc_lanes(size_t n_items, size_t elem) {
+  void *p = malloc((n_items > 0 ? n_items : 1) * W * elem);
+  if (!p) {
+    fprintf(stderr, "malloc failed in ldpc_batch_create\n");
+    exit(1);
+  }
+  return p;
+}
+
+ldpc_batch_decoder_t *ldpc_batch_create(const ldpc_graph_t *g, int K,
+                                        ldpc_simd_target target) {
+  target = resolve_target(target);
+  if (!ldpc_simd_target_supported(target))
+    return NULL;
+
+  ldpc_batch_decoder_t *bd =
+      (ldpc_batch_decoder_t *)calloc(1, sizeof(ldpc_batch_decoder_t));
+  if (!bd) {
+    fprintf(stderr, "malloc failed in ldpc_batch_create\n");
+    exit(1);
+  }
+
+  bd->g = g;
+  bd->K = K;
+  bd->target = target;
+  bd->decode = target_fn(target);
+  bd->step = target_step_fn(target);
+  bd->kernel = LDPC_CN_NMS;
+  bd->cn_param = (float)LDPC_NMS_ALPHA_DEFAULT;
+  bd->schedule = LDPC_SCHED_LAYERED;
+
+  bd->u = (float *)alloc_lanes(g->n_edges, sizeof(float));
+  bd->v = (float *)alloc_lanes(g->n_edges, sizeof(float));
+  bd->L = (float *)alloc_lanes(g->N, sizeof(float));
+  bd->x = (float *)alloc_lanes(g->max_row_deg, sizeof(float));
+  bd->hd = (int32_t *)alloc_lanes(g->N, sizeof(int32_t));
+  bd->llr = (float *)alloc_lanes(g->N, sizeof(float));
+  bd->out = (uint8_t *)alloc_lanes(g->N, sizeof(uint8_t));
+  ldpc_batch_stream_reset(bd);
+
+  return bd;
+}
+
+void ldpc_batch_free(ldpc_batch_decoder_t *bd) {
+  if (!bd)
+    return;
+  free(bd->u);
+  free(bd->v);
+  free(bd->L);
+  free(bd->x);
+  free(bd->hd);
+  free(bd->llr);
+  free(bd->out);
+  free(bd);
+}
+
+ldpc_simd_target ldpc_batch_target(const ldpc_batch_decoder_t *bd) {
+  return bd->target;
+}
+
+int ldpc_batch_set_kernel(ldpc_batch_decoder_t *bd, ldpc_cn_kernel kernel,
+                          double param) {
+  if (kernel == LDPC_CN_SPA)
+    return -1;
+  bd->kernel = kernel;
+  bd->cn_param = (float)param;
+  return 0;
+}
+
+void ldpc_batch_set_schedule(ldpc_batch_decoder_t *bd,
+                             ldpc_schedule schedule) {
+  bd->schedule = schedule;
+}
+
+int ldpc_batch_decode(ldpc_batch_decoder_t *bd, const float *LLR,
+                      uint8_t *ecc, int n_frames, int max_iter, int *iters) {
+  return bd->decode(bd, LLR, ecc, n_frames, max_iter, iters);
+}
+
+void ldpc_batch_stream_reset(ldpc_batch_decoder_t *bd) {
+  const ldpc_graph_t *g = bd->g;
+  memset(bd->u, 0, (size_t)g->n_edges * W * sizeof(float));
+  memset(bd->v, 0, (size_t)g->n_edges * W * sizeof(float));
+  memset(bd->L, 0, (size_t)g->N * W * sizeof(float));
+  memset(bd->llr, 0, (size_t)g->N * W * sizeof(float));
+  for (int w = 0; w < W; w++)
+    bd->busy[w] = 0;
+}
+
+int ldpc_batch_stream_load(ldpc_batch_decoder_t *bd, int lane,
+                           const double *LLR) {
+  const ldpc_graph_t *g = bd->g;
+  if (lane < 0 || lane >= W || bd->busy[lane])
+    return -1;
+
+  /* the lane is clear (reset or finished): only the inputs are set */
+  for (int j = 0; j < g->N; j++) {
+    float l = (float)LLR[j];
+    bd->llr[j * W + lane] = l;
+    bd->L[j * W + lane] = l;
+  }
+  bd->busy[lane] = 1;
+  bd->lane_iter[lane] = 0;
+  return 0;
+}
+
+int ldpc_batch_stream_load_f32(ldpc_batch_decoder_t *bd, int lane,
+                               const float *LLR, float scale) {
+  const ldpc_graph_t *g = bd->g;
+  if (lane < 0 || lane >= W || bd->busy[lane])
+    return -1;
+
+  for (int j = 0; j < g->N; j++) {
+    float l = LLR[j] * scale;
+    bd->llr[j * W + lane] = l;
+    bd->L[j * W + lane] = l;
+  }
+  bd->busy[lane] = 1;
+  bd->lane_iter[lane] = 0;
+  return 0;
+}
+
+int ldpc_batch_stream_load_s8(ldpc_batch_decoder_t *bd, int lane,
+                              const int8_t *LLR, float scale) {
+  const ldpc_graph_t *g = bd->g;
+  if (lane < 0 || lane >= W || bd->busy[lane])
+    return -1;
+
+  for (int j = 0; j < g->N; j++) {
+    float l = (float)LLR[j] * scale;
+    bd->llr[j * W + lane] = l;
+    bd->L[j * W + lane] = l;
+  }
+  bd->busy[lane] = 1;
+  bd->lane_iter[lane] = 0;
+  return 0;
+}
+
+uint32_t ldpc_batch_stream_busy(const ldpc_batch_decoder_t *bd) {
+  uint32_t m = 0;
+  for (int w = 0; w < W; w++)
+    m |= (uint32_t)(bd->busy[w] != 0) << w;
+  return m;
+}
+
+uint32_t ldpc_batch_stream_step(ldpc_batch_decoder_t *bd, int max_iter) {
+  return bd->step(bd, max_iter);
+}
+
+void ldpc_batch_stream_result(const ldpc_batch_decoder_t *bd, int lane,
+                              int *inf, int *iters, int *converged) {
+  const int N = bd->g->N, K = bd->K;
+  for (int i = 0; i < K; i++)
+    inf[i] = bd->out[(i + N - K) * W + lane];
+  if (iters)
+    *iters = bd->lane_iter[lane];
+  if (converged)
+    *converged = bd->lane_conv[lane];
+}
+
+void ldpc_batch_put_llr(float *LLR_batch, const double *LLR, int N, int lane) {
+  for (int j = 0; j < N; j++)
+    LLR_batch[j * W + lane] = (float)LLR[j];
+}
+
+void ldpc_batch_get_inf(const uint8_t *ecc_batch, int *inf, int N, int K,
+                        int lane) {
+  for (int i = 0; i < K; i++)
+    inf[i] = ecc_batch[(i + N - K) * W + lane];
+}
+
+void ldpc_batch_put_sliced(float *x_batch, const uint64_t *code, int N,
+                           int first) {
+  for (int i = 0; i < N; i++) {
+    uint64_t bits = code[i] >> first;
+    for (int w = 0; w < W; w++)
+      x_batch[i * W + w] = ((bits >> w) & 1) ? 1.0f : -1.0f;
+  }
+}
+
+void ldpc_batch_get_sliced(uint64_t *code, const uint8_t *ecc_batch, int N,
+                           int first, int n_frames) {
+  const uint64_t keep = ~((((uint64_t)1 << n_frames) - 1) << first);
+  for (int i = 0; i < N; i++) {
+    uint64_t bits = 0;
+    for (int w = 0; w < n_frames; w++)
+      bits |= (uint64_t)(ecc_batch[i * W + w] & 1) << w;
+    code[i] = (code[i] & keep) | (bits << first);
+  }
+}
@@ -0,0 +1,292 @@
+/**
+ * @file ldpc_bitflip.c
+ * @brief Weighted and gradient-descent bit-flipping decoders.
+ *
+ * This module provides:
+ *   - Bit-packed hard decisions and syndrome with a running syndrome weight
+ *   - Incremental flip updates: a flip toggles the syndrome bits of the
+ *     flipped bit's checks and adjusts the metrics of their bits, so only
+ *     the argmax / threshold scan is O(N) per iteration
+ *   - MWBF (single flip) and GDBF (multi flip, then single flip)
+ */
+
+#include "ldpc_bitflip.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ldpc_bf_decoder {
+  const ldpc_graph_t *g; /* borrowed Tanner graph */
+  int K;
+
+  ldpc_bf_mode mode;
+  double param; /* α (WBF) or θ (GDBF) */
+  int gate;     /* attempt up to M / gate unsatisfied checks, <= 0: all */
+
+  uint64_t *hd;   /* [⌈N/64⌉] hard decisions                   */
+  uint64_t *syn;  /* [⌈M/64⌉] syndrome                          */
+  int weight;     /* number of set syndrome bits               */
+  double *w;      /* [M] check reliabilities (WBF)             */
+  double *metric; /* [N] E_j (WBF) or Δ_j (GDBF)               */
+  int *flip;      /* [N] flip set of a GDBF multi-flip step    */
+
+  const double *llr; /* channel LLRs of the current frame   */
+  double scale;      /* y_j = llr[j] · scale                */
+};
+
+#define BIT_GET(a, j) ((int)(((a)[(j) >> 6] >> ((j)&63)) & 1u))
+#define BIT_FLIP(a, j) ((a)[(j) >> 6] ^= (uint64_t)1 << ((j)&63))
+
+static const char *const bf_mode_names[] = {"wbf", "gdbf"};
+
+const char *ldpc_bf_mode_name(ldpc_bf_mode mode) {
+  if ((int)mode < 0 || (int)mode > LDPC_BF_GDBF)
+    return "unknown";
+  return bf_mode_names[mode];
+}
+
+int ldpc_bf_mode_parse(const char *name, ldpc_bf_mode *mode) {
+  for (int i = 0; i <= LDPC_BF_GDBF; i++) {
+    if (!strcmp(name, bf_mode_names[i])) {
+      *mode = (ldpc_bf_mode)i;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+double ldpc_bf_param_default(ldpc_bf_mode mode) {
+  return mode == LDPC_BF_WBF ? LDPC_WBF_ALPHA_DEFAULT
+                             : LDPC_GDBF_THETA_DEFAULT;
+}
+
+ldpc_bf_decoder_t *ldpc_bf_create(const ldpc_graph_t *g, int K) {
+  ldpc_bf_decoder_t *bf =
+      (ldpc_bf_decoder_t *)calloc(1, sizeof(ldpc_bf_decoder_t));
+  if (!bf) {
+    fprintf(stderr, "malloc failed in ldpc_bf_create\n");
+    exit(1);
+  }
+  size_t nv = (size_t)(g->N > 0 ? g->N : 1);
+  size_t nc = (size_t)(g->M > 0 ? g->M : 1);
+
+  bf->g = g;
+  bf->K = K;
+  bf->mode = LDPC_BF_GDBF;
+  bf->param = LDPC_GDBF_THETA_DEFAULT;
+  bf->gate = LDPC_BF_GATE_DEFAULT;
+  bf->hd = (uint64_t *)malloc((nv + 63) / 64 * sizeof(uint64_t));
+  bf->syn = (uint64_t *)malloc((nc + 63) / 64 * sizeof(uint64_t));
+  bf->w = (double *)malloc(nc * sizeof(double));
+  bf->metric = (double *)malloc(nv * sizeof(double));
+  bf->flip = (int *)malloc(nv * sizeof(int));
+  if (!bf->hd || !bf->syn || !bf->w || !bf->metric || !bf->flip) {
+    fprintf(stderr, "malloc failed in ldpc_bf_create\n");
+    exit(1);
+  }
+  return bf;
+}
+
+void ldpc_bf_free(ldpc_bf_decoder_t *bf) {
+  if (!bf)
+    return;
+  free(bf->hd);
+  free(bf->syn);
+  free(bf->w);
+  free(bf->metric);
+  free(bf->flip);
+  free(bf);
+}
+
+void ldpc_bf_set_mode(ldpc_bf_decoder_t *bf, ldpc_bf_mode mode, double param) {
+  bf->mode = mode;
+  bf->param = param;
+}
+
+void ldpc_bf_set_gate(ldpc_bf_decoder_t *bf, int gate) { bf->gate = gate; }
+
+/* ========================================================================== */
+/* Hard decisions and syndrome                                                */
+/* ========================================================================== */
+/* Packs the hard decisions of LLR and returns mean|LLR| */
+static double hard_decide(ldpc_bf_decoder_t *bf, const double *LLR) {
+  const int N = bf->g->N;
+  double sum = 0.0;
+
+  for (int w = 0; w < (N + 63) / 64; w++) {
+    int n = (N - 64 * w < 64) ? N - 64 * w : 64;
+    const double *l = LLR + 64 * w;
+    uint64_t word = 0;
+    for (int b = 0; b < n; b++) {
+      word |= (uint64_t)(l[b] >= 0.0) << b;
+      sum += fabs(l[b]);
+    }
+    bf->hd[w] = word;
+  }
+  return N > 0 ? sum / N : 0.0;
+}
+
+static void syndrome_init(ldpc_bf_decoder_t *bf) {
+  const ldpc_graph_t *g = bf->g;
+
+  memset(bf->syn, 0, (size_t)(g->M + 63) / 64 * sizeof(uint64_t));
+  bf->weight = 0;
+  for (int i = 0; i < g->M; i++) {
+    int parity = 0;
+    for (int k = g->row_ptr[i]; k < g->row_ptr[i + 1]; k++)
+      parity ^= BIT_GET(bf->hd, g->col_idx[k]);
+    if (parity) {
+      bf->syn[i >> 6] |= (uint64_t)1 << (i & 63);
+      bf->weight++;
+    }
+  }
+}
+
+/* ========================================================================== */
+/* Flip metrics                                                               */
+/* ========================================================================== */
+/*
+ * Both metrics are sums over the checks of a bit of a term that only
+ * depends on the check's syndrome bit, plus a channel term. Toggling
+ * check i changes the check term of every bit of N(i) by the same
+ * amount, which is what flip_bit() applies.
+ *
+ * Before the first flip every hard decision agrees with its channel value
+ * (x_j y_j = |y_j|), so the metrics start from their all-satisfied value
+ * and only the bits of the unsatisfied checks are corrected, e.g. for
+ * GDBF Δ_j = |y_j| + w_c(j) − 2 · #{unsatisfied checks of j}.
+ */
+#define Y(bf, j) ((bf)->llr[j] * (bf)->scale)
+
+static void metric_init(ldpc_bf_decoder_t *bf) {
+  const ldpc_graph_t *g = bf->g;
+  const int wbf = (bf->mode == LDPC_BF_WBF);
+
+  if (wbf) {
+    for (int i = 0; i < g->M; i++) {
+      double w = HUGE_VAL;
+      for (int k = g->row_ptr[i]; k < g->row_ptr[i + 1]; k++) {
+        double a = fabs(bf->llr[g->col_idx[k]]);
+        if (a < w)
+          w = a;
+      }
+      bf->w[i] = (w == HUGE_VAL) ? 0.0 : w * bf->scale;
+    }
+    for (int j = 0; j < g->N; j++) {
+      double m = -bf->param * fabs(Y(bf, j));
+      for (int s = g->col_ptr[j]; s < g->col_ptr[j + 1]; s++)
+        m -= bf->w[g->row_idx[s]];
+      bf->metric[j] = m;
+    }
+  } else {
+    for (int j = 0; j < g->N; j++)
+      bf->metric[j] =
+          fabs(Y(bf, j)) + (double)(g->col_ptr[j + 1] - g->col_ptr[j]);
+  }
+
+  for (int i = 0; i < g->M; i++) {
+    if (!BIT_GET(bf->syn, i))
+      continue;
+    double d = wbf ? 2.0 * bf->w[i] : -2.0;
+    for (int k = g->row_ptr[i]; k < g->row_ptr[i + 1]; k++)
+      bf->metric[g->col_idx[k]] += d;
+  }
+}
+
+static void flip_bit(ldpc_bf_decoder_t *bf, int j) {
+  const ldpc_graph_t *g = bf->g;
+  const int wbf = (bf->mode == LDPC_BF_WBF);
+
+  /* GDBF channel term x_j y_j changes sign with x_j */
+  if (!wbf)
+    bf->metric[j] -= BIT_GET(bf->hd, j) ? 2.0 * Y(bf, j) : -2.0 * Y(bf, j);
+  BIT_FLIP(bf->hd, j);
+
+  for (int s = g->col_ptr[j]; s < g->col_ptr[j + 1]; s++) {
+    int i = g->row_idx[s];
+    int was = BIT_GET(bf->syn, i);
+    double d;
+
+    BIT_FLIP(bf->syn, i);
+    bf->weight += was ? -1 : 1;
+    if (wbf)
+      d = was ? -2.0 * bf->w[i] : 2.0 * bf->w[i];
+    else
+      d = was ? 2.0 : -2.0;
+    for (int k = g->row_ptr[i]; k < g->row_ptr[i + 1]; k++)
+      bf->metric[g->col_idx[k]] += d;
+  }
+}
+
+static int argmax(const double *m, int n) {
+  int best = 0;
+  for (int j = 1; j < n; j++)
+    if (m[j] > m[best])
+      best = j;
+  return best;
+}
+
+static int argmin(const double *m, int n) {
+  int best = 0;
+  for (int j = 1; j < n; j++)
+    if (m[j] < m[best])
+      best = j;
+  return best;
+}
+
+/* ========================================================================== */
+/* Frame decoding                                                             */
+/* ========================================================================== */
+int ldpc_bf_decode(ldpc_bf_decoder_t *bf, const double *LLR, int *ecc,
+                   int *inf, int max_iter) {
+  const ldpc_graph_t *g = bf->g;
+  const int N = g->N;
+  const int K = bf->K;
+  int iters = 0;
+
+  double mean = hard_decide(bf, LLR);
+  syndrome_init(bf);
+
+  if (bf->weight > 0 && N > 0 &&
+      (bf->gate <= 0 || bf->weight <= g->M / bf->gate)) {
+    bf->llr = LLR;
+    bf->scale = mean > 0.0 ? 1.0 / mean : 1.0;
+    metric_init(bf);
+
+    int multi = (bf->mode == LDPC_BF_GDBF);
+    while (iters < max_iter && bf->weight > 0) {
+      int n_flip = 0;
+
+      if (multi) {
+        /* flip set from the metrics before this step */
+        for (int j = 0; j < N; j++)
+          if (bf->metric[j] < bf->param)
+            bf->flip[n_flip++] = j;
+        if (n_flip > 0) {
+          int before = bf->weight;
+          for (int f = 0; f < n_flip; f++)
+            flip_bit(bf, bf->flip[f]);
+          if (bf->weight >= before)
+            multi = 0;
+        } else {
+          multi = 0;
+        }
+      }
+      if (n_flip == 0)
+        flip_bit(bf, bf->mode == LDPC_BF_WBF ? argmax(bf->metric, N)
+                                             : argmin(bf->metric, N));
+      iters++;
+    }
+  }
+
+  for (int j = 0; j < N; j++)
+    ecc[j] = BIT_GET(bf->hd, j);
+  for (int i = 0; i < K; i++)
+    inf[i] = ecc[i + (N - K)];
+  return iters;
+}
+
+int ldpc_bf_unsat(const ldpc_bf_decoder_t *bf) { return bf->weight; }
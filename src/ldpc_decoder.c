@@ -3,12 +3,19 @@
  * @brief LDPC Sum-Product (SPA) decoder and LLR computation utilities.
  *
  * This module provides:
+ *   - A reusable decoder context with a prebuilt Tanner graph and
+ *     edge-indexed message storage (no allocation per frame)
  *   - A standard LDPC decoder based on the Sum-Product Algorithm (SPA)
  *     operating in the log-likelihood ratio (LLR) domain
+ *   - Min-sum, normalized min-sum and offset min-sum check-node kernels
+ *   - Flooding and layered (TDMP) message-passing schedules
+ *   - Double or float messages: the kernels and schedules are written once
+ *     in ldpc_decoder_impl.h and instantiated for both precisions
  *   - A helper function to compute bit-wise LLRs from per-symbol likelihoods
  *
  * The SPA implementation uses:
- *   - Flooding schedule (check-node update → variable-node update)
+ *   - Flooding schedule (check-node update → variable-node update), or
+ *     layered schedule (row-block-wise updates of a running posterior)
  *   - LLR-domain message passing over the Tanner graph defined by H
  *   - Early stopping when all parity checks are satisfied (H·c^T = 0)
  *
@@ -19,15 +26,18 @@
 
 #include "ldpc_decoder.h"
 #include <math.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
-/* ========================================================================== */
-/* Helper: sign(x)                                                            */
-/* ========================================================================== */
-/**
- * @brief Return the sign of x (+1 or -1), treating zero as positive.
+/*
+ * Force inlining of the schedule loops into their two instantiations
+ * (with and without statistics), so that the constant NULL stats pointer
+ * removes all bookkeeping from the plain one.
  */
-static inline double sign_val(double x) { return (x >= 0.0) ? 1.0 : -1.0; }
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
 
 /* ========================================================================== */
 /* Helper: spf(x) = log((e^x + 1)/(e^x - 1)), with safe clipping              */
@@ -49,217 +59,574 @@ static inline double spf(double x) {
 }
 
 /* ========================================================================== */
-/* Sum-Product Algorithm (SPA) LDPC Decoder                                   */
+/* Helper: fast approximations of spf(x)                                      */
 /* ========================================================================== */
-/**
- * @brief LDPC decoding using the Sum-Product Algorithm (LLR-domain, flooding).
+/*
+ * Lookup table with linear interpolation. spf() has a logarithmic
+ * singularity at zero and is nearly flat for large x, so three regions
+ * are used:
  *
- * Tanner graph:
- *   - H: M×N parity-check matrix
- *   - Variable nodes: N
- *   - Check nodes   : M
+ *   region 0 : x ∈ [2^−24, 1/16)  20 octaves × 16 cells, indexed by the
+ *                                  exponent and top 4 mantissa bits of x
+ *   region 1 : x ∈ [1/16, 1)      step 1/256   (240 cells)
+ *   region 2 : x ∈ [1, 16)        step 1/32    (480 cells)
  *
- * Message notation:
- *   - u[i][j] : message from variable node j → check node i (extrinsic LLR)
- *   - v[i][j] : message from check node i → variable node j (extrinsic LLR)
- *
- * Decoding steps per iteration:
- *   1) Check-node update:
- *        v[i][j] = f({ LLR[j'] + u[i][j'] | j' ≠ j, H[i][j']=1 })
- *   2) Variable-node update:
- *        u[i][j] = Σ_{i'≠i} v[i'][j]
- *   3) A-posteriori LLR:
- *        L_post[j] = LLR[j] + Σ_i v[i][j]
- *      → hard decision ecc[j] = (L_post[j] >= 0) ? 1 : 0
- *   4) Parity check:
- *        If H·ecc^T = 0, stop early.
- *
- * Finally, the information part is extracted assuming:
- *      codeword = [parity (N-K bits) | info (K bits)]
- *
- * @param LLR      Input channel LLRs for each code bit (length N)
- * @param ecc      Output decoded codeword bits (length N, 0/1)
- * @param inf      Output decoded information bits (length K, 0/1)
- * @param H        Parity-check matrix (M×N), entries in {0,1}
- * @param M        Number of parity-check equations (rows of H)
- * @param N        Codeword length (columns of H)
- * @param K        Information length (systematic part length)
- * @param max_iter Maximum number of SPA iterations
+ * Knot values are exact spf() values. Below 2^−24 spf() is clipped
+ * (x < 1e-7), beyond x = 16 spf(x) ≈ 2·e^−x < 2.3e-7 and is returned as 0.
  */
-void ldpc_decode_spa(double *LLR, int *ecc, int *inf, int **H, int M, int N,
-                     int K, int max_iter) {
-  int i, j, k, iter;
-
-  /* ------------------------------------------------------------------ */
-  /* Build adjacency lists for check and variable nodes                 */
-  /* ------------------------------------------------------------------ */
-  int **check_node =
-      (int **)malloc(M * sizeof(int *)); /* neighbors of check i */
-  for (i = 0; i < M; i++) {
-    check_node[i] = (int *)malloc(N * sizeof(int));
+#define PHI_OCT_MIN (-24)
+#define PHI_OCTAVES 20
+#define PHI_OCT_CELLS (PHI_OCTAVES * 16)
+#define PHI_R1_START 0.0625
+#define PHI_R1_SCALE 256.0
+#define PHI_R1_CELLS 240
+#define PHI_R2_START 1.0
+#define PHI_R2_SCALE 32.0
+#define PHI_R2_CELLS 480
+#define PHI_LUT_END 16.0
+#define PHI_LUT_R1 (PHI_OCT_CELLS + 1)
+#define PHI_LUT_R2 (PHI_LUT_R1 + PHI_R1_CELLS + 1)
+#define PHI_LUT_SIZE (PHI_LUT_R2 + PHI_R2_CELLS + 1)
+
+static void phi_lut_init(double *lut) {
+  for (int i = 0; i <= PHI_OCT_CELLS; i++)
+    lut[i] = spf(ldexp(1.0 + (i % 16) / 16.0, PHI_OCT_MIN + i / 16));
+  for (int i = 0; i <= PHI_R1_CELLS; i++)
+    lut[PHI_LUT_R1 + i] = spf(PHI_R1_START + i / PHI_R1_SCALE);
+  for (int i = 0; i <= PHI_R2_CELLS; i++)
+    lut[PHI_LUT_R2 + i] = spf(PHI_R2_START + i / PHI_R2_SCALE);
+}
+
+static inline double phi_lut(const double *lut, double x) {
+  double t;
+  int i;
+
+  if (x < PHI_R1_START) {
+    uint64_t b;
+    memcpy(&b, &x, sizeof(b));
+    int e = (int)((b >> 52) & 0x7ff) - 1023 - PHI_OCT_MIN;
+    if (e < 0)
+      return lut[0]; /* clipped region (also x <= 0) */
+    i = e * 16 + (int)((b >> 48) & 15);
+    t = (double)(b & ((1ULL << 48) - 1)) * (1.0 / (double)(1ULL << 48));
+  } else if (x < PHI_R2_START) {
+    t = (x - PHI_R1_START) * PHI_R1_SCALE;
+    i = (int)t;
+    t -= i;
+    lut += PHI_LUT_R1;
+  } else if (x < PHI_LUT_END) {
+    t = (x - PHI_R2_START) * PHI_R2_SCALE;
+    i = (int)t;
+    t -= i;
+    lut += PHI_LUT_R2;
+  } else {
+    return 0.0;
   }
 
-  int *deg_c = (int *)calloc(M, sizeof(int)); /* degree of each check node    */
-  int *deg_v = (int *)calloc(N, sizeof(int)); /* degree of each variable node */
+  return lut[i] + t * (lut[i + 1] - lut[i]);
+}
 
-  /* Count degrees of check nodes */
-  for (i = 0; i < M; i++) {
-    for (j = 0; j < N; j++) {
-      if (H[i][j])
-        deg_c[i]++;
-    }
+/*
+ * Piecewise-linear approximation: chords of spf() between a few
+ * breakpoints, denser where the curvature is large. Slopes and
+ * intercepts are derived from exact spf() values at the breakpoints.
+ */
+#define PHI_PWL_SEGS 16
+static const double phi_pwl_x[PHI_PWL_SEGS + 1] = {
+    0.0,  1.0 / 1024, 1.0 / 256, 1.0 / 64, 1.0 / 32, 0.0625,
+    0.125, 0.25,      0.5,       0.75,     1.0,      1.5,
+    2.0,  3.0,        4.0,       6.0,      10.0};
+
+static void phi_pwl_init(double *slope, double *icpt) {
+  for (int s = 0; s < PHI_PWL_SEGS; s++) {
+    double x0 = phi_pwl_x[s], x1 = phi_pwl_x[s + 1];
+    double y0 = spf(x0), y1 = spf(x1);
+    slope[s] = (y1 - y0) / (x1 - x0);
+    icpt[s] = y0 - slope[s] * x0;
   }
+}
 
-  /* Count degrees of variable nodes */
-  for (j = 0; j < N; j++) {
-    for (i = 0; i < M; i++) {
-      if (H[i][j])
-        deg_v[j]++;
-    }
-  }
+static inline double phi_pwl(const double *slope, const double *icpt,
+                             double x) {
+  if (x < 0.0)
+    x = 0.0;
+  else if (x >= phi_pwl_x[PHI_PWL_SEGS])
+    return 0.0;
+
+  int s = 0;
+  while (x >= phi_pwl_x[s + 1])
+    s++;
+  return slope[s] * x + icpt[s];
+}
 
-  /* Variable-node adjacency list: variable_node[j][*] = list of check indices
-   */
-  int **variable_node = (int **)malloc(N * sizeof(int *));
-  for (j = 0; j < N; j++) {
-    variable_node[j] = (int *)malloc(deg_v[j] * sizeof(int));
-  }
+/* ========================================================================== */
+/* Regular degree profiles                                                    */
+/* ========================================================================== */
+/*
+ * X(id, wc, wr): degree profiles with compile-time specialized min-sum
+ * schedules (see ldpc_decoder_impl.h). They are used when wc and wr are
+ * the most frequent column and row degrees of the code; the generic loops
+ * serve other profiles, the remaining rows / columns of other degrees
+ * (e.g. the empty rows and degree-2 columns of the Gallager matrices in
+ * matrices/) and SPA. Adding a profile only takes a line here.
+ */
+#define LDPC_DECODER_PROFILES(X)                                              \
+  X(1, 3, 6)                                                                  \
+  X(2, 4, 8)                                                                  \
+  X(3, 5, 10)                                                                 \
+  X(4, 3, 12)
+
+/* Profile id of a (wc, wr) pair, 0 if it has no specialized schedule */
+static int profile_id(int wc, int wr) {
+#define LDPC_PROFILE_ID(id, dv, dc)                                           \
+  if (wc == dv && wr == dc)                                                   \
+    return id;
+  LDPC_DECODER_PROFILES(LDPC_PROFILE_ID)
+#undef LDPC_PROFILE_ID
+  return 0;
+}
 
-  /* Fill check_node[i][*] = columns j for which H[i][j] = 1 */
-  for (i = 0; i < M; i++) {
-    int idx = 0;
-    for (j = 0; j < N; j++) {
-      if (H[i][j]) {
-        check_node[i][idx++] = j;
-      }
-    }
+/* Most frequent degree ptr[i + 1] − ptr[i] over n rows / columns */
+static int degree_mode(const int *ptr, int n, int max_deg) {
+  int *count = (int *)calloc((size_t)max_deg + 1, sizeof(int));
+  if (!count) {
+    fprintf(stderr, "malloc failed in ldpc_decoder_create\n");
+    exit(1);
   }
+  for (int i = 0; i < n; i++)
+    count[ptr[i + 1] - ptr[i]]++;
+  int mode = 0;
+  for (int d = 1; d <= max_deg; d++)
+    if (count[d] > count[mode])
+      mode = d;
+  free(count);
+  return mode;
+}
 
-  /* Fill variable_node[j][*] = rows i for which H[i][j] = 1 */
-  for (j = 0; j < N; j++) {
-    int idx = 0;
-    for (i = 0; i < M; i++) {
-      if (H[i][j]) {
-        variable_node[j][idx++] = i;
-      }
-    }
+/* ========================================================================== */
+/* Decoder context                                                            */
+/* ========================================================================== */
+/*
+ * Message storage is edge-indexed in check-major order (see ldpc_graph_t):
+ *
+ *   u[e] : message from variable node col_idx[e] → check node of edge e
+ *   v[e] : message from check node of edge e → variable node col_idx[e]
+ *
+ * Both arrays have n_edges entries instead of the M×N dense layout, so the
+ * working set is about N·wc values per array. The layered schedule uses
+ * v[] together with the posterior L[] and leaves u[] untouched.
+ */
+struct ldpc_decoder {
+  const ldpc_graph_t *g; /* Tanner graph (owned if own_graph != 0) */
+  int own_graph;
+  int K; /* information length (systematic tail) */
+
+  ldpc_cn_kernel kernel;  /* check-node update rule          */
+  double cn_param;        /* α (NMS) or β (OMS)              */
+  ldpc_schedule schedule; /* flooding or layered             */
+  ldpc_phi_mode phi;      /* spf() evaluation for SPA        */
+
+  double *phi_tab;                /* [PHI_LUT_SIZE], built on demand */
+  double phi_slope[PHI_PWL_SEGS]; /* PWL segments                    */
+  double phi_icpt[PHI_PWL_SEGS];
+
+  ldpc_precision prec; /* message precision                */
+  int profile;         /* LDPC_DECODER_PROFILES id, 0: none */
+  int reg_wc, reg_wr;  /* most frequent column / row degree */
+  int specialize;      /* use the profile schedules         */
+
+  /* message storage is sized for double and reused for float */
+  void *u;        /* [n_edges] V→C messages (flooding only) */
+  void *v;        /* [n_edges] C→V messages                */
+  void *L;        /* [N] running posterior (layered only)  */
+  void *x;        /* [max_row_deg] check-row scratch       */
+  void *llr;      /* [N] channel LLRs converted to prec    */
+  double *phi_k;  /* [max_row_deg] φ(|x_k|) of a SPA row   */
+
+  ldpc_bf_decoder_t *bf; /* hybrid front end, built on demand */
+  int bf_iter;           /* bit-flipping budget, 0: off       */
+};
+
+ldpc_decoder_t *ldpc_decoder_create_from_graph(const ldpc_graph_t *g, int K) {
+  ldpc_decoder_t *dec = (ldpc_decoder_t *)calloc(1, sizeof(ldpc_decoder_t));
+  if (!dec) {
+    fprintf(stderr, "malloc failed in ldpc_decoder_create\n");
+    exit(1);
   }
 
-  /* ------------------------------------------------------------------ */
-  /* Allocate message arrays u[i][j] (V→C) and v[i][j] (C→V)            */
-  /* For simplicity, these are allocated as M×N dense matrices.         */
-  /* ------------------------------------------------------------------ */
-  double **u = (double **)malloc(M * sizeof(double *));
-  double **v = (double **)malloc(M * sizeof(double *));
-  for (i = 0; i < M; i++) {
-    u[i] = (double *)calloc(N, sizeof(double));
-    v[i] = (double *)calloc(N, sizeof(double));
+  size_t n_alloc = (size_t)(g->n_edges > 0 ? g->n_edges : 1);
+
+  dec->g = g;
+  dec->K = K;
+  dec->specialize = 1;
+
+  /* degree profile: the most frequent column and row degree */
+  dec->reg_wc = degree_mode(g->col_ptr, g->N, g->max_col_deg);
+  dec->reg_wr = degree_mode(g->row_ptr, g->M, g->max_row_deg);
+  dec->profile = profile_id(dec->reg_wc, dec->reg_wr);
+  size_t n_row = (size_t)(g->max_row_deg > 0 ? g->max_row_deg : 1);
+  size_t n_col = (size_t)(g->N > 0 ? g->N : 1);
+  dec->u = malloc(n_alloc * sizeof(double));
+  dec->v = malloc(n_alloc * sizeof(double));
+  dec->L = malloc(n_col * sizeof(double));
+  dec->x = malloc(n_row * sizeof(double));
+  dec->llr = malloc(n_col * sizeof(double));
+  dec->phi_k = (double *)malloc(n_row * sizeof(double));
+  if (!dec->u || !dec->v || !dec->L || !dec->x || !dec->llr || !dec->phi_k) {
+    fprintf(stderr, "malloc failed in ldpc_decoder_create\n");
+    exit(1);
   }
 
-  /* ================================================================== */
-  /* Iterative Sum-Product Algorithm (flooding schedule)                */
-  /* ================================================================== */
-  for (iter = 0; iter < max_iter; iter++) {
+  return dec;
+}
 
-    /* ------------------------ Check node update ------------------- */
-    for (i = 0; i < M; i++) {
-      for (k = 0; k < deg_c[i]; k++) {
+ldpc_decoder_t *ldpc_decoder_create(int **H, int M, int N, int K) {
+  ldpc_decoder_t *dec =
+      ldpc_decoder_create_from_graph(ldpc_graph_create(H, M, N), K);
+  dec->own_graph = 1;
+  return dec;
+}
 
-        int j_idx = check_node[i][k];
+void ldpc_decoder_free(ldpc_decoder_t *dec) {
+  if (!dec)
+    return;
+  if (dec->own_graph)
+    ldpc_graph_free((ldpc_graph_t *)dec->g);
+  free(dec->u);
+  free(dec->v);
+  free(dec->L);
+  free(dec->x);
+  free(dec->llr);
+  free(dec->phi_k);
+  free(dec->phi_tab);
+  ldpc_bf_free(dec->bf);
+  free(dec);
+}
 
-        double prod_sign = 1.0;
-        double sum_spf_val = 0.0;
+const ldpc_graph_t *ldpc_decoder_graph(const ldpc_decoder_t *dec) {
+  return dec->g;
+}
 
-        /* For each neighbor variable node (except j_idx) */
-        for (j = 0; j < deg_c[i]; j++) {
-          int var = check_node[i][j];
-          if (j != k) {
-            double x = LLR[var] + u[i][var];
-            prod_sign *= sign_val(x);
-            sum_spf_val += spf(fabs(x));
-          }
-        }
+void ldpc_decoder_set_kernel(ldpc_decoder_t *dec, ldpc_cn_kernel kernel,
+                             double param) {
+  dec->kernel = kernel;
+  dec->cn_param = param;
+}
 
-        v[i][j_idx] = prod_sign * spf(sum_spf_val);
-      }
+void ldpc_decoder_set_schedule(ldpc_decoder_t *dec, ldpc_schedule schedule) {
+  dec->schedule = schedule;
+}
+
+int ldpc_decoder_regular(const ldpc_decoder_t *dec, int *wc, int *wr) {
+  if (wc)
+    *wc = dec->reg_wc;
+  if (wr)
+    *wr = dec->reg_wr;
+  return dec->profile != 0;
+}
+
+void ldpc_decoder_set_specialized(ldpc_decoder_t *dec, int enable) {
+  dec->specialize = enable;
+}
+
+void ldpc_decoder_set_precision(ldpc_decoder_t *dec, ldpc_precision prec) {
+  dec->prec = prec;
+}
+
+ldpc_precision ldpc_decoder_precision(const ldpc_decoder_t *dec) {
+  return dec->prec;
+}
+
+void ldpc_decoder_set_hybrid(ldpc_decoder_t *dec, int bf_iter,
+                             ldpc_bf_mode mode, double param, int gate) {
+  if (bf_iter > 0 && !dec->bf)
+    dec->bf = ldpc_bf_create(dec->g, dec->K);
+  if (dec->bf) {
+    ldpc_bf_set_mode(dec->bf, mode, param);
+    ldpc_bf_set_gate(dec->bf, gate);
+  }
+  dec->bf_iter = bf_iter > 0 ? bf_iter : 0;
+}
+
+void ldpc_decoder_set_phi(ldpc_decoder_t *dec, ldpc_phi_mode mode) {
+  if (mode == LDPC_PHI_LUT && !dec->phi_tab) {
+    dec->phi_tab = (double *)malloc(PHI_LUT_SIZE * sizeof(double));
+    if (!dec->phi_tab) {
+      fprintf(stderr, "malloc failed in ldpc_decoder_set_phi\n");
+      exit(1);
     }
+    phi_lut_init(dec->phi_tab);
+  } else if (mode == LDPC_PHI_PWL) {
+    phi_pwl_init(dec->phi_slope, dec->phi_icpt);
+  }
+  dec->phi = mode;
+}
 
-    /* ------------------------ Variable node update ---------------- */
-    for (j = 0; j < N; j++) {
-      for (k = 0; k < deg_v[j]; k++) {
-
-        int i_idx = variable_node[j][k];
-        double sum_v = 0.0;
-
-        /* Sum messages from all checks except i_idx */
-        for (i = 0; i < deg_v[j]; i++) {
-          int cnode = variable_node[j][i];
-          if (i != k) {
-            sum_v += v[cnode][j];
-          }
-        }
-        u[i_idx][j] = sum_v;
-      }
+static const char *const phi_mode_names[] = {"exact", "lut", "pwl"};
+
+const char *ldpc_phi_mode_name(ldpc_phi_mode mode) {
+  if ((int)mode < 0 || (int)mode > LDPC_PHI_PWL)
+    return "unknown";
+  return phi_mode_names[mode];
+}
+
+int ldpc_phi_mode_parse(const char *name, ldpc_phi_mode *mode) {
+  for (int i = 0; i <= LDPC_PHI_PWL; i++) {
+    if (!strcmp(name, phi_mode_names[i])) {
+      *mode = (ldpc_phi_mode)i;
+      return 0;
     }
+  }
+  return -1;
+}
 
-    /* ------------------------ Tentative decision ------------------ */
-    for (j = 0; j < N; j++) {
-      double sum = LLR[j];
-      for (i = 0; i < deg_v[j]; i++) {
-        sum += v[variable_node[j][i]][j];
-      }
-      ecc[j] = (sum >= 0.0) ? 1 : 0;
+static const char *const precision_names[] = {"f64", "f32"};
+
+const char *ldpc_precision_name(ldpc_precision prec) {
+  if ((int)prec < 0 || (int)prec > LDPC_PREC_F32)
+    return "unknown";
+  return precision_names[prec];
+}
+
+int ldpc_precision_parse(const char *name, ldpc_precision *prec) {
+  for (int i = 0; i <= LDPC_PREC_F32; i++) {
+    if (!strcmp(name, precision_names[i])) {
+      *prec = (ldpc_precision)i;
+      return 0;
     }
+  }
+  return -1;
+}
 
-    /* ------------------------ Parity check H·ecc^T ---------------- */
-    int parity_ok = 1;
-    for (i = 0; i < M; i++) {
-      int parity = 0;
-      for (k = 0; k < deg_c[i]; k++) {
-        parity ^= ecc[check_node[i][k]];
-      }
-      if (parity != 0) {
-        parity_ok = 0;
-        break;
-      }
+static const char *const cn_kernel_names[] = {"spa", "minsum", "nms", "oms"};
+
+const char *ldpc_cn_kernel_name(ldpc_cn_kernel kernel) {
+  if ((int)kernel < 0 || (int)kernel > LDPC_CN_OMS)
+    return "unknown";
+  return cn_kernel_names[kernel];
+}
+
+int ldpc_cn_kernel_parse(const char *name, ldpc_cn_kernel *kernel) {
+  for (int i = 0; i <= LDPC_CN_OMS; i++) {
+    if (!strcmp(name, cn_kernel_names[i])) {
+      *kernel = (ldpc_cn_kernel)i;
+      return 0;
     }
+  }
+  return -1;
+}
 
-    /* Early stopping if all parity checks satisfied */
-    if (parity_ok) {
-      break;
+
+/* ========================================================================== */
+/* Parity check H·ecc^T                                                       */
+/* ========================================================================== */
+static int syndrome_is_zero(const ldpc_graph_t *g, const int *ecc) {
+  for (int i = 0; i < g->M; i++) {
+    int parity = 0;
+    for (int k = g->row_ptr[i]; k < g->row_ptr[i + 1]; k++) {
+      parity ^= ecc[g->col_idx[k]];
     }
+    if (parity != 0)
+      return 0;
   }
+  return 1;
+}
 
-  /* ------------------------------------------------------------------ */
-  /* Extract information bits (systematic part)                          */
-  /* Assumes: codeword layout = [parity bits (N-K) | info bits (K)]      */
-  /* ------------------------------------------------------------------ */
-  for (i = 0; i < K; i++) {
-    inf[i] = ecc[i + (N - K)];
+/* Number of unsatisfied checks (statistics trace) */
+static int syndrome_weight(const ldpc_graph_t *g, const int *ecc) {
+  int w = 0;
+  for (int i = 0; i < g->M; i++) {
+    int parity = 0;
+    for (int k = g->row_ptr[i]; k < g->row_ptr[i + 1]; k++)
+      parity ^= ecc[g->col_idx[k]];
+    w += parity;
   }
+  return w;
+}
+
+/* ========================================================================== */
+/* Statistics helpers (only reached with stats != NULL)                       */
+/* ========================================================================== */
+static inline uint64_t stats_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Charge the time since *t to *acc and restart the clock */
+static inline void stats_lap(uint64_t *acc, uint64_t *t) {
+  uint64_t now = stats_now();
+  *acc += now - *t;
+  *t = now;
+}
+
+/* Parity check of iteration iter; records the trace and the phase time */
+ALWAYS_INLINE int check_syndrome(const ldpc_graph_t *g, const int *ecc,
+                                 int iter, ldpc_decoder_stats_t *stats,
+                                 uint64_t *t) {
+  int ok;
+  if (stats && stats->unsat) {
+    stats->unsat[iter] = syndrome_weight(g, ecc);
+    ok = (stats->unsat[iter] == 0);
+  } else {
+    ok = syndrome_is_zero(g, ecc);
+  }
+  if (stats)
+    stats_lap(&stats->syn_ns, t);
+  return ok;
+}
+
+/* ========================================================================== */
+/* Precision instantiations                                                   */
+/* ========================================================================== */
+#define RT double
+#define RSUF f64
+#define RABS fabs
+#include "ldpc_decoder_impl.h"
+#undef RT
+#undef RSUF
+#undef RABS
+
+#define RT float
+#define RSUF f32
+#define RABS fabsf
+#include "ldpc_decoder_impl.h"
+#undef RT
+#undef RSUF
+#undef RABS
+
+/* ========================================================================== */
+/* Frame decoding with a prebuilt context                                     */
+/* ========================================================================== */
+/*
+ * The channel LLRs are converted once per frame when their type differs
+ * from the message precision (dec->llr), so both input types run the same
+ * loops.
+ */
+static const float *llr_to_f32(ldpc_decoder_t *dec, const double *LLR) {
+  float *l = (float *)dec->llr;
+  for (int j = 0; j < dec->g->N; j++)
+    l[j] = (float)LLR[j];
+  return l;
+}
+
+static const double *llr_to_f64(ldpc_decoder_t *dec, const float *LLR) {
+  double *l = (double *)dec->llr;
+  for (int j = 0; j < dec->g->N; j++)
+    l[j] = LLR[j];
+  return l;
+}
 
-  /* ------------------------------------------------------------------ */
-  /* Memory cleanup                                                     */
-  /* ------------------------------------------------------------------ */
-  for (i = 0; i < M; i++) {
-    free(check_node[i]);
+/*
+ * Hybrid front end (dec->bf_iter > 0): bit flipping on the double LLRs.
+ * Returns 1 if it settled the frame; ecc / inf then hold its result and
+ * the soft decoder is skipped.
+ */
+static int bitflip_first(ldpc_decoder_t *dec, const double *LLR, int *ecc,
+                         int *inf, ldpc_decoder_stats_t *stats) {
+  uint64_t t = stats ? stats_now() : 0;
+  int it = ldpc_bf_decode(dec->bf, LLR, ecc, inf, dec->bf_iter);
+  int ok = (ldpc_bf_unsat(dec->bf) == 0);
+
+  if (stats) {
+    stats->bf_ns = stats_now() - t;
+    stats->bf_iterations = it;
+    stats->fallback = !ok;
+    if (ok) {
+      stats->iterations = 0;
+      stats->converged = 1;
+      stats->cn_ns = stats->vn_ns = stats->syn_ns = 0;
+    }
   }
-  free(check_node);
+  return ok;
+}
+
+/* Statistics of a frame decoded without the front end */
+static void stats_soft_only(ldpc_decoder_stats_t *stats) {
+  stats->bf_iterations = 0;
+  stats->fallback = 1;
+  stats->bf_ns = 0;
+}
 
-  for (j = 0; j < N; j++) {
-    free(variable_node[j]);
+int ldpc_decoder_decode(ldpc_decoder_t *dec, const double *LLR, int *ecc,
+                        int *inf, int max_iter) {
+  if (dec->bf_iter > 0 && bitflip_first(dec, LLR, ecc, inf, NULL))
+    return 0;
+  if (dec->prec == LDPC_PREC_F32)
+    return decode_f32(dec, llr_to_f32(dec, LLR), ecc, inf, max_iter);
+  return decode_f64(dec, LLR, ecc, inf, max_iter);
+}
+
+int ldpc_decoder_decode_stats(ldpc_decoder_t *dec, const double *LLR,
+                              int *ecc, int *inf, int max_iter,
+                              ldpc_decoder_stats_t *stats) {
+  if (dec->bf_iter > 0) {
+    if (bitflip_first(dec, LLR, ecc, inf, stats))
+      return 0;
+  } else {
+    stats_soft_only(stats);
   }
-  free(variable_node);
+  if (dec->prec == LDPC_PREC_F32)
+    return decode_stats_f32(dec, llr_to_f32(dec, LLR), ecc, inf, max_iter,
+                            stats);
+  return decode_stats_f64(dec, LLR, ecc, inf, max_iter, stats);
+}
 
-  free(deg_c);
-  free(deg_v);
+/* The front end reads double LLRs: float input is converted for it too */
+int ldpc_decoder_decode_f32(ldpc_decoder_t *dec, const float *LLR, int *ecc,
+                            int *inf, int max_iter) {
+  const double *l = NULL;
+  if (dec->prec == LDPC_PREC_F64 || dec->bf_iter > 0)
+    l = llr_to_f64(dec, LLR);
+  if (dec->bf_iter > 0 && bitflip_first(dec, l, ecc, inf, NULL))
+    return 0;
+  if (dec->prec == LDPC_PREC_F64)
+    return decode_f64(dec, l, ecc, inf, max_iter);
+  return decode_f32(dec, LLR, ecc, inf, max_iter);
+}
 
-  for (i = 0; i < M; i++) {
-    free(u[i]);
-    free(v[i]);
+int ldpc_decoder_decode_f32_stats(ldpc_decoder_t *dec, const float *LLR,
+                                  int *ecc, int *inf, int max_iter,
+                                  ldpc_decoder_stats_t *stats) {
+  const double *l = NULL;
+  if (dec->prec == LDPC_PREC_F64 || dec->bf_iter > 0)
+    l = llr_to_f64(dec, LLR);
+  if (dec->bf_iter > 0) {
+    if (bitflip_first(dec, l, ecc, inf, stats))
+      return 0;
+  } else {
+    stats_soft_only(stats);
   }
-  free(u);
-  free(v);
+  if (dec->prec == LDPC_PREC_F64)
+    return decode_stats_f64(dec, l, ecc, inf, max_iter, stats);
+  return decode_stats_f32(dec, LLR, ecc, inf, max_iter, stats);
+}
+
+/* ========================================================================== */
+/* One-shot SPA decoding (compatibility wrapper)                              */
+/* ========================================================================== */
+/**
+ * @brief Decode one frame directly from a dense H.
+ *
+ * Builds a temporary decoder context, decodes, and releases it. Intended
+ * for occasional calls; frame loops should keep an ldpc_decoder_t alive.
+ */
+void ldpc_decode_spa(double *LLR, int *ecc, int *inf, int **H, int M, int N,
+                     int K, int max_iter) {
+  ldpc_decoder_t *dec = ldpc_decoder_create(H, M, N, K);
+  ldpc_decoder_decode(dec, LLR, ecc, inf, max_iter);
+  ldpc_decoder_free(dec);
+}
+
+int ldpc_decode_spa_stats(double *LLR, int *ecc, int *inf, int **H, int M,
+                          int N, int K, int max_iter,
+                          ldpc_decoder_stats_t *stats) {
+  ldpc_decoder_t *dec = ldpc_decoder_create(H, M, N, K);
+  int iters = stats ? ldpc_decoder_decode_stats(dec, LLR, ecc, inf, max_iter,
+                                                stats)
+                    : ldpc_decoder_decode(dec, LLR, ecc, inf, max_iter);
+  ldpc_decoder_free(dec);
+  return iters;
 }
 
 /* ========================================================================== */
@@ -292,19 +659,9 @@ void compute_llr_from_pyx(double **pyx, int E, int N, double *LLR) {
   int logE =
       (int)log2((double)E); /* bits per symbol, assumes E is power of 2 */
 
-  /* ------------------------------------------------------ */
-  /* Precompute bit labels for each symbol index k          */
-  /* ------------------------------------------------------ */
-  int **symbol_bits = (int **)malloc(E * sizeof(int *));
-  for (k = 0; k < E; k++) {
-    symbol_bits[k] = (int *)malloc(logE * sizeof(int));
-    for (b = 0; b < logE; b++) {
-      symbol_bits[k][b] = (k >> b) & 1;
-    }
-  }
-
   /* ------------------------------------------------------ */
   /* Compute bit-wise LLR for each bit position and symbol  */
+  /* (bit b of symbol index k is (k >> b) & 1)              */
   /* ------------------------------------------------------ */
   for (i = 0; i < N; i++) {
     for (b = 0; b < logE; b++) {
@@ -313,7 +670,7 @@ void compute_llr_from_pyx(double **pyx, int E, int N, double *LLR) {
       double p0 = 0.0;
 
       for (k = 0; k < E; k++) {
-        if (symbol_bits[k][b])
+        if ((k >> b) & 1)
           p1 += pyx[k][i];
         else
           p0 += pyx[k][i];
@@ -328,10 +685,4 @@ void compute_llr_from_pyx(double **pyx, int E, int N, double *LLR) {
       LLR[b + i * logE] = log(p1 / p0);
     }
   }
-
-  /* cleanup */
-  for (k = 0; k < E; k++) {
-    free(symbol_bits[k]);
-  }
-  free(symbol_bits);
 }
@@ -0,0 +1,606 @@
+/**
+ * @file ldpc_decoder_impl.h
+ * @brief Precision-generic body of the message-passing decoder (internal).
+ *
+ * Included by ldpc_decoder.c once per message precision with:
+ *
+ *   RT   : LLR / message type (double or float)
+ *   RSUF : function-name suffix (f64 or f32)
+ *   RABS : absolute value of an RT (fabs or fabsf)
+ *
+ * The channel LLRs, the V→C / C→V messages, the posterior and the row
+ * scratch are all RT. The SPA nonlinearity (spf(), LUT, PWL) is evaluated
+ * in double in both precisions: its cost is the exp() / log() or the table
+ * lookup, not the element width, and float exp() loses the small-x
+ * behaviour that the clipping of spf() relies on.
+ */
+
+#define RFN__(name, suf) name##_##suf
+#define RFN_(name, suf) RFN__(name, suf)
+#define RFN(name) RFN_(name, RSUF)
+
+/* ========================================================================== */
+/* Check-node row kernels                                                     */
+/* ========================================================================== */
+/*
+ * Each kernel maps the d incoming V→C values x[0..d-1] of one check to its
+ * d outgoing C→V messages out[0..d-1]. The schedules below only differ in
+ * how x is formed and where out is accumulated.
+ */
+
+/* Sign of x (+1 or -1), treating zero as positive. */
+static inline RT RFN(sign_val)(RT x) { return (x >= (RT)0) ? (RT)1 : (RT)-1; }
+
+/* Exact SPA: for every edge, combine all other edges of the row. */
+static void RFN(cn_row_spa)(const RT *x, RT *out, int d) {
+  for (int k = 0; k < d; k++) {
+
+    RT prod_sign = 1;
+    double sum_spf_val = 0.0;
+
+    /* For each neighbor variable node (except the target edge) */
+    for (int j = 0; j < d; j++) {
+      if (j != k) {
+        prod_sign *= RFN(sign_val)(x[j]);
+        sum_spf_val += spf(RABS(x[j]));
+      }
+    }
+
+    out[k] = prod_sign * (RT)spf(sum_spf_val);
+  }
+}
+
+/*
+ * SPA with a fast spf(), "total minus self" form:
+ *
+ *   φ_k  = spf(|x_k|)                  (once per edge)
+ *   S    = Σ_k φ_k,  s = Π_k sign(x_k)
+ *   out_k = s · sign(x_k) · spf(S − φ_k)
+ *
+ * 2·d spf() evaluations per row instead of d² for cn_row_spa(). The
+ * subtraction loses precision when one φ_k dominates S, which the table /
+ * PWL resolution already exceeds, so it is only used with LUT / PWL.
+ */
+static void RFN(cn_row_spa_fast)(const ldpc_decoder_t *dec, const RT *x,
+                                 RT *out, int d) {
+  double S = 0.0;
+  RT prod_sign = 1;
+
+  for (int k = 0; k < d; k++) {
+    double a = RABS(x[k]);
+    double p = (dec->phi == LDPC_PHI_LUT)
+                   ? phi_lut(dec->phi_tab, a)
+                   : phi_pwl(dec->phi_slope, dec->phi_icpt, a);
+    prod_sign *= RFN(sign_val)(x[k]);
+    dec->phi_k[k] = p;
+    S += p;
+  }
+
+  for (int k = 0; k < d; k++) {
+    double r = S - dec->phi_k[k];
+    double p = (dec->phi == LDPC_PHI_LUT)
+                   ? phi_lut(dec->phi_tab, r)
+                   : phi_pwl(dec->phi_slope, dec->phi_icpt, r);
+    out[k] = prod_sign * RFN(sign_val)(x[k]) * (RT)p;
+  }
+}
+
+/*
+ * Min-sum family, single pass per row:
+ *
+ *   pass 1: sign product s, smallest magnitude min1 (at edge k_min),
+ *           second smallest magnitude min2
+ *   pass 2: out[k] = s · sign(x_k) · g( k == k_min ? min2 : min1 )
+ *
+ * with g(m) = m (MS), α·m (NMS) or max(m − β, 0) (OMS).
+ */
+static void RFN(cn_row_minsum)(const RT *x, RT *out, int d,
+                               ldpc_cn_kernel kernel, RT param) {
+  RT min1 = (RT)HUGE_VAL, min2 = (RT)HUGE_VAL;
+  RT prod_sign = 1;
+  int k_min = 0;
+
+  for (int k = 0; k < d; k++) {
+    RT a = RABS(x[k]);
+    prod_sign *= RFN(sign_val)(x[k]);
+    if (a < min1) {
+      min2 = min1;
+      min1 = a;
+      k_min = k;
+    } else if (a < min2) {
+      min2 = a;
+    }
+  }
+  if (d == 1)
+    min2 = (RT)LDPC_CN_DEG1_MAG;
+
+  /* magnitude correction applied once per row, not per edge */
+  if (kernel == LDPC_CN_NMS) {
+    min1 *= param;
+    min2 *= param;
+  } else if (kernel == LDPC_CN_OMS) {
+    min1 = (min1 > param) ? min1 - param : (RT)0;
+    min2 = (min2 > param) ? min2 - param : (RT)0;
+  }
+
+  for (int k = 0; k < d; k++) {
+    RT mag = (k == k_min) ? min2 : min1;
+    out[k] = prod_sign * RFN(sign_val)(x[k]) * mag;
+  }
+}
+
+static inline void RFN(cn_row)(const ldpc_decoder_t *dec, const RT *x,
+                               RT *out, int d) {
+  if (dec->kernel == LDPC_CN_SPA && dec->phi == LDPC_PHI_EXACT)
+    RFN(cn_row_spa)(x, out, d);
+  else if (dec->kernel == LDPC_CN_SPA)
+    RFN(cn_row_spa_fast)(dec, x, out, d);
+  else
+    RFN(cn_row_minsum)(x, out, d, dec->kernel, (RT)dec->cn_param);
+}
+
+/* ========================================================================== */
+/* Flooding schedule                                                          */
+/* ========================================================================== */
+/**
+ * @brief LDPC decoding using message passing (LLR-domain, flooding).
+ *
+ * Tanner graph:
+ *   - H: M×N parity-check matrix (held as CSR/CSC edge lists)
+ *   - Variable nodes: N
+ *   - Check nodes   : M
+ *
+ * Message notation (e = edge between check i and variable j):
+ *   - u[e] : message from variable node j → check node i (extrinsic LLR)
+ *   - v[e] : message from check node i → variable node j (extrinsic LLR)
+ *
+ * Decoding steps per iteration:
+ *   1) Check-node update (SPA or min-sum family, see ldpc_cn_kernel):
+ *        v[i][j] = f({ LLR[j'] + u[i][j'] | j' ≠ j, H[i][j']=1 })
+ *   2) Variable-node update:
+ *        u[i][j] = Σ_{i'≠i} v[i'][j]
+ *   3) A-posteriori LLR:
+ *        L_post[j] = LLR[j] + Σ_i v[i][j]
+ *      → hard decision ecc[j] = (L_post[j] >= 0) ? 1 : 0
+ *   4) Parity check:
+ *        If H·ecc^T = 0, stop early.
+ */
+ALWAYS_INLINE int RFN(decode_flooding)(ldpc_decoder_t *dec, const RT *LLR,
+                                       int *ecc, int max_iter,
+                                       ldpc_decoder_stats_t *stats) {
+  const ldpc_graph_t *g = dec->g;
+  const int M = g->M;
+  const int N = g->N;
+  const int E = g->n_edges;
+  const int *row_ptr = g->row_ptr;
+  const int *col_idx = g->col_idx;
+  const int *col_ptr = g->col_ptr;
+  const int *col_edge = g->col_edge;
+  RT *u = (RT *)dec->u;
+  RT *v = (RT *)dec->v;
+  RT *x = (RT *)dec->x;
+  int i, j, k, iter;
+  uint64_t t = stats ? stats_now() : 0;
+
+  /* all messages start at zero (no a-priori information) */
+  for (k = 0; k < E; k++) {
+    u[k] = 0;
+    v[k] = 0;
+  }
+
+  for (iter = 0; iter < max_iter; iter++) {
+
+    /* ------------------------ Check node update ------------------- */
+    for (i = 0; i < M; i++) {
+      const int e0 = row_ptr[i];
+      const int d = row_ptr[i + 1] - e0;
+
+      for (k = 0; k < d; k++)
+        x[k] = LLR[col_idx[e0 + k]] + u[e0 + k];
+
+      RFN(cn_row)(dec, x, v + e0, d);
+    }
+    if (stats)
+      stats_lap(&stats->cn_ns, &t);
+
+    /* ------------------------ Variable node update ---------------- */
+    for (j = 0; j < N; j++) {
+      const int s0 = col_ptr[j];
+      const int s1 = col_ptr[j + 1];
+
+      for (k = s0; k < s1; k++) {
+        RT sum_v = 0;
+
+        /* Sum messages from all checks except the target edge */
+        for (i = s0; i < s1; i++) {
+          if (i != k) {
+            sum_v += v[col_edge[i]];
+          }
+        }
+        u[col_edge[k]] = sum_v;
+      }
+    }
+
+    /* ------------------------ Tentative decision ------------------ */
+    for (j = 0; j < N; j++) {
+      RT sum = LLR[j];
+      for (i = col_ptr[j]; i < col_ptr[j + 1]; i++) {
+        sum += v[col_edge[i]];
+      }
+      ecc[j] = (sum >= (RT)0) ? 1 : 0;
+    }
+    if (stats)
+      stats_lap(&stats->vn_ns, &t);
+
+    /* Early stopping if all parity checks satisfied */
+    if (check_syndrome(g, ecc, iter, stats, &t)) {
+      if (stats)
+        stats->converged = 1;
+      return iter + 1;
+    }
+  }
+  return max_iter;
+}
+
+/* ========================================================================== */
+/* Layered (TDMP) schedule                                                    */
+/* ========================================================================== */
+/**
+ * @brief Layered / turbo-decoding message passing.
+ *
+ * A running a-posteriori LLR L[j] is kept per variable and only the C→V
+ * messages v[e] are stored. The layers of the graph (row blocks that touch
+ * every column at most once, see ldpc_graph_t) are processed in order; for
+ * every check i of a layer:
+ *
+ *   1) extrinsic input:   x_e   = L[j] − v[e]
+ *   2) check update:      v[e]  = f({ x_e' | e' ≠ e })
+ *   3) posterior update:  L[j]  = x_e + v[e]
+ *
+ * Checks inside a layer share no variable, so they may be processed in any
+ * order. Each layer immediately benefits from the updates of the previous
+ * one, which roughly halves the number of iterations compared to flooding.
+ */
+ALWAYS_INLINE int RFN(decode_layered)(ldpc_decoder_t *dec, const RT *LLR,
+                                      int *ecc, int max_iter,
+                                      ldpc_decoder_stats_t *stats) {
+  const ldpc_graph_t *g = dec->g;
+  const int N = g->N;
+  const int E = g->n_edges;
+  const int *row_ptr = g->row_ptr;
+  const int *col_idx = g->col_idx;
+  RT *v = (RT *)dec->v;
+  RT *L = (RT *)dec->L;
+  RT *x = (RT *)dec->x;
+  int j, k, l, iter;
+  uint64_t t = stats ? stats_now() : 0;
+
+  for (k = 0; k < E; k++)
+    v[k] = 0;
+  for (j = 0; j < N; j++)
+    L[j] = LLR[j];
+
+  for (iter = 0; iter < max_iter; iter++) {
+
+    for (l = 0; l < g->n_layers; l++) {
+      for (int i = g->layer_ptr[l]; i < g->layer_ptr[l + 1]; i++) {
+        const int e0 = row_ptr[i];
+        const int d = row_ptr[i + 1] - e0;
+
+        for (k = 0; k < d; k++)
+          x[k] = L[col_idx[e0 + k]] - v[e0 + k];
+
+        RFN(cn_row)(dec, x, v + e0, d);
+
+        for (k = 0; k < d; k++)
+          L[col_idx[e0 + k]] = x[k] + v[e0 + k];
+      }
+    }
+    if (stats)
+      stats_lap(&stats->cn_ns, &t);
+
+    /* ------------------------ Tentative decision ------------------ */
+    for (j = 0; j < N; j++)
+      ecc[j] = (L[j] >= (RT)0) ? 1 : 0;
+    if (stats)
+      stats_lap(&stats->vn_ns, &t);
+
+    if (check_syndrome(g, ecc, iter, stats, &t)) {
+      if (stats)
+        stats->converged = 1;
+      return iter + 1;
+    }
+  }
+  return max_iter;
+}
+
+/* ========================================================================== */
+/* Degree-specialized schedules (min-sum family)                              */
+/* ========================================================================== */
+/*
+ * The same layered and flooding schedules for a (DV, DC) degree profile
+ * known at compile time. Rows of degree DC and columns of degree DV,
+ * i.e. all of them for a regular code, have their loops fully unrolled,
+ * their row extrinsics x[] and column messages in local arrays that the
+ * compiler keeps in registers, and a branchless min1 / min2 search (min /
+ * max instead of the data-dependent branches of cn_row_minsum()). Rows
+ * and columns of any other degree take the generic loops. The arithmetic
+ * and its order are those of the generic path, so the results are
+ * bit-identical. (No specialized profile has degree-1 rows, so the
+ * LDPC_CN_DEG1_MAG case of cn_row_minsum() is not needed here.)
+ */
+
+ALWAYS_INLINE void RFN(cn_row_minsum_reg)(const RT *x, RT *out, const int D,
+                                          ldpc_cn_kernel kernel, RT param) {
+  RT min1 = (RT)HUGE_VAL, min2 = (RT)HUGE_VAL;
+  RT prod_sign = 1;
+  int k_min = 0;
+
+#pragma GCC unroll 16
+  for (int k = 0; k < D; k++) {
+    RT a = RABS(x[k]);
+    prod_sign *= RFN(sign_val)(x[k]);
+    /* = the branches of cn_row_minsum(), including ties */
+    RT hi = (a < min1) ? min1 : a;
+    min2 = (hi < min2) ? hi : min2;
+    k_min = (a < min1) ? k : k_min;
+    min1 = (a < min1) ? a : min1;
+  }
+
+  if (kernel == LDPC_CN_NMS) {
+    min1 *= param;
+    min2 *= param;
+  } else if (kernel == LDPC_CN_OMS) {
+    min1 = (min1 > param) ? min1 - param : (RT)0;
+    min2 = (min2 > param) ? min2 - param : (RT)0;
+  }
+
+#pragma GCC unroll 16
+  for (int k = 0; k < D; k++) {
+    RT mag = (k == k_min) ? min2 : min1;
+    out[k] = prod_sign * RFN(sign_val)(x[k]) * mag;
+  }
+}
+
+ALWAYS_INLINE int RFN(decode_layered_reg)(ldpc_decoder_t *dec, const RT *LLR,
+                                          int *ecc, int max_iter,
+                                          ldpc_decoder_stats_t *stats,
+                                          const int DC) {
+  const ldpc_graph_t *g = dec->g;
+  const int N = g->N;
+  const int E = g->n_edges;
+  const int *row_ptr = g->row_ptr;
+  const int *col_idx = g->col_idx;
+  const ldpc_cn_kernel kernel = dec->kernel;
+  const RT param = (RT)dec->cn_param;
+  RT *v = (RT *)dec->v;
+  RT *L = (RT *)dec->L;
+  RT *xg = (RT *)dec->x;
+  int j, k, iter;
+  uint64_t t = stats ? stats_now() : 0;
+
+  for (k = 0; k < E; k++)
+    v[k] = 0;
+  for (j = 0; j < N; j++)
+    L[j] = LLR[j];
+
+  for (iter = 0; iter < max_iter; iter++) {
+
+    for (int l = 0; l < g->n_layers; l++) {
+      for (int i = g->layer_ptr[l]; i < g->layer_ptr[l + 1]; i++) {
+        const int e0 = row_ptr[i];
+        const int d = row_ptr[i + 1] - e0;
+        const int *col = col_idx + e0;
+
+        if (d == DC) {
+          RT x[DC];
+#pragma GCC unroll 16
+          for (k = 0; k < DC; k++)
+            x[k] = L[col[k]] - v[e0 + k];
+
+          RFN(cn_row_minsum_reg)(x, v + e0, DC, kernel, param);
+
+#pragma GCC unroll 16
+          for (k = 0; k < DC; k++)
+            L[col[k]] = x[k] + v[e0 + k];
+        } else {
+          for (k = 0; k < d; k++)
+            xg[k] = L[col[k]] - v[e0 + k];
+
+          RFN(cn_row_minsum)(xg, v + e0, d, kernel, param);
+
+          for (k = 0; k < d; k++)
+            L[col[k]] = xg[k] + v[e0 + k];
+        }
+      }
+    }
+    if (stats)
+      stats_lap(&stats->cn_ns, &t);
+
+    for (j = 0; j < N; j++)
+      ecc[j] = (L[j] >= (RT)0) ? 1 : 0;
+    if (stats)
+      stats_lap(&stats->vn_ns, &t);
+
+    if (check_syndrome(g, ecc, iter, stats, &t)) {
+      if (stats)
+        stats->converged = 1;
+      return iter + 1;
+    }
+  }
+  return max_iter;
+}
+
+ALWAYS_INLINE int RFN(decode_flooding_reg)(ldpc_decoder_t *dec, const RT *LLR,
+                                           int *ecc, int max_iter,
+                                           ldpc_decoder_stats_t *stats,
+                                           const int DV, const int DC) {
+  const ldpc_graph_t *g = dec->g;
+  const int M = g->M;
+  const int N = g->N;
+  const int E = g->n_edges;
+  const int *row_ptr = g->row_ptr;
+  const int *col_idx = g->col_idx;
+  const int *col_ptr = g->col_ptr;
+  const int *col_edge = g->col_edge;
+  const ldpc_cn_kernel kernel = dec->kernel;
+  const RT param = (RT)dec->cn_param;
+  RT *u = (RT *)dec->u;
+  RT *v = (RT *)dec->v;
+  RT *xg = (RT *)dec->x;
+  int i, j, k, iter;
+  uint64_t t = stats ? stats_now() : 0;
+
+  for (k = 0; k < E; k++) {
+    u[k] = 0;
+    v[k] = 0;
+  }
+
+  for (iter = 0; iter < max_iter; iter++) {
+
+    /* ------------------------ Check node update ------------------- */
+    for (i = 0; i < M; i++) {
+      const int e0 = row_ptr[i];
+      const int d = row_ptr[i + 1] - e0;
+
+      if (d == DC) {
+        RT x[DC];
+#pragma GCC unroll 16
+        for (k = 0; k < DC; k++)
+          x[k] = LLR[col_idx[e0 + k]] + u[e0 + k];
+
+        RFN(cn_row_minsum_reg)(x, v + e0, DC, kernel, param);
+      } else {
+        for (k = 0; k < d; k++)
+          xg[k] = LLR[col_idx[e0 + k]] + u[e0 + k];
+
+        RFN(cn_row_minsum)(xg, v + e0, d, kernel, param);
+      }
+    }
+    if (stats)
+      stats_lap(&stats->cn_ns, &t);
+
+    /* ------------- Variable node update and tentative decision ---- */
+    for (j = 0; j < N; j++) {
+      const int s0 = col_ptr[j];
+      const int s1 = col_ptr[j + 1];
+      RT sum = LLR[j];
+
+      if (s1 - s0 == DV) {
+        const int *ce = col_edge + s0;
+        RT m[DV];
+#pragma GCC unroll 16
+        for (k = 0; k < DV; k++)
+          m[k] = v[ce[k]];
+
+#pragma GCC unroll 16
+        for (k = 0; k < DV; k++) {
+          RT sum_v = 0;
+#pragma GCC unroll 16
+          for (i = 0; i < DV; i++) {
+            if (i != k)
+              sum_v += m[i];
+          }
+          u[ce[k]] = sum_v;
+        }
+
+#pragma GCC unroll 16
+        for (i = 0; i < DV; i++)
+          sum += m[i];
+      } else {
+        for (k = s0; k < s1; k++) {
+          RT sum_v = 0;
+          for (i = s0; i < s1; i++) {
+            if (i != k)
+              sum_v += v[col_edge[i]];
+          }
+          u[col_edge[k]] = sum_v;
+        }
+        for (i = s0; i < s1; i++)
+          sum += v[col_edge[i]];
+      }
+      ecc[j] = (sum >= (RT)0) ? 1 : 0;
+    }
+    if (stats)
+      stats_lap(&stats->vn_ns, &t);
+
+    if (check_syndrome(g, ecc, iter, stats, &t)) {
+      if (stats)
+        stats->converged = 1;
+      return iter + 1;
+    }
+  }
+  return max_iter;
+}
+
+/* ========================================================================== */
+/* Frame decoding with a prebuilt context                                     */
+/* ========================================================================== */
+/**
+ * @param dec      Decoder context (graph + message storage)
+ * @param LLR      Input channel LLRs for each code bit (length N)
+ * @param ecc      Output decoded codeword bits (length N, 0/1)
+ * @param inf      Output decoded information bits (length K, 0/1)
+ * @param max_iter Maximum number of iterations
+ * @return         Iterations used (max_iter if the syndrome never vanished)
+ *
+ * Finally, the information part is extracted assuming:
+ *      codeword = [parity (N-K bits) | info (K bits)]
+ */
+ALWAYS_INLINE int RFN(decode_frame)(ldpc_decoder_t *dec, const RT *LLR,
+                                    int *ecc, int *inf, int max_iter,
+                                    ldpc_decoder_stats_t *stats) {
+  const int N = dec->g->N;
+  const int K = dec->K;
+  int iters;
+
+  if (stats) {
+    stats->converged = 0;
+    stats->cn_ns = stats->vn_ns = stats->syn_ns = 0;
+  }
+
+  switch ((dec->kernel == LDPC_CN_SPA || !dec->specialize) ? 0
+                                                           : dec->profile) {
+#define LDPC_PROFILE_CASE(id, dv, dc)                                         \
+  case id:                                                                    \
+    iters = (dec->schedule == LDPC_SCHED_LAYERED)                             \
+                ? RFN(decode_layered_reg)(dec, LLR, ecc, max_iter, stats, dc) \
+                : RFN(decode_flooding_reg)(dec, LLR, ecc, max_iter, stats,    \
+                                           dv, dc);                           \
+    break;
+    LDPC_DECODER_PROFILES(LDPC_PROFILE_CASE)
+#undef LDPC_PROFILE_CASE
+  default:
+    if (dec->schedule == LDPC_SCHED_LAYERED)
+      iters = RFN(decode_layered)(dec, LLR, ecc, max_iter, stats);
+    else
+      iters = RFN(decode_flooding)(dec, LLR, ecc, max_iter, stats);
+  }
+
+  /* ------------------------------------------------------------------ */
+  /* Extract information bits (systematic part)                          */
+  /* Assumes: codeword layout = [parity bits (N-K) | info bits (K)]      */
+  /* ------------------------------------------------------------------ */
+  for (int i = 0; i < K; i++) {
+    inf[i] = ecc[i + (N - K)];
+  }
+  if (stats)
+    stats->iterations = iters;
+  return iters;
+}
+
+/* The two instantiations of this precision: plain and with statistics */
+static int RFN(decode)(ldpc_decoder_t *dec, const RT *LLR, int *ecc, int *inf,
+                       int max_iter) {
+  return RFN(decode_frame)(dec, LLR, ecc, inf, max_iter, NULL);
+}
+
+static int RFN(decode_stats)(ldpc_decoder_t *dec, const RT *LLR, int *ecc,
+                             int *inf, int max_iter,
+                             ldpc_decoder_stats_t *stats) {
+  return RFN(decode_frame)(dec, LLR, ecc, inf, max_iter, stats);
+}
+
+#undef RFN
+#undef RFN_
+#undef RFN__
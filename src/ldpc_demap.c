@@ -0,0 +1,315 @@
+/**
+ * @file ldpc_demap.c
+ * @brief Exact and max-log soft demappers for QAM, PSK and custom
+ *        constellations.
+ *
+ * This module provides:
+ *   - Gray QAM (as two PAMs), Gray PSK and custom point sets
+ *   - A block kernel: for LDPC_DEMAP_BLOCK symbols, every point's metric
+ *     is computed for all symbols of the block at once and folded into
+ *     per-bit running maxima (max-log) or, in a second pass, into per-bit
+ *     sums of exp(metric − max) (exact)
+ *   - Output stages for double, batch-lane float and quantized LLRs
+ */
+
+#include "ldpc_demap.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+
+#define B LDPC_DEMAP_BLOCK
+#define MAX_BITS 12 /* 4096-QAM */
+
+struct ldpc_demapper {
+  ldpc_mod_kind kind;
+  int order;
+  int m;         /* bits per symbol                               */
+  int separable; /* QAM: I and Q demapped as two PAMs             */
+  int n_pam;     /* levels per dimension (separable)              */
+  int m_pam;     /* bits per dimension (separable)                */
+  double *pam;   /* [n_pam] level of PAM label k                  */
+  double *iq;    /* [2 · order] point of label k                  */
+};
+
+/* ========================================================================== */
+/* Constellations                                                             */
+/* ========================================================================== */
+static int log2_exact(int n) {
+  int m = 0;
+  while ((1 << m) < n)
+    m++;
+  return (n >= 1 && (1 << m) == n) ? m : -1;
+}
+
+static ldpc_demapper_t *demapper_alloc(ldpc_mod_kind kind, int order) {
+  ldpc_demapper_t *dm = (ldpc_demapper_t *)calloc(1, sizeof(ldpc_demapper_t));
+  if (!dm) {
+    fprintf(stderr, "malloc failed in ldpc_demapper_create\n");
+    exit(1);
+  }
+  dm->kind = kind;
+  dm->order = order;
+  dm->m = log2_exact(order);
+  dm->iq = (double *)malloc(2 * (size_t)order * sizeof(double));
+  if (!dm->iq) {
+    fprintf(stderr, "malloc failed in ldpc_demapper_create\n");
+    exit(1);
+  }
+  return dm;
+}
+
+ldpc_demapper_t *ldpc_demapper_create(ldpc_mod_kind kind, int order) {
+  int m = log2_exact(order);
+  if (m < 1)
+    return NULL;
+
+  if (kind == LDPC_MOD_PSK) {
+    if (order > LDPC_DEMAP_MAX_POINTS)
+      return NULL;
+    ldpc_demapper_t *dm = demapper_alloc(kind, order);
+    double phi0 = (order == 2) ? M_PI : M_PI / order;
+    for (int p = 0; p < order; p++) {
+      int k = p ^ (p >> 1); /* Gray label of position p */
+      dm->iq[2 * k] = cos(2.0 * M_PI * p / order + phi0);
+      dm->iq[2 * k + 1] = sin(2.0 * M_PI * p / order + phi0);
+    }
+    return dm;
+  }
+
+  /* square QAM: two Gray PAMs of n levels, unit average energy */
+  if (m % 2 || m > MAX_BITS)
+    return NULL;
+  int n = 1 << (m / 2);
+  if (n > LDPC_DEMAP_MAX_LEVELS)
+    return NULL;
+  ldpc_demapper_t *dm = demapper_alloc(kind, order);
+  dm->separable = 1;
+  dm->n_pam = n;
+  dm->m_pam = m / 2;
+  dm->pam = (double *)malloc((size_t)n * sizeof(double));
+  if (!dm->pam) {
+    fprintf(stderr, "malloc failed in ldpc_demapper_create\n");
+    exit(1);
+  }
+  double scale = sqrt(3.0 / (2.0 * ((double)n * n - 1.0)));
+  for (int j = 0; j < n; j++)
+    dm->pam[j ^ (j >> 1)] = (2 * j - (n - 1)) * scale;
+  for (int k = 0; k < order; k++) {
+    dm->iq[2 * k] = dm->pam[k & (n - 1)];
+    dm->iq[2 * k + 1] = dm->pam[k >> dm->m_pam];
+  }
+  return dm;
+}
+
+ldpc_demapper_t *ldpc_demapper_create_points(const double *iq, int order) {
+  int m = log2_exact(order);
+  if (m < 1 || order > LDPC_DEMAP_MAX_POINTS)
+    return NULL;
+  ldpc_demapper_t *dm = demapper_alloc(LDPC_MOD_PSK, order);
+  memcpy(dm->iq, iq, 2 * (size_t)order * sizeof(double));
+  return dm;
+}
+
+ldpc_demapper_t *ldpc_demapper_parse(const char *name) {
+  if (!strcmp(name, "bpsk"))
+    return ldpc_demapper_create(LDPC_MOD_PSK, 2);
+  if (!strcmp(name, "qpsk"))
+    return ldpc_demapper_create(LDPC_MOD_PSK, 4);
+  int order;
+  char kind[8];
+  if (sscanf(name, "%d%7s", &order, kind) != 2)
+    return NULL;
+  if (!strcmp(kind, "psk"))
+    return ldpc_demapper_create(LDPC_MOD_PSK, order);
+  if (!strcmp(kind, "qam"))
+    return ldpc_demapper_create(LDPC_MOD_QAM, order);
+  return NULL;
+}
+
+void ldpc_demapper_free(ldpc_demapper_t *dm) {
+  if (!dm)
+    return;
+  free(dm->pam);
+  free(dm->iq);
+  free(dm);
+}
+
+int ldpc_demapper_bits(const ldpc_demapper_t *dm) { return dm->m; }
+
+int ldpc_demapper_order(const ldpc_demapper_t *dm) { return dm->order; }
+
+void ldpc_modulate(const ldpc_demapper_t *dm, const int *bits, int n_sym,
+                   double *iq) {
+  const int m = dm->m;
+  for (int i = 0; i < n_sym; i++) {
+    int k = 0;
+    for (int b = 0; b < m; b++)
+      k |= (bits[i * m + b] & 1) << b;
+    iq[2 * i] = dm->iq[2 * k];
+    iq[2 * i + 1] = dm->iq[2 * k + 1];
+  }
+}
+
+/* ========================================================================== */
+/* Block kernel                                                               */
+/* ========================================================================== */
+
+/* Metric −|v − a|² / N0 of one point for the B symbols of a block
+ * (one-dimensional if vy is NULL). */
+ALWAYS_INLINE void point_metric(double *restrict met, const double *vx,
+                                const double *vy, double ax, double ay,
+                                double inv_N0) {
+  if (vy) {
+    for (int s = 0; s < B; s++) {
+      double dx = vx[s] - ax, dy = vy[s] - ay;
+      met[s] = -(dx * dx + dy * dy) * inv_N0;
+    }
+  } else {
+    for (int s = 0; s < B; s++) {
+      double dx = vx[s] - ax;
+      met[s] = -dx * dx * inv_N0;
+    }
+  }
+}
+
+/*
+ * LLRs of the nb label bits of a point set (label = index) for the first
+ * n symbols of a block: bit b of symbol s goes to llr[s·m + b0 + b].
+ * ax / ay: point coordinates (ay NULL: one dimension, vy ignored).
+ */
+ALWAYS_INLINE void demap_set(int np, const double *ax, const double *ay,
+                             int nb, ldpc_demap_mode mode, const double *vx,
+                             const double *vy, double inv_N0, int n,
+                             double *llr, int m, int b0) {
+  double mx[MAX_BITS][2][B];
+  double met[B];
+
+  for (int b = 0; b < nb; b++)
+    for (int s = 0; s < B; s++)
+      mx[b][0][s] = mx[b][1][s] = -DBL_MAX;
+
+  for (int p = 0; p < np; p++) {
+    point_metric(met, vx, ay ? vy : NULL, ax[p], ay ? ay[p] : 0.0, inv_N0);
+    for (int b = 0; b < nb; b++) {
+      double *restrict t = mx[b][(p >> b) & 1];
+      for (int s = 0; s < B; s++)
+        t[s] = t[s] > met[s] ? t[s] : met[s];
+    }
+  }
+
+  if (mode == LDPC_DEMAP_MAXLOG) {
+    for (int s = 0; s < n; s++)
+      for (int b = 0; b < nb; b++)
+        llr[s * m + b0 + b] = mx[b][1][s] - mx[b][0][s];
+    return;
+  }
+
+  /* exact: Σ e^{met − M} per bit value, M = max over all points (both
+   * classes of any bit cover all points); one exp() per point */
+  double M[B], sum[MAX_BITS][2][B], e[B];
+  for (int s = 0; s < B; s++)
+    M[s] = mx[0][0][s] > mx[0][1][s] ? mx[0][0][s] : mx[0][1][s];
+  memset(sum, 0, sizeof(sum));
+
+  for (int p = 0; p < np; p++) {
+    point_metric(met, vx, ay ? vy : NULL, ax[p], ay ? ay[p] : 0.0, inv_N0);
+    for (int s = 0; s < B; s++)
+      e[s] = exp(met[s] - M[s]);
+    for (int b = 0; b < nb; b++) {
+      double *restrict t = sum[b][(p >> b) & 1];
+      for (int s = 0; s < B; s++)
+        t[s] += e[s];
+    }
+  }
+
+  for (int s = 0; s < n; s++) {
+    for (int b = 0; b < nb; b++) {
+      double s1 = sum[b][1][s], s0 = sum[b][0][s];
+      /* a class whose terms all underflow: max-log is exact to ~1e-300 */
+      llr[s * m + b0 + b] = (s1 > 0.0 && s0 > 0.0)
+                                ? log(s1 / s0)
+                                : mx[b][1][s] - mx[b][0][s];
+    }
+  }
+}
+
+/* LLRs of n <= B symbols starting at y[0] into llr[n · m] */
+static void demap_block(const ldpc_demapper_t *dm, ldpc_demap_mode mode,
+                        const double *y, int n, double inv_N0, double *llr) {
+  double yr[B], yi[B];
+  for (int s = 0; s < B; s++) {
+    yr[s] = (s < n) ? y[2 * s] : 0.0;
+    yi[s] = (s < n) ? y[2 * s + 1] : 0.0;
+  }
+
+  if (dm->separable) {
+    demap_set(dm->n_pam, dm->pam, NULL, dm->m_pam, mode, yr, NULL, inv_N0, n,
+              llr, dm->m, 0);
+    demap_set(dm->n_pam, dm->pam, NULL, dm->m_pam, mode, yi, NULL, inv_N0, n,
+              llr, dm->m, dm->m_pam);
+  } else {
+    /* points as separate coordinate arrays for the metric loop */
+    double ax[LDPC_DEMAP_MAX_POINTS], ay[LDPC_DEMAP_MAX_POINTS];
+    for (int p = 0; p < dm->order; p++) {
+      ax[p] = dm->iq[2 * p];
+      ay[p] = dm->iq[2 * p + 1];
+    }
+    demap_set(dm->order, ax, ay, dm->m, mode, yr, yi, inv_N0, n, llr, dm->m,
+              0);
+  }
+}
+
+/* ========================================================================== */
+/* Output stages                                                              */
+/* ========================================================================== */
+void ldpc_demap(const ldpc_demapper_t *dm, ldpc_demap_mode mode,
+                const double *y, int n_sym, double N0, double *LLR) {
+  const double inv_N0 = 1.0 / N0;
+  for (int i = 0; i < n_sym; i += B) {
+    int n = (n_sym - i < B) ? n_sym - i : B;
+    demap_block(dm, mode, y + 2 * i, n, inv_N0, LLR + (size_t)i * dm->m);
+  }
+}
+
+void ldpc_demap_lane(const ldpc_demapper_t *dm, ldpc_demap_mode mode,
+                     const double *y, int n_sym, double N0, float *LLR_batch,
+                     int lane) {
+  const double inv_N0 = 1.0 / N0;
+  double llr[B * MAX_BITS];
+  for (int i = 0; i < n_sym; i += B) {
+    int n = (n_sym - i < B) ? n_sym - i : B;
+    demap_block(dm, mode, y + 2 * i, n, inv_N0, llr);
+    float *dst = LLR_batch + (size_t)i * dm->m * LDPC_BATCH_LANES + lane;
+    for (int j = 0; j < n * dm->m; j++)
+      dst[(size_t)j * LDPC_BATCH_LANES] = (float)llr[j];
+  }
+}
+
+void ldpc_demap_q8(const ldpc_demapper_t *dm, ldpc_demap_mode mode,
+                   const double *y, int n_sym, double N0, int8_t *q,
+                   const ldpc_qformat_t *fmt) {
+  const double inv_N0 = 1.0 / N0;
+  double llr[B * MAX_BITS];
+  for (int i = 0; i < n_sym; i += B) {
+    int n = (n_sym - i < B) ? n_sym - i : B;
+    demap_block(dm, mode, y + 2 * i, n, inv_N0, llr);
+    ldpc_quantize_llr_q8(llr, q + (size_t)i * dm->m, n * dm->m, fmt);
+  }
+}
+
+void ldpc_demap_q16(const ldpc_demapper_t *dm, ldpc_demap_mode mode,
+                    const double *y, int n_sym, double N0, int16_t *q,
+                    const ldpc_qformat_t *fmt) {
+  const double inv_N0 = 1.0 / N0;
+  double llr[B * MAX_BITS];
+  for (int i = 0; i < n_sym; i += B) {
+    int n = (n_sym - i < B) ? n_sym - i : B;
+    demap_block(dm, mode, y + 2 * i, n, inv_N0, llr);
+    ldpc_quantize_llr_q16(llr, q + (size_t)i * dm->m, n * dm->m, fmt);
+  }
+}
@@ -12,10 +12,19 @@
  *    - c   : N-bit encoded codeword
  *
  * All operations are XOR-based (GF(2)).
+ *
+ * ldpc_encoder_t keeps only the parity part P of a systematic G,
+ * bit-packed into 64-bit words, and XORs whole P rows per set
+ * information bit. The same rows drive a bit-sliced encoder that
+ * encodes 64 frames with word-wide XORs.
  */
 
 #include "ldpc_encoder.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 /* ========================================================================
  *  LDPC Encoder (Generator-Matrix Based)
  * ------------------------------------------------------------------------
@@ -46,3 +55,698 @@ void ldpc_encode(int *ecc, const int *inf, int **G, int N, int K) {
     ecc[i] = acc;
   }
 }
+
+/* ========================================================================
+ *  Packed bit vectors
+ * ======================================================================== */
+void ldpc_pack_bits(uint64_t *dst, const int *src, int n) {
+  memset(dst, 0, LDPC_BITS_WORDS(n) * sizeof(uint64_t));
+  for (int i = 0; i < n; i++)
+    dst[i >> 6] |= (uint64_t)(src[i] & 1) << (i & 63);
+}
+
+void ldpc_unpack_bits(int *dst, const uint64_t *src, int n) {
+  for (int i = 0; i < n; i++)
+    dst[i] = (int)((src[i >> 6] >> (i & 63)) & 1);
+}
+
+/* ========================================================================
+ *  Packed systematic encoder
+ * ======================================================================== */
+struct ldpc_encoder {
+  int N, K, M;
+  int pw;            /* words per P row, LDPC_BITS_WORDS(M) */
+  const uint64_t *P; /* [K][pw] parity part of G, row-major */
+  uint64_t *own_P;   /* P if allocated here, NULL if borrowed */
+};
+
+ldpc_encoder_t *ldpc_encoder_create(int **G, int N, int K) {
+  int M = N - K;
+
+  /* information part must be the identity */
+  for (int j = 0; j < K; j++)
+    for (int i = M; i < N; i++)
+      if (G[j][i] != (i - M == j))
+        return NULL;
+
+  ldpc_encoder_t *enc = (ldpc_encoder_t *)malloc(sizeof(ldpc_encoder_t));
+  if (!enc) {
+    fprintf(stderr, "malloc failed in ldpc_encoder_create\n");
+    exit(1);
+  }
+
+  enc->N = N;
+  enc->K = K;
+  enc->M = M;
+  enc->pw = LDPC_BITS_WORDS(M);
+  enc->own_P = (uint64_t *)malloc(
+      (size_t)(K > 0 ? K : 1) * (enc->pw > 0 ? enc->pw : 1) *
+      sizeof(uint64_t));
+  if (!enc->own_P) {
+    fprintf(stderr, "malloc failed in ldpc_encoder_create\n");
+    exit(1);
+  }
+
+  for (int j = 0; j < K; j++)
+    ldpc_pack_bits(enc->own_P + (size_t)j * enc->pw, G[j], M);
+  enc->P = enc->own_P;
+
+  return enc;
+}
+
+ldpc_encoder_t *ldpc_encoder_create_packed(const uint64_t *P, int N, int K) {
+  ldpc_encoder_t *enc = (ldpc_encoder_t *)malloc(sizeof(ldpc_encoder_t));
+  if (!enc) {
+    fprintf(stderr, "malloc failed in ldpc_encoder_create_packed\n");
+    exit(1);
+  }
+
+  enc->N = N;
+  enc->K = K;
+  enc->M = N - K;
+  enc->pw = LDPC_BITS_WORDS(N - K);
+  enc->P = P;
+  enc->own_P = NULL;
+  return enc;
+}
+
+void ldpc_encoder_free(ldpc_encoder_t *enc) {
+  if (!enc)
+    return;
+  free(enc->own_P);
+  free(enc);
+}
+
+const uint64_t *ldpc_encoder_parity(const ldpc_encoder_t *enc) {
+  return enc->P;
+}
+
+void ldpc_encoder_encode(const ldpc_encoder_t *enc, int *ecc, const int *inf) {
+  const int M = enc->M, K = enc->K, pw = enc->pw;
+
+  /* one parity word at a time: accumulate P[j][w] over the set inf[j] */
+  for (int w = 0; w < pw; w++) {
+    const uint64_t *Pw = enc->P + w;
+    uint64_t acc = 0;
+
+    for (int j = 0; j < K; j++)
+      acc ^= Pw[(size_t)j * pw] & (0 - (uint64_t)(inf[j] & 1));
+
+    int n = (M - 64 * w < 64) ? M - 64 * w : 64;
+    for (int b = 0; b < n; b++)
+      ecc[64 * w + b] = (int)((acc >> b) & 1);
+  }
+
+  /* systematic part */
+  memcpy(ecc + M, inf, K * sizeof(int));
+}
+
+void ldpc_encoder_encode_packed(const ldpc_encoder_t *enc, uint64_t *ecc,
+                                const uint64_t *inf) {
+  const int M = enc->M, K = enc->K, pw = enc->pw;
+  const int nw = LDPC_BITS_WORDS(enc->N);
+  const int kw = LDPC_BITS_WORDS(K);
+
+  memset(ecc, 0, nw * sizeof(uint64_t));
+
+  /* parity: XOR the P rows of the set information bits */
+  for (int w = 0; w < kw; w++) {
+    uint64_t bits = inf[w];
+    if (w == kw - 1 && (K & 63))
+      bits &= ((uint64_t)1 << (K & 63)) - 1;
+
+    while (bits) {
+      int j = 64 * w + __builtin_ctzll(bits);
+      const uint64_t *Pj = enc->P + (size_t)j * pw;
+      for (int i = 0; i < pw; i++)
+        ecc[i] ^= Pj[i];
+      bits &= bits - 1;
+    }
+  }
+
+  /* systematic part: inf shifted to bit offset M */
+  const int o = M >> 6, sh = M & 63;
+  for (int w = 0; w < kw; w++) {
+    uint64_t x = inf[w];
+    if (w == kw - 1 && (K & 63))
+      x &= ((uint64_t)1 << (K & 63)) - 1;
+
+    ecc[o + w] |= x << sh;
+    if (sh && o + w + 1 < nw)
+      ecc[o + w + 1] |= x >> (64 - sh);
+  }
+}
+
+/* ========================================================================
+ *  Bit-sliced 64-frame encoder
+ * ------------------------------------------------------------------------
+ *  Walk the ones of each P row j and XOR the 64-frame word inf[j] into
+ *  every parity word it touches; rows whose word is zero are skipped.
+ * ======================================================================== */
+void ldpc_encoder_encode_sliced(const ldpc_encoder_t *enc, uint64_t *ecc,
+                                const uint64_t *inf) {
+  const int M = enc->M, K = enc->K, pw = enc->pw;
+
+  memset(ecc, 0, M * sizeof(uint64_t));
+
+  for (int j = 0; j < K; j++) {
+    const uint64_t x = inf[j];
+    if (!x)
+      continue;
+
+    const uint64_t *Pj = enc->P + (size_t)j * pw;
+    for (int w = 0; w < pw; w++) {
+      uint64_t bits = Pj[w];
+      while (bits) {
+        ecc[64 * w + __builtin_ctzll(bits)] ^= x;
+        bits &= bits - 1;
+      }
+    }
+  }
+
+  /* systematic part */
+  memcpy(ecc + M, inf, K * sizeof(uint64_t));
+}
+
+void ldpc_slice_put(uint64_t *sliced, const int *bits, int n, int frame) {
+  const uint64_t m = (uint64_t)1 << frame;
+  for (int i = 0; i < n; i++)
+    sliced[i] = (sliced[i] & ~m) | ((uint64_t)(bits[i] & 1) << frame);
+}
+
+void ldpc_slice_get(int *bits, const uint64_t *sliced, int n, int frame) {
+  for (int i = 0; i < n; i++)
+    bits[i] = (int)((sliced[i] >> frame) & 1);
+}
+
+/* ========================================================================
+ *  Encoder from the sparse parity-check matrix
+ * ======================================================================== */
+struct ldpc_hencoder {
+  const ldpc_graph_t *g;
+
+  int nT;   /* size of the triangular part T          */
+  int gap;  /* g = M - nT                             */
+  int rank; /* rank of φ (< gap if H has dependent rows) */
+  int gw;   /* words per packed φ row                 */
+
+  int *t_row, *t_col; /* [nT]  pivot (row, column) in forward order */
+  int *b_row, *b_col; /* [gap] bottom rows and gap columns          */
+  int *piv_col;       /* [rank] gap column index solved by Q row i  */
+  uint64_t *Q;        /* [gap][gw] Q·φ = RREF; rows >= rank: Q·φ = 0 */
+
+  uint64_t *r; /* [gw] scratch: bottom-row syndrome */
+};
+
+static void *henc_alloc(size_t n, size_t size) {
+  void *p = malloc((n > 0 ? n : 1) * size);
+  if (!p) {
+    fprintf(stderr, "malloc failed in ldpc_hencoder_create\n");
+    exit(1);
+  }
+  return p;
+}
+
+static ldpc_hencoder_t *henc_new(const ldpc_graph_t *g, int nT, int gap,
+                                 int rank) {
+  ldpc_hencoder_t *enc =
+      (ldpc_hencoder_t *)henc_alloc(1, sizeof(ldpc_hencoder_t));
+  enc->g = g;
+  enc->nT = nT;
+  enc->gap = gap;
+  enc->rank = rank;
+  enc->gw = LDPC_BITS_WORDS(gap);
+  enc->t_row = (int *)henc_alloc(nT, sizeof(int));
+  enc->t_col = (int *)henc_alloc(nT, sizeof(int));
+  enc->b_row = (int *)henc_alloc(gap, sizeof(int));
+  enc->b_col = (int *)henc_alloc(gap, sizeof(int));
+  enc->piv_col = (int *)henc_alloc(rank, sizeof(int));
+  enc->Q = (uint64_t *)henc_alloc((size_t)gap * enc->gw, sizeof(uint64_t));
+  enc->r = (uint64_t *)henc_alloc(enc->gw, sizeof(uint64_t));
+  return enc;
+}
+
+void ldpc_hencoder_free(ldpc_hencoder_t *enc) {
+  if (!enc)
+    return;
+  free(enc->t_row);
+  free(enc->t_col);
+  free(enc->b_row);
+  free(enc->b_col);
+  free(enc->piv_col);
+  free(enc->Q);
+  free(enc->r);
+  free(enc);
+}
+
+ldpc_hencoder_t *ldpc_hencoder_dup(const ldpc_hencoder_t *enc) {
+  ldpc_hencoder_t *d = henc_new(enc->g, enc->nT, enc->gap, enc->rank);
+  memcpy(d->t_row, enc->t_row, enc->nT * sizeof(int));
+  memcpy(d->t_col, enc->t_col, enc->nT * sizeof(int));
+  memcpy(d->b_row, enc->b_row, enc->gap * sizeof(int));
+  memcpy(d->b_col, enc->b_col, enc->gap * sizeof(int));
+  memcpy(d->piv_col, enc->piv_col, enc->rank * sizeof(int));
+  memcpy(d->Q, enc->Q, (size_t)enc->gap * enc->gw * sizeof(uint64_t));
+  return d;
+}
+
+int ldpc_hencoder_gap(const ldpc_hencoder_t *enc) { return enc->gap; }
+
+/* Forward substitution through T: each pivot row has exactly one column
+ * (its pivot) that is not yet known. */
+static void henc_forward(const ldpc_hencoder_t *enc, int *ecc) {
+  const ldpc_graph_t *g = enc->g;
+  for (int k = 0; k < enc->nT; k++) {
+    int i = enc->t_row[k];
+    int x = 0;
+    ecc[enc->t_col[k]] = 0;
+    for (int e = g->row_ptr[i]; e < g->row_ptr[i + 1]; e++)
+      x ^= ecc[g->col_idx[e]];
+    ecc[enc->t_col[k]] = x;
+  }
+}
+
+/* Syndrome of the bottom rows, packed into r[gw]. */
+static void henc_bottom(const ldpc_hencoder_t *enc, const int *ecc,
+                        uint64_t *r) {
+  const ldpc_graph_t *g = enc->g;
+  memset(r, 0, enc->gw * sizeof(uint64_t));
+  for (int b = 0; b < enc->gap; b++) {
+    int i = enc->b_row[b];
+    int x = 0;
+    for (int e = g->row_ptr[i]; e < g->row_ptr[i + 1]; e++)
+      x ^= ecc[g->col_idx[e]];
+    r[b >> 6] |= (uint64_t)x << (b & 63);
+  }
+}
+
+void ldpc_hencoder_encode(ldpc_hencoder_t *enc, int *ecc, const int *inf) {
+  const int N = enc->g->N, M = enc->g->M;
+
+  memcpy(ecc + M, inf, (N - M) * sizeof(int));
+  for (int b = 0; b < enc->gap; b++)
+    ecc[enc->b_col[b]] = 0;
+
+  /* 1) p_t with p_b = 0, residual syndrome of the bottom rows */
+  henc_forward(enc, ecc);
+  henc_bottom(enc, ecc, enc->r);
+
+  /* 2) p_b = φ⁻¹ · r (free gap bits stay 0) */
+  for (int k = 0; k < enc->rank; k++) {
+    const uint64_t *q = enc->Q + (size_t)k * enc->gw;
+    uint64_t acc = 0;
+    for (int w = 0; w < enc->gw; w++)
+      acc ^= q[w] & enc->r[w];
+    ecc[enc->b_col[enc->piv_col[k]]] = __builtin_parityll(acc);
+  }
+
+  /* 3) p_t with the final p_b */
+  henc_forward(enc, ecc);
+}
+
+/* Encode a few random words and check H·c = 0 (catches information
+ * columns that are not free and stale cache files). */
+static int henc_selftest(ldpc_hencoder_t *enc) {
+  const ldpc_graph_t *g = enc->g;
+  const int N = g->N, M = g->M;
+  int *inf = (int *)henc_alloc(N - M, sizeof(int));
+  int *ecc = (int *)henc_alloc(N, sizeof(int));
+  uint64_t s = 0x9e3779b97f4a7c15ULL; /* xorshift64, leaves rand() alone */
+  int ok = 1;
+
+  for (int t = 0; t < 16 && ok; t++) {
+    for (int j = 0; j < N - M; j++) {
+      s ^= s << 13;
+      s ^= s >> 7;
+      s ^= s << 17;
+      inf[j] = (int)(s >> 63);
+    }
+    ldpc_hencoder_encode(enc, ecc, inf);
+    for (int i = 0; i < M && ok; i++) {
+      int x = 0;
+      for (int e = g->row_ptr[i]; e < g->row_ptr[i + 1]; e++)
+        x ^= ecc[g->col_idx[e]];
+      ok = !x;
+    }
+  }
+
+  free(inf);
+  free(ecc);
+  return ok;
+}
+
+/* Triangulation, φ and its reduction; no feasibility check. */
+static ldpc_hencoder_t *henc_build(const ldpc_graph_t *g) {
+  const int M = g->M, N = g->N;
+
+  /* ---------------- Greedy lower triangulation of H[:, 0..M-1] ------------ */
+  int *rdeg = (int *)henc_alloc(M, sizeof(int)); /* active parity cols/row */
+  char *row_done = (char *)calloc(M > 0 ? M : 1, 1);
+  char *col_done = (char *)calloc(M > 0 ? M : 1, 1);
+  int *stack = (int *)henc_alloc(g->n_edges + M, sizeof(int));
+  int *t_row = (int *)henc_alloc(M, sizeof(int));
+  int *t_col = (int *)henc_alloc(M, sizeof(int));
+  int *b_row = (int *)henc_alloc(M, sizeof(int));
+  int *b_col = (int *)henc_alloc(M, sizeof(int));
+  if (!row_done || !col_done) {
+    fprintf(stderr, "malloc failed in ldpc_hencoder_create\n");
+    exit(1);
+  }
+  int nT = 0, nbr = 0, nbc = 0, sp = 0, rows_left = M;
+
+  for (int i = 0; i < M; i++) {
+    rdeg[i] = 0;
+    for (int e = g->row_ptr[i]; e < g->row_ptr[i + 1]; e++)
+      rdeg[i] += (g->col_idx[e] < M);
+    if (rdeg[i] == 1)
+      stack[sp++] = i;
+    else if (rdeg[i] == 0) {
+      row_done[i] = 1;
+      b_row[nbr++] = i;
+      rows_left--;
+    }
+  }
+
+  while (rows_left > 0) {
+    if (sp == 0) {
+      /* no degree-1 row: move all but one column of a minimum-degree row
+       * into the gap */
+      int best = -1;
+      for (int i = 0; i < M; i++)
+        if (!row_done[i] && (best < 0 || rdeg[i] < rdeg[best]))
+          best = i;
+      int keep = 1;
+      for (int e = g->row_ptr[best]; e < g->row_ptr[best + 1]; e++) {
+        int c = g->col_idx[e];
+        if (c >= M || col_done[c])
+          continue;
+        if (keep) {
+          keep = 0;
+          continue;
+        }
+        col_done[c] = 1;
+        b_col[nbc++] = c;
+        for (int k = g->col_ptr[c]; k < g->col_ptr[c + 1]; k++) {
+          int r = g->row_idx[k];
+          if (!row_done[r] && --rdeg[r] == 1)
+            stack[sp++] = r;
+        }
+      }
+      continue;
+    }
+
+    int i = stack[--sp];
+    if (row_done[i] || rdeg[i] != 1)
+      continue;
+
+    int c = -1;
+    for (int e = g->row_ptr[i]; e < g->row_ptr[i + 1]; e++)
+      if (g->col_idx[e] < M && !col_done[g->col_idx[e]])
+        c = g->col_idx[e];
+
+    row_done[i] = 1;
+    rows_left--;
+    col_done[c] = 1;
+    t_row[nT] = i;
+    t_col[nT] = c;
+    nT++;
+
+    for (int k = g->col_ptr[c]; k < g->col_ptr[c + 1]; k++) {
+      int r = g->row_idx[k];
+      if (row_done[r])
+        continue;
+      if (--rdeg[r] == 1) {
+        stack[sp++] = r;
+      } else if (rdeg[r] == 0) {
+        row_done[r] = 1;
+        b_row[nbr++] = r;
+        rows_left--;
+      }
+    }
+  }
+  for (int c = 0; c < M; c++)
+    if (!col_done[c])
+      b_col[nbc++] = c;
+
+  /* nbr == nbc == M - nT */
+  const int gap = M - nT;
+  ldpc_hencoder_t *enc = henc_new(g, nT, gap, gap);
+  memcpy(enc->t_row, t_row, nT * sizeof(int));
+  memcpy(enc->t_col, t_col, nT * sizeof(int));
+  memcpy(enc->b_row, b_row, gap * sizeof(int));
+  memcpy(enc->b_col, b_col, gap * sizeof(int));
+
+  free(rdeg);
+  free(row_done);
+  free(col_done);
+  free(stack);
+  free(t_row);
+  free(t_col);
+  free(b_row);
+  free(b_col);
+
+  /* ---------------- φ = E·T⁻¹·B + D, one gap column at a time ------------- */
+  const int gw = enc->gw, aw = 2 * gw; /* augmented row [φ | I] */
+  uint64_t *X = (uint64_t *)calloc((size_t)(gap > 0 ? gap : 1) * aw,
+                                   sizeof(uint64_t));
+  int *ecc = (int *)henc_alloc(N, sizeof(int));
+  if (!X) {
+    fprintf(stderr, "malloc failed in ldpc_hencoder_create\n");
+    exit(1);
+  }
+
+  for (int k = 0; k < gap; k++) {
+    memset(ecc, 0, N * sizeof(int));
+    ecc[enc->b_col[k]] = 1;
+    henc_forward(enc, ecc);
+    henc_bottom(enc, ecc, enc->r);
+    for (int b = 0; b < gap; b++)
+      if ((enc->r[b >> 6] >> (b & 63)) & 1)
+        X[(size_t)b * aw + (k >> 6)] |= (uint64_t)1 << (k & 63);
+  }
+  for (int b = 0; b < gap; b++)
+    X[(size_t)b * aw + gw + (b >> 6)] |= (uint64_t)1 << (b & 63);
+
+  /* ---------------- Reduce [φ | I] → [R | Q] ------------------------------ */
+  int rank = 0;
+  for (int c = 0; c < gap && rank < gap; c++) {
+    const uint64_t m = (uint64_t)1 << (c & 63);
+    int p = -1;
+    for (int b = rank; b < gap; b++)
+      if (X[(size_t)b * aw + (c >> 6)] & m) {
+        p = b;
+        break;
+      }
+    if (p < 0)
+      continue;
+
+    uint64_t *Xr = X + (size_t)rank * aw;
+    if (p != rank) {
+      uint64_t *Xp = X + (size_t)p * aw;
+      for (int w = 0; w < aw; w++) {
+        uint64_t t = Xr[w];
+        Xr[w] = Xp[w];
+        Xp[w] = t;
+      }
+    }
+    for (int b = 0; b < gap; b++) {
+      uint64_t *Xb = X + (size_t)b * aw;
+      if (b != rank && (Xb[c >> 6] & m))
+        for (int w = 0; w < aw; w++)
+          Xb[w] ^= Xr[w];
+    }
+    enc->piv_col[rank] = c;
+    rank++;
+  }
+  enc->rank = rank;
+  for (int k = 0; k < gap; k++)
+    memcpy(enc->Q + (size_t)k * gw, X + (size_t)k * aw + gw,
+           gw * sizeof(uint64_t));
+
+  free(X);
+  free(ecc);
+  return enc;
+}
+
+/*
+ * A row q of Q beyond the rank is a combination of bottom rows that is
+ * blind to the gap bits (q·φ = 0). Pull it back through T (transposed
+ * substitution, reverse pivot order) to a combination w of all rows with
+ * w·H = 0 on every parity column, and return in bad[] up to max_bad
+ * information columns j with w·h_j = 1. Those make H·c = 0 unsolvable
+ * for some information words.
+ */
+static int henc_bad_info(const ldpc_hencoder_t *enc, const uint64_t *q,
+                         char *w, int *bad, int max_bad) {
+  const ldpc_graph_t *g = enc->g;
+  const int M = g->M, N = g->N;
+  int n_bad = 0;
+
+  memset(w, 0, M);
+  for (int b = 0; b < enc->gap; b++)
+    w[enc->b_row[b]] = (char)((q[b >> 6] >> (b & 63)) & 1);
+
+  for (int k = enc->nT - 1; k >= 0; k--) {
+    int c = enc->t_col[k], a = 0;
+    for (int s = g->col_ptr[c]; s < g->col_ptr[c + 1]; s++)
+      if (g->row_idx[s] != enc->t_row[k])
+        a ^= w[g->row_idx[s]];
+    w[enc->t_row[k]] = (char)a;
+  }
+
+  for (int j = M; j < N && n_bad < max_bad; j++) {
+    int v = 0;
+    for (int s = g->col_ptr[j]; s < g->col_ptr[j + 1]; s++)
+      v ^= w[g->row_idx[s]];
+    if (v)
+      bad[n_bad++] = j;
+  }
+  return n_bad;
+}
+
+ldpc_hencoder_t *ldpc_hencoder_create(const ldpc_graph_t *g) {
+  ldpc_hencoder_t *enc = henc_build(g);
+  char *w = (char *)henc_alloc(g->M, 1);
+  int bad, ok = 1;
+
+  for (int k = enc->rank; k < enc->gap && ok; k++)
+    ok = !henc_bad_info(enc, enc->Q + (size_t)k * enc->gw, w, &bad, 1);
+
+  free(w);
+  if (!ok) {
+    ldpc_hencoder_free(enc);
+    return NULL;
+  }
+  return enc;
+}
+
+int ldpc_hencoder_parity_perm(const ldpc_graph_t *g, int *perm) {
+  const int M = g->M, N = g->N;
+  const ldpc_graph_t *cur = g;
+  char *w = (char *)henc_alloc(M, 1);
+  char *used = (char *)henc_alloc(N, 1);
+  char *is_piv = (char *)henc_alloc(M, 1);
+  int *bad = (int *)henc_alloc(N, sizeof(int));
+  int swaps = 0, done = 0;
+
+  for (int j = 0; j < N; j++)
+    perm[j] = j;
+
+  for (int iter = 0; iter < 64 && !done; iter++) {
+    ldpc_hencoder_t *enc = henc_build(cur);
+
+    /* free gap columns: not solved by any Q row, dependent on the rest */
+    memset(is_piv, 0, M);
+    for (int k = 0; k < enc->rank; k++)
+      is_piv[enc->piv_col[k]] = 1;
+    memset(used, 0, N);
+
+    int n_fix = 0, next_free = 0;
+    for (int k = enc->rank; k < enc->gap; k++) {
+      int nb = henc_bad_info(enc, enc->Q + (size_t)k * enc->gw, w, bad, N);
+      int j = -1;
+      for (int t = 0; t < nb && j < 0; t++)
+        if (!used[bad[t]])
+          j = bad[t];
+      while (next_free < enc->gap && is_piv[next_free])
+        next_free++;
+      if (j < 0 || next_free == enc->gap)
+        continue;
+
+      /* swap information column j with a redundant parity column */
+      int c = enc->b_col[next_free++];
+      int t = perm[j];
+      perm[j] = perm[c];
+      perm[c] = t;
+      used[j] = 1;
+      n_fix++;
+    }
+    ldpc_hencoder_free(enc);
+
+    if (n_fix == 0) {
+      done = 1;
+    } else {
+      swaps += n_fix;
+      if (cur != g)
+        ldpc_graph_free((ldpc_graph_t *)cur);
+      cur = ldpc_graph_permute_cols(g, perm);
+    }
+  }
+
+  if (cur != g)
+    ldpc_graph_free((ldpc_graph_t *)cur);
+  free(w);
+  free(used);
+  free(is_piv);
+  free(bad);
+  return done ? swaps : -1;
+}
+
+/* ---------------- Cache file -------------------------------------------- */
+static const char henc_magic[8] = {'L', 'D', 'P', 'C', 'H', 'E', '0', '1'};
+
+int ldpc_hencoder_save(const ldpc_hencoder_t *enc, const char *path) {
+  FILE *fp = fopen(path, "wb");
+  if (!fp)
+    return -1;
+
+  const ldpc_graph_t *g = enc->g;
+  int32_t hdr[6] = {g->N, g->M, g->n_edges, enc->nT, enc->gap, enc->rank};
+  int ok = fwrite(henc_magic, 1, 8, fp) == 8 &&
+           fwrite(hdr, sizeof(hdr), 1, fp) == 1 &&
+           fwrite(enc->t_row, sizeof(int), enc->nT, fp) == (size_t)enc->nT &&
+           fwrite(enc->t_col, sizeof(int), enc->nT, fp) == (size_t)enc->nT &&
+           fwrite(enc->b_row, sizeof(int), enc->gap, fp) == (size_t)enc->gap &&
+           fwrite(enc->b_col, sizeof(int), enc->gap, fp) == (size_t)enc->gap &&
+           fwrite(enc->piv_col, sizeof(int), enc->rank, fp) ==
+               (size_t)enc->rank &&
+           fwrite(enc->Q, sizeof(uint64_t), (size_t)enc->gap * enc->gw,
+                  fp) == (size_t)enc->gap * enc->gw;
+
+  if (fclose(fp) != 0)
+    ok = 0;
+  return ok ? 0 : -1;
+}
+
+ldpc_hencoder_t *ldpc_hencoder_load(const ldpc_graph_t *g, const char *path) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp)
+    return NULL;
+
+  char magic[8];
+  int32_t hdr[6];
+  if (fread(magic, 1, 8, fp) != 8 || memcmp(magic, henc_magic, 8) ||
+      fread(hdr, sizeof(hdr), 1, fp) != 1 || hdr[0] != g->N ||
+      hdr[1] != g->M || hdr[2] != g->n_edges || hdr[3] < 0 || hdr[4] < 0 ||
+      hdr[3] + hdr[4] != g->M || hdr[5] < 0 || hdr[5] > hdr[4]) {
+    fclose(fp);
+    return NULL;
+  }
+
+  ldpc_hencoder_t *enc = henc_new(g, hdr[3], hdr[4], hdr[5]);
+  int ok =
+      fread(enc->t_row, sizeof(int), enc->nT, fp) == (size_t)enc->nT &&
+      fread(enc->t_col, sizeof(int), enc->nT, fp) == (size_t)enc->nT &&
+      fread(enc->b_row, sizeof(int), enc->gap, fp) == (size_t)enc->gap &&
+      fread(enc->b_col, sizeof(int), enc->gap, fp) == (size_t)enc->gap &&
+      fread(enc->piv_col, sizeof(int), enc->rank, fp) == (size_t)enc->rank &&
+      fread(enc->Q, sizeof(uint64_t), (size_t)enc->gap * enc->gw, fp) ==
+          (size_t)enc->gap * enc->gw;
+  fclose(fp);
+
+  /* indices in range, then a functional check against this graph */
+  for (int k = 0; ok && k < enc->nT; k++)
+    ok = enc->t_row[k] >= 0 && enc->t_row[k] < g->M && enc->t_col[k] >= 0 &&
+         enc->t_col[k] < g->M;
+  for (int k = 0; ok && k < enc->gap; k++)
+    ok = enc->b_row[k] >= 0 && enc->b_row[k] < g->M && enc->b_col[k] >= 0 &&
+         enc->b_col[k] < g->M;
+  for (int k = 0; ok && k < enc->rank; k++)
+    ok = enc->piv_col[k] >= 0 && enc->piv_col[k] < enc->gap;
+
+  if (!ok || !henc_selftest(enc)) {
+    ldpc_hencoder_free(enc);
+    return NULL;
+  }
+  return enc;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file ldpc_fixed.c
+ * @brief Fixed-point (int8 / int16) LDPC min-sum decoder and LLR quantizer.
+ *
+ * This module provides:
+ *   - Quantization of double LLRs into saturating int8 / int16 values
+ *   - A min-sum family decoder whose messages are stored as int8 or int16
+ *     (selected from the format width), with a posterior that has two
+ *     extra bits of headroom
+ *
+ * The decoding loops are written once in ldpc_fixed_impl.h and
+ * instantiated for both storage widths.
+ */
+
+#include "ldpc_fixed.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ========================================================================== */
+/* Decoder context                                                            */
+/* ========================================================================== */
+struct ldpc_qdecoder {
+  const ldpc_graph_t *g;
+  int K;
+
+  ldpc_qformat_t fmt;
+  int qmax; /* message saturation  2^(bits-1) - 1               */
+  int pmax; /* posterior saturation 2^(bits+1) - 1 (2 bits more) */
+
+  ldpc_cn_kernel kernel;
+  int alpha16; /* NMS factor in 1/16 steps */
+  int beta_q;  /* OMS offset in LSBs       */
+  ldpc_schedule schedule;
+
+  void *v; /* [n_edges] C→V messages (int8_t or int16_t) */
+  void *L; /* [N] posterior (int16_t or int32_t)          */
+  void *x; /* [max_row_deg] check-row extrinsics (posterior type) */
+};
+
+/* ========================================================================== */
+/* Helpers                                                                    */
+/* ========================================================================== */
+static inline int sat_int(int x, int lim) {
+  return (x > lim) ? lim : (x < -lim) ? -lim : x;
+}
+
+static int qsyndrome_is_zero(const ldpc_graph_t *g, const int *ecc) {
+  for (int i = 0; i < g->M; i++) {
+    int parity = 0;
+    for (int k = g->row_ptr[i]; k < g->row_ptr[i + 1]; k++)
+      parity ^= ecc[g->col_idx[k]];
+    if (parity)
+      return 0;
+  }
+  return 1;
+}
+
+/* ========================================================================== */
+/* Width instantiations                                                       */
+/* ========================================================================== */
+#define QT int8_t
+#define PT int16_t
+#define QSUF q8
+#include "ldpc_fixed_impl.h"
+#undef QT
+#undef PT
+#undef QSUF
+
+#define QT int16_t
+#define PT int32_t
+#define QSUF q16
+#include "ldpc_fixed_impl.h"
+#undef QT
+#undef PT
+#undef QSUF
+
+/* ========================================================================== */
+/* Quantization format                                                        */
+/* ========================================================================== */
+int ldpc_qformat_max(const ldpc_qformat_t *fmt) {
+  return (1 << (fmt->bits - 1)) - 1;
+}
+
+static int qformat_valid(const ldpc_qformat_t *fmt) {
+  return fmt->bits >= 2 && fmt->bits <= 16 && fmt->frac_bits >= 0 &&
+         fmt->frac_bits < fmt->bits;
+}
+
+int ldpc_qformat_parse(const char *str, ldpc_qformat_t *fmt) {
+  ldpc_qformat_t f = {0, 0, 0.0};
+  int end = 0;
+  /* "B.F" or "B.F:clip", nothing after it */
+  if (sscanf(str, "%d.%d%n", &f.bits, &f.frac_bits, &end) != 2)
+    return -1;
+  if (str[end] == ':') {
+    int len = 0;
+    if (sscanf(str + end + 1, "%lf%n", &f.clip, &len) != 1)
+      return -1;
+    end += 1 + len;
+  }
+  if (str[end] != '\0' || !qformat_valid(&f))
+    return -1;
+  *fmt = f;
+  return 0;
+}
+
+void ldpc_quantize_llr_q8(const double *LLR, int8_t *q, int n,
+                          const ldpc_qformat_t *fmt) {
+  quantize_q8(LLR, q, n, fmt);
+}
+
+void ldpc_quantize_llr_q16(const double *LLR, int16_t *q, int n,
+                           const ldpc_qformat_t *fmt) {
+  quantize_q16(LLR, q, n, fmt);
+}
+
+/* ========================================================================== */
+/* Public API                                                                 */
+/* ========================================================================== */
+ldpc_qdecoder_t *ldpc_qdecoder_create(const ldpc_graph_t *g, int K,
+                                      const ldpc_qformat_t *fmt) {
+  if (!qformat_valid(fmt))
+    return NULL;
+
+  ldpc_qdecoder_t *qd = (ldpc_qdecoder_t *)calloc(1, sizeof(ldpc_qdecoder_t));
+  if (!qd) {
+    fprintf(stderr, "malloc failed in ldpc_qdecoder_create\n");
+    exit(1);
+  }
+
+  qd->g = g;
+  qd->K = K;
+  qd->fmt = *fmt;
+  qd->qmax = ldpc_qformat_max(fmt);
+  qd->pmax = (1 << (fmt->bits + 1)) - 1;
+  qd->schedule = LDPC_SCHED_LAYERED;
+  ldpc_qdecoder_set_kernel(qd, LDPC_CN_OMS, LDPC_OMS_BETA_DEFAULT);
+
+  size_t qsz = (fmt->bits <= 8) ? sizeof(int8_t) : sizeof(int16_t);
+  size_t psz = (fmt->bits <= 8) ? sizeof(int16_t) : sizeof(int32_t);
+
+  qd->v = malloc((size_t)(g->n_edges > 0 ? g->n_edges : 1) * qsz);
+  qd->L = malloc((size_t)(g->N > 0 ? g->N : 1) * psz);
+  qd->x = malloc((size_t)(g->max_row_deg > 0 ? g->max_row_deg : 1) * psz);
+  if (!qd->v || !qd->L || !qd->x) {
+    fprintf(stderr, "malloc failed in ldpc_qdecoder_create\n");
+    exit(1);
+  }
+
+  return qd;
+}
+
+void ldpc_qdecoder_free(ldpc_qdecoder_t *qd) {
+  if (!qd)
+    return;
+  free(qd->v);
+  free(qd->L);
+  free(qd->x);
+  free(qd);
+}
+
+const ldpc_qformat_t *ldpc_qdecoder_format(const ldpc_qdecoder_t *qd) {
+  return &qd->fmt;
+}
+
+int ldpc_qdecoder_set_kernel(ldpc_qdecoder_t *qd, ldpc_cn_kernel kernel,
+                             double param) {
+  if (kernel == LDPC_CN_SPA)
+    return -1;
+  qd->kernel = kernel;
+  qd->alpha16 = (int)lround(param * 16.0);
+  qd->beta_q = (int)lround(ldexp(param, qd->fmt.frac_bits));
+  return 0;
+}
+
+void ldpc_qdecoder_set_schedule(ldpc_qdecoder_t *qd, ldpc_schedule schedule) {
+  qd->schedule = schedule;
+}
+
+int ldpc_qdecoder_decode_q8(ldpc_qdecoder_t *qd, const int8_t *LLR, int *ecc,
+                            int *inf, int max_iter) {
+  if (qd->fmt.bits > 8)
+    return -1;
+  return qdecode_q8(qd, LLR, ecc, inf, max_iter);
+}
+
+int ldpc_qdecoder_decode_q16(ldpc_qdecoder_t *qd, const int16_t *LLR,
+                             int *ecc, int *inf, int max_iter) {
+  if (qd->fmt.bits <= 8)
+    return -1;
+  return qdecode_q16(qd, LLR, ecc, inf, max_iter);
+}
@@ -0,0 +1,190 @@
+/**
+ * @file ldpc_fixed_impl.h
+ * @brief Width-generic body of the fixed-point decoder (internal).
+ *
+ * Included by ldpc_fixed.c once per storage width with:
+ *
+ *   QT   : message / channel LLR type (int8_t or int16_t)
+ *   PT   : posterior type (int16_t or int32_t, 2 bits of headroom)
+ *   QSUF : function-name suffix (q8 or q16)
+ *
+ * All arithmetic is done in int and saturated on store.
+ */
+
+#define QFN__(name, suf) name##_##suf
+#define QFN_(name, suf) QFN__(name, suf)
+#define QFN(name) QFN_(name, QSUF)
+
+/*
+ * Min-sum family check row: x[0..d-1] → out[0..d-1] (see cn_row_minsum()).
+ * The inputs are extrinsic values in posterior precision; their magnitudes
+ * are saturated to the message range here.
+ */
+static void QFN(qcn_row)(const ldpc_qdecoder_t *qd, const PT *x, QT *out,
+                         int d) {
+  const int qmax = qd->qmax;
+  int m1 = qmax, m2 = qmax;
+  int sgn = 0, k_min = 0;
+
+  for (int k = 0; k < d; k++) {
+    int a = (x[k] < 0) ? -x[k] : x[k];
+    if (a > qmax)
+      a = qmax;
+    sgn ^= (x[k] < 0);
+    if (a < m1) {
+      m2 = m1;
+      m1 = a;
+      k_min = k;
+    } else if (a < m2) {
+      m2 = a;
+    }
+  }
+
+  if (qd->kernel == LDPC_CN_NMS) {
+    m1 = (m1 * qd->alpha16) >> 4;
+    m2 = (m2 * qd->alpha16) >> 4;
+  } else if (qd->kernel == LDPC_CN_OMS) {
+    m1 = (m1 > qd->beta_q) ? m1 - qd->beta_q : 0;
+    m2 = (m2 > qd->beta_q) ? m2 - qd->beta_q : 0;
+  }
+
+  for (int k = 0; k < d; k++) {
+    int mag = (k == k_min) ? m2 : m1;
+    out[k] = (QT)((sgn ^ (x[k] < 0)) ? -mag : mag);
+  }
+}
+
+/* Layered schedule (see decode_layered() in ldpc_decoder.c) */
+static int QFN(qdecode_layered)(ldpc_qdecoder_t *qd, const QT *LLR, int *ecc,
+                                int max_iter) {
+  const ldpc_graph_t *g = qd->g;
+  const int *row_ptr = g->row_ptr;
+  const int *col_idx = g->col_idx;
+  const int pmax = qd->pmax;
+  QT *v = (QT *)qd->v;
+  PT *L = (PT *)qd->L;
+  PT *x = (PT *)qd->x;
+  int iter;
+
+  memset(v, 0, (size_t)g->n_edges * sizeof(QT));
+  for (int j = 0; j < g->N; j++)
+    L[j] = LLR[j];
+
+  for (iter = 0; iter < max_iter; iter++) {
+
+    for (int i = 0; i < g->M; i++) {
+      const int e0 = row_ptr[i];
+      const int d = row_ptr[i + 1] - e0;
+
+      /* keep the extrinsic at posterior width: clipping it before
+       * L = x + v would erase posterior magnitude on every pass */
+      for (int k = 0; k < d; k++)
+        x[k] = (PT)sat_int(L[col_idx[e0 + k]] - v[e0 + k], pmax);
+
+      QFN(qcn_row)(qd, x, v + e0, d);
+
+      for (int k = 0; k < d; k++)
+        L[col_idx[e0 + k]] = (PT)sat_int(x[k] + v[e0 + k], pmax);
+    }
+
+    for (int j = 0; j < g->N; j++)
+      ecc[j] = (L[j] >= 0) ? 1 : 0;
+
+    if (qsyndrome_is_zero(g, ecc))
+      return iter + 1;
+  }
+  return max_iter;
+}
+
+/*
+ * Flooding schedule. The V→C input of edge e = (i, j) is the posterior of
+ * the previous iteration minus the edge's own C→V message,
+ *
+ *     x_e = L[j] − v[e],     L[j] = LLR[j] + Σ_e v[e],
+ *
+ * so only v[] and L[] are stored (|x_e| ≤ pmax + qmax still fits PT).
+ */
+static int QFN(qdecode_flooding)(ldpc_qdecoder_t *qd, const QT *LLR, int *ecc,
+                                 int max_iter) {
+  const ldpc_graph_t *g = qd->g;
+  const int *row_ptr = g->row_ptr;
+  const int *col_idx = g->col_idx;
+  const int *col_ptr = g->col_ptr;
+  const int *col_edge = g->col_edge;
+  const int pmax = qd->pmax;
+  QT *v = (QT *)qd->v;
+  PT *L = (PT *)qd->L;
+  PT *x = (PT *)qd->x;
+  int iter;
+
+  memset(v, 0, (size_t)g->n_edges * sizeof(QT));
+  for (int j = 0; j < g->N; j++)
+    L[j] = LLR[j];
+
+  for (iter = 0; iter < max_iter; iter++) {
+
+    /* ------------------------ Check node update ------------------- */
+    for (int i = 0; i < g->M; i++) {
+      const int e0 = row_ptr[i];
+      const int d = row_ptr[i + 1] - e0;
+
+      for (int k = 0; k < d; k++)
+        x[k] = (PT)(L[col_idx[e0 + k]] - v[e0 + k]);
+
+      QFN(qcn_row)(qd, x, v + e0, d);
+    }
+
+    /* ------------------------ Variable node update ---------------- */
+    for (int j = 0; j < g->N; j++) {
+      int sum = LLR[j];
+      for (int s = col_ptr[j]; s < col_ptr[j + 1]; s++)
+        sum += v[col_edge[s]];
+      L[j] = (PT)sat_int(sum, pmax);
+      ecc[j] = (L[j] >= 0) ? 1 : 0;
+    }
+
+    if (qsyndrome_is_zero(g, ecc))
+      return iter + 1;
+  }
+  return max_iter;
+}
+
+/* Public entry point for this width */
+static int QFN(qdecode)(ldpc_qdecoder_t *qd, const QT *LLR, int *ecc, int *inf,
+                        int max_iter) {
+  int iters = (qd->schedule == LDPC_SCHED_LAYERED)
+                  ? QFN(qdecode_layered)(qd, LLR, ecc, max_iter)
+                  : QFN(qdecode_flooding)(qd, LLR, ecc, max_iter);
+
+  for (int i = 0; i < qd->K; i++)
+    inf[i] = ecc[i + (qd->g->N - qd->K)];
+
+  return iters;
+}
+
+/* Quantizer for this width */
+static void QFN(quantize)(const double *LLR, QT *q, int n,
+                          const ldpc_qformat_t *fmt) {
+  const double scale = ldexp(1.0, fmt->frac_bits);
+  const int qmax = ldpc_qformat_max(fmt);
+
+  for (int i = 0; i < n; i++) {
+    double x = LLR[i];
+    if (fmt->clip > 0.0) {
+      if (x > fmt->clip)
+        x = fmt->clip;
+      else if (x < -fmt->clip)
+        x = -fmt->clip;
+    }
+    x = nearbyint(x * scale);
+    if (x > qmax)
+      x = qmax;
+    else if (x < -qmax)
+      x = -qmax;
+    q[i] = (QT)x;
+  }
+}
+
+#undef QFN
+#undef QFN_
+#undef QFN__
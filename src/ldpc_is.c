@@ -0,0 +1,408 @@
+/**
+ * @file ldpc_is.c
+ * @brief Mean-shift importance sampling of the BPSK/AWGN channel.
+ *
+ * This module provides:
+ *   - Cycle sets: per variable node, the variables of a shortest cycle
+ *     through it, from a depth-limited breadth-first search (the search
+ *     of ldpc_graph_girth(), rooted at every variable), deduplicated
+ *   - Sampling from the defensive mixture and the frame weight p/q
+ *   - The weighted estimator with its confidence interval
+ */
+
+#include "ldpc_is.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ldpc_is {
+  ldpc_is_mode mode;
+  double shift;
+  double p0;
+
+  int n_all;         /* candidate sets                         */
+  int *set_ptr;      /* [n_all+1] offsets into set_var         */
+  int *set_var;      /* variables of every set, sorted per set  */
+  double *set_shift; /* [n_all] mean shift of every set         */
+  int n_sets;        /* sets in use (mixture components)        */
+  int *active;       /* [n_all] indices of the sets in use      */
+};
+
+static const char *const is_mode_names[] = {"shift", "ts"};
+
+const char *ldpc_is_mode_name(ldpc_is_mode mode) {
+  if ((int)mode < 0 || (int)mode > LDPC_IS_TS)
+    return "unknown";
+  return is_mode_names[mode];
+}
+
+int ldpc_is_mode_parse(const char *name, ldpc_is_mode *mode) {
+  for (int i = 0; i <= LDPC_IS_TS; i++) {
+    if (!strcmp(name, is_mode_names[i])) {
+      *mode = (ldpc_is_mode)i;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+double ldpc_is_shift_default(ldpc_is_mode mode) {
+  return mode == LDPC_IS_SHIFT ? LDPC_IS_SHIFT_DEFAULT
+                               : LDPC_IS_TS_SHIFT_DEFAULT;
+}
+
+static void *is_alloc(size_t n, size_t size) {
+  void *p = malloc((n > 0 ? n : 1) * size);
+  if (!p) {
+    fprintf(stderr, "malloc failed in ldpc_is_create\n");
+    exit(1);
+  }
+  return p;
+}
+
+/* ========================================================================== */
+/* Cycle sets                                                                 */
+/* ========================================================================== */
+/*
+ * A breadth-first search from root v labels every node with the neighbor
+ * of v its tree path starts with. A non-tree edge u–w between two
+ * different labels closes a cycle through v of length d(u) + d(w) + 1;
+ * in a bipartite graph the first one met is a shortest one. Its
+ * variables are those on the tree paths from u and w back to v.
+ */
+typedef struct {
+  int *dist, *parent, *branch, *queue; /* [N + M] */
+} bfs_t;
+
+/* variables of a shortest cycle through root into out[]; returns their
+ * number, 0 if there is no cycle of at most max_len edges */
+static int shortest_cycle(const ldpc_graph_t *g, int root, int max_len,
+                          bfs_t *b, int *out) {
+  int head = 0, tail = 0, n_out = 0;
+  int cu = -1, cw = -1;
+
+  b->dist[root] = 0;
+  b->parent[root] = -1;
+  b->branch[root] = -1;
+  b->queue[tail++] = root;
+
+  while (head < tail && cu < 0) {
+    int u = b->queue[head++];
+    if (2 * b->dist[u] + 2 > max_len)
+      break;
+
+    /* neighbors of u: checks of a variable, variables of a check */
+    int k0, k1, off;
+    const int *adj;
+    if (u < g->N) {
+      k0 = g->col_ptr[u];
+      k1 = g->col_ptr[u + 1];
+      adj = g->row_idx;
+      off = g->N;
+    } else {
+      k0 = g->row_ptr[u - g->N];
+      k1 = g->row_ptr[u - g->N + 1];
+      adj = g->col_idx;
+      off = 0;
+    }
+
+    for (int k = k0; k < k1; k++) {
+      int w = adj[k] + off;
+      if (w == b->parent[u])
+        continue;
+      if (b->dist[w] < 0) {
+        b->dist[w] = b->dist[u] + 1;
+        b->parent[w] = u;
+        b->branch[w] = (u == root) ? w : b->branch[u];
+        b->queue[tail++] = w;
+      } else if (w != root && b->branch[w] != b->branch[u]) {
+        cu = u;
+        cw = w;
+        break;
+      }
+    }
+  }
+
+  if (cu >= 0) {
+    for (int x = cu; x != root; x = b->parent[x])
+      if (x < g->N)
+        out[n_out++] = x;
+    for (int x = cw; x != root; x = b->parent[x])
+      if (x < g->N)
+        out[n_out++] = x;
+    out[n_out++] = root;
+  }
+
+  for (int k = 0; k < tail; k++)
+    b->dist[b->queue[k]] = -1;
+  return n_out;
+}
+
+static int cmp_int(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+/* candidate set: size, then its sorted variables, padded with -1 */
+#define SET_WIDTH (LDPC_IS_MAX_CYCLE / 2 + 1)
+
+static int cmp_set(const void *a, const void *b) {
+  const int *x = (const int *)a, *y = (const int *)b;
+  for (int k = 0; k < SET_WIDTH; k++)
+    if (x[k] != y[k])
+      return (x[k] > y[k]) - (x[k] < y[k]);
+  return 0;
+}
+
+static void cycle_sets(ldpc_is_t *is, const ldpc_graph_t *g) {
+  int n_nodes = g->N + g->M;
+  bfs_t b;
+
+  b.dist = (int *)is_alloc(n_nodes, sizeof(int));
+  b.parent = (int *)is_alloc(n_nodes, sizeof(int));
+  b.branch = (int *)is_alloc(n_nodes, sizeof(int));
+  b.queue = (int *)is_alloc(n_nodes, sizeof(int));
+  for (int v = 0; v < n_nodes; v++)
+    b.dist[v] = -1;
+
+  /* one candidate per variable */
+  int *cand = (int *)is_alloc((size_t)g->N * SET_WIDTH, sizeof(int));
+  int n = 0, n_var = 0;
+  for (int v = 0; v < g->N; v++) {
+    int *c = cand + (size_t)n * SET_WIDTH;
+    int len = shortest_cycle(g, v, LDPC_IS_MAX_CYCLE, &b, c + 1);
+    if (len == 0)
+      continue;
+    qsort(c + 1, len, sizeof(int), cmp_int);
+    c[0] = len;
+    for (int k = len + 1; k < SET_WIDTH; k++)
+      c[k] = -1;
+    n++;
+  }
+
+  /* drop duplicates: a cycle is usually found from each of its variables */
+  qsort(cand, n, SET_WIDTH * sizeof(int), cmp_set);
+  for (int s = 0; s < n; s++)
+    n_var += cand[(size_t)s * SET_WIDTH];
+
+  is->set_ptr = (int *)is_alloc(n + 1, sizeof(int));
+  is->set_var = (int *)is_alloc(n_var, sizeof(int));
+  is->set_shift = (double *)is_alloc(n, sizeof(double));
+  is->set_ptr[0] = 0;
+  is->n_all = 0;
+  for (int s = 0; s < n; s++) {
+    const int *c = cand + (size_t)s * SET_WIDTH;
+    if (s > 0 && cmp_set(c - SET_WIDTH, c) == 0)
+      continue;
+    int at = is->set_ptr[is->n_all];
+    memcpy(is->set_var + at, c + 1, c[0] * sizeof(int));
+    is->set_ptr[++is->n_all] = at + c[0];
+  }
+
+  free(cand);
+  free(b.dist);
+  free(b.parent);
+  free(b.branch);
+  free(b.queue);
+}
+
+/* ========================================================================== */
+/* Public API                                                                 */
+/* ========================================================================== */
+ldpc_is_t *ldpc_is_create(const ldpc_graph_t *g, ldpc_is_mode mode,
+                          double shift, double p0) {
+  if (!(p0 > 0.0 && p0 < 1.0))
+    return NULL;
+
+  ldpc_is_t *is = (ldpc_is_t *)is_alloc(1, sizeof(ldpc_is_t));
+  is->mode = mode;
+  is->shift = shift;
+  is->p0 = p0;
+
+  if (mode == LDPC_IS_SHIFT) {
+    is->n_all = 1;
+    is->set_ptr = (int *)is_alloc(2, sizeof(int));
+    is->set_var = (int *)is_alloc(g->N, sizeof(int));
+    is->set_shift = (double *)is_alloc(1, sizeof(double));
+    is->set_ptr[0] = 0;
+    is->set_ptr[1] = g->N;
+    for (int j = 0; j < g->N; j++)
+      is->set_var[j] = j;
+  } else {
+    cycle_sets(is, g);
+  }
+
+  /* all sets in use, at the given shift */
+  is->active = (int *)is_alloc(is->n_all, sizeof(int));
+  is->n_sets = is->n_all;
+  for (int k = 0; k < is->n_all; k++) {
+    is->active[k] = k;
+    is->set_shift[k] = shift;
+  }
+
+  if (is->n_sets == 0) {
+    ldpc_is_free(is);
+    return NULL;
+  }
+  return is;
+}
+
+double ldpc_is_shift_auto(int n, double sigma2) {
+  return n > 0 ? LDPC_IS_SHIFT_KAPPA * sqrt(sigma2 / n) : 0.0;
+}
+
+void ldpc_is_set_shift(ldpc_is_t *is, double shift) {
+  is->shift = shift;
+  is->n_sets = is->n_all;
+  for (int k = 0; k < is->n_all; k++) {
+    is->active[k] = k;
+    is->set_shift[k] = shift;
+  }
+}
+
+void ldpc_is_free(ldpc_is_t *is) {
+  if (!is)
+    return;
+  free(is->set_ptr);
+  free(is->set_var);
+  free(is->set_shift);
+  free(is->active);
+  free(is);
+}
+
+int ldpc_is_n_sets(const ldpc_is_t *is) { return is->n_sets; }
+
+double ldpc_is_mean_set_size(const ldpc_is_t *is) {
+  long long bits = 0;
+  for (int a = 0; a < is->n_sets; a++)
+    bits += is->set_ptr[is->active[a] + 1] - is->set_ptr[is->active[a]];
+  return is->n_sets > 0 ? (double)bits / is->n_sets : 0.0;
+}
+
+/* ========================================================================== */
+/* Calibration                                                                */
+/* ========================================================================== */
+/* 1 if the noise-free all-zero frame with set k shifted by s is decoded
+ * wrongly */
+static int impulse_fails(const ldpc_is_t *is, int k, double s,
+                         ldpc_decoder_t *dec, int max_iter, double sigma2,
+                         double *LLR, int *ecc, int *inf, int N) {
+  for (int j = 0; j < N; j++)
+    LLR[j] = -2.0 / sigma2;
+  for (int e = is->set_ptr[k]; e < is->set_ptr[k + 1]; e++)
+    LLR[is->set_var[e]] = 2.0 * (s - 1.0) / sigma2;
+  ldpc_decoder_decode(dec, LLR, ecc, inf, max_iter);
+  for (int j = 0; j < N; j++)
+    if (ecc[j])
+      return 1;
+  return 0;
+}
+
+int ldpc_is_calibrate(ldpc_is_t *is, ldpc_decoder_t *dec, int N, int K,
+                      int max_iter, double sigma2) {
+  double *LLR = (double *)is_alloc(N, sizeof(double));
+  int *ecc = (int *)is_alloc(N, sizeof(int));
+  int *inf = (int *)is_alloc(K, sizeof(int));
+  int n = 0;
+
+  /* every candidate, also those an earlier calibration dropped */
+  for (int k = 0; k < is->n_all; k++) {
+    double lo = 0.0, hi = LDPC_IS_IMPULSE_MAX;
+    if (!impulse_fails(is, k, hi, dec, max_iter, sigma2, LLR, ecc, inf, N))
+      continue;
+    for (int step = 0; step < 16; step++) {
+      double mid = 0.5 * (lo + hi);
+      if (impulse_fails(is, k, mid, dec, max_iter, sigma2, LLR, ecc, inf, N))
+        hi = mid;
+      else
+        lo = mid;
+    }
+
+    /* keep set k, at its boundary */
+    is->set_shift[k] = hi;
+    is->active[n++] = k;
+  }
+  if (n > 0)
+    is->n_sets = n;
+
+  free(LLR);
+  free(ecc);
+  free(inf);
+  return n;
+}
+
+/* ========================================================================== */
+/* Sampling and weights                                                       */
+/* ========================================================================== */
+/*
+ * With x_j = ±1 and y_j = x_j + n_j, shifting the bits of set k by
+ * μ_j = −s·x_j gives the likelihood ratio
+ *
+ *      p(n − μ_k) / p(n) = exp(D_k),
+ *      D_k = (s · Σ_{j∈k} (1 − x_j y_j) − |k| s² / 2) / σ²
+ *
+ * so the weight of a frame is
+ *
+ *      w = 1 / (p0 + (1 − p0)/S · Σ_k exp(D_k)),
+ *
+ * evaluated around the largest D_k so no term overflows. The cost is one
+ * pass over the sets, Σ|k| ≤ N · LDPC_IS_MAX_CYCLE / 2 bit reads.
+ */
+double ldpc_is_awgn_llr(const ldpc_is_t *is, ldpc_rng_t *rng,
+                        const int *code, double *LLR, int n, double sigma2) {
+  ldpc_bpsk_awgn_llr(rng, code, LLR, n, sigma2);
+
+  /* mixture component: the unbiased one with probability p0 */
+  double u = ldpc_rng_uniform(rng);
+  if (u >= is->p0) {
+    int a = (int)((u - is->p0) / (1.0 - is->p0) * is->n_sets);
+    int k = is->active[a < is->n_sets ? a : is->n_sets - 1];
+    double d = 2.0 * is->set_shift[k] / sigma2;
+    for (int e = is->set_ptr[k]; e < is->set_ptr[k + 1]; e++) {
+      int j = is->set_var[e];
+      LLR[j] += code[j] ? -d : d;
+    }
+  }
+
+  double d_max = -HUGE_VAL, sum = 0.0;
+  for (int a = 0; a < is->n_sets; a++) {
+    int k = is->active[a];
+    double s = is->set_shift[k], t = 0.0;
+    for (int e = is->set_ptr[k]; e < is->set_ptr[k + 1]; e++) {
+      int j = is->set_var[e];
+      double xy = 0.5 * sigma2 * LLR[j]; /* x_j · y_j */
+      t += 1.0 - (code[j] ? xy : -xy);
+    }
+    int len = is->set_ptr[k + 1] - is->set_ptr[k];
+    double D = (s * t - 0.5 * len * s * s) / sigma2;
+    if (D > d_max) {
+      sum = sum * exp(d_max - D) + 1.0;
+      d_max = D;
+    } else {
+      sum += exp(D - d_max);
+    }
+  }
+
+  /* 1 / (p0 + c·e^{d_max}·sum) = e^{−d_max} / (p0·e^{−d_max} + c·sum) */
+  double c = (1.0 - is->p0) / is->n_sets;
+  if (d_max > 0.0)
+    return exp(-d_max) / (is->p0 * exp(-d_max) + c * sum);
+  return 1.0 / (is->p0 + c * sum * exp(d_max));
+}
+
+void ldpc_is_estimate(double sum, double sum2, long long n, double *mean,
+                      double *ci95) {
+  if (n <= 0) {
+    *mean = 0.0;
+    *ci95 = 0.0;
+    return;
+  }
+  double m = sum / n;
+  double var = sum2 / n - m * m;
+  if (n > 1)
+    var *= (double)n / (n - 1);
+  *mean = m;
+  *ci95 = var > 0.0 ? 1.96 * sqrt(var / n) : 0.0;
+}
@@ -6,6 +6,8 @@
  *   - Regular (w_c, w_r) Gallager-type parity-check matrix generation
  *   - Systematic generator matrix construction via Gaussian elimination
  *   - 4-cycle counting for structural LDPC code evaluation
+ *   - Sparse Tanner-graph (CSR/CSC) construction from a dense H
+ *   - alist and memory-mapped binary storage of the sparse H
  *
  * All operations are over GF(2): addition = XOR, multiplication = AND.
  *
@@ -19,10 +21,18 @@
  * simulation.
  */
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "ldpc_matrix.h"
 
 /* ========================================================================== */
@@ -125,134 +135,240 @@ void generate_Hmatrix(int **H, int N, int wc, int wr) {
  *     to maintain the H·G^T = 0 constraint
  */
 /* ========================================================================== */
-void generate_Gmatrix(int **H, int **G, int N, int wc, int wr) {
-  int M = (N * wc) / wr;
-
-  int i, j, k, l;
+/*
+ * Rows of X are bit-packed into uint64_t words (bit c of a row is bit
+ * c % 64 of word c / 64), so a row XOR is (M+N)/64 word operations and a
+ * row swap is a pointer swap.
+ *
+ * With m4ri_k > 0 the elimination is blocked by the Method of Four
+ * Russians: pivots for k consecutive columns are found first (pivot
+ * search on an k-bit window, lazily reduced), the k pivot rows are
+ * reduced among themselves, and every other row is updated with one XOR
+ * from a 2^k-entry table of pivot-row combinations instead of up to k
+ * row XORs. The reduced form of each row is unique, so the result is
+ * identical to the column-by-column elimination. A column that needs a
+ * column swap ends the block and is handled by the plain step.
+ */
+typedef struct {
+  int n;          /* rows (N)                  */
+  int cols;       /* columns (M + N)           */
+  int w;          /* words per row             */
+  uint64_t **r;   /* row pointers (swappable)  */
+  uint64_t *data; /* n × w words               */
+} gf2_rows_t;
 
-  /* X is the augmented matrix: [H^T | I] */
-  int **X = (int **)malloc(N * sizeof(int *));
-  for (i = 0; i < N; i++)
-    X[i] = (int *)malloc((M + N) * sizeof(int));
+static inline int gf2_bit(const uint64_t *row, int c) {
+  return (int)((row[c >> 6] >> (c & 63)) & 1);
+}
 
-  int *row_buf = (int *)malloc((M + N) * sizeof(int));
-  int *col_buf = (int *)malloc(N * sizeof(int));
-  int *Hcol_buf = (int *)malloc(M * sizeof(int));
+static inline void gf2_xor_row(uint64_t *dst, const uint64_t *src, int w) {
+  for (int t = 0; t < w; t++)
+    dst[t] ^= src[t];
+}
 
-  if (!X || !row_buf || !col_buf || !Hcol_buf) {
-    fprintf(stderr, "malloc failed in generate_Gmatrix\n");
-    exit(1);
-  }
+/* k (<= 16) bits of a row starting at column c */
+static inline unsigned gf2_window(const uint64_t *row, int c, int k) {
+  int o = c & 63;
+  uint64_t v = row[c >> 6] >> o;
+  if (o + k > 64)
+    v |= row[(c >> 6) + 1] << (64 - o);
+  return (unsigned)(v & ((1u << k) - 1));
+}
 
-  /* --------------------- Step 1: Build [H^T | I] ------------------------ */
-  for (i = 0; i < N; i++) {
-    for (j = 0; j < M; j++)
-      X[i][j] = H[j][i]; /* left block */
-    for (j = M; j < M + N; j++)
-      X[i][j] = (i == (j - M)) ? 1 : 0; /* right block = I */
+static void gf2_swap_cols(gf2_rows_t *X, int a, int b) {
+  for (int i = 0; i < X->n; i++) {
+    uint64_t *row = X->r[i];
+    if (gf2_bit(row, a) != gf2_bit(row, b)) {
+      row[a >> 6] ^= (uint64_t)1 << (a & 63);
+      row[b >> 6] ^= (uint64_t)1 << (b & 63);
+    }
   }
+}
 
-  /* -------- Step 2: Gaussian elimination on left block (H^T part only) --- */
-  for (j = 0; j < M; j++) {
-
-    /* If pivot missing → row swap OR column swap within X */
-    if (X[j][j] == 0) {
-
-      int pivot_found = 0;
-      for (i = j + 1; i < N; i++) {
-        if (X[i][j] == 1) {
-          memcpy(row_buf, X[i], (M + N) * sizeof(int));
-          memcpy(X[i], X[j], (M + N) * sizeof(int));
-          memcpy(X[j], row_buf, (M + N) * sizeof(int));
-          pivot_found = 1;
-          break;
-        }
+/*
+ * One plain Gauss–Jordan step on column j with pivot row pr:
+ *   - missing pivot → first row below with a 1 (row swap)
+ *   - still missing → last column k > k_low with X[pr][k] = 1 (column
+ *     swap, mirrored into H if given)
+ *   - clear column j in every other row
+ */
+static void gf2_gj_column(gf2_rows_t *X, int j, int pr, int k_low, int **H,
+                          int M) {
+  if (!gf2_bit(X->r[pr], j)) {
+    int found = 0;
+    for (int i = pr + 1; i < X->n; i++) {
+      if (gf2_bit(X->r[i], j)) {
+        uint64_t *t = X->r[i];
+        X->r[i] = X->r[pr];
+        X->r[pr] = t;
+        found = 1;
+        break;
       }
+    }
 
-      /* If pivot still not found → swap columns inside X */
-      if (!pivot_found) {
-        for (k = M + N - 1; k > j; k--) {
-          if (X[j][k] == 1) {
-            for (l = 0; l < N; l++) {
-              col_buf[l] = X[l][k];
-              X[l][k] = X[l][j];
-              X[l][j] = col_buf[l];
+    if (!found) {
+      for (int k = X->cols - 1; k > k_low; k--) {
+        if (gf2_bit(X->r[pr], k)) {
+          gf2_swap_cols(X, k, j);
+          if (H) {
+            for (int l = 0; l < M; l++) {
+              int t = H[l][k - M];
+              H[l][k - M] = H[l][j - M];
+              H[l][j - M] = t;
             }
-            break;
           }
+          break;
         }
       }
     }
-
-    /* Row elimination (GF(2)) */
-    for (i = 0; i < N; i++)
-      if (i != j && X[i][j] == 1)
-        for (k = 0; k < M + N; k++)
-          X[i][k] ^= X[j][k];
   }
 
-  /* ------------- Step 3: Elimination on right block with H updates ------- */
-  for (j = 2 * M; j < M + N; j++) {
+  const uint64_t *P = X->r[pr];
+  for (int i = 0; i < X->n; i++)
+    if (i != pr && gf2_bit(X->r[i], j))
+      gf2_xor_row(X->r[i], P, X->w);
+}
 
-    int pivot_row = j - M;
+/*
+ * Four-Russians block on columns j0 .. j0+k-1 (pivot row of column j is
+ * j - off). Returns the number of columns eliminated; fewer than k means
+ * column j0 + ret has no pivot row and needs gf2_gj_column().
+ */
+static int gf2_m4ri_block(gf2_rows_t *X, int j0, int k, int off,
+                          uint64_t *table) {
+  const int w = X->w;
+  unsigned pwin[16]; /* pivot windows at selection time */
+  int sel;
 
-    if (X[pivot_row][j] == 0) {
+  /* ---- pivot selection (same rows as the column-by-column search) ---- */
+  for (sel = 0; sel < k; sel++) {
+    int pr = j0 + sel - off;
+    int found = -1;
 
-      int found = 0;
-      for (i = pivot_row + 1; i < N; i++) {
-        if (X[i][j] == 1) {
-          memcpy(row_buf, X[i], (M + N) * sizeof(int));
-          memcpy(X[i], X[pivot_row], (M + N) * sizeof(int));
-          memcpy(X[pivot_row], row_buf, (M + N) * sizeof(int));
-          found = 1;
-          break;
-        }
-      }
+    for (int i = pr; i < X->n && found < 0; i++) {
+      unsigned win = gf2_window(X->r[i], j0, k);
+      for (int a = 0; a < sel; a++)
+        if ((win >> a) & 1)
+          win ^= pwin[a];
+      if ((win >> sel) & 1)
+        found = i;
+    }
+    if (found < 0)
+      break;
 
-      /* Still missing pivot → swap columns → update H accordingly */
-      if (!found) {
-        for (k = M + N - 1; k > M - 1; k--) {
-          if (X[pivot_row][k] == 1) {
+    if (found != pr) {
+      uint64_t *t = X->r[found];
+      X->r[found] = X->r[pr];
+      X->r[pr] = t;
+    }
 
-            /* swap columns in X */
-            for (l = 0; l < N; l++) {
-              col_buf[l] = X[l][k];
-              X[l][k] = X[l][j];
-              X[l][j] = col_buf[l];
-            }
+    /* bring the new pivot row to its sequential state */
+    uint64_t *P = X->r[pr];
+    for (int a = 0; a < sel; a++)
+      if (gf2_bit(P, j0 + a))
+        gf2_xor_row(P, X->r[j0 + a - off], w);
+    pwin[sel] = gf2_window(P, j0, k);
+  }
+  if (sel == 0)
+    return 0;
 
-            /* mirror swap inside H (only H columns affected) */
-            for (l = 0; l < M; l++) {
-              Hcol_buf[l] = H[l][k - M];
-              H[l][k - M] = H[l][j - M];
-              H[l][j - M] = Hcol_buf[l];
-            }
+  /* ---- reduce pivot rows among themselves ---------------------------- */
+  const int p0 = j0 - off;
+  for (int b = 1; b < sel; b++)
+    for (int a = 0; a < b; a++)
+      if (gf2_bit(X->r[p0 + a], j0 + b))
+        gf2_xor_row(X->r[p0 + a], X->r[p0 + b], w);
 
-            break;
-          }
-        }
-      }
+  /* ---- table of all pivot-row combinations (Gray-code build) --------- */
+  memset(table, 0, (size_t)w * sizeof(uint64_t));
+  for (unsigned idx = 1; idx < (1u << sel); idx++) {
+    uint64_t *T = table + (size_t)idx * w;
+    memcpy(T, table + (size_t)(idx & (idx - 1)) * w, w * sizeof(uint64_t));
+    gf2_xor_row(T, X->r[p0 + __builtin_ctz(idx)], w);
+  }
+
+  /* ---- one table XOR per remaining row ------------------------------- */
+  for (int i = 0; i < X->n; i++) {
+    if (i >= p0 && i < p0 + sel)
+      continue;
+    unsigned idx = gf2_window(X->r[i], j0, sel);
+    if (idx)
+      gf2_xor_row(X->r[i], table + (size_t)idx * w, w);
+  }
+  return sel;
+}
+
+/* Eliminate columns [j_begin, j_end). H != NULL selects the step-3 rule
+ * (column swaps restricted to the right block and mirrored into H). */
+static void gf2_eliminate(gf2_rows_t *X, int j_begin, int j_end, int off,
+                          int **H, int M, int m4ri_k, uint64_t *table) {
+  int j = j_begin;
+  while (j < j_end) {
+    if (m4ri_k > 0) {
+      int kk = (j_end - j < m4ri_k) ? j_end - j : m4ri_k;
+      int done = gf2_m4ri_block(X, j, kk, off, table);
+      j += done;
+      if (done == kk)
+        continue;
     }
+    gf2_gj_column(X, j, j - off, H ? M - 1 : j, H, M);
+    j++;
+  }
+}
 
-    /* eliminate other rows */
-    for (i = 0; i < N; i++)
-      if (i != pivot_row && X[i][j] == 1)
-        for (k = 0; k < M + N; k++)
-          X[i][k] ^= X[pivot_row][k];
+void generate_Gmatrix(int **H, int **G, int N, int wc, int wr) {
+  generate_Gmatrix_m4ri(H, G, N, wc, wr, LDPC_M4RI_K_DEFAULT);
+}
+
+void generate_Gmatrix_m4ri(int **H, int **G, int N, int wc, int wr,
+                           int m4ri_k) {
+  int M = (N * wc) / wr;
+
+  int i, j;
+
+  if (m4ri_k > 16)
+    m4ri_k = 16;
+
+  /* X is the augmented matrix: [H^T | I], bit-packed rows */
+  gf2_rows_t X;
+  X.n = N;
+  X.cols = M + N;
+  X.w = (M + N + 63) / 64;
+  X.data = (uint64_t *)calloc((size_t)N * X.w, sizeof(uint64_t));
+  X.r = (uint64_t **)malloc(N * sizeof(uint64_t *));
+  uint64_t *table = (uint64_t *)malloc(
+      ((size_t)1 << (m4ri_k > 0 ? m4ri_k : 0)) * X.w * sizeof(uint64_t));
+
+  if (!X.data || !X.r || !table) {
+    fprintf(stderr, "malloc failed in generate_Gmatrix\n");
+    exit(1);
   }
 
+  /* --------------------- Step 1: Build [H^T | I] ------------------------ */
+  for (i = 0; i < N; i++) {
+    X.r[i] = X.data + (size_t)i * X.w;
+    X.r[i][(M + i) >> 6] |= (uint64_t)1 << ((M + i) & 63); /* right = I */
+  }
+  for (j = 0; j < M; j++) /* left block, walking H row by row */
+    for (i = 0; i < N; i++)
+      if (H[j][i])
+        X.r[i][j >> 6] |= (uint64_t)1 << (j & 63);
+
+  /* -------- Step 2: Gaussian elimination on left block (H^T part only) --- */
+  gf2_eliminate(&X, 0, M, 0, NULL, M, m4ri_k, table);
+
+  /* ------------- Step 3: Elimination on right block with H updates ------- */
+  gf2_eliminate(&X, 2 * M, M + N, M, H, M, m4ri_k, table);
+
   /* ----------------------- Step 4: Extract G (K×N) ----------------------- */
   for (i = M; i < N; i++)
     for (j = M; j < M + N; j++)
-      G[i - M][j - M] = X[i][j];
+      G[i - M][j - M] = gf2_bit(X.r[i], j);
 
   /* cleanup */
-  for (i = 0; i < N; i++)
-    free(X[i]);
-  free(X);
-  free(row_buf);
-  free(col_buf);
-  free(Hcol_buf);
+  free(X.data);
+  free(X.r);
+  free(table);
 }
 
 /* ========================================================================== */
@@ -263,60 +379,946 @@ void generate_Gmatrix(int **H, int **G, int N, int wc, int wr) {
  * Short cycles harm message-passing performance (SPA/BP).
  *
  * This function:
- *   - Builds adjacency lists of check nodes for each variable
- *   - Counts the number of pairs of columns sharing ≥2 rows
- *   - Counts multiplicities using nC2 = shared! / (2!(shared-2)!)
+ *   - Converts H to its Tanner graph (edge lists)
+ *   - Counts, for every column, how many rows it shares with each later
+ *     column reachable through its checks (see section 6)
+ *   - Adds shared·(shared−1)/2 for every pair sharing ≥2 rows
+ *
+ * Only column pairs that actually meet in a check are visited:
+ * O(N·wc·wr) = O(M·wr²) instead of O(N²·wc²) for all pairs.
  *
  * A good LDPC code strives to minimize such 4-cycles.
  */
 /* ========================================================================== */
-static int factorial(int n) {
-  int f = 1;
-  for (int i = 1; i <= n; i++)
-    f *= i;
-  return f;
+int count_floop(int **H, int N, int wc, int wr) {
+  int M = (N * wc) / wr;
+
+  ldpc_graph_t *g = ldpc_graph_create(H, M, N);
+  long long floop = ldpc_graph_count_4cycles(g);
+  ldpc_graph_free(g);
+
+  return (int)floop;
 }
 
-int count_floop(int **H, int N, int wc, int wr) {
+/* ========================================================================== */
+/* 4. Sparse Tanner Graph (CSR/CSC edge lists)                                */
+/* -------------------------------------------------------------------------- */
+/*
+ * Convert the dense 0/1 matrix H into edge lists once, so that decoders and
+ * analysis routines can walk only the n_edges ones of H instead of all M·N
+ * entries.
+ *
+ *   pass 1: count row/column degrees and build row_ptr / col_ptr
+ *   pass 2: scan H row by row, numbering edges in check-major order, and
+ *           append each edge to its column's CSC slot list
+ *
+ * Because rows are scanned in ascending order, the CSC slots of each column
+ * are also sorted by check index.
+ *
+ * Layers are found greedily: consecutive rows are appended to the current
+ * layer until a row hits a column the layer already covers.
+ */
+/* ========================================================================== */
+ldpc_graph_t *ldpc_graph_create(int **H, int M, int N) {
+  int i, j;
+
+  int *row_ptr = (int *)calloc(M + 1, sizeof(int));
+  if (!row_ptr) {
+    fprintf(stderr, "malloc failed in ldpc_graph_create\n");
+    exit(1);
+  }
+  for (i = 0; i < M; i++)
+    for (j = 0; j < N; j++)
+      row_ptr[i + 1] += (H[i][j] != 0);
+  for (i = 0; i < M; i++)
+    row_ptr[i + 1] += row_ptr[i];
+
+  int *col_idx = (int *)malloc((row_ptr[M] > 0 ? row_ptr[M] : 1) * sizeof(int));
+  if (!col_idx) {
+    fprintf(stderr, "malloc failed in ldpc_graph_create\n");
+    exit(1);
+  }
+  int e = 0;
+  for (i = 0; i < M; i++)
+    for (j = 0; j < N; j++)
+      if (H[i][j])
+        col_idx[e++] = j;
+
+  ldpc_graph_t *g = ldpc_graph_create_csr(M, N, row_ptr, col_idx);
+  free(row_ptr);
+  free(col_idx);
+  return g;
+}
+
+ldpc_graph_t *ldpc_graph_create_csr(int M, int N, const int *row_ptr,
+                                    const int *col_idx) {
+  int i, j, e;
+
+  ldpc_graph_t *g = (ldpc_graph_t *)calloc(1, sizeof(ldpc_graph_t));
+  if (!g) {
+    fprintf(stderr, "malloc failed in ldpc_graph_create\n");
+    exit(1);
+  }
+  g->M = M;
+  g->N = N;
+  g->n_edges = row_ptr[M];
+
+  g->row_ptr = (int *)malloc((M + 1) * sizeof(int));
+  g->col_ptr = (int *)calloc(N + 1, sizeof(int));
+  if (!g->row_ptr || !g->col_ptr) {
+    fprintf(stderr, "malloc failed in ldpc_graph_create\n");
+    exit(1);
+  }
+  memcpy(g->row_ptr, row_ptr, (M + 1) * sizeof(int));
+
+  /* ---------------- column degrees → prefix offsets ----------------- */
+  for (e = 0; e < g->n_edges; e++)
+    g->col_ptr[col_idx[e] + 1]++;
+  for (j = 0; j < N; j++)
+    g->col_ptr[j + 1] += g->col_ptr[j];
+
+  /* at least one element so that empty graphs still get valid pointers */
+  size_t n_alloc = (size_t)(g->n_edges > 0 ? g->n_edges : 1);
+  g->col_idx = (int *)malloc(n_alloc * sizeof(int));
+  g->col_edge = (int *)malloc(n_alloc * sizeof(int));
+  g->row_idx = (int *)malloc(n_alloc * sizeof(int));
+  int *fill = (int *)malloc((N > 0 ? N : 1) * sizeof(int));
+  if (!g->col_idx || !g->col_edge || !g->row_idx || !fill) {
+    fprintf(stderr, "malloc failed in ldpc_graph_create\n");
+    exit(1);
+  }
+
+  /* ---------------- fill edge lists (CSC slots sorted by row) -------- */
+  memcpy(g->col_idx, col_idx, g->n_edges * sizeof(int));
+  for (j = 0; j < N; j++)
+    fill[j] = g->col_ptr[j];
+
+  for (i = 0; i < M; i++) {
+    for (e = row_ptr[i]; e < row_ptr[i + 1]; e++) {
+      int s = fill[col_idx[e]]++;
+      g->col_edge[s] = e;
+      g->row_idx[s] = i;
+    }
+  }
+
+  /* ---------------- degree bounds ----------------------------------- */
+  for (i = 0; i < M; i++)
+    if (g->row_ptr[i + 1] - g->row_ptr[i] > g->max_row_deg)
+      g->max_row_deg = g->row_ptr[i + 1] - g->row_ptr[i];
+  for (j = 0; j < N; j++)
+    if (g->col_ptr[j + 1] - g->col_ptr[j] > g->max_col_deg)
+      g->max_col_deg = g->col_ptr[j + 1] - g->col_ptr[j];
+
+  /* ---------------- row layers (reuse fill[] as "last layer") -------- */
+  g->layer_ptr = (int *)malloc((M + 1) * sizeof(int));
+  if (!g->layer_ptr) {
+    fprintf(stderr, "malloc failed in ldpc_graph_create\n");
+    exit(1);
+  }
+  for (j = 0; j < N; j++)
+    fill[j] = -1;
+
+  g->n_layers = 0;
+  for (i = 0; i < M; i++) {
+    int clash = (i == 0);
+    for (e = g->row_ptr[i]; e < g->row_ptr[i + 1] && !clash; e++)
+      if (fill[g->col_idx[e]] == g->n_layers - 1)
+        clash = 1;
+
+    if (clash)
+      g->layer_ptr[g->n_layers++] = i;
+
+    for (e = g->row_ptr[i]; e < g->row_ptr[i + 1]; e++)
+      fill[g->col_idx[e]] = g->n_layers - 1;
+  }
+  g->layer_ptr[g->n_layers] = M;
+
+  free(fill);
+  return g;
+}
+
+ldpc_graph_t *ldpc_graph_gallager(int N, int wc, int wr, ldpc_rng_t *rng) {
+  int M = (N * wc) / wr;
+  int block_rows = M / wc;
+  int used = block_rows * wr; /* columns with a one in block 0 */
+
+  int *perm = (int *)malloc((N > 0 ? N : 1) * sizeof(int));
+  int *fill = (int *)malloc((block_rows > 0 ? block_rows : 1) * sizeof(int));
+  int *row_ptr = (int *)malloc((M + 1) * sizeof(int));
+  int *col_idx = (int *)malloc(
+      ((size_t)wc * used > 0 ? (size_t)wc * used : 1) * sizeof(int));
+  if (!perm || !fill || !row_ptr || !col_idx) {
+    fprintf(stderr, "malloc failed in ldpc_graph_gallager\n");
+    exit(1);
+  }
+
+  /* every row of the wc blocks has wr ones, trailing rows are empty */
+  for (int i = 0; i <= M; i++)
+    row_ptr[i] = (i < wc * block_rows ? i : wc * block_rows) * wr;
+
+  /* Block 0: row i holds columns i·wr .. (i+1)·wr − 1 */
+  for (int j = 0; j < used; j++)
+    col_idx[j] = j;
+
+  /* Block b: H[b·block_rows + r][k] = H[r][perm[k]], i.e. column k lands
+   * in row perm[k] / wr; visiting k in order keeps rows sorted */
+  for (int b = 1; b < wc; b++) {
+    for (int j = 0; j < N; j++)
+      perm[j] = j;
+
+    /* same shuffle as generate_Hmatrix() */
+    for (int j = 0; j < N; j++) {
+      int r = (int)(ldpc_rng_next(rng) % (uint64_t)N);
+      int tmp = perm[j];
+      perm[j] = perm[r];
+      perm[r] = tmp;
+    }
+
+    int *blk = col_idx + row_ptr[b * block_rows];
+    for (int r = 0; r < block_rows; r++)
+      fill[r] = r * wr;
+    for (int k = 0; k < N; k++)
+      if (perm[k] < used)
+        blk[fill[perm[k] / wr]++] = k;
+  }
+
+  ldpc_graph_t *g = ldpc_graph_create_csr(M, N, row_ptr, col_idx);
+  free(perm);
+  free(fill);
+  free(row_ptr);
+  free(col_idx);
+  return g;
+}
+
+ldpc_graph_t *ldpc_graph_peg(int N, int wc, int wr, ldpc_rng_t *rng) {
   int M = (N * wc) / wr;
+  if (M < 1 || wc < 1 || wc > M)
+    return NULL;
+  int cap = (int)(((long long)N * wc + M - 1) / M); /* check degree bound */
 
-  /* store row positions of '1's for each column */
-  int **var_nodes = (int **)malloc(N * sizeof(int *));
-  for (int i = 0; i < N; i++)
-    var_nodes[i] = (int *)malloc(wc * sizeof(int));
+  /* adjacency built so far: checks of each variable, variables of each
+   * check (fixed-size slots, variables appended in ascending order) */
+  int *vc = (int *)malloc((size_t)N * wc * sizeof(int));
+  int *cv = (int *)malloc((size_t)M * cap * sizeof(int));
+  int *cdeg = (int *)calloc(M, sizeof(int));
+  /* BFS state: stamps avoid clearing per search */
+  int *cdist = (int *)malloc(M * sizeof(int));
+  int *cstamp = (int *)calloc(M, sizeof(int));
+  int *vstamp = (int *)calloc(N, sizeof(int));
+  int *queue = (int *)malloc(M * sizeof(int));
+  if (!vc || !cv || !cdeg || !cdist || !cstamp || !vstamp || !queue) {
+    fprintf(stderr, "malloc failed in ldpc_graph_peg\n");
+    exit(1);
+  }
 
-  /* build adjacency list: var_nodes[j][*] = rows where H[row][j] = 1 */
+  int stamp = 0;
   for (int j = 0; j < N; j++) {
-    int idx = 0;
-    for (int i = 0; i < M; i++) {
-      if (H[i][j])
-        var_nodes[j][idx++] = i;
-      if (idx == wc)
+    for (int k = 0; k < wc; k++) {
+      /* -------- distances from j to every check (in check levels) ---- */
+      stamp++;
+      int head = 0, tail = 0;
+      vstamp[j] = stamp;
+      for (int t = 0; t < k; t++) {
+        int c = vc[j * wc + t];
+        cstamp[c] = stamp;
+        cdist[c] = 0;
+        queue[tail++] = c;
+      }
+      while (head < tail) {
+        int c = queue[head++];
+        for (int t = 0; t < cdeg[c]; t++) {
+          int v = cv[c * cap + t];
+          if (vstamp[v] == stamp)
+            continue;
+          vstamp[v] = stamp;
+          int dv = (v < j) ? wc : k; /* edges placed so far */
+          for (int u = 0; u < dv; u++) {
+            int c2 = vc[v * wc + u];
+            if (c2 < 0)
+              break;
+            if (cstamp[c2] != stamp) {
+              cstamp[c2] = stamp;
+              cdist[c2] = cdist[c] + 1;
+              queue[tail++] = c2;
+            }
+          }
+        }
+      }
+
+      /* -------- farthest, then least loaded, then random ---------------- */
+      int best = -1, best_dist = 0, best_deg = 0, n_ties = 0;
+      for (int c = 0; c < M; c++) {
+        if (cdeg[c] >= cap)
+          continue;
+        int d = (cstamp[c] == stamp) ? cdist[c] : 0x7fffffff;
+        if (d == 0)
+          continue; /* already adjacent to j */
+        if (best < 0 || d > best_dist ||
+            (d == best_dist && cdeg[c] < best_deg)) {
+          best = c;
+          best_dist = d;
+          best_deg = cdeg[c];
+          n_ties = 1;
+        } else if (d == best_dist && cdeg[c] == best_deg) {
+          /* reservoir sampling over the ties */
+          if (ldpc_rng_next(rng) % (uint64_t)++n_ties == 0)
+            best = c;
+        }
+      }
+      if (best < 0) {
+        /* every check with room is already adjacent: degree < wc */
+        for (int u = k; u < wc; u++)
+          vc[j * wc + u] = -1;
         break;
+      }
+
+      vc[j * wc + k] = best;
+      cv[best * cap + cdeg[best]++] = j;
     }
   }
 
-  int floop = 0;
+  /* CSR: variables of each check are already ascending */
+  int *row_ptr = (int *)malloc((M + 1) * sizeof(int));
+  if (!row_ptr) {
+    fprintf(stderr, "malloc failed in ldpc_graph_peg\n");
+    exit(1);
+  }
+  row_ptr[0] = 0;
+  for (int c = 0; c < M; c++) {
+    memmove(cv + row_ptr[c], cv + (size_t)c * cap, cdeg[c] * sizeof(int));
+    row_ptr[c + 1] = row_ptr[c] + cdeg[c];
+  }
+
+  ldpc_graph_t *g = ldpc_graph_create_csr(M, N, row_ptr, cv);
+  free(vc);
+  free(cv);
+  free(cdeg);
+  free(cdist);
+  free(cstamp);
+  free(vstamp);
+  free(queue);
+  free(row_ptr);
+  return g;
+}
+
+ldpc_graph_t *ldpc_graph_permute_cols(const ldpc_graph_t *g,
+                                      const int *perm) {
+  int *inv = (int *)malloc((g->N > 0 ? g->N : 1) * sizeof(int));
+  int *col_idx = (int *)malloc(
+      (g->n_edges > 0 ? g->n_edges : 1) * sizeof(int));
+  if (!inv || !col_idx) {
+    fprintf(stderr, "malloc failed in ldpc_graph_permute_cols\n");
+    exit(1);
+  }
+
+  for (int j = 0; j < g->N; j++)
+    inv[perm[j]] = j;
+  for (int e = 0; e < g->n_edges; e++)
+    col_idx[e] = inv[g->col_idx[e]];
 
-  /* Count column pairs sharing ≥2 check nodes (4-cycles) */
-  for (int i = 0; i < N - 1; i++) {
-    for (int j = i + 1; j < N; j++) {
+  ldpc_graph_t *gp = ldpc_graph_create_csr(g->M, g->N, g->row_ptr, col_idx);
+  free(inv);
+  free(col_idx);
+  return gp;
+}
 
-      int shared = 0;
-      for (int k = 0; k < wc; k++)
-        for (int l = 0; l < wc; l++)
-          if (var_nodes[i][k] == var_nodes[j][l])
-            shared++;
+void ldpc_graph_free(ldpc_graph_t *g) {
+  if (!g)
+    return;
+  if (g->map) {
+    /* arrays point into the file image */
+#ifdef _WIN32
+    free(g->map);
+#else
+    munmap(g->map, g->map_size);
+#endif
+    free(g);
+    return;
+  }
+  free(g->row_ptr);
+  free(g->col_idx);
+  free(g->col_ptr);
+  free(g->col_edge);
+  free(g->row_idx);
+  free(g->layer_ptr);
+  free(g);
+}
 
-      if (shared >= 2)
-        floop += factorial(shared) / (2 * factorial(shared - 2));
+/* ========================================================================== */
+/* 5. Sparse Matrix Files (alist, binary image)                               */
+/* -------------------------------------------------------------------------- */
+/*
+ * alist is the common exchange format for sparse codes; it is parsed once
+ * into CSR and goes through ldpc_graph_create_csr().
+ *
+ * The binary image stores the finished graph arrays, so a loader only has
+ * to validate them; with mmap() all workers on a host share one copy of
+ * the pages. Every index is range-checked on load because the decoders
+ * index message arrays with them unchecked.
+ */
+/* ========================================================================== */
+int ldpc_graph_write_alist(const ldpc_graph_t *g, const char *path) {
+  FILE *fp = fopen(path, "w");
+  if (!fp)
+    return -1;
+
+  int i, j, k;
+  fprintf(fp, "%d %d\n%d %d\n", g->N, g->M, g->max_col_deg, g->max_row_deg);
+  for (j = 0; j < g->N; j++)
+    fprintf(fp, "%d%c", g->col_ptr[j + 1] - g->col_ptr[j],
+            j + 1 < g->N ? ' ' : '\n');
+  for (i = 0; i < g->M; i++)
+    fprintf(fp, "%d%c", g->row_ptr[i + 1] - g->row_ptr[i],
+            i + 1 < g->M ? ' ' : '\n');
+
+  for (j = 0; j < g->N; j++) {
+    int d = g->col_ptr[j + 1] - g->col_ptr[j];
+    for (k = 0; k < g->max_col_deg; k++)
+      fprintf(fp, "%d%c", k < d ? g->row_idx[g->col_ptr[j] + k] + 1 : 0,
+              k + 1 < g->max_col_deg ? ' ' : '\n');
+  }
+  for (i = 0; i < g->M; i++) {
+    int d = g->row_ptr[i + 1] - g->row_ptr[i];
+    for (k = 0; k < g->max_row_deg; k++)
+      fprintf(fp, "%d%c", k < d ? g->col_idx[g->row_ptr[i] + k] + 1 : 0,
+              k + 1 < g->max_row_deg ? ' ' : '\n');
+  }
+
+  return fclose(fp) == 0 ? 0 : -1;
+}
+
+/* next non-zero entry of an alist list (skips the 0 padding) */
+static int alist_next_index(FILE *fp, int *v) {
+  do {
+    if (fscanf(fp, "%d", v) != 1)
+      return -1;
+  } while (*v == 0);
+  return 0;
+}
+
+ldpc_graph_t *ldpc_graph_read_alist(const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+    return NULL;
+
+  int N, M, max_cd, max_rd, i, j, k;
+  if (fscanf(fp, "%d %d %d %d", &N, &M, &max_cd, &max_rd) != 4 || N <= 0 ||
+      M <= 0) {
+    fclose(fp);
+    return NULL;
+  }
+
+  int *col_deg = (int *)malloc(N * sizeof(int));
+  int *row_deg = (int *)malloc(M * sizeof(int));
+  int *row_ptr = (int *)calloc(M + 1, sizeof(int));
+  if (!col_deg || !row_deg || !row_ptr) {
+    fprintf(stderr, "malloc failed in ldpc_graph_read_alist\n");
+    exit(1);
+  }
+
+  long long n_edges = 0;
+  int ok = 1;
+  for (j = 0; j < N && ok; j++) {
+    ok = fscanf(fp, "%d", &col_deg[j]) == 1 && col_deg[j] >= 0 &&
+         col_deg[j] <= M;
+    n_edges += ok ? col_deg[j] : 0;
+  }
+  for (i = 0; i < M && ok; i++)
+    ok = fscanf(fp, "%d", &row_deg[i]) == 1 && row_deg[i] >= 0;
+  ok = ok && n_edges <= 0x7fffffff;
+
+  /* column lists → (row, column) pairs in column-major order */
+  int *edge_row = NULL, *edge_col = NULL;
+  if (ok) {
+    edge_row = (int *)malloc((n_edges > 0 ? n_edges : 1) * sizeof(int));
+    edge_col = (int *)malloc((n_edges > 0 ? n_edges : 1) * sizeof(int));
+    if (!edge_row || !edge_col) {
+      fprintf(stderr, "malloc failed in ldpc_graph_read_alist\n");
+      exit(1);
+    }
+  }
+  int e = 0;
+  for (j = 0; j < N && ok; j++) {
+    for (k = 0; k < col_deg[j] && ok; k++) {
+      int r;
+      ok = alist_next_index(fp, &r) == 0 && r >= 1 && r <= M;
+      if (ok) {
+        edge_row[e] = r - 1;
+        edge_col[e++] = j;
+        row_ptr[r]++;
+      }
     }
   }
+  fclose(fp);
 
-  /* cleanup */
-  for (int i = 0; i < N; i++)
-    free(var_nodes[i]);
-  free(var_nodes);
+  /* the row section must agree with the column section */
+  for (i = 0; i < M && ok; i++)
+    ok = row_ptr[i + 1] == row_deg[i];
+
+  ldpc_graph_t *g = NULL;
+  if (ok) {
+    for (i = 0; i < M; i++)
+      row_ptr[i + 1] += row_ptr[i];
+
+    /* bucket by row; columns come out ascending within each row */
+    int *col_idx = (int *)malloc((e > 0 ? e : 1) * sizeof(int));
+    int *fill = (int *)malloc(M * sizeof(int));
+    if (!col_idx || !fill) {
+      fprintf(stderr, "malloc failed in ldpc_graph_read_alist\n");
+      exit(1);
+    }
+    memcpy(fill, row_ptr, M * sizeof(int));
+    for (k = 0; k < e && ok; k++) {
+      int s = fill[edge_row[k]]++;
+      /* a row listed twice in one column */
+      ok = !(s > row_ptr[edge_row[k]] && col_idx[s - 1] == edge_col[k]);
+      col_idx[s] = edge_col[k];
+    }
+    if (ok)
+      g = ldpc_graph_create_csr(M, N, row_ptr, col_idx);
+    free(col_idx);
+    free(fill);
+  }
+
+  free(col_deg);
+  free(row_deg);
+  free(row_ptr);
+  free(edge_row);
+  free(edge_col);
+  return g;
+}
+
+static const char hbin_magic[8] = {'L', 'D', 'P', 'C', 'H', 'B', '0', '1'};
+
+enum {
+  HBIN_ROW_PTR = 0,
+  HBIN_COL_IDX,
+  HBIN_COL_PTR,
+  HBIN_COL_EDGE,
+  HBIN_ROW_IDX,
+  HBIN_LAYER_PTR,
+  HBIN_P,
+  HBIN_SECTIONS
+};
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t bom;
+  int32_t M, N, n_edges, n_layers;
+  int32_t max_row_deg, max_col_deg;
+  int32_t K, pw;
+  uint64_t off[HBIN_SECTIONS];
+  uint64_t file_size;
+} hbin_header_t;
+
+#define HBIN_BOM 0x01020304u
+
+/* section sizes in bytes, in file order */
+static void hbin_sizes(const hbin_header_t *h, uint64_t *size) {
+  size[HBIN_ROW_PTR] = ((uint64_t)h->M + 1) * sizeof(int32_t);
+  size[HBIN_COL_IDX] = (uint64_t)h->n_edges * sizeof(int32_t);
+  size[HBIN_COL_PTR] = ((uint64_t)h->N + 1) * sizeof(int32_t);
+  size[HBIN_COL_EDGE] = (uint64_t)h->n_edges * sizeof(int32_t);
+  size[HBIN_ROW_IDX] = (uint64_t)h->n_edges * sizeof(int32_t);
+  size[HBIN_LAYER_PTR] = ((uint64_t)h->n_layers + 1) * sizeof(int32_t);
+  size[HBIN_P] = (uint64_t)h->K * h->pw * sizeof(uint64_t);
+}
+
+int ldpc_graph_save_bin(const ldpc_graph_t *g, const uint64_t *P, int K,
+                        const char *path) {
+  hbin_header_t h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, hbin_magic, 8);
+  h.version = LDPC_HBIN_VERSION;
+  h.bom = HBIN_BOM;
+  h.M = g->M;
+  h.N = g->N;
+  h.n_edges = g->n_edges;
+  h.n_layers = g->n_layers;
+  h.max_row_deg = g->max_row_deg;
+  h.max_col_deg = g->max_col_deg;
+  h.K = P ? K : 0;
+  h.pw = P ? (g->M + 63) / 64 : 0;
+
+  const void *data[HBIN_SECTIONS] = {g->row_ptr,  g->col_idx, g->col_ptr,
+                                     g->col_edge, g->row_idx, g->layer_ptr,
+                                     P};
+  uint64_t size[HBIN_SECTIONS];
+  hbin_sizes(&h, size);
+
+  uint64_t pos = sizeof(h);
+  for (int k = 0; k < HBIN_SECTIONS; k++) {
+    if (k == HBIN_P && !P)
+      continue;
+    h.off[k] = pos;
+    pos = (pos + size[k] + 7) & ~(uint64_t)7;
+  }
+  h.file_size = pos;
+
+  FILE *fp = fopen(path, "wb");
+  if (!fp)
+    return -1;
+
+  static const char pad[8] = {0};
+  int ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+  for (int k = 0; k < HBIN_SECTIONS && ok; k++) {
+    if (!h.off[k])
+      continue;
+    ok = fwrite(data[k], 1, size[k], fp) == size[k] &&
+         fwrite(pad, 1, (8 - size[k] % 8) % 8, fp) == (8 - size[k] % 8) % 8;
+  }
+
+  if (fclose(fp) != 0)
+    ok = 0;
+  return ok ? 0 : -1;
+}
+
+/* Offsets must be monotone from 0 to last and the degree bound exact. */
+static int hbin_check_ptr(const int *ptr, int n, int last, int max_deg) {
+  int m = 0;
+  if (ptr[0] != 0 || ptr[n] != last)
+    return 0;
+  for (int i = 0; i < n; i++) {
+    if (ptr[i + 1] < ptr[i])
+      return 0;
+    if (ptr[i + 1] - ptr[i] > m)
+      m = ptr[i + 1] - ptr[i];
+  }
+  return max_deg < 0 || m == max_deg;
+}
+
+static int hbin_check_graph(const ldpc_graph_t *g) {
+  int i, j, e, s;
+  if (!hbin_check_ptr(g->row_ptr, g->M, g->n_edges, g->max_row_deg) ||
+      !hbin_check_ptr(g->col_ptr, g->N, g->n_edges, g->max_col_deg))
+    return 0;
+
+  /* columns strictly ascending within each row */
+  for (i = 0; i < g->M; i++)
+    for (e = g->row_ptr[i]; e < g->row_ptr[i + 1]; e++)
+      if (g->col_idx[e] < 0 || g->col_idx[e] >= g->N ||
+          (e > g->row_ptr[i] && g->col_idx[e] <= g->col_idx[e - 1]))
+        return 0;
+
+  /* every CSC slot names an edge of its column in its row */
+  for (j = 0; j < g->N; j++)
+    for (s = g->col_ptr[j]; s < g->col_ptr[j + 1]; s++) {
+      int r = g->row_idx[s];
+      e = g->col_edge[s];
+      if (r < 0 || r >= g->M || e < g->row_ptr[r] || e >= g->row_ptr[r + 1] ||
+          g->col_idx[e] != j || (s > g->col_ptr[j] && r <= g->row_idx[s - 1]))
+        return 0;
+    }
+
+  /* non-empty layers covering all rows */
+  if (g->n_layers < (g->M > 0) || g->n_layers > g->M ||
+      !hbin_check_ptr(g->layer_ptr, g->n_layers, g->M, -1))
+    return 0;
+  for (i = 0; i < g->n_layers; i++)
+    if (g->layer_ptr[i + 1] == g->layer_ptr[i])
+      return 0;
+  return 1;
+}
+
+ldpc_graph_t *ldpc_graph_load_bin(const char *path, const uint64_t **P,
+                                  int *K) {
+  unsigned char *img = NULL;
+  size_t img_size = 0;
+
+#ifdef _WIN32
+  FILE *fp = fopen(path, "rb");
+  if (!fp)
+    return NULL;
+  if (fseek(fp, 0, SEEK_END) == 0) {
+    long len = ftell(fp);
+    if (len > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+      img_size = (size_t)len;
+      img = (unsigned char *)malloc(img_size);
+      if (!img) {
+        fprintf(stderr, "malloc failed in ldpc_graph_load_bin\n");
+        exit(1);
+      }
+      if (fread(img, 1, img_size, fp) != img_size) {
+        free(img);
+        img = NULL;
+      }
+    }
+  }
+  fclose(fp);
+  if (!img)
+    return NULL;
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    img_size = (size_t)st.st_size;
+    img = (unsigned char *)mmap(NULL, img_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (img == (unsigned char *)MAP_FAILED)
+      img = NULL;
+  }
+  close(fd);
+  if (!img)
+    return NULL;
+#endif
+
+  ldpc_graph_t *g = (ldpc_graph_t *)calloc(1, sizeof(ldpc_graph_t));
+  if (!g) {
+    fprintf(stderr, "malloc failed in ldpc_graph_load_bin\n");
+    exit(1);
+  }
+  g->map = img;
+  g->map_size = img_size;
+
+  /* header fields, then section bounds, then contents */
+  hbin_header_t h;
+  int ok = img_size >= sizeof(h);
+  if (ok) {
+    memcpy(&h, img, sizeof(h));
+    ok = memcmp(h.magic, hbin_magic, 8) == 0 &&
+         h.version == LDPC_HBIN_VERSION && h.bom == HBIN_BOM &&
+         h.file_size == img_size && h.M >= 0 && h.N >= 0 &&
+         h.n_edges >= 0 && h.n_layers >= 0 && h.K >= 0 &&
+         h.pw == (h.K ? (h.M + 63) / 64 : 0) &&
+         (h.off[HBIN_P] != 0) == (h.K != 0);
+  }
+
+  uint64_t size[HBIN_SECTIONS];
+  void *sec[HBIN_SECTIONS] = {NULL};
+  if (ok)
+    hbin_sizes(&h, size);
+  for (int k = 0; k < HBIN_SECTIONS && ok; k++) {
+    if (k == HBIN_P && h.K == 0)
+      continue;
+    ok = h.off[k] >= sizeof(h) && h.off[k] % 8 == 0 &&
+         h.off[k] <= img_size && size[k] <= img_size - h.off[k];
+    if (ok)
+      sec[k] = img + h.off[k];
+  }
+
+  if (ok) {
+    g->M = h.M;
+    g->N = h.N;
+    g->n_edges = h.n_edges;
+    g->n_layers = h.n_layers;
+    g->max_row_deg = h.max_row_deg;
+    g->max_col_deg = h.max_col_deg;
+    g->row_ptr = (int *)sec[HBIN_ROW_PTR];
+    g->col_idx = (int *)sec[HBIN_COL_IDX];
+    g->col_ptr = (int *)sec[HBIN_COL_PTR];
+    g->col_edge = (int *)sec[HBIN_COL_EDGE];
+    g->row_idx = (int *)sec[HBIN_ROW_IDX];
+    g->layer_ptr = (int *)sec[HBIN_LAYER_PTR];
+    ok = hbin_check_graph(g);
+  }
+
+  if (!ok) {
+    ldpc_graph_free(g);
+    return NULL;
+  }
+  if (P)
+    *P = (const uint64_t *)sec[HBIN_P];
+  if (K)
+    *K = h.K;
+  return g;
+}
+
+/* ========================================================================== */
+/* 6. Girth and Short-Cycle Analysis                                          */
+/* -------------------------------------------------------------------------- */
+/*
+ * All counts walk the variable–variable adjacency through the checks:
+ * for a column a, every check r of a and every column b > a of r gives
+ *
+ *      cnt[b] = |N(a) ∩ N(b)|     (checks shared by a and b)
+ *
+ * in a scratch array that is reset through the list of touched columns,
+ * so a column costs O(wc·wr) and no N×N table is needed.
+ *
+ * 6-cycles a–x–b–y–c–z–a (a < b < c) are counted per triple of pairwise
+ * adjacent columns: with n1 = |S_ab|, n2 = |S_bc|, n3 = |S_ca| and
+ * t = number of checks holding all three, the choices of pairwise
+ * distinct checks (x, y, z) ∈ S_ab × S_bc × S_ca are
+ *
+ *      n1·n2·n3 − t·(n1 + n2 + n3) + 2t
+ *
+ * (any two of x, y, z can only coincide on a check of all three).
+ *
+ * The girth is found by a breadth-first search from every variable; a
+ * non-tree edge met at depths du, dw closes a cycle of length at most
+ * du + dw + 1, and the search from a node on a shortest cycle meets it
+ * exactly. Searches stop at half the best length found so far.
+ */
+/* ========================================================================== */
+typedef struct {
+  int *cnt;   /* [N] shared checks with the current column      */
+  int *touch; /* [N] columns with cnt > 0                         */
+  int n_touch;
+} cycle_scratch_t;
+
+static void cycle_scratch_init(cycle_scratch_t *sc, int N) {
+  sc->cnt = (int *)calloc(N > 0 ? N : 1, sizeof(int));
+  sc->touch = (int *)malloc((N > 0 ? N : 1) * sizeof(int));
+  if (!sc->cnt || !sc->touch) {
+    fprintf(stderr, "malloc failed in cycle analysis\n");
+    exit(1);
+  }
+  sc->n_touch = 0;
+}
+
+static void cycle_scratch_free(cycle_scratch_t *sc) {
+  free(sc->cnt);
+  free(sc->touch);
+}
+
+/* cnt[b] = |N(a) ∩ N(b)| for the columns b > min_col that also pass
+ * filter[b] != 0 (filter may be NULL) */
+static void cycle_neighbors(const ldpc_graph_t *g, int a, int min_col,
+                            const int *filter, cycle_scratch_t *sc) {
+  sc->n_touch = 0;
+  for (int s = g->col_ptr[a]; s < g->col_ptr[a + 1]; s++) {
+    int r = g->row_idx[s];
+    for (int e = g->row_ptr[r]; e < g->row_ptr[r + 1]; e++) {
+      int b = g->col_idx[e];
+      if (b <= min_col || (filter && !filter[b]))
+        continue;
+      if (sc->cnt[b]++ == 0)
+        sc->touch[sc->n_touch++] = b;
+    }
+  }
+}
+
+static void cycle_reset(cycle_scratch_t *sc) {
+  for (int k = 0; k < sc->n_touch; k++)
+    sc->cnt[sc->touch[k]] = 0;
+  sc->n_touch = 0;
+}
+
+long long ldpc_graph_count_4cycles(const ldpc_graph_t *g) {
+  cycle_scratch_t sa;
+  cycle_scratch_init(&sa, g->N);
+
+  long long n4 = 0;
+  for (int a = 0; a < g->N; a++) {
+    cycle_neighbors(g, a, a, NULL, &sa);
+    for (int k = 0; k < sa.n_touch; k++) {
+      long long s = sa.cnt[sa.touch[k]];
+      n4 += s * (s - 1) / 2;
+    }
+    cycle_reset(&sa);
+  }
+
+  cycle_scratch_free(&sa);
+  return n4;
+}
+
+/* 1 if check r is adjacent to column c (CSC slots are sorted by row) */
+static int col_has_row(const ldpc_graph_t *g, int c, int r) {
+  for (int s = g->col_ptr[c]; s < g->col_ptr[c + 1]; s++)
+    if (g->row_idx[s] >= r)
+      return g->row_idx[s] == r;
+  return 0;
+}
+
+long long ldpc_graph_count_6cycles(const ldpc_graph_t *g) {
+  cycle_scratch_t sa, sb;
+  cycle_scratch_init(&sa, g->N);
+  cycle_scratch_init(&sb, g->N);
+
+  long long n6 = 0;
+  for (int a = 0; a < g->N; a++) {
+    cycle_neighbors(g, a, a, NULL, &sa);
+
+    for (int k = 0; k < sa.n_touch; k++) {
+      int b = sa.touch[k];
+      long long n1 = sa.cnt[b];
+
+      /* columns c > b adjacent to both b and a */
+      cycle_neighbors(g, b, b, sa.cnt, &sb);
+      for (int m = 0; m < sb.n_touch; m++) {
+        int c = sb.touch[m];
+        long long n2 = sb.cnt[c], n3 = sa.cnt[c];
+
+        long long t = 0;
+        for (int s = g->col_ptr[b]; s < g->col_ptr[b + 1]; s++) {
+          int r = g->row_idx[s];
+          t += col_has_row(g, a, r) && col_has_row(g, c, r);
+        }
+        n6 += n1 * n2 * n3 - t * (n1 + n2 + n3) + 2 * t;
+      }
+      cycle_reset(&sb);
+    }
+    cycle_reset(&sa);
+  }
+
+  cycle_scratch_free(&sa);
+  cycle_scratch_free(&sb);
+  return n6;
+}
+
+int ldpc_graph_girth(const ldpc_graph_t *g) {
+  /* nodes: variables 0..N-1, checks N..N+M-1 */
+  int n_nodes = g->N + g->M;
+  int *dist = (int *)malloc((n_nodes > 0 ? n_nodes : 1) * sizeof(int));
+  int *parent = (int *)malloc((n_nodes > 0 ? n_nodes : 1) * sizeof(int));
+  int *queue = (int *)malloc((n_nodes > 0 ? n_nodes : 1) * sizeof(int));
+  if (!dist || !parent || !queue) {
+    fprintf(stderr, "malloc failed in ldpc_graph_girth\n");
+    exit(1);
+  }
+  for (int v = 0; v < n_nodes; v++)
+    dist[v] = -1;
+
+  int best = 0x7fffffff;
+  for (int root = 0; root < g->N && best > 4; root++) {
+    int head = 0, tail = 0;
+    dist[root] = 0;
+    parent[root] = -1;
+    queue[tail++] = root;
+
+    while (head < tail) {
+      int u = queue[head++];
+      if (2 * dist[u] + 1 >= best)
+        break;
+
+      /* neighbors of u: checks of a variable, variables of a check */
+      int k0, k1;
+      const int *adj;
+      int off;
+      if (u < g->N) {
+        k0 = g->col_ptr[u];
+        k1 = g->col_ptr[u + 1];
+        adj = g->row_idx;
+        off = g->N;
+      } else {
+        k0 = g->row_ptr[u - g->N];
+        k1 = g->row_ptr[u - g->N + 1];
+        adj = g->col_idx;
+        off = 0;
+      }
+
+      for (int k = k0; k < k1; k++) {
+        int w = adj[k] + off;
+        if (w == parent[u])
+          continue;
+        if (dist[w] < 0) {
+          dist[w] = dist[u] + 1;
+          parent[w] = u;
+          queue[tail++] = w;
+        } else if (dist[u] + dist[w] + 1 < best) {
+          best = dist[u] + dist[w] + 1;
+        }
+      }
+    }
+
+    for (int k = 0; k < tail; k++)
+      dist[queue[k]] = -1;
+  }
 
-  return floop;
+  free(dist);
+  free(parent);
+  free(queue);
+  return best == 0x7fffffff ? 0 : best;
 }
@@ -0,0 +1,181 @@
+/**
+ * @file ldpc_noise.c
+ * @brief xoshiro256** random streams and Gaussian samples.
+ *
+ * This module provides:
+ *   - xoshiro256** with jump / long jump for non-overlapping streams
+ *   - Ziggurat normal samples (Doornik's ZIGNOR, 128 layers)
+ *   - Bulk AWGN and fused BPSK + AWGN + LLR generation
+ *
+ * References:
+ *   D. Blackman, S. Vigna, "Scrambled Linear Pseudorandom Number
+ *   Generators", ACM TOMS 47(4), 2021 (jump polynomials for xoshiro256).
+ *   J. A. Doornik, "An Improved Ziggurat Method to Generate Normal Random
+ *   Samples", 2005.
+ */
+
+#include "ldpc_noise.h"
+
+#include <math.h>
+#include <pthread.h>
+
+static inline uint64_t rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t xoshiro_next(uint64_t *s) {
+  uint64_t r = rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return r;
+}
+
+void ldpc_rng_seed(ldpc_rng_t *rng, uint64_t seed) {
+  /* splitmix64: never yields the all-zero state */
+  for (int k = 0; k < 4; k++) {
+    uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    rng->s[k] = z ^ (z >> 31);
+  }
+}
+
+/* s ← A^d · s for the jump polynomial given by poly[4] */
+static void rng_apply_jump(ldpc_rng_t *rng, const uint64_t *poly) {
+  uint64_t t[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 4; i++)
+    for (int b = 0; b < 64; b++) {
+      if (poly[i] >> b & 1)
+        for (int k = 0; k < 4; k++)
+          t[k] ^= rng->s[k];
+      xoshiro_next(rng->s);
+    }
+  for (int k = 0; k < 4; k++)
+    rng->s[k] = t[k];
+}
+
+void ldpc_rng_jump(ldpc_rng_t *rng) {
+  static const uint64_t poly[4] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                   0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+  rng_apply_jump(rng, poly);
+}
+
+void ldpc_rng_long_jump(ldpc_rng_t *rng) {
+  static const uint64_t poly[4] = {0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+                                   0x77710069854ee241ULL, 0x39109bb02acbe635ULL};
+  rng_apply_jump(rng, poly);
+}
+
+void ldpc_rng_stream(ldpc_rng_t *rng, uint64_t seed, int block, int index) {
+  ldpc_rng_seed(rng, seed);
+  for (int p = 0; p < block; p++)
+    ldpc_rng_long_jump(rng);
+  for (int t = 0; t < index; t++)
+    ldpc_rng_jump(rng);
+}
+
+uint64_t ldpc_rng_next(ldpc_rng_t *rng) { return xoshiro_next(rng->s); }
+
+double ldpc_rng_uniform(ldpc_rng_t *rng) {
+  return ((double)(xoshiro_next(rng->s) >> 11) + 0.5) * 0x1.0p-53;
+}
+
+void ldpc_rng_bits(ldpc_rng_t *rng, int *bits, int n) {
+  for (int i = 0; i < n; i += 64) {
+    uint64_t w = xoshiro_next(rng->s);
+    int m = (n - i < 64) ? n - i : 64;
+    for (int b = 0; b < m; b++)
+      bits[i + b] = (int)(w >> b & 1);
+  }
+}
+
+/* ========================================================================== */
+/* Ziggurat normal sampler                                                    */
+/* -------------------------------------------------------------------------- */
+/*
+ * The density is covered by 128 layers of equal area V: layer 0 is the
+ * base strip plus the tail beyond R, layers 1..127 are rectangles of
+ * width x[i] whose part under the curve runs up to x[i+1]. One 64-bit
+ * draw supplies the layer (bits 0..6) and a signed uniform u (bits
+ * 11..63); |u| < x[i+1]/x[i] (≈ 98.8 % of draws) returns u·x[i] with one
+ * multiply, otherwise the wedge or the tail is sampled exactly.
+ */
+/* ========================================================================== */
+#define ZIG_C 128
+#define ZIG_R 3.442619855899
+#define ZIG_V 9.91256303526217e-3
+
+static double zig_x[ZIG_C + 1]; /* layer right edges, x[1] = R, x[C] = 0 */
+static double zig_r[ZIG_C];     /* x[i+1] / x[i]                         */
+static pthread_once_t zig_once = PTHREAD_ONCE_INIT;
+
+static void zig_init(void) {
+  double f = exp(-0.5 * ZIG_R * ZIG_R);
+  zig_x[0] = ZIG_V / f; /* base strip as a rectangle of area V */
+  zig_x[1] = ZIG_R;
+  zig_x[ZIG_C] = 0.0;
+  for (int i = 2; i < ZIG_C; i++) {
+    zig_x[i] = sqrt(-2.0 * log(ZIG_V / zig_x[i - 1] + f));
+    f = exp(-0.5 * zig_x[i] * zig_x[i]);
+  }
+  for (int i = 0; i < ZIG_C; i++)
+    zig_r[i] = zig_x[i + 1] / zig_x[i];
+}
+
+/* Rare path: tail beyond R (layer 0) or a wedge. Returns 0 if the wedge
+ * point is rejected and a new draw is needed. */
+static int zig_slow(ldpc_rng_t *rng, unsigned i, double u, double *z) {
+  if (i == 0) {
+    double x, y;
+    do {
+      x = log(ldpc_rng_uniform(rng)) / ZIG_R;
+      y = log(ldpc_rng_uniform(rng));
+    } while (-2.0 * y < x * x);
+    *z = (u < 0) ? x - ZIG_R : ZIG_R - x;
+    return 1;
+  }
+  double x = u * zig_x[i];
+  double f0 = exp(-0.5 * (zig_x[i] * zig_x[i] - x * x));
+  double f1 = exp(-0.5 * (zig_x[i + 1] * zig_x[i + 1] - x * x));
+  *z = x;
+  return f1 + ldpc_rng_uniform(rng) * (f0 - f1) < 1.0;
+}
+
+static inline double zig_gauss(ldpc_rng_t *rng) {
+  for (;;) {
+    uint64_t w = xoshiro_next(rng->s);
+    unsigned i = (unsigned)(w & (ZIG_C - 1));
+    double u = ((double)(int64_t)(w >> 11) - 0x1.0p52 + 0.5) * 0x1.0p-52;
+    if (fabs(u) < zig_r[i])
+      return u * zig_x[i];
+    double z;
+    if (zig_slow(rng, i, u, &z))
+      return z;
+  }
+}
+
+double ldpc_rng_gauss(ldpc_rng_t *rng) {
+  pthread_once(&zig_once, zig_init);
+  return zig_gauss(rng);
+}
+
+void ldpc_fill_awgn(ldpc_rng_t *rng, double *buf, int n, double sigma) {
+  pthread_once(&zig_once, zig_init);
+  for (int i = 0; i < n; i++)
+    buf[i] = sigma * zig_gauss(rng);
+}
+
+void ldpc_bpsk_awgn_llr(ldpc_rng_t *rng, const int *code, double *LLR, int n,
+                        double sigma2) {
+  pthread_once(&zig_once, zig_init);
+  /* LLR = 2(x + σz)/σ² = x·(2/σ²) + z·(2/σ) */
+  double a = 2.0 / sigma2;
+  double b = 2.0 / sqrt(sigma2);
+  for (int i = 0; i < n; i++)
+    LLR[i] = (code[i] ? a : -a) + b * zig_gauss(rng);
+}
@@ -0,0 +1,443 @@
+/**
+ * @file ldpc_registry.c
+ * @brief Code registry: folder loading, lookup and per-thread contexts.
+ *
+ * This module provides:
+ *   - Loading of one code folder (H, G and the H encoder)
+ *   - Directory scans and config files listing code folders
+ *   - Lookup by id (array index), name / path and (N, wc, wr)
+ *   - Per-thread contexts with a decoder and H encoder for every code
+ */
+
+#include "ldpc_registry.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/* A code and the owning pointers behind its read-only view */
+typedef struct {
+  ldpc_code_t pub;
+  char *name;
+  char *path;
+  char *h_file;
+  ldpc_graph_t *graph;
+  ldpc_qc_t *qc;
+  ldpc_encoder_t *enc;
+  int **G;
+  ldpc_hencoder_t *henc;
+  ldpc_graph_t *henc_graph; /* NULL unless H was column permuted */
+} code_entry_t;
+
+struct ldpc_registry {
+  code_entry_t **codes; /* [cap]; entries never move once added */
+  int n, cap;
+};
+
+struct ldpc_registry_ctx {
+  int n;
+  ldpc_decoder_t **dec;   /* [n] */
+  ldpc_hencoder_t **henc; /* [n], NULL where the code has none */
+};
+
+static void *reg_alloc(size_t n, size_t size) {
+  void *p = calloc(n > 0 ? n : 1, size);
+  if (!p) {
+    fprintf(stderr, "malloc failed in ldpc_registry\n");
+    exit(1);
+  }
+  return p;
+}
+
+static char *reg_strdup(const char *s) {
+  char *d = (char *)reg_alloc(strlen(s) + 1, 1);
+  strcpy(d, s);
+  return d;
+}
+
+/* ========================================================================== */
+/* Dense 0/1 CSV matrices                                                     */
+/* ========================================================================== */
+static int **alloc_matrix_int(int rows, int cols) {
+  int **m = (int **)reg_alloc(rows, sizeof(int *));
+  for (int i = 0; i < rows; i++)
+    m[i] = (int *)reg_alloc(cols, sizeof(int));
+  return m;
+}
+
+static void free_matrix_int(int **m, int rows) {
+  if (!m)
+    return;
+  for (int i = 0; i < rows; i++)
+    free(m[i]);
+  free(m);
+}
+
+/* Returns 0 on success */
+static int load_matrix(int **mat, int rows, int cols, const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+    return -1;
+
+  int line_size = cols + 3;
+  char *line = (char *)reg_alloc(line_size, 1);
+  for (int r = 0; r < rows; r++) {
+    if (!fgets(line, line_size, fp) || (int)strlen(line) < cols) {
+      free(line);
+      fclose(fp);
+      return -2;
+    }
+    for (int c = 0; c < cols; c++)
+      mat[r][c] = (line[c] == '1') ? 1 : 0;
+  }
+  free(line);
+  fclose(fp);
+  return 0;
+}
+
+/* ========================================================================== */
+/* One code folder                                                            */
+/* ========================================================================== */
+static const char *base_name(const char *path) {
+  size_t n = strlen(path);
+  while (n > 1 && path[n - 1] == '/')
+    n--;
+  while (n > 0 && path[n - 1] != '/')
+    n--;
+  return path + n;
+}
+
+static void entry_free(code_entry_t *e) {
+  if (!e)
+    return;
+  ldpc_hencoder_free(e->henc);
+  ldpc_graph_free(e->henc_graph);
+  ldpc_encoder_free(e->enc);
+  if (e->graph)
+    free_matrix_int(e->G, e->graph->N - e->graph->M);
+  ldpc_qc_free(e->qc);
+  ldpc_graph_free(e->graph);
+  free(e->name);
+  free(e->path);
+  free(e->h_file);
+  free(e);
+}
+
+/* H of a folder: H.qc, H.bin (with the packed P of G), H.alist, H.csv */
+static int entry_load_h(code_entry_t *e, const char *folder,
+                        const uint64_t **P_bin, int *K_bin) {
+  char path[1024];
+
+  snprintf(path, sizeof(path), "%s/H.qc", folder);
+  e->qc = ldpc_qc_read(path);
+  if (e->qc) {
+    e->graph = ldpc_qc_expand(e->qc);
+  } else {
+    snprintf(path, sizeof(path), "%s/H.bin", folder);
+    e->graph = ldpc_graph_load_bin(path, P_bin, K_bin);
+  }
+  if (!e->graph) {
+    snprintf(path, sizeof(path), "%s/H.alist", folder);
+    e->graph = ldpc_graph_read_alist(path);
+  }
+  if (!e->graph) {
+    int N, wc, wr;
+    char name[256];
+    snprintf(name, sizeof(name), "%s", base_name(folder));
+    if (sscanf(name, "N%d_wc%d_wr%d", &N, &wc, &wr) != 3 || wr <= 0)
+      return -1;
+    int M = (N * wc) / wr;
+    int **H = alloc_matrix_int(M, N);
+    snprintf(path, sizeof(path), "%s/H.csv", folder);
+    if (load_matrix(H, M, N, path)) {
+      free_matrix_int(H, M);
+      return -1;
+    }
+    e->graph = ldpc_graph_create(H, M, N);
+    free_matrix_int(H, M);
+  }
+  e->h_file = reg_strdup(path);
+  return 0;
+}
+
+static code_entry_t *entry_load(const char *folder, const char *name) {
+  code_entry_t *e = (code_entry_t *)reg_alloc(1, sizeof(code_entry_t));
+  const uint64_t *P_bin = NULL;
+  int K_bin = 0;
+  char path[1024];
+
+  if (entry_load_h(e, folder, &P_bin, &K_bin)) {
+    entry_free(e);
+    return NULL;
+  }
+  int N = e->graph->N, K = e->graph->N - e->graph->M;
+
+  /* G encoders: packed P of H.bin, else G.csv */
+  if (P_bin && K_bin == K) {
+    e->enc = ldpc_encoder_create_packed(P_bin, N, K);
+  } else {
+    e->G = alloc_matrix_int(K, N);
+    snprintf(path, sizeof(path), "%s/G.csv", folder);
+    if (load_matrix(e->G, K, N, path)) {
+      free_matrix_int(e->G, K);
+      e->G = NULL;
+    } else {
+      e->enc = ldpc_encoder_create(e->G, N, K);
+    }
+  }
+
+  /* sparse-H encoder, on a column-permuted copy of H if needed */
+  snprintf(path, sizeof(path), "%s/H_enc.bin", folder);
+  e->henc = ldpc_hencoder_load(e->graph, path);
+  if (!e->henc)
+    e->henc = ldpc_hencoder_create(e->graph);
+  if (!e->henc) {
+    int *perm = (int *)reg_alloc(N, sizeof(int));
+    if (ldpc_hencoder_parity_perm(e->graph, perm) >= 0) {
+      e->henc_graph = ldpc_graph_permute_cols(e->graph, perm);
+      e->henc = ldpc_hencoder_create(e->henc_graph);
+    }
+    free(perm);
+  }
+
+  e->name = reg_strdup(name ? name : base_name(folder));
+  e->path = reg_strdup(folder);
+
+  ldpc_code_t *c = &e->pub;
+  c->name = e->name;
+  c->path = e->path;
+  c->h_file = e->h_file;
+  c->N = N;
+  c->K = K;
+  c->wc = e->graph->max_col_deg;
+  c->wr = e->graph->max_row_deg;
+  c->graph = e->graph;
+  c->qc = e->qc;
+  c->enc = e->enc;
+  c->G = e->G;
+  c->henc = e->henc;
+  if (e->henc)
+    c->henc_graph = e->henc_graph ? e->henc_graph : e->graph;
+  return e;
+}
+
+/* ========================================================================== */
+/* Registry                                                                   */
+/* ========================================================================== */
+ldpc_registry_t *ldpc_registry_create(void) {
+  return (ldpc_registry_t *)reg_alloc(1, sizeof(ldpc_registry_t));
+}
+
+void ldpc_registry_free(ldpc_registry_t *reg) {
+  if (!reg)
+    return;
+  for (int i = 0; i < reg->n; i++)
+    entry_free(reg->codes[i]);
+  free(reg->codes);
+  free(reg);
+}
+
+int ldpc_registry_add(ldpc_registry_t *reg, const char *folder,
+                      const char *name) {
+  code_entry_t *e = entry_load(folder, name);
+  if (!e)
+    return -1;
+
+  if (reg->n == reg->cap) {
+    int cap = reg->cap ? 2 * reg->cap : 8;
+    code_entry_t **c =
+        (code_entry_t **)realloc(reg->codes, cap * sizeof(code_entry_t *));
+    if (!c) {
+      fprintf(stderr, "malloc failed in ldpc_registry_add\n");
+      exit(1);
+    }
+    reg->codes = c;
+    reg->cap = cap;
+  }
+  e->pub.id = reg->n;
+  reg->codes[reg->n++] = e;
+  return e->pub.id;
+}
+
+static int cmp_str(const void *a, const void *b) {
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+int ldpc_registry_scan(ldpc_registry_t *reg, const char *dir) {
+  DIR *dp = opendir(dir);
+  if (!dp)
+    return -1;
+
+  char **names = NULL;
+  int n = 0, cap = 0;
+  struct dirent *de;
+  while ((de = readdir(dp)) != NULL) {
+    if (de->d_name[0] != 'N')
+      continue;
+    if (n == cap) {
+      cap = cap ? 2 * cap : 16;
+      char **p = (char **)realloc(names, cap * sizeof(char *));
+      if (!p) {
+        fprintf(stderr, "malloc failed in ldpc_registry_scan\n");
+        exit(1);
+      }
+      names = p;
+    }
+    names[n++] = reg_strdup(de->d_name);
+  }
+  closedir(dp);
+  qsort(names, n, sizeof(char *), cmp_str);
+
+  int added = 0;
+  for (int i = 0; i < n; i++) {
+    char folder[1024];
+    snprintf(folder, sizeof(folder), "%s/%s", dir, names[i]);
+    if (ldpc_registry_add(reg, folder, NULL) >= 0)
+      added++;
+    free(names[i]);
+  }
+  free(names);
+  return added;
+}
+
+int ldpc_registry_load_config(ldpc_registry_t *reg, const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+    return -1;
+
+  char line[2048];
+  int added = 0;
+  while (fgets(line, sizeof(line), fp)) {
+    char folder[1024], name[256];
+    const char *p = line + strspn(line, " \t");
+    if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0')
+      continue;
+    int n = sscanf(p, "%1023s %255s", folder, name);
+    if (n < 1)
+      continue;
+    if (ldpc_registry_add(reg, folder, n == 2 ? name : NULL) < 0) {
+      fclose(fp);
+      return -1;
+    }
+    added++;
+  }
+  fclose(fp);
+  return added;
+}
+
+/* A folder holds a code if one of the H files exists */
+static int is_code_folder(const char *folder) {
+  static const char *const files[] = {"H.qc", "H.bin", "H.alist", "H.csv"};
+  for (int i = 0; i < 4; i++) {
+    char path[1024];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", folder, files[i]);
+    if (stat(path, &st) == 0)
+      return 1;
+  }
+  return 0;
+}
+
+int ldpc_registry_load(ldpc_registry_t *reg, const char *path) {
+  struct stat st;
+  if (stat(path, &st) != 0)
+    return -1;
+  if (!S_ISDIR(st.st_mode))
+    return ldpc_registry_load_config(reg, path);
+  if (is_code_folder(path))
+    return (ldpc_registry_add(reg, path, NULL) >= 0) ? 1 : -1;
+  return ldpc_registry_scan(reg, path);
+}
+
+ldpc_registry_t *ldpc_registry_open(const char *path) {
+  ldpc_registry_t *reg = ldpc_registry_create();
+  if (ldpc_registry_load(reg, path) <= 0) {
+    ldpc_registry_free(reg);
+    return NULL;
+  }
+  return reg;
+}
+
+int ldpc_registry_count(const ldpc_registry_t *reg) { return reg->n; }
+
+const ldpc_code_t *ldpc_registry_code(const ldpc_registry_t *reg, int id) {
+  if (id < 0 || id >= reg->n)
+    return NULL;
+  return &reg->codes[id]->pub;
+}
+
+int ldpc_registry_find(const ldpc_registry_t *reg, const char *name) {
+  for (int i = 0; i < reg->n; i++)
+    if (!strcmp(reg->codes[i]->name, name) ||
+        !strcmp(reg->codes[i]->path, name))
+      return i;
+  return -1;
+}
+
+int ldpc_registry_find_params(const ldpc_registry_t *reg, int N, int wc,
+                              int wr) {
+  for (int i = 0; i < reg->n; i++) {
+    const ldpc_code_t *c = &reg->codes[i]->pub;
+    if (c->N == N && c->wc == wc && c->wr == wr)
+      return i;
+  }
+  return -1;
+}
+
+/* ========================================================================== */
+/* Per-thread contexts                                                        */
+/* ========================================================================== */
+ldpc_registry_ctx_t *ldpc_registry_ctx_create(const ldpc_registry_t *reg) {
+  ldpc_registry_ctx_t *ctx =
+      (ldpc_registry_ctx_t *)reg_alloc(1, sizeof(ldpc_registry_ctx_t));
+  ctx->n = reg->n;
+  ctx->dec = (ldpc_decoder_t **)reg_alloc(reg->n, sizeof(ldpc_decoder_t *));
+  ctx->henc =
+      (ldpc_hencoder_t **)reg_alloc(reg->n, sizeof(ldpc_hencoder_t *));
+  for (int i = 0; i < reg->n; i++) {
+    const ldpc_code_t *c = &reg->codes[i]->pub;
+    ctx->dec[i] = ldpc_decoder_create_from_graph(c->graph, c->K);
+    if (c->henc)
+      ctx->henc[i] = ldpc_hencoder_dup(c->henc);
+  }
+  return ctx;
+}
+
+void ldpc_registry_ctx_free(ldpc_registry_ctx_t *ctx) {
+  if (!ctx)
+    return;
+  for (int i = 0; i < ctx->n; i++) {
+    ldpc_decoder_free(ctx->dec[i]);
+    ldpc_hencoder_free(ctx->henc[i]);
+  }
+  free(ctx->dec);
+  free(ctx->henc);
+  free(ctx);
+}
+
+void ldpc_registry_ctx_set_kernel(ldpc_registry_ctx_t *ctx,
+                                  ldpc_cn_kernel kernel, double param) {
+  for (int i = 0; i < ctx->n; i++)
+    ldpc_decoder_set_kernel(ctx->dec[i], kernel, param);
+}
+
+void ldpc_registry_ctx_set_schedule(ldpc_registry_ctx_t *ctx,
+                                    ldpc_schedule schedule) {
+  for (int i = 0; i < ctx->n; i++)
+    ldpc_decoder_set_schedule(ctx->dec[i], schedule);
+}
+
+ldpc_decoder_t *ldpc_registry_ctx_decoder(ldpc_registry_ctx_t *ctx, int id) {
+  if (id < 0 || id >= ctx->n)
+    return NULL;
+  return ctx->dec[id];
+}
+
+ldpc_hencoder_t *ldpc_registry_ctx_hencoder(ldpc_registry_ctx_t *ctx,
+                                            int id) {
+  if (id < 0 || id >= ctx->n)
+    return NULL;
+  return ctx->henc[id];
+}
@@ -0,0 +1,524 @@
+/**
+ * @file ldpc_service.c
+ * @brief Asynchronous decode service: worker pool with work-stealing deques
+ *        and per-lane refill of the batch decoder.
+ *
+ * Locking:
+ *   - every worker deque has its own mutex (owner pops the head, thieves
+ *     take the tail half, the submitter appends);
+ *   - one service mutex protects the job pool, the counters and the
+ *     completion queue, with condition variables for idle workers (work),
+ *     blocked submitters (space), completion-queue readers (done) and
+ *     drain (idle). A deque lock is only ever taken inside the service
+ *     lock (submit), never the other way round.
+ * The per-frame decode work dominates, so a lock round trip per frame is
+ * negligible next to it.
+ */
+
+#include "ldpc_service.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ========================================================================== */
+/* Internal types                                                             */
+/* ========================================================================== */
+typedef struct job {
+  struct job *next; /* free list / completion queue */
+  uint64_t id;
+  void *user;
+  int iterations;
+  int converged;
+  int worker;
+  double *LLR; /* [N] */
+  int *inf;    /* [K] */
+} job_t;
+
+typedef struct {
+  pthread_mutex_t lock;
+  job_t **ring; /* [cap] circular buffer, head = oldest */
+  int cap;
+  int head;
+  int count;
+} deque_t;
+
+typedef struct {
+  ldpc_service_t *svc;
+  int id;
+  pthread_t thread;
+  deque_t dq;
+  ldpc_batch_decoder_t *bd; /* min-sum family */
+  ldpc_decoder_t *dec;      /* SPA            */
+  int *ecc;                 /* [N] scalar path */
+  job_t *lane[LDPC_BATCH_LANES];
+  unsigned steal_seed;
+} worker_t;
+
+struct ldpc_service {
+  ldpc_service_config_t cfg;
+  int N;
+  int batch; /* 1: batch stream mode, 0: scalar SPA */
+
+  worker_t *w;
+  int n_workers;
+
+  pthread_mutex_t lock;
+  pthread_cond_t work;  /* queued > 0 or stop            */
+  pthread_cond_t space; /* pending < max_pending         */
+  pthread_cond_t done;  /* completion queue not empty    */
+  pthread_cond_t idle;  /* pending == 0                  */
+
+  job_t *pool;      /* free jobs                     */
+  job_t *done_head; /* completion queue (FIFO)       */
+  job_t *done_tail;
+  int n_done;
+
+  uint64_t next_id;
+  int next_worker; /* round-robin submission target */
+  int queued;      /* jobs sitting in deques         */
+  int pending;     /* submitted, not yet delivered   */
+  long long steals;
+  int stop;
+};
+
+/* ========================================================================== */
+/* Deques                                                                     */
+/* ========================================================================== */
+static void deque_init(deque_t *d, int cap) {
+  pthread_mutex_init(&d->lock, NULL);
+  d->ring = (job_t **)malloc((size_t)cap * sizeof(job_t *));
+  if (!d->ring) {
+    fprintf(stderr, "malloc failed in ldpc_service_create\n");
+    exit(1);
+  }
+  d->cap = cap;
+  d->head = 0;
+  d->count = 0;
+}
+
+static void deque_destroy(deque_t *d) {
+  pthread_mutex_destroy(&d->lock);
+  free(d->ring);
+}
+
+/* Append at the tail. The ring holds max_pending entries, which bounds the
+ * number of jobs in all deques together, so it never overflows. */
+static void deque_push(deque_t *d, job_t *j) {
+  pthread_mutex_lock(&d->lock);
+  d->ring[(d->head + d->count) % d->cap] = j;
+  d->count++;
+  pthread_mutex_unlock(&d->lock);
+}
+
+/* Owner: take the oldest job. */
+static job_t *deque_pop(deque_t *d) {
+  job_t *j = NULL;
+  pthread_mutex_lock(&d->lock);
+  if (d->count > 0) {
+    j = d->ring[d->head];
+    d->head = (d->head + 1) % d->cap;
+    d->count--;
+  }
+  pthread_mutex_unlock(&d->lock);
+  return j;
+}
+
+/* Thief: move the newer half (at least one) of `from` into `to`; returns
+ * the number of jobs moved. Locks are taken one at a time, so two workers
+ * stealing from each other cannot deadlock. */
+static int deque_steal(deque_t *from, deque_t *to) {
+  job_t *buf[64];
+  int n = 0;
+
+  pthread_mutex_lock(&from->lock);
+  if (from->count > 0) {
+    n = (from->count + 1) / 2;
+    if (n > 64)
+      n = 64;
+    from->count -= n;
+    for (int i = 0; i < n; i++)
+      buf[i] = from->ring[(from->head + from->count + i) % from->cap];
+  }
+  pthread_mutex_unlock(&from->lock);
+
+  for (int i = 0; i < n; i++)
+    deque_push(to, buf[i]);
+  return n;
+}
+
+/* ========================================================================== */
+/* Worker                                                                     */
+/* ========================================================================== */
+
+/* Next job for worker w, or NULL if every deque is empty. */
+static job_t *take_job(worker_t *w) {
+  ldpc_service_t *svc = w->svc;
+  job_t *j = deque_pop(&w->dq);
+
+  if (!j && svc->n_workers > 1) {
+    /* Start at a pseudo-random victim so thieves spread out. */
+    w->steal_seed = w->steal_seed * 1103515245u + 12345u;
+    int start = (int)((w->steal_seed >> 16) % (unsigned)svc->n_workers);
+    for (int k = 0; k < svc->n_workers && !j; k++) {
+      int v = (start + k) % svc->n_workers;
+      if (v == w->id)
+        continue;
+      int n = deque_steal(&svc->w[v].dq, &w->dq);
+      if (n > 0) {
+        pthread_mutex_lock(&svc->lock);
+        svc->steals += n;
+        pthread_mutex_unlock(&svc->lock);
+        j = deque_pop(&w->dq);
+      }
+    }
+  }
+
+  if (j) {
+    pthread_mutex_lock(&svc->lock);
+    svc->queued--;
+    pthread_mutex_unlock(&svc->lock);
+  }
+  return j;
+}
+
+/* Hand a decoded job to the callback (then recycle it) or to the
+ * completion queue. */
+static void deliver(ldpc_service_t *svc, job_t *j) {
+  if (svc->cfg.callback) {
+    ldpc_service_result_t res = {j->id,         j->user,      j->inf,
+                                 j->iterations, j->converged, j->worker};
+    svc->cfg.callback(&res, svc->cfg.callback_arg);
+
+    pthread_mutex_lock(&svc->lock);
+    j->next = svc->pool;
+    svc->pool = j;
+    svc->pending--;
+    pthread_cond_signal(&svc->space);
+    if (svc->pending == 0)
+      pthread_cond_broadcast(&svc->idle);
+    pthread_mutex_unlock(&svc->lock);
+    return;
+  }
+
+  pthread_mutex_lock(&svc->lock);
+  j->next = NULL;
+  if (svc->done_tail)
+    svc->done_tail->next = j;
+  else
+    svc->done_head = j;
+  svc->done_tail = j;
+  svc->n_done++;
+  pthread_cond_signal(&svc->done);
+  if (svc->n_done == svc->pending)
+    pthread_cond_broadcast(&svc->idle);
+  pthread_mutex_unlock(&svc->lock);
+}
+
+/* Sleep until a job is queued somewhere; returns 0 once stopped. */
+static int wait_for_work(ldpc_service_t *svc) {
+  pthread_mutex_lock(&svc->lock);
+  while (svc->queued == 0 && !svc->stop)
+    pthread_cond_wait(&svc->work, &svc->lock);
+  int run = (svc->queued > 0);
+  pthread_mutex_unlock(&svc->lock);
+  return run;
+}
+
+static int syndrome_is_zero(const ldpc_graph_t *g, const int *ecc) {
+  for (int i = 0; i < g->M; i++) {
+    int parity = 0;
+    for (int k = g->row_ptr[i]; k < g->row_ptr[i + 1]; k++)
+      parity ^= ecc[g->col_idx[k]];
+    if (parity)
+      return 0;
+  }
+  return 1;
+}
+
+/* Batch stream mode: keep every lane busy, refilling a lane as soon as its
+ * frame finishes. */
+static void run_batch(worker_t *w) {
+  ldpc_service_t *svc = w->svc;
+  const int max_iter = svc->cfg.max_iter;
+
+  for (;;) {
+    uint32_t busy = ldpc_batch_stream_busy(w->bd);
+    for (int l = 0; l < LDPC_BATCH_LANES; l++) {
+      if (busy & (1u << l))
+        continue;
+      job_t *j = take_job(w);
+      if (!j)
+        break;
+      ldpc_batch_stream_load(w->bd, l, j->LLR);
+      w->lane[l] = j;
+      busy |= 1u << l;
+    }
+
+    if (!busy) {
+      if (!wait_for_work(svc))
+        return;
+      continue;
+    }
+
+    uint32_t fin = ldpc_batch_stream_step(w->bd, max_iter);
+    for (int l = 0; fin; l++, fin >>= 1) {
+      if (!(fin & 1u))
+        continue;
+      job_t *j = w->lane[l];
+      w->lane[l] = NULL;
+      ldpc_batch_stream_result(w->bd, l, j->inf, &j->iterations,
+                               &j->converged);
+      j->worker = w->id;
+      deliver(svc, j);
+    }
+  }
+}
+
+/* SPA: one frame at a time. */
+static void run_scalar(worker_t *w) {
+  ldpc_service_t *svc = w->svc;
+  const ldpc_graph_t *g = svc->cfg.graph;
+
+  for (;;) {
+    job_t *j = take_job(w);
+    if (!j) {
+      if (!wait_for_work(svc))
+        return;
+      continue;
+    }
+    j->iterations =
+        ldpc_decoder_decode(w->dec, j->LLR, w->ecc, j->inf, svc->cfg.max_iter);
+    j->converged = j->iterations < svc->cfg.max_iter ||
+                   syndrome_is_zero(g, w->ecc);
+    j->worker = w->id;
+    deliver(svc, j);
+  }
+}
+
+static void *worker_main(void *arg) {
+  worker_t *w = (worker_t *)arg;
+  if (w->svc->batch)
+    run_batch(w);
+  else
+    run_scalar(w);
+  return NULL;
+}
+
+/* ========================================================================== */
+/* Public API                                                                 */
+/* ========================================================================== */
+ldpc_service_t *ldpc_service_create(const ldpc_service_config_t *cfg) {
+  if (cfg->n_threads < 1 || cfg->max_iter < 1)
+    return NULL;
+  int batch = (cfg->kernel != LDPC_CN_SPA);
+  if (batch && cfg->target != LDPC_SIMD_AUTO &&
+      !ldpc_simd_target_supported(cfg->target))
+    return NULL;
+
+  ldpc_service_t *svc = (ldpc_service_t *)calloc(1, sizeof(ldpc_service_t));
+  if (!svc) {
+    fprintf(stderr, "malloc failed in ldpc_service_create\n");
+    exit(1);
+  }
+  svc->cfg = *cfg;
+  if (svc->cfg.max_pending <= 0)
+    svc->cfg.max_pending = 4 * cfg->n_threads * LDPC_BATCH_LANES;
+  svc->N = cfg->graph->N;
+  svc->batch = batch;
+  svc->n_workers = cfg->n_threads;
+  svc->next_id = 1;
+
+  pthread_mutex_init(&svc->lock, NULL);
+  pthread_cond_init(&svc->work, NULL);
+  pthread_cond_init(&svc->space, NULL);
+  pthread_cond_init(&svc->done, NULL);
+  pthread_cond_init(&svc->idle, NULL);
+
+  svc->w = (worker_t *)calloc((size_t)svc->n_workers, sizeof(worker_t));
+  if (!svc->w) {
+    fprintf(stderr, "malloc failed in ldpc_service_create\n");
+    exit(1);
+  }
+
+  for (int t = 0; t < svc->n_workers; t++) {
+    worker_t *w = &svc->w[t];
+    w->svc = svc;
+    w->id = t;
+    w->steal_seed = 2654435761u * (unsigned)(t + 1);
+    deque_init(&w->dq, svc->cfg.max_pending);
+    if (batch) {
+      w->bd = ldpc_batch_create(cfg->graph, cfg->K, cfg->target);
+      ldpc_batch_set_kernel(w->bd, cfg->kernel, cfg->cn_param);
+      ldpc_batch_set_schedule(w->bd, cfg->schedule);
+    } else {
+      w->dec = ldpc_decoder_create_from_graph(cfg->graph, cfg->K);
+      ldpc_decoder_set_kernel(w->dec, cfg->kernel, cfg->cn_param);
+      ldpc_decoder_set_schedule(w->dec, cfg->schedule);
+      w->ecc = (int *)malloc((size_t)svc->N * sizeof(int));
+      if (!w->ecc) {
+        fprintf(stderr, "malloc failed in ldpc_service_create\n");
+        exit(1);
+      }
+    }
+  }
+
+  for (int t = 0; t < svc->n_workers; t++) {
+    if (pthread_create(&svc->w[t].thread, NULL, worker_main, &svc->w[t]) !=
+        0) {
+      fprintf(stderr, "pthread_create failed in ldpc_service_create\n");
+      exit(1);
+    }
+  }
+  return svc;
+}
+
+void ldpc_service_free(ldpc_service_t *svc) {
+  if (!svc)
+    return;
+
+  ldpc_service_drain(svc);
+  pthread_mutex_lock(&svc->lock);
+  svc->stop = 1;
+  pthread_cond_broadcast(&svc->work);
+  pthread_mutex_unlock(&svc->lock);
+
+  for (int t = 0; t < svc->n_workers; t++) {
+    worker_t *w = &svc->w[t];
+    pthread_join(w->thread, NULL);
+    deque_destroy(&w->dq);
+    ldpc_batch_free(w->bd);
+    ldpc_decoder_free(w->dec);
+    free(w->ecc);
+  }
+  free(svc->w);
+
+  /* Jobs are allocated as one block each (header + LLR + inf). */
+  for (job_t *j = svc->pool, *next; j; j = next) {
+    next = j->next;
+    free(j);
+  }
+  for (job_t *j = svc->done_head, *next; j; j = next) {
+    next = j->next;
+    free(j);
+  }
+
+  pthread_mutex_destroy(&svc->lock);
+  pthread_cond_destroy(&svc->work);
+  pthread_cond_destroy(&svc->space);
+  pthread_cond_destroy(&svc->done);
+  pthread_cond_destroy(&svc->idle);
+  free(svc);
+}
+
+static job_t *job_alloc(const ldpc_service_t *svc) {
+  size_t sz = sizeof(job_t) + (size_t)svc->N * sizeof(double) +
+              (size_t)(svc->cfg.K > 0 ? svc->cfg.K : 1) * sizeof(int);
+  job_t *j = (job_t *)malloc(sz);
+  if (!j) {
+    fprintf(stderr, "malloc failed in ldpc_service_submit\n");
+    exit(1);
+  }
+  j->LLR = (double *)(j + 1);
+  j->inf = (int *)(j->LLR + svc->N);
+  return j;
+}
+
+uint64_t ldpc_service_submit(ldpc_service_t *svc, const double *LLR,
+                             void *user) {
+  pthread_mutex_lock(&svc->lock);
+  while (svc->pending >= svc->cfg.max_pending)
+    pthread_cond_wait(&svc->space, &svc->lock);
+  svc->pending++;
+  uint64_t id = svc->next_id++;
+  int t = svc->next_worker;
+  svc->next_worker = (t + 1) % svc->n_workers;
+  job_t *j = svc->pool;
+  if (j)
+    svc->pool = j->next;
+  pthread_mutex_unlock(&svc->lock);
+
+  if (!j)
+    j = job_alloc(svc);
+  j->id = id;
+  j->user = user;
+  memcpy(j->LLR, LLR, (size_t)svc->N * sizeof(double));
+
+  /* Push under the service lock so that a worker never takes the job
+   * before it is counted in queued. */
+  pthread_mutex_lock(&svc->lock);
+  deque_push(&svc->w[t].dq, j);
+  svc->queued++;
+  pthread_cond_signal(&svc->work);
+  pthread_mutex_unlock(&svc->lock);
+  return id;
+}
+
+/* Pop the completion queue (service lock held, queue not empty). */
+static void take_done(ldpc_service_t *svc, ldpc_service_result_t *res,
+                      int *inf) {
+  job_t *j = svc->done_head;
+  svc->done_head = j->next;
+  if (!svc->done_head)
+    svc->done_tail = NULL;
+  svc->n_done--;
+  svc->pending--;
+
+  memcpy(inf, j->inf, (size_t)svc->cfg.K * sizeof(int));
+  res->id = j->id;
+  res->user = j->user;
+  res->inf = inf;
+  res->iterations = j->iterations;
+  res->converged = j->converged;
+  res->worker = j->worker;
+
+  j->next = svc->pool;
+  svc->pool = j;
+  pthread_cond_signal(&svc->space);
+  if (svc->pending == 0)
+    pthread_cond_broadcast(&svc->idle);
+}
+
+int ldpc_service_wait(ldpc_service_t *svc, ldpc_service_result_t *res,
+                      int *inf) {
+  if (svc->cfg.callback)
+    return -1;
+  pthread_mutex_lock(&svc->lock);
+  while (svc->n_done == 0 && svc->pending > 0)
+    pthread_cond_wait(&svc->done, &svc->lock);
+  if (svc->n_done == 0) {
+    pthread_mutex_unlock(&svc->lock);
+    return -1;
+  }
+  take_done(svc, res, inf);
+  pthread_mutex_unlock(&svc->lock);
+  return 0;
+}
+
+int ldpc_service_poll(ldpc_service_t *svc, ldpc_service_result_t *res,
+                      int *inf) {
+  int got = 0;
+  pthread_mutex_lock(&svc->lock);
+  if (svc->n_done > 0) {
+    take_done(svc, res, inf);
+    got = 1;
+  }
+  pthread_mutex_unlock(&svc->lock);
+  return got;
+}
+
+void ldpc_service_drain(ldpc_service_t *svc) {
+  pthread_mutex_lock(&svc->lock);
+  while (svc->pending > svc->n_done)
+    pthread_cond_wait(&svc->idle, &svc->lock);
+  pthread_mutex_unlock(&svc->lock);
+}
+
+long long ldpc_service_steals(const ldpc_service_t *svc) {
+  ldpc_service_t *s = (ldpc_service_t *)svc;
+  pthread_mutex_lock(&s->lock);
+  long long n = s->steals;
+  pthread_mutex_unlock(&s->lock);
+  return n;
+}
@@ -0,0 +1,413 @@
+/**
+ * @file ldpc_sim.c
+ * @brief Multi-threaded Monte Carlo BER engine (BPSK over AWGN).
+ *
+ * This module provides:
+ *   - Per-worker decoder, encoder scratch and buffer sets on a shared graph
+ *   - Static frame partitioning with one xoshiro256** stream per worker
+ *   - Persistent worker threads, started once in ldpc_sim_create() and
+ *     parked on a condition variable between ldpc_sim_run() calls;
+ *     worker 0 runs on the calling thread
+ *
+ * All per-frame memory and all threads are set up once in
+ * ldpc_sim_create(), so a call costs one wake-up and one completion
+ * signal per worker, however few frames it runs.
+ */
+
+#include "ldpc_sim.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ldpc_noise.h"
+
+/* ========================================================================== */
+/* Worker and engine contexts                                                 */
+/* ========================================================================== */
+typedef struct {
+  struct ldpc_sim *sim;
+  ldpc_rng_t rng;
+
+  ldpc_decoder_t *dec;
+  ldpc_qc_decoder_t *qcdec; /* replaces dec for QC codes */
+  ldpc_decoder_t *dec_ref;
+  ldpc_qdecoder_t *qdec[LDPC_SIM_MAX_QUANT];
+  ldpc_hencoder_t *henc; /* private copy: encoding uses scratch memory */
+
+  int *inf, *code, *ecc, *inf_hat, *inf_ref;
+  int *unsat; /* [max_iter] unsatisfied-check trace (stats only) */
+  double *LLR;
+  int8_t *LLR_q8;
+  int16_t *LLR_q16;
+
+  long long n_frames; /* frames of the current call */
+  ldpc_sim_counts_t counts;
+
+  pthread_t thread; /* workers 1 .. T-1 */
+  int started;      /* thread running; else the worker runs inline */
+} sim_worker_t;
+
+struct ldpc_sim {
+  ldpc_sim_config_t cfg;
+  ldpc_rng_t base; /* seed after the long jumps of the shard */
+  double sigma2;
+  sim_worker_t *w; /* [n_threads] */
+
+  /* the lock protects round, busy and stop */
+  pthread_mutex_t lock;
+  pthread_cond_t go;   /* round advanced or stop */
+  pthread_cond_t done; /* busy == 0              */
+  long long round;     /* ldpc_sim_run() calls so far */
+  int busy;            /* threads still running the current call */
+  int stop;
+};
+
+static void *sim_alloc(size_t n, size_t size) {
+  void *p = malloc((n > 0 ? n : 1) * size);
+  if (!p) {
+    fprintf(stderr, "malloc failed in ldpc_sim_create\n");
+    exit(1);
+  }
+  return p;
+}
+
+/* ========================================================================== */
+/* One frame                                                                  */
+/* ========================================================================== */
+static void sim_frame(sim_worker_t *w) {
+  const ldpc_sim_config_t *cfg = &w->sim->cfg;
+  int N = cfg->graph->N, K = cfg->K;
+  double sigma2 = w->sim->sigma2;
+  int i;
+
+  /* all-zero mode: inf and code stay zero from ldpc_sim_create() */
+  if (!cfg->all_zero) {
+    ldpc_rng_bits(&w->rng, w->inf, K);
+    if (w->henc)
+      ldpc_hencoder_encode(w->henc, w->code, w->inf);
+    else if (cfg->enc)
+      ldpc_encoder_encode(cfg->enc, w->code, w->inf);
+    else
+      ldpc_encode(w->code, w->inf, cfg->G, N, K);
+  }
+
+  double weight = 1.0;
+  if (cfg->is)
+    weight = ldpc_is_awgn_llr(cfg->is, &w->rng, w->code, w->LLR, N, sigma2);
+  else
+    ldpc_bpsk_awgn_llr(&w->rng, w->code, w->LLR, N, sigma2);
+
+  if (w->qcdec) {
+    w->counts.iterations += ldpc_qc_decoder_decode(
+        w->qcdec, w->LLR, w->ecc, w->inf_hat, cfg->max_iter);
+  } else if (cfg->stats) {
+    ldpc_decoder_stats_t st;
+    ldpc_sim_stats_t *acc = &w->counts.stats;
+    st.unsat = w->unsat;
+    w->counts.iterations += ldpc_decoder_decode_stats(
+        w->dec, w->LLR, w->ecc, w->inf_hat, cfg->max_iter, &st);
+    if (st.converged)
+      acc->converged[st.iterations]++;
+    else
+      acc->failed++;
+    for (i = 0; i < st.iterations; i++) {
+      acc->unsat_sum[i] += st.unsat[i];
+      acc->unsat_frames[i]++;
+    }
+    acc->cn_ns += (long long)st.cn_ns;
+    acc->vn_ns += (long long)st.vn_ns;
+    acc->syn_ns += (long long)st.syn_ns;
+    acc->fallback += st.fallback;
+    acc->bf_iterations += st.bf_iterations;
+    acc->bf_ns += (long long)st.bf_ns;
+  } else {
+    w->counts.iterations += ldpc_decoder_decode(w->dec, w->LLR, w->ecc,
+                                                w->inf_hat, cfg->max_iter);
+  }
+  long long err = 0;
+  for (i = 0; i < K; i++)
+    if (w->inf[i] != w->inf_hat[i])
+      err++;
+  w->counts.err_info += err;
+  w->counts.err_frames += (err > 0);
+  if (cfg->is) {
+    double we = (err > 0) ? weight : 0.0, wb = weight * (double)err;
+    w->counts.is_w += weight;
+    w->counts.is_fe += we;
+    w->counts.is_fe2 += we * we;
+    w->counts.is_be += wb;
+    w->counts.is_be2 += wb * wb;
+  }
+
+  if (w->dec_ref) {
+    int differ = 0;
+    memcpy(w->inf_ref, w->inf_hat, K * sizeof(int));
+    ldpc_decoder_decode(w->dec_ref, w->LLR, w->ecc, w->inf_hat,
+                        cfg->max_iter);
+    for (i = 0; i < K; i++) {
+      if (w->inf[i] != w->inf_hat[i])
+        w->counts.err_libm++;
+      if (w->inf_ref[i] != w->inf_hat[i])
+        differ = 1;
+    }
+    w->counts.frames_differ += differ;
+  }
+
+  /* same noisy frame through each fixed-point format */
+  for (int q = 0; q < cfg->n_quant; q++) {
+    if (cfg->quant[q].bits <= 8) {
+      ldpc_quantize_llr_q8(w->LLR, w->LLR_q8, N, &cfg->quant[q]);
+      ldpc_qdecoder_decode_q8(w->qdec[q], w->LLR_q8, w->ecc, w->inf_hat,
+                              cfg->max_iter);
+    } else {
+      ldpc_quantize_llr_q16(w->LLR, w->LLR_q16, N, &cfg->quant[q]);
+      ldpc_qdecoder_decode_q16(w->qdec[q], w->LLR_q16, w->ecc, w->inf_hat,
+                               cfg->max_iter);
+    }
+    for (i = 0; i < K; i++)
+      if (w->inf[i] != w->inf_hat[i])
+        w->counts.err_q[q]++;
+  }
+
+  w->counts.frames++;
+}
+
+static void sim_worker_run(sim_worker_t *w) {
+  for (long long f = 0; f < w->n_frames; f++)
+    sim_frame(w);
+}
+
+/* Threads of workers 1 .. T-1: one sim_worker_run() per round */
+static void *sim_worker_main(void *arg) {
+  sim_worker_t *w = (sim_worker_t *)arg;
+  struct ldpc_sim *sim = w->sim;
+  long long seen = 0;
+
+  pthread_mutex_lock(&sim->lock);
+  for (;;) {
+    while (!sim->stop && sim->round == seen)
+      pthread_cond_wait(&sim->go, &sim->lock);
+    if (sim->stop)
+      break;
+    seen = sim->round;
+    pthread_mutex_unlock(&sim->lock);
+
+    sim_worker_run(w);
+
+    pthread_mutex_lock(&sim->lock);
+    if (--sim->busy == 0)
+      pthread_cond_signal(&sim->done);
+  }
+  pthread_mutex_unlock(&sim->lock);
+  return NULL;
+}
+
+/* ========================================================================== */
+/* Public API                                                                 */
+/* ========================================================================== */
+ldpc_sim_t *ldpc_sim_create(const ldpc_sim_config_t *cfg) {
+  if (cfg->n_threads < 1 || cfg->shard < 0 || cfg->n_quant < 0 ||
+      cfg->n_quant > LDPC_SIM_MAX_QUANT ||
+      (!cfg->all_zero && !cfg->henc && !cfg->enc && !cfg->G) ||
+      (cfg->stats && cfg->max_iter > LDPC_SIM_MAX_ITER))
+    return NULL;
+
+  ldpc_sim_t *sim = (ldpc_sim_t *)sim_alloc(1, sizeof(ldpc_sim_t));
+  sim->cfg = *cfg;
+  sim->sigma2 = 1.0;
+  ldpc_rng_stream(&sim->base, cfg->seed,
+                  cfg->shard * LDPC_SIM_MAX_POINTS, 0);
+  sim->w = (sim_worker_t *)calloc(cfg->n_threads, sizeof(sim_worker_t));
+  if (!sim->w) {
+    fprintf(stderr, "malloc failed in ldpc_sim_create\n");
+    exit(1);
+  }
+
+  const ldpc_graph_t *g = cfg->graph;
+  for (int t = 0; t < cfg->n_threads; t++) {
+    sim_worker_t *w = &sim->w[t];
+    w->sim = sim;
+
+    if (cfg->qc && !cfg->stats && cfg->schedule == LDPC_SCHED_LAYERED &&
+        cfg->kernel != LDPC_CN_SPA && cfg->precision == LDPC_PREC_F64 &&
+        cfg->bf_iter <= 0) {
+      w->qcdec = ldpc_qc_decoder_create(cfg->qc, cfg->K);
+      ldpc_qc_decoder_set_kernel(w->qcdec, cfg->kernel, cfg->cn_param);
+    } else {
+      w->dec = ldpc_decoder_create_from_graph(g, cfg->K);
+      ldpc_decoder_set_kernel(w->dec, cfg->kernel, cfg->cn_param);
+      ldpc_decoder_set_schedule(w->dec, cfg->schedule);
+      ldpc_decoder_set_phi(w->dec, cfg->phi);
+      ldpc_decoder_set_precision(w->dec, cfg->precision);
+      ldpc_decoder_set_hybrid(w->dec, cfg->bf_iter, cfg->bf_mode,
+                              cfg->bf_param, cfg->bf_gate);
+    }
+
+    if (cfg->check_libm) {
+      w->dec_ref = ldpc_decoder_create_from_graph(g, cfg->K);
+      ldpc_decoder_set_schedule(w->dec_ref, cfg->schedule);
+      ldpc_decoder_set_precision(w->dec_ref, cfg->precision);
+    }
+
+    for (int q = 0; q < cfg->n_quant; q++) {
+      w->qdec[q] = ldpc_qdecoder_create(g, cfg->K, &cfg->quant[q]);
+      ldpc_qdecoder_set_kernel(w->qdec[q], cfg->kernel, cfg->cn_param);
+      ldpc_qdecoder_set_schedule(w->qdec[q], cfg->schedule);
+    }
+
+    if (cfg->henc && !cfg->all_zero)
+      w->henc = ldpc_hencoder_dup(cfg->henc);
+
+    w->inf = (int *)sim_alloc(cfg->K, sizeof(int));
+    w->code = (int *)sim_alloc(g->N, sizeof(int));
+    memset(w->inf, 0, cfg->K * sizeof(int));
+    memset(w->code, 0, g->N * sizeof(int));
+    w->ecc = (int *)sim_alloc(g->N, sizeof(int));
+    w->inf_hat = (int *)sim_alloc(cfg->K, sizeof(int));
+    w->inf_ref = (int *)sim_alloc(cfg->K, sizeof(int));
+    w->LLR = (double *)sim_alloc(g->N, sizeof(double));
+    w->unsat = (int *)sim_alloc(cfg->max_iter, sizeof(int));
+    w->LLR_q8 = (int8_t *)sim_alloc(g->N, sizeof(int8_t));
+    w->LLR_q16 = (int16_t *)sim_alloc(g->N, sizeof(int16_t));
+  }
+
+  sim->round = 0;
+  sim->busy = 0;
+  sim->stop = 0;
+  pthread_mutex_init(&sim->lock, NULL);
+  pthread_cond_init(&sim->go, NULL);
+  pthread_cond_init(&sim->done, NULL);
+  /* a worker whose thread cannot be started runs on the calling thread */
+  for (int t = 1; t < cfg->n_threads; t++)
+    sim->w[t].started = (pthread_create(&sim->w[t].thread, NULL,
+                                        sim_worker_main, &sim->w[t]) == 0);
+
+  ldpc_sim_set_point(sim, 0, 1.0);
+  return sim;
+}
+
+void ldpc_sim_free(ldpc_sim_t *sim) {
+  if (!sim)
+    return;
+
+  pthread_mutex_lock(&sim->lock);
+  sim->stop = 1;
+  pthread_cond_broadcast(&sim->go);
+  pthread_mutex_unlock(&sim->lock);
+  for (int t = 1; t < sim->cfg.n_threads; t++)
+    if (sim->w[t].started)
+      pthread_join(sim->w[t].thread, NULL);
+  pthread_mutex_destroy(&sim->lock);
+  pthread_cond_destroy(&sim->go);
+  pthread_cond_destroy(&sim->done);
+
+  for (int t = 0; t < sim->cfg.n_threads; t++) {
+    sim_worker_t *w = &sim->w[t];
+    ldpc_decoder_free(w->dec);
+    ldpc_qc_decoder_free(w->qcdec);
+    ldpc_decoder_free(w->dec_ref);
+    for (int q = 0; q < sim->cfg.n_quant; q++)
+      ldpc_qdecoder_free(w->qdec[q]);
+    ldpc_hencoder_free(w->henc);
+    free(w->inf);
+    free(w->code);
+    free(w->ecc);
+    free(w->inf_hat);
+    free(w->inf_ref);
+    free(w->LLR);
+    free(w->unsat);
+    free(w->LLR_q8);
+    free(w->LLR_q16);
+  }
+  free(sim->w);
+  free(sim);
+}
+
+void ldpc_sim_set_point(ldpc_sim_t *sim, int point, double sigma2) {
+  /* stream(seed, shard·MAX_POINTS + point, t), from the shard's base */
+  ldpc_rng_t r = sim->base;
+  sim->sigma2 = sigma2;
+  for (int p = 0; p < point; p++)
+    ldpc_rng_long_jump(&r);
+  for (int t = 0; t < sim->cfg.n_threads; t++) {
+    sim->w[t].rng = r;
+    ldpc_rng_jump(&r);
+  }
+}
+
+void ldpc_sim_get_rng(const ldpc_sim_t *sim, ldpc_rng_t *rng) {
+  for (int t = 0; t < sim->cfg.n_threads; t++)
+    rng[t] = sim->w[t].rng;
+}
+
+void ldpc_sim_set_rng(ldpc_sim_t *sim, const ldpc_rng_t *rng) {
+  for (int t = 0; t < sim->cfg.n_threads; t++)
+    sim->w[t].rng = rng[t];
+}
+
+void ldpc_sim_run(ldpc_sim_t *sim, long long n_frames,
+                  ldpc_sim_counts_t *counts) {
+  int T = sim->cfg.n_threads, n_started = 0;
+
+  for (int t = 0; t < T; t++) {
+    sim_worker_t *w = &sim->w[t];
+    w->n_frames = n_frames * (t + 1) / T - n_frames * t / T;
+    memset(&w->counts, 0, sizeof(w->counts));
+    n_started += w->started;
+  }
+
+  /* wake workers 1..T-1, run worker 0 (and any without a thread) here */
+  if (n_started > 0) {
+    pthread_mutex_lock(&sim->lock);
+    sim->round++;
+    sim->busy = n_started;
+    pthread_cond_broadcast(&sim->go);
+    pthread_mutex_unlock(&sim->lock);
+  }
+  for (int t = 0; t < T; t++)
+    if (!sim->w[t].started)
+      sim_worker_run(&sim->w[t]);
+  if (n_started > 0) {
+    pthread_mutex_lock(&sim->lock);
+    while (sim->busy > 0)
+      pthread_cond_wait(&sim->done, &sim->lock);
+    pthread_mutex_unlock(&sim->lock);
+  }
+
+  /* reduce in worker order */
+  for (int t = 0; t < T; t++) {
+    const ldpc_sim_counts_t *c = &sim->w[t].counts;
+    counts->frames += c->frames;
+    counts->err_info += c->err_info;
+    counts->err_frames += c->err_frames;
+    counts->iterations += c->iterations;
+    counts->err_libm += c->err_libm;
+    counts->frames_differ += c->frames_differ;
+    for (int q = 0; q < sim->cfg.n_quant; q++)
+      counts->err_q[q] += c->err_q[q];
+    counts->is_w += c->is_w;
+    counts->is_fe += c->is_fe;
+    counts->is_fe2 += c->is_fe2;
+    counts->is_be += c->is_be;
+    counts->is_be2 += c->is_be2;
+    if (sim->cfg.stats) {
+      ldpc_sim_stats_t *a = &counts->stats;
+      const ldpc_sim_stats_t *b = &c->stats;
+      for (int i = 0; i <= sim->cfg.max_iter; i++)
+        a->converged[i] += b->converged[i];
+      for (int i = 0; i < sim->cfg.max_iter; i++) {
+        a->unsat_sum[i] += b->unsat_sum[i];
+        a->unsat_frames[i] += b->unsat_frames[i];
+      }
+      a->failed += b->failed;
+      a->cn_ns += b->cn_ns;
+      a->vn_ns += b->vn_ns;
+      a->syn_ns += b->syn_ns;
+      a->fallback += b->fallback;
+      a->bf_iterations += b->bf_iterations;
+      a->bf_ns += b->bf_ns;
+    }
+  }
+}
@@ -0,0 +1,608 @@
+/**
+ * @file ldpc_stream.c
+ * @brief Ring-buffered streaming encode / decode pipelines.
+ *
+ * Buffer life cycle (sequence numbers grow without bound, buffer =
+ * seq % n_bufs):
+ *
+ *      FREE ──reader fills──▶ FULL ──workers code all frames──▶ DONE
+ *        ▲                                                        │
+ *        └──────────────────writer writes the output──────────────┘
+ *
+ * Workers take single frames from the oldest FULL buffer that still has
+ * frames to hand out, so a worker can hold frames of two buffers at once
+ * (lanes refilled across the boundary). Bit-stream outputs of adjacent
+ * frames may share a byte; output areas are cleared by the reader and the
+ * boundary bytes of a frame are OR-ed atomically.
+ */
+
+#include "ldpc_stream.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ========================================================================== */
+/* Formats                                                                    */
+/* ========================================================================== */
+static const char *const format_names[] = {"bits", "f32", "s8"};
+
+const char *ldpc_stream_format_name(ldpc_stream_format fmt) {
+  if ((int)fmt < 0 || fmt > LDPC_STREAM_S8)
+    return "?";
+  return format_names[fmt];
+}
+
+int ldpc_stream_format_parse(const char *name, ldpc_stream_format *fmt) {
+  for (int i = 0; i <= LDPC_STREAM_S8; i++) {
+    if (!strcmp(name, format_names[i])) {
+      *fmt = (ldpc_stream_format)i;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/* Stream bits per code bit */
+static int format_bits(ldpc_stream_format fmt) {
+  return fmt == LDPC_STREAM_F32 ? 32 : fmt == LDPC_STREAM_S8 ? 8 : 1;
+}
+
+/* ========================================================================== */
+/* MSB-first bit streams                                                      */
+/* ========================================================================== */
+static void get_bits(const unsigned char *s, long long pos, int *bits,
+                     int n) {
+  for (int k = 0; k < n; k++, pos++)
+    bits[k] = (s[pos >> 3] >> (7 - (pos & 7))) & 1;
+}
+
+/* The first and last byte of a frame may be shared with the neighbouring
+ * frames, which other workers write concurrently. */
+static inline void store_byte(unsigned char *s, long long i, unsigned v,
+                              int shared) {
+  if (shared)
+    __atomic_fetch_or(&s[i], (unsigned char)v, __ATOMIC_RELAXED);
+  else
+    s[i] = (unsigned char)v;
+}
+
+static void put_bits(unsigned char *s, long long pos, const int *bits,
+                     int n) {
+  long long first = pos >> 3;
+  long long byte = first;
+  unsigned acc = 0;
+  for (int k = 0; k < n; k++, pos++) {
+    if ((pos >> 3) != byte) {
+      store_byte(s, byte, acc, byte == first);
+      acc = 0;
+      byte = pos >> 3;
+    }
+    if (bits[k])
+      acc |= 0x80u >> (pos & 7);
+  }
+  store_byte(s, byte, acc, 1);
+}
+
+static int syndrome_is_zero(const ldpc_graph_t *g, const int *ecc) {
+  for (int i = 0; i < g->M; i++) {
+    int parity = 0;
+    for (int k = g->row_ptr[i]; k < g->row_ptr[i + 1]; k++)
+      parity ^= ecc[g->col_idx[k]];
+    if (parity)
+      return 0;
+  }
+  return 1;
+}
+
+/* ========================================================================== */
+/* Buffer ring                                                                */
+/* ========================================================================== */
+enum { BUF_FREE = 0, BUF_FULL, BUF_DONE };
+
+typedef struct {
+  unsigned char *in;  /* [in_cap]  */
+  unsigned char *out; /* [out_cap] */
+  size_t out_bytes;   /* valid output bytes */
+  int n_frames;
+  int next;      /* next frame to hand out */
+  int remaining; /* frames not finished yet */
+  int state;
+} buf_t;
+
+typedef struct {
+  buf_t *buf;
+  int n_bufs;
+  int F;                  /* frames per buffer (multiple of 8) */
+  long long in_bits;      /* stream bits per input frame        */
+  long long out_bits;     /* stream bits per output frame       */
+  size_t in_cap, out_cap; /* bytes per buffer                   */
+  int pad_input;          /* encoder: pad a partial last frame  */
+
+  FILE *in, *out;
+
+  pthread_mutex_t lock;
+  pthread_cond_t cv_free; /* reader: buffer became FREE      */
+  pthread_cond_t cv_full; /* workers: frames published / eof */
+  pthread_cond_t cv_done; /* writer: buffer became DONE      */
+
+  long long rd_seq;   /* next buffer the reader fills          */
+  long long work_seq; /* buffer workers take frames from        */
+  long long wr_seq;   /* next buffer the writer writes          */
+  int eof;            /* reader finished                        */
+  int error;
+
+  long long frames, bytes_in, bytes_out;
+} pipe_t;
+
+static void pipe_init(pipe_t *p, const ldpc_stream_ring_t *ring,
+                      long long in_bits, long long out_bits, int pad_input,
+                      FILE *in, FILE *out) {
+  memset(p, 0, sizeof(*p));
+  int T = ring->n_threads > 0 ? ring->n_threads : 1;
+  p->n_bufs = ring->n_bufs > 0 ? ring->n_bufs : 2 * T + 2;
+  if (p->n_bufs < 2)
+    p->n_bufs = 2;
+  p->F = ring->frames_per_buf > 0 ? ring->frames_per_buf
+                                  : 16 * LDPC_BATCH_LANES;
+  p->F = (p->F + 7) & ~7; /* every buffer is a whole number of bytes */
+  p->in_bits = in_bits;
+  p->out_bits = out_bits;
+  p->in_cap = (size_t)(p->F * in_bits / 8);
+  p->out_cap = (size_t)(p->F * out_bits / 8);
+  p->pad_input = pad_input;
+  p->in = in;
+  p->out = out;
+
+  p->buf = (buf_t *)calloc((size_t)p->n_bufs, sizeof(buf_t));
+  if (!p->buf) {
+    fprintf(stderr, "malloc failed in ldpc_stream\n");
+    exit(1);
+  }
+  for (int b = 0; b < p->n_bufs; b++) {
+    p->buf[b].in = (unsigned char *)malloc(p->in_cap);
+    p->buf[b].out = (unsigned char *)malloc(p->out_cap);
+    if (!p->buf[b].in || !p->buf[b].out) {
+      fprintf(stderr, "malloc failed in ldpc_stream\n");
+      exit(1);
+    }
+  }
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->cv_free, NULL);
+  pthread_cond_init(&p->cv_full, NULL);
+  pthread_cond_init(&p->cv_done, NULL);
+}
+
+static void pipe_destroy(pipe_t *p) {
+  for (int b = 0; b < p->n_bufs; b++) {
+    free(p->buf[b].in);
+    free(p->buf[b].out);
+  }
+  free(p->buf);
+  pthread_mutex_destroy(&p->lock);
+  pthread_cond_destroy(&p->cv_free);
+  pthread_cond_destroy(&p->cv_full);
+  pthread_cond_destroy(&p->cv_done);
+}
+
+/* Reader stage: fill free buffers until end of input (or a write error). */
+static void *reader_main(void *arg) {
+  pipe_t *p = (pipe_t *)arg;
+
+  for (;;) {
+    pthread_mutex_lock(&p->lock);
+    buf_t *b = &p->buf[p->rd_seq % p->n_bufs];
+    while (b->state != BUF_FREE && !p->error)
+      pthread_cond_wait(&p->cv_free, &p->lock);
+    if (p->error) { /* write failed: stop reading, let the rest drain */
+      p->eof = 1;
+      pthread_cond_broadcast(&p->cv_full);
+      pthread_cond_broadcast(&p->cv_done);
+      pthread_mutex_unlock(&p->lock);
+      return NULL;
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    size_t got = fread(b->in, 1, p->in_cap, p->in);
+    int last = (got < p->in_cap);
+
+    long long bits = (long long)got * 8;
+    if (p->pad_input) {
+      b->n_frames = (int)((bits + p->in_bits - 1) / p->in_bits);
+      memset(b->in + got, 0, p->in_cap - got);
+    } else {
+      b->n_frames = (int)(bits / p->in_bits);
+    }
+    b->out_bytes = (size_t)((b->n_frames * p->out_bits + 7) / 8);
+    memset(b->out, 0, b->out_bytes);
+    b->next = 0;
+    b->remaining = b->n_frames;
+
+    pthread_mutex_lock(&p->lock);
+    b->state = b->n_frames > 0 ? BUF_FULL : BUF_DONE;
+    p->rd_seq++;
+    p->bytes_in += (long long)got;
+    p->frames += b->n_frames;
+    if (last) {
+      p->eof = 1;
+      if (ferror(p->in))
+        p->error = 1;
+    }
+    pthread_cond_broadcast(&p->cv_full);
+    pthread_cond_broadcast(&p->cv_done);
+    pthread_mutex_unlock(&p->lock);
+    if (last)
+      return NULL;
+  }
+}
+
+/*
+ * Next frame to code. Returns 1 with *bp / *idx set, 0 if no frame is
+ * available right now (block = 0 only), -1 at the end of the stream.
+ */
+static int pipe_take(pipe_t *p, int block, buf_t **bp, int *idx) {
+  pthread_mutex_lock(&p->lock);
+  for (;;) {
+    if (p->work_seq < p->rd_seq) {
+      buf_t *b = &p->buf[p->work_seq % p->n_bufs];
+      if (b->next < b->n_frames) {
+        *bp = b;
+        *idx = b->next++;
+        if (b->next == b->n_frames)
+          p->work_seq++;
+        pthread_mutex_unlock(&p->lock);
+        return 1;
+      }
+      p->work_seq++; /* empty buffer */
+      continue;
+    }
+    if (p->eof || !block) {
+      int r = p->eof ? -1 : 0;
+      pthread_mutex_unlock(&p->lock);
+      return r;
+    }
+    pthread_cond_wait(&p->cv_full, &p->lock);
+  }
+}
+
+/* One frame of b is coded; the last one hands the buffer to the writer. */
+static void pipe_finish(pipe_t *p, buf_t *b) {
+  pthread_mutex_lock(&p->lock);
+  if (--b->remaining == 0) {
+    b->state = BUF_DONE;
+    pthread_cond_broadcast(&p->cv_done);
+  }
+  pthread_mutex_unlock(&p->lock);
+}
+
+/* Writer stage (calling thread): write DONE buffers in stream order. */
+static void pipe_write(pipe_t *p) {
+  for (;;) {
+    pthread_mutex_lock(&p->lock);
+    buf_t *b = &p->buf[p->wr_seq % p->n_bufs];
+    while ((p->wr_seq == p->rd_seq && !p->eof) ||
+           (p->wr_seq < p->rd_seq && b->state != BUF_DONE))
+      pthread_cond_wait(&p->cv_done, &p->lock);
+    if (p->wr_seq == p->rd_seq) {
+      pthread_mutex_unlock(&p->lock);
+      break;
+    }
+    int skip = p->error;
+    pthread_mutex_unlock(&p->lock);
+
+    int failed = 0;
+    if (!skip && b->out_bytes > 0)
+      failed = fwrite(b->out, 1, b->out_bytes, p->out) != b->out_bytes;
+
+    pthread_mutex_lock(&p->lock);
+    if (failed)
+      p->error = 1;
+    else if (!skip)
+      p->bytes_out += (long long)b->out_bytes;
+    b->state = BUF_FREE;
+    p->wr_seq++;
+    pthread_cond_broadcast(&p->cv_free);
+    pthread_mutex_unlock(&p->lock);
+  }
+  if (!p->error && fflush(p->out) != 0)
+    p->error = 1;
+}
+
+/* Start n workers and the reader, write in this thread, join everything.
+ * If a thread cannot be started, the ones already running are shut down
+ * (end of stream with nothing read) and -1 is returned. */
+static int pipe_run(pipe_t *p, int n, void *(*worker)(void *), void *ctx,
+                    size_t ctx_size) {
+  pthread_t reader;
+  pthread_t *tid = (pthread_t *)malloc((size_t)n * sizeof(pthread_t));
+  if (!tid) {
+    fprintf(stderr, "malloc failed in ldpc_stream\n");
+    exit(1);
+  }
+  int started = 0;
+  while (started < n &&
+         pthread_create(&tid[started], NULL, worker,
+                        (char *)ctx + started * ctx_size) == 0)
+    started++;
+  int ok = (started == n &&
+            pthread_create(&reader, NULL, reader_main, p) == 0);
+
+  if (ok) {
+    pipe_write(p);
+    pthread_join(reader, NULL);
+  } else {
+    fprintf(stderr, "pthread_create failed in ldpc_stream\n");
+    pthread_mutex_lock(&p->lock);
+    p->eof = 1;
+    p->error = 1;
+    pthread_cond_broadcast(&p->cv_full);
+    pthread_mutex_unlock(&p->lock);
+  }
+  for (int t = 0; t < started; t++)
+    pthread_join(tid[t], NULL);
+  free(tid);
+  return p->error ? -1 : 0;
+}
+
+static void fill_counts(const pipe_t *p, ldpc_stream_counts_t *counts) {
+  counts->frames = p->frames;
+  counts->bytes_in = p->bytes_in;
+  counts->bytes_out = p->bytes_out;
+}
+
+/* ========================================================================== */
+/* Encode pipeline                                                            */
+/* ========================================================================== */
+typedef struct {
+  pipe_t *p;
+  const ldpc_stream_enc_config_t *cfg;
+  ldpc_hencoder_t *henc; /* private copy, NULL with a G encoder */
+} enc_worker_t;
+
+static void *enc_worker_main(void *arg) {
+  enc_worker_t *w = (enc_worker_t *)arg;
+  pipe_t *p = w->p;
+  const ldpc_stream_enc_config_t *cfg = w->cfg;
+  int N = cfg->N, K = cfg->K;
+
+  int *inf = (int *)malloc((size_t)(K > 0 ? K : 1) * sizeof(int));
+  int *ecc = (int *)malloc((size_t)N * sizeof(int));
+  if (!inf || !ecc) {
+    fprintf(stderr, "malloc failed in ldpc_stream_encode\n");
+    exit(1);
+  }
+
+  buf_t *b;
+  int f;
+  while (pipe_take(p, 1, &b, &f) > 0) {
+    get_bits(b->in, (long long)f * K, inf, K);
+    if (cfg->enc)
+      ldpc_encoder_encode(cfg->enc, ecc, inf);
+    else
+      ldpc_hencoder_encode(w->henc, ecc, inf);
+
+    switch (cfg->format) {
+    case LDPC_STREAM_BITS:
+      put_bits(b->out, (long long)f * N, ecc, N);
+      break;
+    case LDPC_STREAM_F32: {
+      float *x = (float *)b->out + (size_t)f * N;
+      for (int j = 0; j < N; j++)
+        x[j] = ecc[j] ? 1.0f : -1.0f;
+      break;
+    }
+    case LDPC_STREAM_S8: {
+      int8_t *x = (int8_t *)b->out + (size_t)f * N;
+      for (int j = 0; j < N; j++)
+        x[j] = ecc[j] ? 127 : -127;
+      break;
+    }
+    }
+    pipe_finish(p, b);
+  }
+
+  free(inf);
+  free(ecc);
+  return NULL;
+}
+
+int ldpc_stream_encode(const ldpc_stream_enc_config_t *cfg, FILE *in,
+                       FILE *out, ldpc_stream_counts_t *counts) {
+  if ((!cfg->enc && !cfg->henc) || cfg->K < 1 || (int)cfg->format < 0 ||
+      cfg->format > LDPC_STREAM_S8)
+    return -1;
+
+  pipe_t p;
+  pipe_init(&p, &cfg->ring, cfg->K,
+            (long long)cfg->N * format_bits(cfg->format), 1, in, out);
+
+  int T = cfg->ring.n_threads > 0 ? cfg->ring.n_threads : 1;
+  enc_worker_t *w = (enc_worker_t *)calloc((size_t)T, sizeof(enc_worker_t));
+  if (!w) {
+    fprintf(stderr, "malloc failed in ldpc_stream_encode\n");
+    exit(1);
+  }
+  for (int t = 0; t < T; t++) {
+    w[t].p = &p;
+    w[t].cfg = cfg;
+    w[t].henc = cfg->enc ? NULL : ldpc_hencoder_dup(cfg->henc);
+  }
+
+  int rc = pipe_run(&p, T, enc_worker_main, w, sizeof(enc_worker_t));
+  if (counts) {
+    memset(counts, 0, sizeof(*counts));
+    fill_counts(&p, counts);
+  }
+
+  for (int t = 0; t < T; t++)
+    ldpc_hencoder_free(w[t].henc);
+  free(w);
+  pipe_destroy(&p);
+  return rc;
+}
+
+/* ========================================================================== */
+/* Decode pipeline                                                            */
+/* ========================================================================== */
+typedef struct {
+  pipe_t *p;
+  const ldpc_stream_dec_config_t *cfg;
+  long long iterations;
+  long long not_converged;
+} dec_worker_t;
+
+/* Min-sum family: batch decoder in stream mode, lanes refilled from the
+ * input buffers as soon as their frame finishes. */
+static void dec_batch(dec_worker_t *w) {
+  pipe_t *p = w->p;
+  const ldpc_stream_dec_config_t *cfg = w->cfg;
+  const int N = cfg->graph->N, K = cfg->K;
+  const float scale = (float)cfg->llr_scale;
+
+  ldpc_batch_decoder_t *bd = ldpc_batch_create(cfg->graph, K, cfg->target);
+  ldpc_batch_set_kernel(bd, cfg->kernel, cfg->cn_param);
+  ldpc_batch_set_schedule(bd, cfg->schedule);
+  int *inf = (int *)malloc((size_t)(K > 0 ? K : 1) * sizeof(int));
+  if (!inf) {
+    fprintf(stderr, "malloc failed in ldpc_stream_decode\n");
+    exit(1);
+  }
+
+  buf_t *lane_buf[LDPC_BATCH_LANES];
+  int lane_frame[LDPC_BATCH_LANES];
+  int end = 0;
+
+  for (;;) {
+    uint32_t busy = ldpc_batch_stream_busy(bd);
+    for (int l = 0; l < LDPC_BATCH_LANES && !end; l++) {
+      if (busy & (1u << l))
+        continue;
+      buf_t *b;
+      int f;
+      int r = pipe_take(p, busy == 0, &b, &f);
+      if (r <= 0) {
+        end = (r < 0);
+        break;
+      }
+      if (cfg->format == LDPC_STREAM_F32)
+        ldpc_batch_stream_load_f32(bd, l, (const float *)b->in + (size_t)f * N,
+                                   scale);
+      else
+        ldpc_batch_stream_load_s8(bd, l, (const int8_t *)b->in + (size_t)f * N,
+                                  scale);
+      lane_buf[l] = b;
+      lane_frame[l] = f;
+      busy |= 1u << l;
+    }
+    if (!busy)
+      break;
+
+    uint32_t fin = ldpc_batch_stream_step(bd, cfg->max_iter);
+    for (int l = 0; fin; l++, fin >>= 1) {
+      if (!(fin & 1u))
+        continue;
+      int iters, conv;
+      ldpc_batch_stream_result(bd, l, inf, &iters, &conv);
+      put_bits(lane_buf[l]->out, (long long)lane_frame[l] * K, inf, K);
+      w->iterations += iters;
+      w->not_converged += !conv;
+      pipe_finish(p, lane_buf[l]);
+    }
+  }
+
+  free(inf);
+  ldpc_batch_free(bd);
+}
+
+/* SPA: one frame at a time. */
+static void dec_scalar(dec_worker_t *w) {
+  pipe_t *p = w->p;
+  const ldpc_stream_dec_config_t *cfg = w->cfg;
+  const int N = cfg->graph->N, K = cfg->K;
+
+  ldpc_decoder_t *dec = ldpc_decoder_create_from_graph(cfg->graph, K);
+  ldpc_decoder_set_kernel(dec, cfg->kernel, cfg->cn_param);
+  ldpc_decoder_set_schedule(dec, cfg->schedule);
+  double *LLR = (double *)malloc((size_t)N * sizeof(double));
+  int *ecc = (int *)malloc((size_t)N * sizeof(int));
+  int *inf = (int *)malloc((size_t)(K > 0 ? K : 1) * sizeof(int));
+  if (!LLR || !ecc || !inf) {
+    fprintf(stderr, "malloc failed in ldpc_stream_decode\n");
+    exit(1);
+  }
+
+  buf_t *b;
+  int f;
+  while (pipe_take(p, 1, &b, &f) > 0) {
+    if (cfg->format == LDPC_STREAM_F32) {
+      const float *x = (const float *)b->in + (size_t)f * N;
+      for (int j = 0; j < N; j++)
+        LLR[j] = x[j] * cfg->llr_scale;
+    } else {
+      const int8_t *x = (const int8_t *)b->in + (size_t)f * N;
+      for (int j = 0; j < N; j++)
+        LLR[j] = x[j] * cfg->llr_scale;
+    }
+    int iters = ldpc_decoder_decode(dec, LLR, ecc, inf, cfg->max_iter);
+    int conv = iters < cfg->max_iter || syndrome_is_zero(cfg->graph, ecc);
+    put_bits(b->out, (long long)f * K, inf, K);
+    w->iterations += iters;
+    w->not_converged += !conv;
+    pipe_finish(p, b);
+  }
+
+  free(LLR);
+  free(ecc);
+  free(inf);
+  ldpc_decoder_free(dec);
+}
+
+static void *dec_worker_main(void *arg) {
+  dec_worker_t *w = (dec_worker_t *)arg;
+  if (w->cfg->kernel == LDPC_CN_SPA)
+    dec_scalar(w);
+  else
+    dec_batch(w);
+  return NULL;
+}
+
+int ldpc_stream_decode(const ldpc_stream_dec_config_t *cfg, FILE *in,
+                       FILE *out, ldpc_stream_counts_t *counts) {
+  if (cfg->format != LDPC_STREAM_F32 && cfg->format != LDPC_STREAM_S8)
+    return -1;
+  if (cfg->K < 1 || cfg->max_iter < 1)
+    return -1;
+  if (cfg->kernel != LDPC_CN_SPA && cfg->target != LDPC_SIMD_AUTO &&
+      !ldpc_simd_target_supported(cfg->target))
+    return -1;
+
+  pipe_t p;
+  pipe_init(&p, &cfg->ring, (long long)cfg->graph->N * format_bits(cfg->format),
+            cfg->K, 0, in, out);
+
+  int T = cfg->ring.n_threads > 0 ? cfg->ring.n_threads : 1;
+  dec_worker_t *w = (dec_worker_t *)calloc((size_t)T, sizeof(dec_worker_t));
+  if (!w) {
+    fprintf(stderr, "malloc failed in ldpc_stream_decode\n");
+    exit(1);
+  }
+  for (int t = 0; t < T; t++) {
+    w[t].p = &p;
+    w[t].cfg = cfg;
+  }
+
+  int rc = pipe_run(&p, T, dec_worker_main, w, sizeof(dec_worker_t));
+  if (counts) {
+    memset(counts, 0, sizeof(*counts));
+    fill_counts(&p, counts);
+    for (int t = 0; t < T; t++) {
+      counts->iterations += w[t].iterations;
+      counts->not_converged += w[t].not_converged;
+    }
+  }
+
+  free(w);
+  pipe_destroy(&p);
+  return rc;
+}